@@ -0,0 +1,597 @@
+/*
+ * Testy simulátoru uni_iec (jen POSIX, stejně jako simulátor)
+ */
+
+#include "unity.h"
+#include "iec60870_common.h"
+#include "iec60870_slave.h"
+#include "hal_time.h"
+#include "uni_commands.h"
+#include "uni_config.h"
+#include "uni_gicache.h"
+#include "uni_journal.h"
+#include "uni_points.h"
+#include "uni_timer.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+void setUp(void) { }
+void tearDown(void) {}
+
+struct sCommandResult {
+    int executed;
+    int wrong;
+    bool seen[200];
+};
+
+static CS101_AppLayerParameters
+test_CommandEngine_getParameters(IMasterConnection self)
+{
+    return (CS101_AppLayerParameters) self->object;
+}
+
+static void
+test_CommandEngine_handler(void* parameter, IMasterConnection connection, CS101_ASDU asdu, int point, float value)
+{
+    struct sCommandResult* result = (struct sCommandResult*) parameter;
+
+    (void) connection;
+
+    result->executed++;
+
+    InformationObject io = CS101_ASDU_getElement(asdu, 0);
+
+    if ((io == NULL) || (CS101_ASDU_getTypeID(asdu) != C_SC_NA_1) || (CS101_ASDU_getCA(asdu) != 20) ||
+            (point < 0) || (point >= 200) || (InformationObject_getObjectAddress(io) != 1000 + point) ||
+            (SingleCommand_getState((SingleCommand) io) != (value != 0.0f)) || result->seen[point]) {
+        result->wrong++;
+    }
+    else
+        result->seen[point] = true;
+
+    if (io)
+        InformationObject_destroy(io);
+}
+
+void
+test_CommandEngineManyInFlight(void)
+{
+    struct sCS101_AppLayerParameters alParameters;
+
+    alParameters.maxSizeOfASDU = 249;
+    alParameters.originatorAddress = 0;
+    alParameters.sizeOfCA = 2;
+    alParameters.sizeOfCOT = 2;
+    alParameters.sizeOfIOA = 3;
+    alParameters.sizeOfTypeId = 1;
+    alParameters.sizeOfVSQ = 1;
+
+    struct sIMasterConnection connection;
+    memset(&connection, 0, sizeof(connection));
+    connection.getApplicationLayerParameters = test_CommandEngine_getParameters;
+    connection.object = &alParameters;
+
+    PointTable points = PointTable_create(200);
+
+    int i;
+    for (i = 0; i < 200; i++)
+        PointTable_add(points, M_SP_NA_1, 1000 + i, 0.0f, 0.0f, 0);
+
+    CommandDelay delay;
+    memset(&delay, 0, sizeof(delay));
+    delay.kind = COMMAND_DELAY_FIXED;
+
+    CommandEngine engine = CommandEngine_create(points, &delay, 10000, 1000);
+    TEST_ASSERT_NOT_NULL(engine);
+
+    /* 200 commands in flight -> the slot array grows past its initial 64 slots */
+    for (i = 0; i < 200; i++) {
+        sCS101_StaticASDU storage;
+        CS101_ASDU asdu = CS101_ASDU_initializeStatic(&storage, &alParameters, false, CS101_COT_ACTIVATION, 0, 20,
+                false, false);
+
+        SingleCommand sc = SingleCommand_create(NULL, 1000 + i, (i % 2) == 1, false, 0);
+        CS101_ASDU_addInformationObject(asdu, (InformationObject) sc);
+        SingleCommand_destroy(sc);
+
+        TEST_ASSERT_EQUAL_INT(COMMAND_QUEUED, CommandEngine_submit(engine, &connection, asdu));
+    }
+
+    CommandStats stats;
+    CommandEngine_getStats(engine, &stats);
+    TEST_ASSERT_EQUAL_INT(200, stats.inFlight);
+
+    struct sCommandResult result;
+    memset(&result, 0, sizeof(result));
+
+    TEST_ASSERT_EQUAL_INT(200, CommandEngine_process(engine, test_CommandEngine_handler, &result));
+    TEST_ASSERT_EQUAL_INT(200, result.executed);
+    TEST_ASSERT_EQUAL_INT(0, result.wrong);
+
+    CommandEngine_getStats(engine, &stats);
+    TEST_ASSERT_EQUAL_INT(0, stats.inFlight);
+    TEST_ASSERT_EQUAL_INT(200, (int) stats.executed);
+
+    CommandEngine_destroy(engine);
+    PointTable_destroy(points);
+}
+
+#define WHEEL_TEST_MAX_FIRES 64
+
+struct sWheelRecord {
+    int fires;
+    int id[WHEEL_TEST_MAX_FIRES];
+    uint64_t tick[WHEEL_TEST_MAX_FIRES];
+};
+
+struct sWheelProbe {
+    struct sWheelRecord* record;
+    int id;
+};
+
+static void
+test_TimerWheel_callback(void* parameter, uint64_t now)
+{
+    struct sWheelProbe* probe = (struct sWheelProbe*) parameter;
+    struct sWheelRecord* record = probe->record;
+
+    if (record->fires < WHEEL_TEST_MAX_FIRES) {
+        record->id[record->fires] = probe->id;
+        record->tick[record->fires] = now;
+    }
+
+    record->fires++;
+}
+
+/* services the wheel until count callbacks have fired (at most timeoutMs) */
+static void
+test_TimerWheel_runUntil(TimerWheel wheel, struct sWheelRecord* record, int count, int timeoutMs)
+{
+    uint64_t deadline = TimerWheel_monotonicMs() + (uint64_t) timeoutMs;
+
+    while ((record->fires < count) && (TimerWheel_monotonicMs() < deadline)) {
+        TimerWheel_sleep(wheel, 20);
+        TimerWheel_process(wheel);
+    }
+}
+
+void
+test_TimerWheelCascade(void)
+{
+    TimerWheel wheel = TimerWheel_create();
+    TEST_ASSERT_NOT_NULL(wheel);
+
+    struct sWheelRecord record;
+    memset(&record, 0, sizeof(record));
+
+    /* 5 ms lands in level 0, the others in level 1 and have to cascade down */
+    static const uint64_t delays[4] = {600, 5, 300, 270};
+    struct sWheelProbe probes[4];
+    Timer timers[4];
+    uint64_t starts[4];
+
+    int i;
+    for (i = 0; i < 4; i++) {
+        probes[i].record = &record;
+        probes[i].id = i;
+        timers[i] = TimerWheel_addTimer(wheel, test_TimerWheel_callback, &probes[i]);
+        starts[i] = TimerWheel_now(wheel);
+        TimerWheel_start(wheel, timers[i], delays[i], 0);
+        TEST_ASSERT_TRUE(TimerWheel_isActive(timers[i]));
+    }
+
+    test_TimerWheel_runUntil(wheel, &record, 1, 1000);
+    TEST_ASSERT_TRUE(record.fires >= 1);
+
+    /* the next deadline is the 270 ms timer (or the start of its level 1 slot) */
+    if (record.fires == 1) {
+        int64_t toNext = TimerWheel_getMsToNext(wheel);
+        TEST_ASSERT_TRUE(toNext >= 0);
+        TEST_ASSERT_TRUE(toNext <= 270);
+    }
+
+    test_TimerWheel_runUntil(wheel, &record, 4, 2000);
+    TEST_ASSERT_EQUAL_INT(4, record.fires);
+
+    /* fired in deadline order, each exactly at its own tick after cascading */
+    static const int order[4] = {1, 3, 2, 0};
+
+    for (i = 0; i < 4; i++) {
+        int id = order[i];
+        TEST_ASSERT_EQUAL_INT(id, record.id[i]);
+        TEST_ASSERT_TRUE(record.tick[i] >= starts[id] + delays[id]);
+        TEST_ASSERT_TRUE(record.tick[i] <= starts[id] + delays[id] + 2);
+        TEST_ASSERT_FALSE(TimerWheel_isActive(timers[id]));
+    }
+
+    TEST_ASSERT_EQUAL_INT(-1, (int) TimerWheel_getMsToNext(wheel));
+
+    TimerWheel_destroy(wheel);
+}
+
+void
+test_TimerWheelPeriodic(void)
+{
+    TimerWheel wheel = TimerWheel_create();
+    TEST_ASSERT_NOT_NULL(wheel);
+
+    struct sWheelRecord record;
+    memset(&record, 0, sizeof(record));
+
+    struct sWheelProbe probe;
+    probe.record = &record;
+    probe.id = 7;
+
+    Timer timer = TimerWheel_addTimer(wheel, test_TimerWheel_callback, &probe);
+    TimerWheel_start(wheel, timer, 10, 10);
+
+    test_TimerWheel_runUntil(wheel, &record, 12, 2000);
+    TEST_ASSERT_TRUE(record.fires >= 12);
+
+    /* re-armed with a fixed phase: every tick is the first one plus a multiple of the period */
+    int i;
+    for (i = 1; i < 12; i++) {
+        TEST_ASSERT_TRUE(record.tick[i] > record.tick[i - 1]);
+        TEST_ASSERT_EQUAL_INT(0, (int) ((record.tick[i] - record.tick[0]) % 10));
+    }
+
+    TEST_ASSERT_TRUE(TimerWheel_isActive(timer));
+
+    TimerWheel_stop(wheel, timer);
+    TEST_ASSERT_FALSE(TimerWheel_isActive(timer));
+    TEST_ASSERT_EQUAL_INT(-1, (int) TimerWheel_getMsToNext(wheel));
+
+    TimerWheel_removeTimer(wheel, timer);
+    TimerWheel_destroy(wheel);
+}
+
+void
+test_TimerWheelMsToNext(void)
+{
+    TimerWheel wheel = TimerWheel_create();
+    TEST_ASSERT_NOT_NULL(wheel);
+
+    TEST_ASSERT_EQUAL_INT(-1, (int) TimerWheel_getMsToNext(wheel));
+
+    struct sWheelRecord record;
+    memset(&record, 0, sizeof(record));
+
+    struct sWheelProbe probe;
+    probe.record = &record;
+    probe.id = 0;
+
+    Timer late = TimerWheel_addTimer(wheel, test_TimerWheel_callback, &probe);
+    Timer early = TimerWheel_addTimer(wheel, test_TimerWheel_callback, &probe);
+    Timer far = TimerWheel_addTimer(wheel, test_TimerWheel_callback, &probe);
+
+    TimerWheel_start(wheel, late, 100, 0);
+    int64_t toNext = TimerWheel_getMsToNext(wheel);
+    TEST_ASSERT_TRUE((toNext >= 95) && (toNext <= 100));
+
+    TimerWheel_start(wheel, early, 40, 0);
+    toNext = TimerWheel_getMsToNext(wheel);
+    TEST_ASSERT_TRUE((toNext >= 35) && (toNext <= 40));
+
+    TimerWheel_stop(wheel, early);
+    toNext = TimerWheel_getMsToNext(wheel);
+    TEST_ASSERT_TRUE((toNext >= 95) && (toNext <= 100));
+
+    /* level 1: only the slot start is known, the wake-up may come early but never late */
+    TimerWheel_stop(wheel, late);
+    TimerWheel_start(wheel, far, 1000, 0);
+    toNext = TimerWheel_getMsToNext(wheel);
+    TEST_ASSERT_TRUE((toNext > 0) && (toNext <= 1000));
+
+    TimerWheel_removeTimer(wheel, far);
+    TEST_ASSERT_EQUAL_INT(-1, (int) TimerWheel_getMsToNext(wheel));
+
+    TEST_ASSERT_EQUAL_INT(0, TimerWheel_process(wheel));
+    TEST_ASSERT_EQUAL_INT(0, record.fires);
+
+    TimerWheel_destroy(wheel);
+}
+
+void
+test_TimerWheelParseDuration(void)
+{
+    TEST_ASSERT_EQUAL_INT(20000, (int) TimerWheel_parseDuration("20"));
+    TEST_ASSERT_EQUAL_INT(500, (int) TimerWheel_parseDuration("0.5"));
+    TEST_ASSERT_EQUAL_INT(250, (int) TimerWheel_parseDuration("250ms"));
+    TEST_ASSERT_EQUAL_INT(3000, (int) TimerWheel_parseDuration("3s"));
+    TEST_ASSERT_EQUAL_INT(-1, (int) TimerWheel_parseDuration("abc"));
+    TEST_ASSERT_EQUAL_INT(-1, (int) TimerWheel_parseDuration("-1"));
+}
+
+#define JOURNAL_TEST_CONFIG "uni_tests_journal.txt"
+
+static void
+test_TempJournal_write(const char* path, const char* text)
+{
+    FILE* file = fopen(path, "w");
+    TEST_ASSERT_NOT_NULL(file);
+    fputs(text, file);
+    fclose(file);
+}
+
+static PointTable
+test_TempJournal_load(void)
+{
+    Config cfg;
+    PointTable points = PointTable_create(8);
+
+    TEST_ASSERT_NOT_NULL(points);
+    TEST_ASSERT_TRUE(ConfigFile_load(JOURNAL_TEST_CONFIG, &cfg, points));
+
+    return points;
+}
+
+static int
+test_TempJournal_countIoa(PointTable points, int ioa)
+{
+    int count = 0;
+    int i;
+
+    for (i = 0; i < points->count; i++) {
+        if (points->ioa[i] == ioa)
+            count++;
+    }
+
+    return count;
+}
+
+void
+test_TempJournalPairingAndCompaction(void)
+{
+    test_TempJournal_write(JOURNAL_TEST_CONFIG,
+            "PROTOCOL=104\nROLE=CLIENT\nPERIOD=2\n"
+            "PERM_MESS=\n1;100;1\n"
+            "TEMP_MESS=\n1;200;1\n1;200;1\n1;200;1\n1;201;0\n1;200;0\n");
+
+    /* one of the three identical TEMP rows was sent in the previous run (single value: valueB = valueA) */
+    test_TempJournal_write(JOURNAL_TEST_CONFIG ".consumed", "1;200;1;1\n");
+
+    PointTable points = test_TempJournal_load();
+    TEST_ASSERT_EQUAL_INT(6, points->count);
+
+    TempJournal journal = TempJournal_open(JOURNAL_TEST_CONFIG);
+    TEST_ASSERT_NOT_NULL(journal);
+    TEST_ASSERT_EQUAL_INT(1, TempJournal_getPending(journal));
+
+    TempJournal_apply(journal, points);
+
+    /* the journal entry pairs with the first of the identical rows only (rows 1 to 3) */
+    TEST_ASSERT_FALSE(points->flags[0] & POINT_FLAG_CONSUMED);
+    TEST_ASSERT_TRUE(points->flags[1] & POINT_FLAG_CONSUMED);
+    TEST_ASSERT_FALSE(points->flags[2] & POINT_FLAG_CONSUMED);
+    TEST_ASSERT_FALSE(points->flags[3] & POINT_FLAG_CONSUMED);
+    TEST_ASSERT_FALSE(points->flags[4] & POINT_FLAG_CONSUMED);
+    TEST_ASSERT_FALSE(points->flags[5] & POINT_FLAG_CONSUMED);
+
+    /* PERM rows and rows already sent are not journaled */
+    TempJournal_consume(journal, points, 0);
+    TempJournal_consume(journal, points, 1);
+    TEST_ASSERT_EQUAL_INT(1, TempJournal_getPending(journal));
+
+    TempJournal_consume(journal, points, 2);
+    TempJournal_consume(journal, points, 2);
+    TEST_ASSERT_TRUE(points->flags[2] & POINT_FLAG_CONSUMED);
+    TEST_ASSERT_EQUAL_INT(2, TempJournal_getPending(journal));
+
+    /* compaction removes exactly two of the three 1;200;1 rows and empties the journal */
+    TEST_ASSERT_TRUE(TempJournal_compact(journal));
+    TEST_ASSERT_EQUAL_INT(0, TempJournal_getPending(journal));
+
+    PointTable compacted = test_TempJournal_load();
+    TEST_ASSERT_EQUAL_INT(4, compacted->count);
+    TEST_ASSERT_EQUAL_INT(1, test_TempJournal_countIoa(compacted, 100));
+    TEST_ASSERT_EQUAL_INT(2, test_TempJournal_countIoa(compacted, 200));
+    TEST_ASSERT_EQUAL_INT(1, test_TempJournal_countIoa(compacted, 201));
+
+    /* the unsent 1;200;1 row and the 1;200;0 row (different value) stay in file order */
+    TEST_ASSERT_EQUAL_INT(200, compacted->ioa[1]);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, compacted->valueA[1]);
+    TEST_ASSERT_EQUAL_INT(200, compacted->ioa[3]);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, compacted->valueA[3]);
+
+    TempJournal_close(journal);
+
+    /* a journal reopened after compaction knows nothing */
+    journal = TempJournal_open(JOURNAL_TEST_CONFIG);
+    TEST_ASSERT_EQUAL_INT(0, TempJournal_getPending(journal));
+    TempJournal_apply(journal, compacted);
+
+    int i;
+    for (i = 0; i < compacted->count; i++)
+        TEST_ASSERT_FALSE(compacted->flags[i] & POINT_FLAG_CONSUMED);
+
+    TempJournal_close(journal);
+
+    PointTable_destroy(compacted);
+    PointTable_destroy(points);
+
+    remove(JOURNAL_TEST_CONFIG);
+    remove(JOURNAL_TEST_CONFIG ".consumed");
+}
+
+static int giCreated = 0;
+
+static InformationObject
+test_GiCache_createIO(int type, int ioa, float value)
+{
+    giCreated++;
+
+    if (type == M_ME_NC_1)
+        return (InformationObject) MeasuredValueShort_create(NULL, ioa, value, IEC60870_QUALITY_GOOD);
+
+    if (type == M_ME_TF_1) {
+        /* deliberately stale time tag - the cache has to stamp the current time on every send */
+        struct sCP56Time2a time;
+        CP56Time2a_createFromMsTimestamp(&time, 0);
+
+        return (InformationObject) MeasuredValueShortWithCP56Time2a_create(NULL, ioa, value, IEC60870_QUALITY_GOOD,
+                &time);
+    }
+
+    return NULL;
+}
+
+struct sGiResult {
+    int asdus;
+    int elements;
+    int wrongCot;
+    int expectedCot;
+    float value1010;
+    uint64_t minTimestamp;
+};
+
+static void
+test_GiCache_collect(void* parameter, CS101_ASDU asdu)
+{
+    struct sGiResult* result = (struct sGiResult*) parameter;
+
+    result->asdus++;
+
+    if (CS101_ASDU_getCOT(asdu) != result->expectedCot)
+        result->wrongCot++;
+
+    int i;
+    for (i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
+        InformationObject io = CS101_ASDU_getElement(asdu, i);
+
+        if (io == NULL)
+            continue;
+
+        result->elements++;
+
+        if (CS101_ASDU_getTypeID(asdu) == M_ME_NC_1) {
+            if (InformationObject_getObjectAddress(io) == 1010)
+                result->value1010 = MeasuredValueShort_getValue((MeasuredValueShort) io);
+        }
+        else if (CS101_ASDU_getTypeID(asdu) == M_ME_TF_1) {
+            uint64_t timestamp = CP56Time2a_toMsTimestamp(
+                    MeasuredValueShortWithCP56Time2a_getTimestamp((MeasuredValueShortWithCP56Time2a) io));
+
+            if (timestamp < result->minTimestamp)
+                result->minTimestamp = timestamp;
+        }
+
+        InformationObject_destroy(io);
+    }
+}
+
+static int
+test_GiCache_send(GiCache cache, PointTable points, int group, struct sGiResult* result)
+{
+    memset(result, 0, sizeof(struct sGiResult));
+    result->expectedCot = CS101_COT_INTERROGATED_BY_STATION + group;
+    result->minTimestamp = UINT64_MAX;
+    giCreated = 0;
+
+    return GiCache_send(cache, points, group, test_GiCache_collect, result);
+}
+
+void
+test_GiCacheChunksAndGroups(void)
+{
+    struct sCS101_AppLayerParameters alParameters;
+
+    alParameters.maxSizeOfASDU = 249;
+    alParameters.originatorAddress = 0;
+    alParameters.sizeOfCA = 2;
+    alParameters.sizeOfCOT = 2;
+    alParameters.sizeOfIOA = 3;
+    alParameters.sizeOfTypeId = 1;
+    alParameters.sizeOfVSQ = 1;
+
+    PointTable points = PointTable_create(320);
+
+    /* 300 measured values (two chunks of the station list), every third one also in group 2 */
+    int i;
+    for (i = 0; i < 300; i++) {
+        int index = PointTable_add(points, M_ME_NC_1, 1000 + i, (float) i, (float) i, 0);
+
+        if ((i % 3) == 0)
+            PointTable_setGroups(points, index, 1u << 1);
+    }
+
+    for (i = 0; i < 3; i++) {
+        int index = PointTable_add(points, M_ME_TF_1, 5000 + i, 1.0f, 1.0f, 0);
+        PointTable_setGroups(points, index, 1u << 1);
+    }
+
+    giCreated = 0;
+    GiCache cache = GiCache_create(&alParameters, points, 0, 20, test_GiCache_createIO);
+    TEST_ASSERT_NOT_NULL(cache);
+    TEST_ASSERT_EQUAL_INT(303 + 103, giCreated);
+
+    struct sGiResult result;
+
+    /* station interrogation from the cache: COT 20, nothing rebuilt, time tags stamped now */
+    uint64_t before = Hal_getTimeInMs();
+    int asdus = test_GiCache_send(cache, points, 0, &result);
+    TEST_ASSERT_TRUE(asdus > 1);
+    TEST_ASSERT_EQUAL_INT(asdus, result.asdus);
+    TEST_ASSERT_EQUAL_INT(303, result.elements);
+    TEST_ASSERT_EQUAL_INT(0, result.wrongCot);
+    TEST_ASSERT_EQUAL_INT(0, giCreated);
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, result.value1010);
+    TEST_ASSERT_TRUE(result.minTimestamp + 1000 >= before);
+
+    /* group 2: COT 22 (20 + group) and only its members */
+    test_GiCache_send(cache, points, 2, &result);
+    TEST_ASSERT_EQUAL_INT(103, result.elements);
+    TEST_ASSERT_EQUAL_INT(0, result.wrongCot);
+    TEST_ASSERT_EQUAL_INT(0, giCreated);
+
+    TEST_ASSERT_EQUAL_INT(0, test_GiCache_send(cache, points, 5, &result));
+    TEST_ASSERT_EQUAL_INT(-1, test_GiCache_send(cache, points, GI_CACHE_GROUPS + 1, &result));
+
+    /* a change outside group 2 rebuilds only its station chunk */
+    points->value[10] = 99.0f;
+    GiCache_invalidate(cache, points, 10);
+
+    test_GiCache_send(cache, points, 0, &result);
+    TEST_ASSERT_EQUAL_INT(303, result.elements);
+    TEST_ASSERT_EQUAL_FLOAT(99.0f, result.value1010);
+    TEST_ASSERT_TRUE((giCreated > 0) && (giCreated <= 256));
+
+    test_GiCache_send(cache, points, 2, &result);
+    TEST_ASSERT_EQUAL_INT(0, giCreated);
+
+    /* a change of a group 2 member rebuilds its chunk there as well */
+    points->value[9] = 42.0f;
+    GiCache_invalidate(cache, points, 9);
+
+    test_GiCache_send(cache, points, 2, &result);
+    TEST_ASSERT_EQUAL_INT(103, result.elements);
+    TEST_ASSERT_TRUE((giCreated > 0) && (giCreated <= 100));
+
+    test_GiCache_send(cache, points, 0, &result);
+    TEST_ASSERT_TRUE((giCreated > 0) && (giCreated <= 256));
+
+    /* without generated points a generator tick invalidates nothing */
+    GiCache_invalidateGenerated(cache);
+    test_GiCache_send(cache, points, 0, &result);
+    TEST_ASSERT_EQUAL_INT(0, giCreated);
+
+    GiCache_destroy(cache);
+    PointTable_destroy(points);
+}
+
+int
+main(int argc, char** argv)
+{
+    (void) argc;
+    (void) argv;
+
+    UNITY_BEGIN();
+    RUN_TEST(test_CommandEngineManyInFlight);
+    RUN_TEST(test_TimerWheelCascade);
+    RUN_TEST(test_TimerWheelPeriodic);
+    RUN_TEST(test_TimerWheelMsToNext);
+    RUN_TEST(test_TimerWheelParseDuration);
+    RUN_TEST(test_TempJournalPairingAndCompaction);
+    RUN_TEST(test_GiCacheChunksAndGroups);
+    return UNITY_END();
+}
@@ -0,0 +1,401 @@
+// =======================
+// BINÁRNÍ DATOVÝ LOG S INDEXEM – implementace
+// =======================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "uni_binlog.h"
+#include "lib_memory.h"
+
+#define BINLOG_MAGIC "UNIBLOG1"
+#define BINLOG_INDEX_MAGIC "UNIBIDX1"
+#define BINLOG_VERSION 1
+#define BINLOG_BUFFER_RECORDS 8192
+#define BLOOM_WORDS 4                 // 256bitový Bloomův filtr IOA v bloku
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t blockRecords;
+    uint8_t reserved[12];
+} BinLogHeader;
+
+// Položka indexu pro jeden blok záznamů
+typedef struct {
+    uint64_t firstTimeMs;
+    uint64_t lastTimeMs;
+    uint32_t minIoa;
+    uint32_t maxIoa;
+    uint64_t bloom[BLOOM_WORDS];
+} BinLogIndexEntry;
+
+_Static_assert(sizeof(BinLogRecord) == 32, "BinLogRecord musí mít 32 B");
+_Static_assert(sizeof(BinLogHeader) == 32, "BinLogHeader musí mít 32 B");
+
+struct sBinLogWriter {
+    int fd;
+    int indexFd;
+    uint64_t records;             // Počet záznamů v souboru (včetně bufferu)
+
+    BinLogRecord *buffer;
+    int used;
+
+    BinLogIndexEntry block;       // Rozpracovaný blok indexu
+    int blockCount;
+};
+
+static inline void
+bloomAdd(uint64_t *bloom, uint32_t ioa)
+{
+    uint32_t h = ioa * 2654435761u;
+    bloom[(h >> 6) & (BLOOM_WORDS - 1)] |= 1ULL << (h & 63);
+    h = (h >> 16) | (h << 16);
+    bloom[(h >> 6) & (BLOOM_WORDS - 1)] |= 1ULL << (h & 63);
+}
+
+static inline bool
+bloomContains(const uint64_t *bloom, uint32_t ioa)
+{
+    uint32_t h = ioa * 2654435761u;
+    if ((bloom[(h >> 6) & (BLOOM_WORDS - 1)] & (1ULL << (h & 63))) == 0)
+        return false;
+    h = (h >> 16) | (h << 16);
+    return (bloom[(h >> 6) & (BLOOM_WORDS - 1)] & (1ULL << (h & 63))) != 0;
+}
+
+static void
+resetBlock(BinLogWriter self)
+{
+    memset(&self->block, 0, sizeof(BinLogIndexEntry));
+    self->block.minIoa = UINT32_MAX;
+    self->blockCount = 0;
+}
+
+static void
+addToBlock(BinLogWriter self, const BinLogRecord *record)
+{
+    BinLogIndexEntry *block = &self->block;
+
+    if ((self->blockCount == 0) || (record->timeMs < block->firstTimeMs))
+        block->firstTimeMs = record->timeMs;
+    if (record->timeMs > block->lastTimeMs)
+        block->lastTimeMs = record->timeMs;
+    if (record->ioa < block->minIoa)
+        block->minIoa = record->ioa;
+    if (record->ioa > block->maxIoa)
+        block->maxIoa = record->ioa;
+
+    bloomAdd(block->bloom, record->ioa);
+    self->blockCount++;
+}
+
+static bool
+writeAll(int fd, const void *data, size_t size)
+{
+    const uint8_t *p = (const uint8_t *) data;
+
+    while (size > 0) {
+        ssize_t written = write(fd, p, size);
+        if (written <= 0)
+            return false;
+        p += written;
+        size -= (size_t) written;
+    }
+
+    return true;
+}
+
+static void
+writeHeader(int fd, const char *magic)
+{
+    BinLogHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, magic, 8);
+    header.version = BINLOG_VERSION;
+    header.recordSize = sizeof(BinLogRecord);
+    header.blockRecords = BINLOG_BLOCK_RECORDS;
+    writeAll(fd, &header, sizeof(header));
+}
+
+// Ověří hlavičku souboru (nebo ji zapíše do prázdného souboru)
+static bool
+checkHeader(int fd, const char *magic)
+{
+    off_t size = lseek(fd, 0, SEEK_END);
+
+    if (size == 0) {
+        writeHeader(fd, magic);
+        return true;
+    }
+
+    BinLogHeader header;
+
+    if ((pread(fd, &header, sizeof(header), 0) != sizeof(header)) || (memcmp(header.magic, magic, 8) != 0) ||
+        (header.recordSize != sizeof(BinLogRecord)) || (header.blockRecords != BINLOG_BLOCK_RECORDS))
+        return false;
+
+    return true;
+}
+
+BinLogWriter
+BinLogWriter_open(const char *path)
+{
+    char indexPath[300];
+    snprintf(indexPath, sizeof(indexPath), "%s.idx", path);
+
+    BinLogWriter self = (BinLogWriter) GLOBAL_CALLOC(1, sizeof(struct sBinLogWriter));
+
+    if (self == NULL)
+        return NULL;
+
+    self->fd = open(path, O_RDWR | O_CREAT, 0644);
+    self->indexFd = open(indexPath, O_RDWR | O_CREAT, 0644);
+    self->buffer = (BinLogRecord *) GLOBAL_MALLOC(sizeof(BinLogRecord) * BINLOG_BUFFER_RECORDS);
+
+    if ((self->fd < 0) || (self->indexFd < 0) || (self->buffer == NULL) ||
+        !checkHeader(self->fd, BINLOG_MAGIC)) {
+        fprintf(stderr, "Nelze otevřít binární log %s (chybí nebo jiný formát)\n", path);
+        BinLogWriter_close(self);
+        return NULL;
+    }
+
+    // Useknutý poslední záznam (pád při zápisu) zahoď
+    off_t size = lseek(self->fd, 0, SEEK_END);
+    self->records = (uint64_t) (size - sizeof(BinLogHeader)) / sizeof(BinLogRecord);
+    if (ftruncate(self->fd, sizeof(BinLogHeader) + self->records * sizeof(BinLogRecord)) != 0) {
+        BinLogWriter_close(self);
+        return NULL;
+    }
+    lseek(self->fd, 0, SEEK_END);
+
+    // Index obsahuje jen celé bloky – platný index zkrať, poškozený přestav od začátku
+    uint64_t fullBlocks = self->records / BINLOG_BLOCK_RECORDS;
+    off_t indexSize = lseek(self->indexFd, 0, SEEK_END);
+    uint64_t firstRecord = 0;
+
+    if ((indexSize > 0) && checkHeader(self->indexFd, BINLOG_INDEX_MAGIC) &&
+        ((uint64_t) (indexSize - sizeof(BinLogHeader)) / sizeof(BinLogIndexEntry) >= fullBlocks)) {
+        firstRecord = fullBlocks * BINLOG_BLOCK_RECORDS;
+    }
+
+    off_t keep = sizeof(BinLogHeader) + (off_t) (firstRecord / BINLOG_BLOCK_RECORDS) * sizeof(BinLogIndexEntry);
+
+    if (ftruncate(self->indexFd, (firstRecord == 0) ? 0 : keep) != 0) {
+        BinLogWriter_close(self);
+        return NULL;
+    }
+
+    if (firstRecord == 0)
+        checkHeader(self->indexFd, BINLOG_INDEX_MAGIC);
+
+    lseek(self->indexFd, 0, SEEK_END);
+    resetBlock(self);
+
+    // Dopočítej chybějící bloky indexu a rozpracovaný blok (po dávkách přes buffer)
+    uint64_t index = firstRecord;
+
+    while (index < self->records) {
+        uint64_t count = self->records - index;
+        if (count > BINLOG_BUFFER_RECORDS)
+            count = BINLOG_BUFFER_RECORDS;
+
+        off_t offset = sizeof(BinLogHeader) + (off_t) (index * sizeof(BinLogRecord));
+        if (pread(self->fd, self->buffer, count * sizeof(BinLogRecord), offset) != (ssize_t) (count * sizeof(BinLogRecord)))
+            break;
+
+        for (uint64_t i = 0; i < count; i++) {
+            addToBlock(self, &self->buffer[i]);
+
+            if (self->blockCount == BINLOG_BLOCK_RECORDS) {
+                writeAll(self->indexFd, &self->block, sizeof(BinLogIndexEntry));
+                resetBlock(self);
+            }
+        }
+
+        index += count;
+    }
+
+    return self;
+}
+
+void
+BinLogWriter_flush(BinLogWriter self)
+{
+    if (self->used > 0) {
+        writeAll(self->fd, self->buffer, sizeof(BinLogRecord) * self->used);
+        self->used = 0;
+    }
+}
+
+void
+BinLogWriter_append(BinLogWriter self, const BinLogRecord *record)
+{
+    if (self->used == BINLOG_BUFFER_RECORDS)
+        BinLogWriter_flush(self);
+
+    self->buffer[self->used++] = *record;
+    self->records++;
+
+    addToBlock(self, record);
+
+    if (self->blockCount == BINLOG_BLOCK_RECORDS) {
+        // Blok indexu se zapisuje až po zapsání jeho záznamů
+        BinLogWriter_flush(self);
+        writeAll(self->indexFd, &self->block, sizeof(BinLogIndexEntry));
+        resetBlock(self);
+    }
+}
+
+uint64_t
+BinLogWriter_getSize(BinLogWriter self)
+{
+    return sizeof(BinLogHeader) + self->records * sizeof(BinLogRecord);
+}
+
+void
+BinLogWriter_close(BinLogWriter self)
+{
+    if (self == NULL)
+        return;
+
+    if ((self->fd >= 0) && self->buffer)
+        BinLogWriter_flush(self);
+
+    if (self->fd >= 0)
+        close(self->fd);
+    if (self->indexFd >= 0)
+        close(self->indexFd);
+
+    GLOBAL_FREEMEM(self->buffer);
+    GLOBAL_FREEMEM(self);
+}
+
+// =======================
+// DOTAZY NAD NAMAPOVANÝM SOUBOREM
+// =======================
+
+static const void *
+mapFile(const char *path, size_t *size)
+{
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+
+    if ((fstat(fd, &st) != 0) || (st.st_size < (off_t) sizeof(BinLogHeader))) {
+        close(fd);
+        return NULL;
+    }
+
+    void *data = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED)
+        return NULL;
+
+    *size = (size_t) st.st_size;
+    return data;
+}
+
+static bool
+validHeader(const void *data, const char *magic)
+{
+    const BinLogHeader *header = (const BinLogHeader *) data;
+
+    return (memcmp(header->magic, magic, 8) == 0) && (header->recordSize == sizeof(BinLogRecord)) &&
+           (header->blockRecords == BINLOG_BLOCK_RECORDS);
+}
+
+// Projde záznamy [first, end) a předá odpovídající handleru, vrací false při ukončení
+static bool
+scanRecords(const BinLogRecord *records, uint64_t first, uint64_t end, int ioa, uint64_t fromMs, uint64_t toMs,
+            BinLogQueryHandler handler, void *parameter, int *found)
+{
+    for (uint64_t i = first; i < end; i++) {
+        const BinLogRecord *record = &records[i];
+
+        if ((ioa >= 0) && (record->ioa != (uint32_t) ioa))
+            continue;
+        if ((record->timeMs < fromMs) || (record->timeMs > toMs))
+            continue;
+
+        (*found)++;
+
+        if (handler && !handler(parameter, record))
+            return false;
+    }
+
+    return true;
+}
+
+int
+BinLog_query(const char *path, int ioa, uint64_t fromMs, uint64_t toMs, BinLogQueryHandler handler, void *parameter)
+{
+    size_t dataSize = 0;
+    const uint8_t *data = (const uint8_t *) mapFile(path, &dataSize);
+
+    if ((data == NULL) || !validHeader(data, BINLOG_MAGIC)) {
+        if (data)
+            munmap((void *) data, dataSize);
+        return -1;
+    }
+
+    const BinLogRecord *records = (const BinLogRecord *) (data + sizeof(BinLogHeader));
+    uint64_t recordCount = (dataSize - sizeof(BinLogHeader)) / sizeof(BinLogRecord);
+
+    char indexPath[300];
+    snprintf(indexPath, sizeof(indexPath), "%s.idx", path);
+
+    size_t indexSize = 0;
+    const uint8_t *index = (const uint8_t *) mapFile(indexPath, &indexSize);
+    uint64_t blocks = 0;
+
+    if (index && validHeader(index, BINLOG_INDEX_MAGIC))
+        blocks = (indexSize - sizeof(BinLogHeader)) / sizeof(BinLogIndexEntry);
+
+    if (blocks * BINLOG_BLOCK_RECORDS > recordCount)
+        blocks = recordCount / BINLOG_BLOCK_RECORDS;
+
+    const BinLogIndexEntry *entries = (const BinLogIndexEntry *) (index + sizeof(BinLogHeader));
+
+    int found = 0;
+    bool proceed = true;
+
+    // Bloky pokryté indexem – přeskoč ty, které dotaz nemohou obsahovat
+    for (uint64_t b = 0; (b < blocks) && proceed; b++) {
+        const BinLogIndexEntry *entry = &entries[b];
+
+        if ((entry->lastTimeMs < fromMs) || (entry->firstTimeMs > toMs))
+            continue;
+
+        if (ioa >= 0) {
+            if (((uint32_t) ioa < entry->minIoa) || ((uint32_t) ioa > entry->maxIoa))
+                continue;
+            if (!bloomContains(entry->bloom, (uint32_t) ioa))
+                continue;
+        }
+
+        proceed = scanRecords(records, b * BINLOG_BLOCK_RECORDS, (b + 1) * BINLOG_BLOCK_RECORDS, ioa, fromMs, toMs,
+                              handler, parameter, &found);
+    }
+
+    // Konec souboru, který ještě nemá položku v indexu
+    if (proceed)
+        scanRecords(records, blocks * BINLOG_BLOCK_RECORDS, recordCount, ioa, fromMs, toMs, handler, parameter,
+                    &found);
+
+    if (index)
+        munmap((void *) index, indexSize);
+    munmap((void *) data, dataSize);
+
+    return found;
+}
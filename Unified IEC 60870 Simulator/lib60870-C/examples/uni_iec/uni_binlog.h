@@ -0,0 +1,56 @@
+// =======================
+// BINÁRNÍ DATOVÝ LOG S INDEXEM
+// =======================
+//
+// Soubor = hlavička + záznamy pevné délky (32 B): čas, směr, typ, CA, IOA,
+// hodnota, kvalita a CP56. Vedlejší soubor <path>.idx má pro každý blok
+// BINLOG_BLOCK_RECORDS záznamů časový rozsah, rozsah IOA a Bloomův filtr IOA,
+// takže dotaz "IOA X mezi T1 a T2" čte jen bloky, které ho mohou obsahovat.
+
+#ifndef UNI_BINLOG_H_
+#define UNI_BINLOG_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BINLOG_BLOCK_RECORDS 4096
+
+#define BINLOG_DIR_TX 0
+#define BINLOG_DIR_RX 1
+
+typedef struct {
+    uint64_t timeMs;          // Čas zápisu (ms od epochy)
+    uint32_t ioa;
+    float value;
+    uint16_t ca;
+    uint8_t type;             // TypeID ASDU
+    uint8_t direction;        // BINLOG_DIR_*
+    uint8_t quality;          // QDS
+    uint8_t hasTimestamp;     // 0 = bez časové známky, 24 / 56 = CP24 / CP56
+    uint8_t timestamp[7];     // Zakódovaná CP56Time2a (CP24 v prvních 3 bajtech)
+    uint8_t reserved[3];
+} BinLogRecord;
+
+typedef struct sBinLogWriter* BinLogWriter;
+
+// Otevře (nebo vytvoří) log pro připisování, index dorovná k obsahu souboru
+BinLogWriter BinLogWriter_open(const char *path);
+
+void BinLogWriter_append(BinLogWriter self, const BinLogRecord *record);
+
+// Zapíše buffer na disk (index se zapisuje po celých blocích)
+void BinLogWriter_flush(BinLogWriter self);
+
+// Velikost datového souboru v bajtech včetně nezapsaných záznamů
+uint64_t BinLogWriter_getSize(BinLogWriter self);
+
+void BinLogWriter_close(BinLogWriter self);
+
+// Callback dotazu, vrací false pro ukončení dotazu
+typedef bool (*BinLogQueryHandler)(void *parameter, const BinLogRecord *record);
+
+// Projde záznamy IOA (ioa < 0 = všechny) v intervalu <fromMs, toMs>, vrací počet nalezených nebo -1 při chybě
+int BinLog_query(const char *path, int ioa, uint64_t fromMs, uint64_t toMs, BinLogQueryHandler handler,
+                 void *parameter);
+
+#endif /* UNI_BINLOG_H_ */
@@ -0,0 +1,594 @@
+// =======================
+// ZÁZNAM A PŘEHRÁVÁNÍ SUROVÝCH RÁMCŮ – implementace
+// =======================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <signal.h>
+#include <pthread.h>
+
+#include "uni_capture.h"
+#include "hal_thread.h"
+#include "hal_time.h"
+#include "lib_memory.h"
+
+#define CAPTURE_BUFFER_SIZE (4 * 1024 * 1024)  // Kruhový buffer mezi protokolem a zapisovacím vláknem
+#define CAPTURE_FLUSH_MS 20                    // Jak často zapisovací vlákno vyprázdní buffer
+#define CAPTURE_MAX_STREAMS 1024               // Rozlišená spojení (další sdílí poslední číslo)
+#define CAPTURE_MAX_FRAME 300                  // APDU 104 má max. 255 B, rámec 101 max. 261 B
+#define CAPTURE_CLIENT_PORT 40000              // Port klienta spojení 0 v syntetických hlavičkách
+
+#define PCAP_MAGIC_US 0xa1b2c3d4
+#define PCAP_MAGIC_NS 0xa1b23c4d
+#define LINKTYPE_ETHERNET 1
+#define LINKTYPE_RAW 101
+#define LINKTYPE_USER0 147
+#define LINKTYPE_IPV4 228
+
+#define PCAP_RECORD_HEADER 16
+#define IP_TCP_HEADER 40
+
+// Server a klient v syntetických IPv4 hlavičkách (10.0.0.1 a 10.0.0.2)
+#define SERVER_ADDRESS 0x0a000001
+#define CLIENT_ADDRESS 0x0a000002
+
+typedef struct {
+    uint32_t magic;
+    uint16_t versionMajor;
+    uint16_t versionMinor;
+    int32_t thisZone;
+    uint32_t sigFigs;
+    uint32_t snapLength;
+    uint32_t linkType;
+} PcapHeader;
+
+// Pořadová čísla TCP jednoho spojení (0 = od serveru, 1 = od klienta)
+typedef struct {
+    const void *key;
+    uint32_t seq[2];
+} CaptureStream;
+
+struct sFrameCapture {
+    FILE *file;
+    bool is104;
+    bool server;
+    int port;
+
+    uint8_t *buffer;
+    uint64_t head;            // Zapisuje protokol (pod zámkem)
+    uint64_t tail;            // Posouvá zapisovací vlákno (pod zámkem)
+    Semaphore lock;
+    Thread writer;
+    atomic_bool running;
+
+    CaptureStream streams[CAPTURE_MAX_STREAMS];
+    int streamCount;
+    uint16_t ipId;
+
+    uint64_t frames;
+    uint64_t dropped;
+};
+
+static void
+putUInt16(uint8_t *p, uint16_t value)
+{
+    p[0] = (uint8_t) (value >> 8);
+    p[1] = (uint8_t) value;
+}
+
+static void
+putUInt32(uint8_t *p, uint32_t value)
+{
+    p[0] = (uint8_t) (value >> 24);
+    p[1] = (uint8_t) (value >> 16);
+    p[2] = (uint8_t) (value >> 8);
+    p[3] = (uint8_t) value;
+}
+
+static uint16_t
+getUInt16(const uint8_t *p)
+{
+    return (uint16_t) ((p[0] << 8) | p[1]);
+}
+
+static uint32_t
+getUInt32(const uint8_t *p)
+{
+    return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | p[3];
+}
+
+static uint16_t
+ipChecksum(const uint8_t *header)
+{
+    uint32_t sum = 0;
+
+    for (int i = 0; i < 20; i += 2)
+        sum += getUInt16(header + i);
+
+    while (sum >> 16)
+        sum = (sum & 0xffff) + (sum >> 16);
+
+    return (uint16_t) ~sum;
+}
+
+// Číslo spojení podle ukazatele (volá se pod zámkem)
+static int
+getStream(FrameCapture self, const void *key)
+{
+    for (int i = 0; i < self->streamCount; i++) {
+        if (self->streams[i].key == key)
+            return i;
+    }
+
+    if (self->streamCount == CAPTURE_MAX_STREAMS)
+        return CAPTURE_MAX_STREAMS - 1;
+
+    CaptureStream *stream = &self->streams[self->streamCount];
+    stream->key = key;
+    stream->seq[0] = 1;
+    stream->seq[1] = 1;
+
+    return self->streamCount++;
+}
+
+// Syntetická hlavička IPv4 + TCP pro APDU 104 (volá se pod zámkem)
+static void
+writeIpTcpHeader(FrameCapture self, uint8_t *p, int stream, bool fromServer, int payloadSize)
+{
+    CaptureStream *state = &self->streams[stream];
+    uint16_t clientPort = (uint16_t) (CAPTURE_CLIENT_PORT + stream);
+    int direction = fromServer ? 0 : 1;
+
+    memset(p, 0, IP_TCP_HEADER);
+
+    p[0] = 0x45;
+    putUInt16(p + 2, (uint16_t) (IP_TCP_HEADER + payloadSize));
+    putUInt16(p + 4, self->ipId++);
+    putUInt16(p + 6, 0x4000);
+    p[8] = 64;
+    p[9] = 6;
+    putUInt32(p + 12, fromServer ? SERVER_ADDRESS : CLIENT_ADDRESS);
+    putUInt32(p + 16, fromServer ? CLIENT_ADDRESS : SERVER_ADDRESS);
+    putUInt16(p + 10, ipChecksum(p));
+
+    uint8_t *tcp = p + 20;
+    putUInt16(tcp, fromServer ? (uint16_t) self->port : clientPort);
+    putUInt16(tcp + 2, fromServer ? clientPort : (uint16_t) self->port);
+    putUInt32(tcp + 4, state->seq[direction]);
+    putUInt32(tcp + 8, state->seq[1 - direction]);
+    tcp[12] = 5 << 4;
+    tcp[13] = 0x18;           // PSH + ACK
+    putUInt16(tcp + 14, 0xffff);
+
+    state->seq[direction] += (uint32_t) payloadSize;
+}
+
+// Zkopíruje bajty do kruhového bufferu (volá se pod zámkem, místo už je ověřené)
+static void
+putRing(FrameCapture self, const uint8_t *data, int size)
+{
+    size_t position = (size_t) (self->head % CAPTURE_BUFFER_SIZE);
+    size_t first = CAPTURE_BUFFER_SIZE - position;
+
+    if (first > (size_t) size)
+        first = (size_t) size;
+
+    memcpy(self->buffer + position, data, first);
+    memcpy(self->buffer, data + first, (size_t) size - first);
+    self->head += (uint64_t) size;
+}
+
+// Zapíše obsah bufferu mezi tail a head (jen zapisovací vlákno)
+static void
+drain(FrameCapture self)
+{
+    Semaphore_wait(self->lock);
+    uint64_t head = self->head;
+    uint64_t tail = self->tail;
+    Semaphore_post(self->lock);
+
+    if (head == tail)
+        return;
+
+    // Data mezi tail a head protokol nepřepíše, dokud se tail neposune
+    size_t position = (size_t) (tail % CAPTURE_BUFFER_SIZE);
+    size_t size = (size_t) (head - tail);
+    size_t first = CAPTURE_BUFFER_SIZE - position;
+
+    if (first > size)
+        first = size;
+
+    fwrite(self->buffer + position, 1, first, self->file);
+    fwrite(self->buffer, 1, size - first, self->file);
+    fflush(self->file);
+
+    Semaphore_wait(self->lock);
+    self->tail = head;
+    Semaphore_post(self->lock);
+}
+
+static void *
+writerThread(void *parameter)
+{
+    FrameCapture self = (FrameCapture) parameter;
+
+    // Ctrl+C musí obsloužit jiné vlákno – handler zavírá spojení, jehož vlákno může čekat na náš zámek
+    sigset_t signals;
+    sigfillset(&signals);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+    while (atomic_load(&self->running)) {
+        Thread_sleep(CAPTURE_FLUSH_MS);
+        drain(self);
+    }
+
+    drain(self);
+    return NULL;
+}
+
+FrameCapture
+FrameCapture_create(const char *path, bool is104, bool server, int port)
+{
+    FILE *file = fopen(path, "wb");
+
+    if (file == NULL)
+        return NULL;
+
+    FrameCapture self = (FrameCapture) GLOBAL_CALLOC(1, sizeof(struct sFrameCapture));
+
+    if (self == NULL) {
+        fclose(file);
+        return NULL;
+    }
+
+    self->file = file;
+    self->is104 = is104;
+    self->server = server;
+    self->port = port;
+    self->buffer = (uint8_t *) GLOBAL_MALLOC(CAPTURE_BUFFER_SIZE);
+
+    if (self->buffer == NULL) {
+        fclose(file);
+        GLOBAL_FREEMEM(self);
+        return NULL;
+    }
+
+    PcapHeader header = {PCAP_MAGIC_NS, 2, 4, 0, 0, 65535, is104 ? LINKTYPE_IPV4 : LINKTYPE_USER0};
+    fwrite(&header, sizeof(header), 1, file);
+
+    self->lock = Semaphore_create(1);
+    atomic_init(&self->running, true);
+    self->writer = Thread_create(writerThread, self, false);
+    Thread_start(self->writer);
+
+    return self;
+}
+
+void
+FrameCapture_destroy(FrameCapture self)
+{
+    if (self == NULL)
+        return;
+
+    atomic_store(&self->running, false);
+    Thread_destroy(self->writer);
+
+    fclose(self->file);
+    Semaphore_destroy(self->lock);
+    GLOBAL_FREEMEM(self->buffer);
+    GLOBAL_FREEMEM(self);
+}
+
+void
+FrameCapture_add(FrameCapture self, const void *connection, const uint8_t *msg, int msgSize, bool sent)
+{
+    if (msgSize <= 0 || msgSize > CAPTURE_MAX_FRAME)
+        return;
+
+    uint64_t timestamp = Hal_getTimeInNs();
+    bool fromServer = (sent == self->server);
+    int headerSize = self->is104 ? IP_TCP_HEADER : 1;
+    int recordSize = PCAP_RECORD_HEADER + headerSize + msgSize;
+
+    uint8_t record[PCAP_RECORD_HEADER + IP_TCP_HEADER + CAPTURE_MAX_FRAME];
+    uint32_t recordHeader[4] = {(uint32_t) (timestamp / 1000000000ULL), (uint32_t) (timestamp % 1000000000ULL),
+                                (uint32_t) (headerSize + msgSize), (uint32_t) (headerSize + msgSize)};
+    memcpy(record, recordHeader, sizeof(recordHeader));
+    memcpy(record + PCAP_RECORD_HEADER + headerSize, msg, (size_t) msgSize);
+
+    Semaphore_wait(self->lock);
+
+    if (self->head - self->tail + (uint64_t) recordSize > CAPTURE_BUFFER_SIZE) {
+        self->dropped++;
+    }
+    else {
+        if (self->is104)
+            writeIpTcpHeader(self, record + PCAP_RECORD_HEADER, getStream(self, connection), fromServer, msgSize);
+        else
+            record[PCAP_RECORD_HEADER] = fromServer ? 1 : 0;
+
+        putRing(self, record, recordSize);
+        self->frames++;
+    }
+
+    Semaphore_post(self->lock);
+}
+
+void
+FrameCapture_getCounts(FrameCapture self, uint64_t *frames, uint64_t *dropped)
+{
+    Semaphore_wait(self->lock);
+    *frames = self->frames;
+    *dropped = self->dropped;
+    Semaphore_post(self->lock);
+}
+
+
+// =======================
+// ČTENÍ ZÁZNAMU
+// =======================
+
+// Klient (adresa a port) → číslo spojení
+typedef struct {
+    uint32_t address;
+    uint16_t port;
+} ReaderStream;
+
+struct sCaptureReader {
+    FILE *file;
+    uint32_t linkType;
+    bool nanoseconds;
+    int port;
+
+    uint8_t packet[65536];
+    int packetSize;
+    int offset;               // Další APDU v aktuálním paketu
+    int payloadEnd;
+    CaptureFrame current;     // Čas, směr a spojení aktuálního paketu
+
+    ReaderStream streams[CAPTURE_MAX_STREAMS];
+    int streamCount;
+};
+
+static int
+getReaderStream(CaptureReader self, uint32_t address, uint16_t port)
+{
+    for (int i = 0; i < self->streamCount; i++) {
+        if (self->streams[i].address == address && self->streams[i].port == port)
+            return i;
+    }
+
+    if (self->streamCount == CAPTURE_MAX_STREAMS)
+        return CAPTURE_MAX_STREAMS - 1;
+
+    self->streams[self->streamCount].address = address;
+    self->streams[self->streamCount].port = port;
+
+    return self->streamCount++;
+}
+
+CaptureReader
+CaptureReader_open(const char *path, int port)
+{
+    FILE *file = fopen(path, "rb");
+
+    if (file == NULL)
+        return NULL;
+
+    PcapHeader header;
+
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        (header.magic != PCAP_MAGIC_US && header.magic != PCAP_MAGIC_NS) ||
+        (header.linkType != LINKTYPE_ETHERNET && header.linkType != LINKTYPE_RAW &&
+         header.linkType != LINKTYPE_IPV4 && header.linkType != LINKTYPE_USER0)) {
+        fclose(file);
+        return NULL;
+    }
+
+    CaptureReader self = (CaptureReader) GLOBAL_CALLOC(1, sizeof(struct sCaptureReader));
+
+    if (self == NULL) {
+        fclose(file);
+        return NULL;
+    }
+
+    self->file = file;
+    self->linkType = header.linkType;
+    self->nanoseconds = (header.magic == PCAP_MAGIC_NS);
+    self->port = port;
+
+    return self;
+}
+
+void
+CaptureReader_close(CaptureReader self)
+{
+    if (self == NULL)
+        return;
+
+    fclose(self->file);
+    GLOBAL_FREEMEM(self);
+}
+
+// Najde TCP data paketu 104 a určí směr a spojení; false = paket bez dat 104
+static bool
+parseTcpPacket(CaptureReader self)
+{
+    const uint8_t *p = self->packet;
+    int size = self->packetSize;
+
+    if (self->linkType == LINKTYPE_ETHERNET) {
+        int etherType = (size >= 14) ? getUInt16(p + 12) : 0;
+        int skip = 14;
+
+        if (etherType == 0x8100 && size >= 18) {
+            etherType = getUInt16(p + 16);
+            skip = 18;
+        }
+
+        if (etherType != 0x0800)
+            return false;
+
+        p += skip;
+        size -= skip;
+    }
+
+    if (size < 20 || (p[0] >> 4) != 4 || p[9] != 6)
+        return false;
+
+    int ipHeaderSize = (p[0] & 0x0f) * 4;
+    int ipSize = getUInt16(p + 2);
+
+    if (ipSize < size)
+        size = ipSize;
+
+    if (size < ipHeaderSize + 20)
+        return false;
+
+    const uint8_t *tcp = p + ipHeaderSize;
+    int tcpHeaderSize = (tcp[12] >> 4) * 4;
+    uint16_t sourcePort = getUInt16(tcp);
+
+    if (size < ipHeaderSize + tcpHeaderSize)
+        return false;
+
+    self->current.fromServer = (sourcePort == self->port);
+
+    if (self->current.fromServer)
+        self->current.stream = getReaderStream(self, getUInt32(p + 16), getUInt16(tcp + 2));
+    else
+        self->current.stream = getReaderStream(self, getUInt32(p + 12), sourcePort);
+
+    self->offset = (int) (tcp + tcpHeaderSize - self->packet);
+    self->payloadEnd = (int) (p + size - self->packet);
+
+    return self->offset < self->payloadEnd;
+}
+
+// Načte další paket se daty; false = konec souboru
+static bool
+readPacket(CaptureReader self)
+{
+    for (;;) {
+        uint32_t recordHeader[4];
+
+        if (fread(recordHeader, sizeof(recordHeader), 1, self->file) != 1)
+            return false;
+
+        uint32_t length = recordHeader[2];
+
+        if (length > sizeof(self->packet))
+            return false;
+
+        if (fread(self->packet, 1, length, self->file) != length)
+            return false;
+
+        self->packetSize = (int) length;
+        self->current.timestampNs = (uint64_t) recordHeader[0] * 1000000000ULL +
+                                    (uint64_t) recordHeader[1] * (self->nanoseconds ? 1 : 1000);
+
+        if (self->linkType == LINKTYPE_USER0) {
+            if (length < 2)
+                continue;
+
+            self->current.is104 = false;
+            self->current.fromServer = (self->packet[0] & 1) != 0;
+            self->current.stream = 0;
+            self->offset = 1;
+            self->payloadEnd = (int) length;
+            return true;
+        }
+
+        self->current.is104 = true;
+
+        if (parseTcpPacket(self))
+            return true;
+    }
+}
+
+bool
+CaptureReader_next(CaptureReader self, CaptureFrame *frame)
+{
+    for (;;) {
+        if (self->offset >= self->payloadEnd) {
+            if (!readPacket(self))
+                return false;
+        }
+
+        *frame = self->current;
+        frame->data = self->packet + self->offset;
+
+        // 101: celý paket je jeden rámec
+        if (!self->current.is104) {
+            frame->length = self->payloadEnd - self->offset;
+            self->offset = self->payloadEnd;
+            return true;
+        }
+
+        // 104: další APDU (0x68, délka) v segmentu
+        int available = self->payloadEnd - self->offset;
+
+        if (available < 2 || frame->data[0] != 0x68 || frame->data[1] + 2 > available) {
+            self->offset = self->payloadEnd;
+            continue;
+        }
+
+        frame->length = frame->data[1] + 2;
+        self->offset += frame->length;
+        return true;
+    }
+}
+
+int
+CaptureFrame_getAsdu(const CaptureFrame *frame, int linkAddressLength, const uint8_t **asdu)
+{
+    const uint8_t *data = frame->data;
+
+    if (frame->is104) {
+        // I-rámec: bit 0 prvního řídicího bajtu = 0
+        if (frame->length <= 6 || (data[2] & 1) != 0)
+            return 0;
+
+        *asdu = data + 6;
+        return frame->length - 6;
+    }
+
+    // 101: 68 L L 68 C A... ASDU CS 16
+    int headerSize = 5 + linkAddressLength;
+
+    if (frame->length <= headerSize + 2 || data[0] != 0x68 || data[3] != 0x68)
+        return 0;
+
+    *asdu = data + headerSize;
+    return frame->length - headerSize - 2;
+}
+
+CS101_ASDU
+CaptureFrame_decodeAsdu(CS101_StaticASDU buffer, CS101_AppLayerParameters alParams, const uint8_t *asdu, int length)
+{
+    int headerSize = 2 + alParams->sizeOfCOT + alParams->sizeOfCA;
+
+    if (length < headerSize)
+        return NULL;
+
+    int cot = asdu[2] & 0x3f;
+    bool isTest = (asdu[2] & 0x80) != 0;
+    bool isNegative = (asdu[2] & 0x40) != 0;
+    int oa = (alParams->sizeOfCOT > 1) ? asdu[3] : 0;
+    int ca = asdu[2 + alParams->sizeOfCOT];
+
+    if (alParams->sizeOfCA > 1)
+        ca |= asdu[3 + alParams->sizeOfCOT] << 8;
+
+    CS101_ASDU result = CS101_ASDU_initializeStatic(buffer, alParams, (asdu[1] & 0x80) != 0,
+                                                    (CS101_CauseOfTransmission) cot, oa, ca, isTest, isNegative);
+    CS101_ASDU_setTypeID(result, (IEC60870_5_TypeID) asdu[0]);
+    CS101_ASDU_setNumberOfElements(result, asdu[1] & 0x7f);
+
+    if (!CS101_ASDU_addPayload(result, (uint8_t *) asdu + headerSize, length - headerSize))
+        return NULL;
+
+    return result;
+}
@@ -0,0 +1,66 @@
+// =======================
+// ZÁZNAM A PŘEHRÁVÁNÍ SUROVÝCH RÁMCŮ (CAPTURE / REPLAY)
+// =======================
+//
+// Záznam: raw handlery (vlákna protokolu) jen zkopírují rámec s časem v ns do
+// kruhového bufferu, na disk ho zapisuje samostatné vlákno. Soubor je pcap
+// s nanosekundovými časy, takže ho otevře i Wireshark:
+//   - 104: každé APDU jako IPv4/TCP paket (server 10.0.0.1:PORT, spojení N
+//     = klient 10.0.0.2:40000+N), pořadová čísla TCP navazují po směrech,
+//   - 101: LINKTYPE_USER0, 1 bajt směru (1 = od slave) + rámec FT 1.2.
+//
+// Přehrávání čte pcap postupně (nikdy celý do paměti) a vrací jednotlivá
+// APDU/rámce s časem a směrem. Umí i záznamy z Wiresharku (Ethernet, IPv4);
+// segment TCP s více APDU se rozdělí, APDU rozdělené mezi segmenty se zahodí.
+
+#ifndef UNI_CAPTURE_H_
+#define UNI_CAPTURE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "iec60870_common.h"
+
+typedef struct sFrameCapture* FrameCapture;
+
+typedef struct sCaptureReader* CaptureReader;
+
+// Jedno APDU (104) nebo rámec FT 1.2 (101) ze záznamu; data platí do dalšího CaptureReader_next
+typedef struct {
+    uint64_t timestampNs;
+    bool fromServer;          // Odeslal server (104) / slave (101)
+    bool is104;
+    int stream;               // Pořadí spojení v záznamu (0 = první)
+    const uint8_t *data;
+    int length;
+} CaptureFrame;
+
+// is104 = formát 104 (jinak 101), server = lokální strana je server/slave, port = port serveru v záznamu
+FrameCapture FrameCapture_create(const char *path, bool is104, bool server, int port);
+
+// Zapíše zbytek bufferu, ukončí zapisovací vlákno a zavře soubor
+void FrameCapture_destroy(FrameCapture self);
+
+// Uloží rámec (volá se z raw handleru libovolného vlákna); connection rozlišuje spojení serveru 104
+void FrameCapture_add(FrameCapture self, const void *connection, const uint8_t *msg, int msgSize, bool sent);
+
+// Uložené a zahozené (plný buffer) rámce
+void FrameCapture_getCounts(FrameCapture self, uint64_t *frames, uint64_t *dropped);
+
+// Otevře pcap (ns i us časy; IPv4, Ethernet nebo USER0); port = port serveru 104 pro určení směru
+CaptureReader CaptureReader_open(const char *path, int port);
+
+void CaptureReader_close(CaptureReader self);
+
+// Další APDU/rámec, false = konec souboru
+bool CaptureReader_next(CaptureReader self, CaptureFrame *frame);
+
+// ASDU z I-rámce 104 nebo rámce s proměnnou délkou 101 (linkAddressLength = velikost linkové adresy).
+// Vrací délku ASDU, 0 = rámec ASDU nenese
+int CaptureFrame_getAsdu(const CaptureFrame *frame, int linkAddressLength, const uint8_t **asdu);
+
+// Sestaví ASDU ze zakódovaných bajtů (velikosti COT a CA podle alParams), NULL = nejde
+CS101_ASDU CaptureFrame_decodeAsdu(CS101_StaticASDU buffer, CS101_AppLayerParameters alParams, const uint8_t *asdu,
+                                   int length);
+
+#endif /* UNI_CAPTURE_H_ */
@@ -0,0 +1,507 @@
+// =======================
+// VÍCE SPOJENÍ KLIENTA 104 – implementace
+// =======================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <sys/resource.h>
+
+#include "uni_clients.h"
+#include "uni_timer.h"
+#include "hal_thread.h"
+#include "hal_time.h"
+#include "lib_memory.h"
+
+#define CLIENT_SUPERVISE_MS 100        // Jak často hlavní smyčka obslouží změny stavu spojení
+#define CLIENT_CONNECTS_PER_TICK 50    // Max. nových pokusů o připojení za jeden běh (náběh bez záplavy SYN)
+#define CLIENT_BACKOFF_MIN_MS 1000     // První čekání před opětovným připojením
+#define CLIENT_BACKOFF_MAX_MS 30000
+#define CLIENT_CLOSE_THREADS 32        // Vlákna pro paralelní uzavření spojení při ukončení
+
+// Stav spojení – vlákno spojení nastavuje OPENED/ACTIVE/CLOSED/FAILED, ostatní jen hlavní smyčka
+typedef enum {
+    SLOT_WAITING,             // Čeká na (opětovné) připojení
+    SLOT_CONNECTING,
+    SLOT_OPENED,              // TCP spojeno, hlavní smyčka pošle STARTDT
+    SLOT_STARTING,
+    SLOT_ACTIVE,              // STARTDT potvrzen
+    SLOT_CLOSED,
+    SLOT_FAILED
+} SlotState;
+
+typedef struct sClientSlot {
+    struct sClientPool *pool;
+    int index;
+    const ClientTarget *target;
+    CS104_Connection connection;
+    atomic_int state;
+
+    uint64_t reconnectAtMs;   // Monotónní čas kola (ms), změna systémového času ho neovlivní
+    int backoffMs;
+    bool everActive;
+
+    Timer giTimer;
+    Timer syncTimer;
+    Timer commandTimer;
+
+    atomic_uint_fast64_t rxAsdus;
+    uint64_t lastRxAsdus;     // Jen vlákno výpisu
+} ClientSlot;
+
+struct sClientPool {
+    ClientTarget targets[CLIENT_MAX_TARGETS];
+    int numTargets;
+
+    ClientSlot *slots;
+    int count;
+
+    ClientAsduFunction onAsdu;
+    ClientCommandFunction command;
+    ClientSentFunction onSent;
+    void *context;
+
+    TimerWheel wheel;
+    Timer superviseTimer;
+
+    // Počty za běh (jen hlavní smyčka)
+    uint64_t disconnects;
+    uint64_t failures;
+    uint64_t giSent;
+    uint64_t syncSent;
+    uint64_t commandRounds;
+
+    uint64_t lastReportUs;
+    uint64_t lastGiSent;
+    uint64_t lastSyncSent;
+    uint64_t lastCommandRounds;
+    uint64_t lastDisconnects;
+};
+
+int
+ClientPool_parseTargets(const char *text, const char *defaultHost, int defaultPort, int defaultCa,
+                        ClientTarget *targets, int maxTargets)
+{
+    int count = 0;
+
+    while (text && *text && count < maxTargets) {
+        char item[128];
+        size_t length = strcspn(text, ",");
+
+        if (length >= sizeof(item))
+            length = sizeof(item) - 1;
+
+        memcpy(item, text, length);
+        item[length] = '\0';
+        text += strcspn(text, ",");
+        if (*text == ',')
+            text++;
+
+        char *start = item;
+        while (*start == ' ')
+            start++;
+
+        if (*start == '\0')
+            continue;
+
+        ClientTarget *target = &targets[count];
+        target->port = defaultPort;
+        target->ca = defaultCa;
+
+        char *slash = strchr(start, '/');
+        if (slash) {
+            *slash = '\0';
+            target->ca = atoi(slash + 1);
+        }
+
+        char *colon = strchr(start, ':');
+        if (colon) {
+            *colon = '\0';
+            target->port = atoi(colon + 1);
+        }
+
+        strncpy(target->host, *start ? start : defaultHost, sizeof(target->host) - 1);
+        target->host[sizeof(target->host) - 1] = '\0';
+        count++;
+    }
+
+    if (count == 0 && maxTargets > 0) {
+        strncpy(targets[0].host, defaultHost, sizeof(targets[0].host) - 1);
+        targets[0].host[sizeof(targets[0].host) - 1] = '\0';
+        targets[0].port = defaultPort;
+        targets[0].ca = defaultCa;
+        count = 1;
+    }
+
+    return count;
+}
+
+// Každé spojení potřebuje deskriptor – zvedne měkký limit až k tvrdému
+static void
+raiseFileLimit(int count)
+{
+    struct rlimit limit;
+
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0)
+        return;
+
+    rlim_t needed = (rlim_t) count + 64;
+
+    if (limit.rlim_cur >= needed)
+        return;
+
+    limit.rlim_cur = (limit.rlim_max < needed) ? limit.rlim_max : needed;
+    setrlimit(RLIMIT_NOFILE, &limit);
+
+    if (limit.rlim_cur < needed)
+        fprintf(stderr, "Limit otevřených souborů %llu nestačí na %d spojení (ulimit -n)\n",
+                (unsigned long long) limit.rlim_cur, count);
+}
+
+static void
+slotConnectionHandler(void *parameter, CS104_Connection connection, CS104_ConnectionEvent event)
+{
+    (void) connection;
+
+    ClientSlot *slot = (ClientSlot *) parameter;
+
+    switch (event) {
+        case CS104_CONNECTION_OPENED:
+            atomic_store(&slot->state, SLOT_OPENED);
+            break;
+        case CS104_CONNECTION_STARTDT_CON_RECEIVED:
+            atomic_store(&slot->state, SLOT_ACTIVE);
+            break;
+        case CS104_CONNECTION_CLOSED:
+            atomic_store(&slot->state, SLOT_CLOSED);
+            break;
+        case CS104_CONNECTION_FAILED:
+            atomic_store(&slot->state, SLOT_FAILED);
+            break;
+        default:
+            break;
+    }
+}
+
+static bool
+slotAsduHandler(void *parameter, int address, CS101_ASDU asdu)
+{
+    (void) address;
+
+    ClientSlot *slot = (ClientSlot *) parameter;
+
+    atomic_fetch_add_explicit(&slot->rxAsdus, 1, memory_order_relaxed);
+
+    if (slot->pool->onAsdu)
+        slot->pool->onAsdu(slot->pool->context, slot->index, asdu);
+
+    return true;
+}
+
+ClientPool
+ClientPool_create(const ClientTarget *targets, int numTargets, int count, int originatorAddress,
+                  ClientAsduFunction onAsdu, IEC60870_RawMessageHandler rawHandler, void *context)
+{
+    if (count <= 0 || numTargets <= 0)
+        return NULL;
+
+    ClientPool self = (ClientPool) GLOBAL_CALLOC(1, sizeof(struct sClientPool));
+
+    if (self == NULL)
+        return NULL;
+
+    self->numTargets = numTargets < CLIENT_MAX_TARGETS ? numTargets : CLIENT_MAX_TARGETS;
+    memcpy(self->targets, targets, (size_t) self->numTargets * sizeof(ClientTarget));
+    self->onAsdu = onAsdu;
+    self->context = context;
+
+    self->slots = (ClientSlot *) GLOBAL_CALLOC((size_t) count, sizeof(ClientSlot));
+
+    if (self->slots == NULL) {
+        GLOBAL_FREEMEM(self);
+        return NULL;
+    }
+
+    raiseFileLimit(count);
+
+    for (int i = 0; i < count; i++) {
+        ClientSlot *slot = &self->slots[i];
+        slot->pool = self;
+        slot->index = i;
+        slot->target = &self->targets[i % self->numTargets];
+        slot->backoffMs = CLIENT_BACKOFF_MIN_MS;
+        atomic_init(&slot->state, SLOT_WAITING);
+        atomic_init(&slot->rxAsdus, 0);
+
+        slot->connection = CS104_Connection_create(slot->target->host, slot->target->port);
+
+        if (slot->connection == NULL)
+            break;
+
+        CS104_Connection_getAppLayerParameters(slot->connection)->originatorAddress = originatorAddress;
+        CS104_Connection_setConnectionHandler(slot->connection, slotConnectionHandler, slot);
+        CS104_Connection_setASDUReceivedHandler(slot->connection, slotAsduHandler, slot);
+
+        if (rawHandler)
+            CS104_Connection_setRawMessageHandler(slot->connection, rawHandler, slot->connection);
+
+        self->count++;
+    }
+
+    return self;
+}
+
+// Uzavře každé CLIENT_CLOSE_THREADS-té spojení od zadaného
+typedef struct {
+    ClientPool pool;
+    int first;
+} CloseTask;
+
+static void *
+closeThread(void *parameter)
+{
+    CloseTask *task = (CloseTask *) parameter;
+
+    for (int i = task->first; i < task->pool->count; i += CLIENT_CLOSE_THREADS)
+        CS104_Connection_destroy(task->pool->slots[i].connection);
+
+    return NULL;
+}
+
+void
+ClientPool_destroy(ClientPool self)
+{
+    if (self == NULL)
+        return;
+
+    if (self->wheel) {
+        TimerWheel_removeTimer(self->wheel, self->superviseTimer);
+
+        for (int i = 0; i < self->count; i++) {
+            TimerWheel_removeTimer(self->wheel, self->slots[i].giTimer);
+            TimerWheel_removeTimer(self->wheel, self->slots[i].syncTimer);
+            TimerWheel_removeTimer(self->wheel, self->slots[i].commandTimer);
+        }
+    }
+
+    CloseTask tasks[CLIENT_CLOSE_THREADS];
+    Thread threads[CLIENT_CLOSE_THREADS];
+
+    for (int t = 0; t < CLIENT_CLOSE_THREADS; t++) {
+        tasks[t].pool = self;
+        tasks[t].first = t;
+        threads[t] = Thread_create(closeThread, &tasks[t], false);
+        Thread_start(threads[t]);
+    }
+
+    for (int t = 0; t < CLIENT_CLOSE_THREADS; t++)
+        Thread_destroy(threads[t]);
+
+    GLOBAL_FREEMEM(self->slots);
+    GLOBAL_FREEMEM(self);
+}
+
+// Obsluha změn stavu spojení (hlavní smyčka)
+static void
+onSuperviseTimer(void *parameter, uint64_t now)
+{
+    ClientPool self = (ClientPool) parameter;
+    int connects = 0;
+
+    for (int i = 0; i < self->count; i++) {
+        ClientSlot *slot = &self->slots[i];
+        int state = atomic_load(&slot->state);
+
+        switch (state) {
+            case SLOT_CLOSED:
+            case SLOT_FAILED:
+                // Vlákno spojení už skončilo, stav mění jen hlavní smyčka
+                if (state == SLOT_CLOSED)
+                    self->disconnects++;
+                else
+                    self->failures++;
+
+                // Rozptyl odstupu ±25 %, aby se odpojená spojení nevracela najednou
+                slot->reconnectAtMs = now + (uint64_t) (slot->backoffMs * 3 / 4 + rand() % (slot->backoffMs / 2 + 1));
+                slot->backoffMs = (slot->backoffMs * 2 < CLIENT_BACKOFF_MAX_MS) ? slot->backoffMs * 2 : CLIENT_BACKOFF_MAX_MS;
+                atomic_store(&slot->state, SLOT_WAITING);
+                break;
+
+            case SLOT_WAITING:
+                if (now >= slot->reconnectAtMs && connects < CLIENT_CONNECTS_PER_TICK) {
+                    atomic_store(&slot->state, SLOT_CONNECTING);
+                    CS104_Connection_connectAsync(slot->connection);
+                    connects++;
+                }
+                break;
+
+            case SLOT_OPENED:
+                // Spojení se mohlo mezitím zavřít – CLOSED se nesmí přepsat
+                if (atomic_compare_exchange_strong(&slot->state, &state, SLOT_STARTING))
+                    CS104_Connection_sendStartDT(slot->connection);
+                break;
+
+            case SLOT_ACTIVE:
+                slot->backoffMs = CLIENT_BACKOFF_MIN_MS;
+                slot->everActive = true;
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+static bool
+isActive(ClientSlot *slot)
+{
+    return atomic_load(&slot->state) == SLOT_ACTIVE;
+}
+
+static void
+onGiTimer(void *parameter, uint64_t now)
+{
+    (void) now;
+
+    ClientSlot *slot = (ClientSlot *) parameter;
+
+    if (!isActive(slot))
+        return;
+
+    // Před odesláním – odpověď může přijít dřív, než send vrátí
+    if (slot->pool->onSent)
+        slot->pool->onSent(slot->pool->context, slot->index, C_IC_NA_1, slot->target->ca);
+
+    if (CS104_Connection_sendInterrogationCommand(slot->connection, CS101_COT_ACTIVATION, slot->target->ca,
+                                                  IEC60870_QOI_STATION))
+        slot->pool->giSent++;
+}
+
+static void
+onSyncTimer(void *parameter, uint64_t now)
+{
+    (void) now;
+
+    ClientSlot *slot = (ClientSlot *) parameter;
+
+    if (!isActive(slot))
+        return;
+
+    struct sCP56Time2a time;
+    CP56Time2a_createFromMsTimestamp(&time, Hal_getTimeInMs());
+
+    if (slot->pool->onSent)
+        slot->pool->onSent(slot->pool->context, slot->index, C_CS_NA_1, slot->target->ca);
+
+    if (CS104_Connection_sendClockSyncCommand(slot->connection, slot->target->ca, &time))
+        slot->pool->syncSent++;
+}
+
+static void
+onCommandTimer(void *parameter, uint64_t now)
+{
+    (void) now;
+
+    ClientSlot *slot = (ClientSlot *) parameter;
+
+    if (!isActive(slot))
+        return;
+
+    slot->pool->command(slot->pool->context, slot->index, slot->connection, slot->target->ca);
+    slot->pool->commandRounds++;
+}
+
+// Periodický časovač spojení i s fází rozprostřenou podle pořadí spojení
+static Timer
+startSlotTimer(ClientPool self, ClientSlot *slot, TimerCallback callback, int periodMs)
+{
+    if (periodMs <= 0)
+        return NULL;
+
+    Timer timer = TimerWheel_addTimer(self->wheel, callback, slot);
+    uint64_t phase = (uint64_t) periodMs * (uint64_t) slot->index / (uint64_t) self->count;
+    TimerWheel_start(self->wheel, timer, (uint64_t) periodMs + phase, (uint64_t) periodMs);
+
+    return timer;
+}
+
+void
+ClientPool_start(ClientPool self, TimerWheel wheel, const ClientSchedule *schedule, ClientCommandFunction command)
+{
+    self->wheel = wheel;
+    self->command = command;
+    self->lastReportUs = TimerWheel_monotonicUs();
+
+    self->superviseTimer = TimerWheel_addTimer(wheel, onSuperviseTimer, self);
+    TimerWheel_start(wheel, self->superviseTimer, 0, CLIENT_SUPERVISE_MS);
+
+    for (int i = 0; i < self->count; i++) {
+        ClientSlot *slot = &self->slots[i];
+        slot->giTimer = startSlotTimer(self, slot, onGiTimer, schedule->giMs);
+        slot->syncTimer = startSlotTimer(self, slot, onSyncTimer, schedule->syncMs);
+        if (command)
+            slot->commandTimer = startSlotTimer(self, slot, onCommandTimer, schedule->commandMs);
+    }
+}
+
+void
+ClientPool_setSentHandler(ClientPool self, ClientSentFunction onSent)
+{
+    self->onSent = onSent;
+}
+
+void
+ClientPool_report(ClientPool self, const char *label)
+{
+    uint64_t nowUs = TimerWheel_monotonicUs();
+    double seconds = (double) (nowUs - self->lastReportUs) / 1e6;
+
+    if (seconds <= 0)
+        return;
+
+    int states[SLOT_FAILED + 1] = {0};
+    uint64_t rxTotal = 0;
+    uint64_t rxMin = UINT64_MAX;
+    uint64_t rxMax = 0;
+    int neverActive = 0;
+
+    for (int i = 0; i < self->count; i++) {
+        ClientSlot *slot = &self->slots[i];
+        states[atomic_load(&slot->state)]++;
+
+        uint64_t rx = atomic_load_explicit(&slot->rxAsdus, memory_order_relaxed);
+        uint64_t delta = rx - slot->lastRxAsdus;
+        slot->lastRxAsdus = rx;
+
+        rxTotal += delta;
+        if (delta < rxMin) rxMin = delta;
+        if (delta > rxMax) rxMax = delta;
+        if (!slot->everActive) neverActive++;
+    }
+
+    printf("%s SPOJENÍ %d/%d aktivních", label, states[SLOT_ACTIVE], self->count);
+
+    int pending = states[SLOT_CONNECTING] + states[SLOT_OPENED] + states[SLOT_STARTING];
+    if (pending > 0)
+        printf(", %d se připojuje", pending);
+    if (states[SLOT_WAITING] > 0)
+        printf(", %d čeká na nové připojení", states[SLOT_WAITING]);
+    if (neverActive > 0)
+        printf(" (%d dosud nepřipojeno)", neverActive);
+
+    printf(" | odpojení %llu (celkem %llu), neúspěšných pokusů %llu",
+           (unsigned long long) (self->disconnects - self->lastDisconnects), (unsigned long long) self->disconnects,
+           (unsigned long long) self->failures);
+
+    printf(" | RX %.0f ASDU/s (spojení min %.0f, max %.0f)", rxTotal / seconds, rxMin / seconds, rxMax / seconds);
+    printf(" | TX GI %.0f/s, SYNC %.0f/s, commandy %.0f kol/s\n", (self->giSent - self->lastGiSent) / seconds,
+           (self->syncSent - self->lastSyncSent) / seconds, (self->commandRounds - self->lastCommandRounds) / seconds);
+    fflush(stdout);
+
+    self->lastReportUs = nowUs;
+    self->lastGiSent = self->giSent;
+    self->lastSyncSent = self->syncSent;
+    self->lastCommandRounds = self->commandRounds;
+    self->lastDisconnects = self->disconnects;
+}
@@ -0,0 +1,70 @@
+// =======================
+// VÍCE SPOJENÍ KLIENTA 104 V JEDNOM PROCESU (CLIENTS)
+// =======================
+//
+// Sada N spojení CS104_Connection na jeden nebo více serverů. Vlákna spojení
+// (knihovna) jen přijímají a nastavují atomický stav; připojování, STARTDT,
+// opětovné připojení s rostoucím odstupem i rozvrhy GI, synchronizace času a
+// commandů běží v hlavní smyčce na jednom TimerWheel. Rozvrhy jednotlivých
+// spojení jsou fázově rozprostřené, aby N spojení neposílalo ve stejné ms.
+// Příjem se jen započítá po spojeních a předá jednomu společnému handleru.
+
+#ifndef UNI_CLIENTS_H_
+#define UNI_CLIENTS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "iec60870_common.h"
+#include "cs104_connection.h"
+#include "uni_timer.h"
+
+#define CLIENT_MAX_TARGETS 64
+
+typedef struct sClientPool* ClientPool;
+
+// Cíl spojení (server a adresa stanice)
+typedef struct {
+    char host[64];
+    int port;
+    int ca;
+} ClientTarget;
+
+// Periody akcí každého spojení v ms (0 = vypnuto)
+typedef struct {
+    int giMs;
+    int syncMs;
+    int commandMs;
+} ClientSchedule;
+
+// Přijaté ASDU spojení číslo connection (volá se z vlákna spojení)
+typedef void (*ClientAsduFunction)(void *context, int connection, CS101_ASDU asdu);
+
+// Pošle commandy spojení číslo index (volá se z hlavní smyčky)
+typedef void (*ClientCommandFunction)(void *context, int index, CS104_Connection connection, int ca);
+
+// Spojení číslo connection právě odešle GI nebo synchronizaci času (typ 100/103), volá se před odesláním
+typedef void (*ClientSentFunction)(void *context, int connection, int type, int ca);
+
+// "host:port/ca,host:port/ca..." – chybějící port a CA se doplní z výchozích. Vrací počet cílů.
+int ClientPool_parseTargets(const char *text, const char *defaultHost, int defaultPort, int defaultCa,
+                            ClientTarget *targets, int maxTargets);
+
+// count spojení rozdělených mezi cíle po řadě; rawHandler dostane jako parametr CS104_Connection spojení
+ClientPool ClientPool_create(const ClientTarget *targets, int numTargets, int count, int originatorAddress,
+                             ClientAsduFunction onAsdu, IEC60870_RawMessageHandler rawHandler, void *context);
+
+// Uzavře všechna spojení (paralelně – každé vlákno spojení končí až po svém čekání na data)
+void ClientPool_destroy(ClientPool self);
+
+// Naplánuje připojování a rozvrhy akcí na wheel (command může být NULL)
+void ClientPool_start(ClientPool self, TimerWheel wheel, const ClientSchedule *schedule,
+                      ClientCommandFunction command);
+
+// Handler odeslaných GI a synchronizací (např. pro měření latence), volat před ClientPool_start
+void ClientPool_setSentHandler(ClientPool self, ClientSentFunction onSent);
+
+// Vypíše souhrn spojení a rychlostí od minulého výpisu
+void ClientPool_report(ClientPool self, const char *label);
+
+#endif /* UNI_CLIENTS_H_ */
@@ -0,0 +1,754 @@
+// =======================
+// VYKONÁVÁNÍ COMMANDŮ SERVEREM – implementace
+// =======================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "uni_commands.h"
+#include "uni_math.h"
+#include "uni_timer.h"
+#include "hal_thread.h"
+#include "lib_memory.h"
+
+#define COMMAND_INITIAL_SLOTS 64
+#define COMMAND_MAX_PAYLOAD 16            // IOA (max. 3 B) + prvek commandu (max. 12 B u 63 s CP56)
+#define COMMAND_MAX_DELAY_MS 3600000.0f   // Horní mez vylosované doby (1 h)
+
+// Druh commandu a jemu odpovídající druh stavového bodu
+typedef enum {
+    KIND_NONE = 0,
+    KIND_SINGLE,              // 45/58 -> 1, 2, 30
+    KIND_DOUBLE,              // 46/59 -> 3, 4, 31
+    KIND_NORMALIZED,          // 48/61 -> 9, 10, 34
+    KIND_SCALED,              // 49/62 -> 11, 12, 35
+    KIND_FLOAT                // 50/63 -> 13, 14, 36
+} CommandKind;
+
+// Vazba IOA commandu na stavový bod
+typedef struct {
+    int32_t ioa;
+    int32_t point;
+    uint8_t kind;
+    uint8_t selectBeforeOperate;
+    CommandDelay delay;
+
+    // Platný výběr SBO
+    IMasterConnection selectedBy;
+    uint64_t selectExpiresMs;
+    float selectedValue;
+} CommandLink;
+
+// Čekající command. Pole slotů se při růstu přesouvá (realloc), proto slot nesmí obsahovat
+// ukazatele do sebe (sCS101_StaticASDU) – přijaté ASDU se drží jen jako hlavička a bajty
+// payloadu a pro ACT_CON a ACT_TERM se sestaví až při vykonání
+typedef struct {
+    IMasterConnection connection;
+    uint64_t dueMs;
+    uint64_t sequence;        // Commandy se stejným termínem v pořadí příjmu
+    int32_t ioa;
+    uint8_t kind;
+    bool cancelled;
+    float value;
+
+    uint8_t typeId;
+    uint8_t cot;
+    bool isTest;
+    bool isNegative;
+    int32_t oa;
+    int32_t ca;
+    uint8_t payloadSize;
+    uint8_t payload[COMMAND_MAX_PAYLOAD];
+} CommandSlot;
+
+struct sCommandEngine {
+    Semaphore lock;           // Commandy přijímají vlákna spojení, vykonává hlavní smyčka
+
+    CommandDelay defaultDelay;
+    int selectTimeoutMs;
+    uint64_t random;          // xorshift64*
+
+    // Vazby a vyhledávání (druh, IOA) -> vazba, otevřené adresování (-1 = prázdné místo)
+    CommandLink *links;
+    int linkCount;
+    int32_t *hash;
+    uint32_t hashMask;
+
+    // Čekající commandy: pole slotů, zásobník volných slotů a halda podle (termín, pořadí)
+    CommandSlot *slots;
+    int32_t *freeSlots;
+    int32_t *heap;
+    int slotCapacity;
+    int maxSlots;
+    int freeCount;
+    int heapCount;
+    uint64_t sequence;
+
+    CommandStats stats;
+};
+
+static int
+commandKind(int type)
+{
+    switch (type) {
+        case C_SC_NA_1: case C_SC_TA_1: return KIND_SINGLE;
+        case C_DC_NA_1: case C_DC_TA_1: return KIND_DOUBLE;
+        case C_SE_NA_1: case C_SE_TA_1: return KIND_NORMALIZED;
+        case C_SE_NB_1: case C_SE_TB_1: return KIND_SCALED;
+        case C_SE_NC_1: case C_SE_TC_1: return KIND_FLOAT;
+        default: return KIND_NONE;
+    }
+}
+
+static int
+statusKind(int type)
+{
+    switch (type) {
+        case M_SP_NA_1: case M_SP_TA_1: case M_SP_TB_1: return KIND_SINGLE;
+        case M_DP_NA_1: case M_DP_TA_1: case M_DP_TB_1: return KIND_DOUBLE;
+        case M_ME_NA_1: case M_ME_TA_1: case M_ME_TD_1: return KIND_NORMALIZED;
+        case M_ME_NB_1: case M_ME_TB_1: case M_ME_TE_1: return KIND_SCALED;
+        case M_ME_NC_1: case M_ME_TC_1: case M_ME_TF_1: return KIND_FLOAT;
+        default: return KIND_NONE;
+    }
+}
+
+// Doba s jednotkou jako TimerWheel_parseDuration ("200ms", "1.5" = s), v ms
+static bool
+parseDelayMs(const char *text, float *ms)
+{
+    while (*text == ' ')
+        text++;
+
+    char *end;
+    double value = strtod(text, &end);
+
+    if (end == text || value < 0)
+        return false;
+
+    if (strcmp(end, "ms") == 0)
+        *ms = (float) value;
+    else if (*end == '\0' || strcmp(end, "s") == 0)
+        *ms = (float) (value * 1000.0);
+    else
+        return false;
+
+    return true;
+}
+
+bool
+CommandDelay_parse(const char *text, CommandDelay *delay)
+{
+    static const struct {
+        const char *name;
+        CommandDelayKind kind;
+        int args;
+    } delayNames[] = {
+        {"FIX", COMMAND_DELAY_FIXED, 1},
+        {"UNIFORM", COMMAND_DELAY_UNIFORM, 2},
+        {"NORMAL", COMMAND_DELAY_NORMAL, 2},
+        {"EXP", COMMAND_DELAY_EXP, 1}
+    };
+
+    memset(delay, 0, sizeof(CommandDelay));
+
+    // Volba končí středníkem nebo koncem řádku
+    char buffer[128];
+    size_t length = strcspn(text, ";\r\n");
+    if (length >= sizeof(buffer))
+        return false;
+    memcpy(buffer, text, length);
+    buffer[length] = '\0';
+
+    char *args[3];
+    int argc = 0;
+
+    for (char *token = strtok(buffer, ","); token != NULL; token = strtok(NULL, ",")) {
+        if (argc == 3)
+            return false;
+        while (*token == ' ')
+            token++;
+        args[argc++] = token;
+    }
+
+    if (argc == 0)
+        return false;
+
+    // Samotná doba = pevná
+    if (argc == 1 && parseDelayMs(args[0], &delay->param[0])) {
+        delay->kind = COMMAND_DELAY_FIXED;
+        return true;
+    }
+
+    int count = (int) (sizeof(delayNames) / sizeof(delayNames[0]));
+    int k = 0;
+    while (k < count && strcmp(args[0], delayNames[k].name) != 0)
+        k++;
+
+    if (k == count || argc - 1 != delayNames[k].args)
+        return false;
+
+    delay->kind = (uint8_t) delayNames[k].kind;
+
+    for (int i = 1; i < argc; i++) {
+        if (!parseDelayMs(args[i], &delay->param[i - 1]))
+            return false;
+    }
+
+    return delay->kind != COMMAND_DELAY_UNIFORM || delay->param[1] >= delay->param[0];
+}
+
+bool
+CommandLink_parse(const char *text, PointCommand *command)
+{
+    char buffer[64];
+    size_t length = strcspn(text, ";\r\n");
+    if (length >= sizeof(buffer))
+        return false;
+    memcpy(buffer, text, length);
+    buffer[length] = '\0';
+
+    int32_t ioa = -1;
+    bool selectBeforeOperate = false;
+
+    for (char *token = strtok(buffer, ","); token != NULL; token = strtok(NULL, ",")) {
+        while (*token == ' ')
+            token++;
+
+        char *end;
+        long value = strtol(token, &end, 10);
+
+        if (strcmp(token, "SBO") == 0)
+            selectBeforeOperate = true;
+        else if (strcmp(token, "DIRECT") == 0)
+            selectBeforeOperate = false;
+        else if (end != token && *end == '\0' && value >= 0 && value <= 0xffffff)
+            ioa = (int32_t) value;
+        else
+            return false;
+    }
+
+    command->ioa = ioa;
+    command->selectBeforeOperate = selectBeforeOperate;
+    return true;
+}
+
+static uint32_t
+linkHash(int kind, int32_t ioa, uint32_t mask)
+{
+    return (((uint32_t) ioa * 2654435761u) ^ (uint32_t) kind) & mask;
+}
+
+static int
+findLink(CommandEngine self, int kind, int32_t ioa)
+{
+    uint32_t h = linkHash(kind, ioa, self->hashMask);
+
+    while (self->hash[h] >= 0) {
+        const CommandLink *link = &self->links[self->hash[h]];
+        if (link->ioa == ioa && link->kind == kind)
+            return self->hash[h];
+        h = (h + 1) & self->hashMask;
+    }
+
+    return -1;
+}
+
+// Přidá vazbu, pokud (druh, IOA) ještě nemá žádnou
+static void
+addLink(CommandEngine self, int kind, int32_t ioa, int point, bool selectBeforeOperate, const CommandDelay *delay)
+{
+    uint32_t h = linkHash(kind, ioa, self->hashMask);
+
+    while (self->hash[h] >= 0) {
+        const CommandLink *link = &self->links[self->hash[h]];
+        if (link->ioa == ioa && link->kind == kind)
+            return;
+        h = (h + 1) & self->hashMask;
+    }
+
+    CommandLink *link = &self->links[self->linkCount];
+    memset(link, 0, sizeof(CommandLink));
+    link->ioa = ioa;
+    link->point = point;
+    link->kind = (uint8_t) kind;
+    link->selectBeforeOperate = selectBeforeOperate;
+    link->delay = *delay;
+    self->hash[h] = self->linkCount++;
+}
+
+// Sestaví vazby z tabulky: nejdřív volby CMD=, pak stejné IOA (volá se pod zámkem nebo před spuštěním)
+static bool
+buildLinks(CommandEngine self, PointTable points)
+{
+    int capacity = points->count > 0 ? points->count : 1;
+    uint32_t hashSize = 16;
+
+    while (hashSize < 2 * (uint32_t) capacity)
+        hashSize <<= 1;
+
+    CommandLink *links = (CommandLink *) GLOBAL_MALLOC((size_t) capacity * sizeof(CommandLink));
+    int32_t *hash = (int32_t *) GLOBAL_MALLOC(hashSize * sizeof(int32_t));
+
+    if (links == NULL || hash == NULL) {
+        GLOBAL_FREEMEM(links);
+        GLOBAL_FREEMEM(hash);
+        return false;
+    }
+
+    GLOBAL_FREEMEM(self->links);
+    GLOBAL_FREEMEM(self->hash);
+    self->links = links;
+    self->hash = hash;
+    self->hashMask = hashSize - 1;
+    self->linkCount = 0;
+    memset(hash, 0xff, hashSize * sizeof(int32_t));
+
+    for (int c = 0; c < points->commandCount; c++) {
+        const PointCommand *command = &points->commands[c];
+        int p = command->point;
+        int kind = statusKind(points->type[p]);
+
+        if (kind == KIND_NONE)
+            continue;
+
+        addLink(self, kind, command->ioa >= 0 ? command->ioa : points->ioa[p], p, command->selectBeforeOperate,
+                command->hasDelay ? &command->delay : &self->defaultDelay);
+    }
+
+    for (int p = 0; p < points->count; p++) {
+        int kind = statusKind(points->type[p]);
+
+        if (kind != KIND_NONE && (points->flags[p] & POINT_FLAG_COMMAND) == 0)
+            addLink(self, kind, points->ioa[p], p, false, &self->defaultDelay);
+    }
+
+    return true;
+}
+
+CommandEngine
+CommandEngine_create(PointTable points, const CommandDelay *defaultDelay, int selectTimeoutMs, int capacity)
+{
+    CommandEngine self = (CommandEngine) GLOBAL_CALLOC(1, sizeof(struct sCommandEngine));
+
+    if (self == NULL)
+        return NULL;
+
+    self->defaultDelay = *defaultDelay;
+    self->selectTimeoutMs = selectTimeoutMs;
+    self->maxSlots = capacity;
+    self->random = TimerWheel_monotonicMs() | 1;
+    self->lock = Semaphore_create(1);
+
+    if (self->lock == NULL || !buildLinks(self, points)) {
+        CommandEngine_destroy(self);
+        return NULL;
+    }
+
+    return self;
+}
+
+void
+CommandEngine_destroy(CommandEngine self)
+{
+    if (self == NULL)
+        return;
+
+    if (self->lock)
+        Semaphore_destroy(self->lock);
+
+    GLOBAL_FREEMEM(self->links);
+    GLOBAL_FREEMEM(self->hash);
+    GLOBAL_FREEMEM(self->slots);
+    GLOBAL_FREEMEM(self->freeSlots);
+    GLOBAL_FREEMEM(self->heap);
+    GLOBAL_FREEMEM(self);
+}
+
+bool
+CommandEngine_setPoints(CommandEngine self, PointTable points)
+{
+    Semaphore_wait(self->lock);
+    bool built = buildLinks(self, points);
+    Semaphore_post(self->lock);
+    return built;
+}
+
+// Rovnoměrně v (0, 1]
+static double
+uniform(CommandEngine self)
+{
+    self->random ^= self->random >> 12;
+    self->random ^= self->random << 25;
+    self->random ^= self->random >> 27;
+    uint64_t x = self->random * 0x2545F4914F6CDD1DULL;
+
+    return (double) ((x >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+
+static float
+sampleDelay(CommandEngine self, const CommandDelay *delay)
+{
+    double ms;
+
+    switch (delay->kind) {
+        case COMMAND_DELAY_UNIFORM:
+            ms = delay->param[0] + (delay->param[1] - delay->param[0]) * uniform(self);
+            break;
+        case COMMAND_DELAY_NORMAL: {
+            // Součet 12 rovnoměrných minus 6 má rozptyl 1 (Irwin–Hall), na dobu odezvy stačí
+            double sum = -6.0;
+            for (int i = 0; i < 12; i++)
+                sum += uniform(self);
+            ms = delay->param[0] + delay->param[1] * sum;
+            break;
+        }
+        case COMMAND_DELAY_EXP:
+            ms = -delay->param[0] * UniMath_naturalLog(uniform(self));
+            break;
+        default:
+            ms = delay->param[0];
+            break;
+    }
+
+    if (ms < 0)
+        return 0;
+
+    return ms > COMMAND_MAX_DELAY_MS ? COMMAND_MAX_DELAY_MS : (float) ms;
+}
+
+static bool
+slotBefore(CommandEngine self, int32_t a, int32_t b)
+{
+    const CommandSlot *x = &self->slots[a];
+    const CommandSlot *y = &self->slots[b];
+    return x->dueMs < y->dueMs || (x->dueMs == y->dueMs && x->sequence < y->sequence);
+}
+
+static void
+heapPush(CommandEngine self, int32_t slot)
+{
+    int i = self->heapCount++;
+
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!slotBefore(self, slot, self->heap[parent]))
+            break;
+        self->heap[i] = self->heap[parent];
+        i = parent;
+    }
+
+    self->heap[i] = slot;
+}
+
+static int32_t
+heapPop(CommandEngine self)
+{
+    int32_t top = self->heap[0];
+    int32_t last = self->heap[--self->heapCount];
+    int i = 0;
+
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= self->heapCount)
+            break;
+        if (child + 1 < self->heapCount && slotBefore(self, self->heap[child + 1], self->heap[child]))
+            child++;
+        if (!slotBefore(self, self->heap[child], last))
+            break;
+        self->heap[i] = self->heap[child];
+        i = child;
+    }
+
+    if (self->heapCount > 0)
+        self->heap[i] = last;
+
+    return top;
+}
+
+// Volný slot (pole rostou zdvojením až do maxSlots), -1 = fronta je plná
+static int32_t
+allocateSlot(CommandEngine self)
+{
+    if (self->freeCount == 0) {
+        if (self->slotCapacity >= self->maxSlots)
+            return -1;
+
+        int capacity = self->slotCapacity ? self->slotCapacity * 2 : COMMAND_INITIAL_SLOTS;
+        if (capacity > self->maxSlots)
+            capacity = self->maxSlots;
+
+        CommandSlot *slots = (CommandSlot *) GLOBAL_REALLOC(self->slots, (size_t) capacity * sizeof(CommandSlot));
+        if (slots == NULL)
+            return -1;
+        self->slots = slots;
+
+        int32_t *freeSlots = (int32_t *) GLOBAL_REALLOC(self->freeSlots, (size_t) capacity * sizeof(int32_t));
+        if (freeSlots == NULL)
+            return -1;
+        self->freeSlots = freeSlots;
+
+        int32_t *heap = (int32_t *) GLOBAL_REALLOC(self->heap, (size_t) capacity * sizeof(int32_t));
+        if (heap == NULL)
+            return -1;
+        self->heap = heap;
+
+        // Nové sloty na zásobník od konce, aby se bralo od nejnižšího
+        for (int s = capacity - 1; s >= self->slotCapacity; s--)
+            self->freeSlots[self->freeCount++] = s;
+
+        self->slotCapacity = capacity;
+    }
+
+    return self->freeSlots[--self->freeCount];
+}
+
+// Hodnota stavového bodu a příznak výběru z jediného IO commandu, false = neplatný stav
+static bool
+decodeCommand(CS101_ASDU asdu, int kind, int32_t *ioa, float *value, bool *select)
+{
+    InformationObject io = CS101_ASDU_getElement(asdu, 0);
+
+    if (io == NULL)
+        return false;
+
+    bool valid = true;
+    *ioa = InformationObject_getObjectAddress(io);
+
+    switch (kind) {
+        case KIND_SINGLE:
+            *value = SingleCommand_getState((SingleCommand) io) ? 1.0f : 0.0f;
+            *select = SingleCommand_isSelect((SingleCommand) io);
+            break;
+        case KIND_DOUBLE: {
+            // DCS 1 = vypnuto, 2 = zapnuto odpovídá DPI stavového bodu, 0 a 3 nejsou přípustné
+            int state = DoubleCommand_getState((DoubleCommand) io);
+            valid = state == IEC60870_DOUBLE_POINT_OFF || state == IEC60870_DOUBLE_POINT_ON;
+            *value = (float) state;
+            *select = DoubleCommand_isSelect((DoubleCommand) io);
+            break;
+        }
+        case KIND_NORMALIZED:
+            *value = SetpointCommandNormalized_getValue((SetpointCommandNormalized) io);
+            *select = SetpointCommandNormalized_isSelect((SetpointCommandNormalized) io);
+            break;
+        case KIND_SCALED:
+            *value = (float) SetpointCommandScaled_getValue((SetpointCommandScaled) io);
+            *select = SetpointCommandScaled_isSelect((SetpointCommandScaled) io);
+            break;
+        default:
+            *value = SetpointCommandShort_getValue((SetpointCommandShort) io);
+            *select = SetpointCommandShort_isSelect((SetpointCommandShort) io);
+            break;
+    }
+
+    InformationObject_destroy(io);
+    return valid;
+}
+
+// Uloží přijaté ASDU do slotu, false = payload je delší než command s jedním IO
+static bool
+storeAsdu(CommandSlot *slot, CS101_ASDU asdu)
+{
+    int payloadSize = CS101_ASDU_getPayloadSize(asdu);
+
+    if (payloadSize > COMMAND_MAX_PAYLOAD)
+        return false;
+
+    slot->typeId = (uint8_t) CS101_ASDU_getTypeID(asdu);
+    slot->cot = (uint8_t) CS101_ASDU_getCOT(asdu);
+    slot->isTest = CS101_ASDU_isTest(asdu);
+    slot->isNegative = CS101_ASDU_isNegative(asdu);
+    slot->oa = CS101_ASDU_getOA(asdu);
+    slot->ca = CS101_ASDU_getCA(asdu);
+    slot->payloadSize = (uint8_t) payloadSize;
+    memcpy(slot->payload, CS101_ASDU_getPayload(asdu), (size_t) payloadSize);
+
+    return true;
+}
+
+// Sestaví ASDU commandu ze slotu do storage (platí, dokud žije storage)
+static CS101_ASDU
+restoreAsdu(const CommandSlot *slot, CS101_StaticASDU storage)
+{
+    CS101_ASDU asdu = CS101_ASDU_initializeStatic(storage,
+                                                  IMasterConnection_getApplicationLayerParameters(slot->connection),
+                                                  false, (CS101_CauseOfTransmission) slot->cot, slot->oa, slot->ca,
+                                                  slot->isTest, slot->isNegative);
+
+    CS101_ASDU_setTypeID(asdu, (IEC60870_5_TypeID) slot->typeId);
+    CS101_ASDU_setNumberOfElements(asdu, 1);
+    CS101_ASDU_addPayload(asdu, (uint8_t *) slot->payload, slot->payloadSize);
+
+    return asdu;
+}
+
+// Deaktivace: zruší čekající command stejného spojení, typu a IOA
+static bool
+cancelCommand(CommandEngine self, IMasterConnection connection, int type, int32_t ioa)
+{
+    for (int h = 0; h < self->heapCount; h++) {
+        CommandSlot *slot = &self->slots[self->heap[h]];
+
+        if (!slot->cancelled && slot->connection == connection && slot->ioa == ioa && slot->typeId == type) {
+            slot->cancelled = true;
+            self->stats.inFlight--;
+            self->stats.cancelled++;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+CommandVerdict
+CommandEngine_submit(CommandEngine self, IMasterConnection connection, CS101_ASDU asdu)
+{
+    int type = CS101_ASDU_getTypeID(asdu);
+    int kind = commandKind(type);
+    int cot = CS101_ASDU_getCOT(asdu);
+
+    if (kind == KIND_NONE || (cot != CS101_COT_ACTIVATION && cot != CS101_COT_DEACTIVATION))
+        return COMMAND_IGNORED;
+
+    int32_t ioa;
+    float value;
+    bool select;
+    bool valid = CS101_ASDU_getNumberOfElements(asdu) == 1 && CS101_ASDU_getPayloadSize(asdu) <= COMMAND_MAX_PAYLOAD &&
+                 decodeCommand(asdu, kind, &ioa, &value, &select);
+    uint64_t now = TimerWheel_monotonicMs();
+    CommandVerdict verdict;
+
+    Semaphore_wait(self->lock);
+
+    if (cot == CS101_COT_DEACTIVATION) {
+        verdict = (valid && cancelCommand(self, connection, type, ioa)) ? COMMAND_CONFIRM : COMMAND_REJECT;
+        Semaphore_post(self->lock);
+        return verdict;
+    }
+
+    self->stats.received++;
+    int l = valid ? findLink(self, kind, ioa) : -1;
+    CommandLink *link = (l >= 0) ? &self->links[l] : NULL;
+
+    if (!valid) {
+        verdict = COMMAND_REJECT;
+    }
+    else if (link == NULL) {
+        verdict = COMMAND_UNKNOWN_IOA;
+    }
+    else if (select) {
+        // Výběr platí pro toto spojení do vypršení; u bodu bez SBO se jen potvrdí (provedení ho nepotřebuje)
+        link->selectedBy = connection;
+        link->selectExpiresMs = now + (uint64_t) self->selectTimeoutMs;
+        link->selectedValue = value;
+        self->stats.selected++;
+        verdict = COMMAND_CONFIRM;
+    }
+    else if (link->selectBeforeOperate &&
+             (link->selectedBy != connection || now > link->selectExpiresMs || link->selectedValue != value)) {
+        verdict = COMMAND_REJECT;
+    }
+    else {
+        int32_t s = allocateSlot(self);
+
+        if (s < 0) {
+            verdict = COMMAND_REJECT;
+        }
+        else {
+            CommandSlot *slot = &self->slots[s];
+            storeAsdu(slot, asdu);
+            slot->connection = connection;
+            slot->dueMs = now + (uint64_t) sampleDelay(self, &link->delay);
+            slot->sequence = self->sequence++;
+            slot->ioa = ioa;
+            slot->kind = (uint8_t) kind;
+            slot->cancelled = false;
+            slot->value = value;
+            heapPush(self, s);
+
+            // Výběr se provedením spotřebuje
+            link->selectedBy = NULL;
+
+            if (++self->stats.inFlight > self->stats.maxInFlight)
+                self->stats.maxInFlight = self->stats.inFlight;
+            verdict = COMMAND_QUEUED;
+        }
+    }
+
+    if (verdict == COMMAND_REJECT || verdict == COMMAND_UNKNOWN_IOA)
+        self->stats.rejected++;
+
+    Semaphore_post(self->lock);
+    return verdict;
+}
+
+int
+CommandEngine_process(CommandEngine self, CommandExecuteHandler handler, void *parameter)
+{
+    int executed = 0;
+    uint64_t now = TimerWheel_monotonicMs();
+
+    // Zámek drží i odeslání – handler zavření spojení (dropConnection) tak počká a spojení
+    // nedostane odpověď po zavření
+    Semaphore_wait(self->lock);
+
+    while (self->heapCount > 0 && self->slots[self->heap[0]].dueMs <= now) {
+        int32_t s = heapPop(self);
+        CommandSlot *slot = &self->slots[s];
+
+        if (!slot->cancelled) {
+            int l = findLink(self, slot->kind, slot->ioa);
+            sCS101_StaticASDU storage;
+            CS101_ASDU asdu = restoreAsdu(slot, &storage);
+
+            // Vazba mohla zmizet při hot reloadu – handler pošle negativní potvrzení
+            handler(parameter, slot->connection, asdu, l >= 0 ? self->links[l].point : -1, slot->value);
+
+            self->stats.inFlight--;
+            if (l >= 0)
+                self->stats.executed++;
+            else
+                self->stats.rejected++;
+            executed++;
+        }
+
+        self->freeSlots[self->freeCount++] = s;
+    }
+
+    Semaphore_post(self->lock);
+    return executed;
+}
+
+void
+CommandEngine_dropConnection(CommandEngine self, IMasterConnection connection)
+{
+    Semaphore_wait(self->lock);
+
+    for (int h = 0; h < self->heapCount; h++) {
+        CommandSlot *slot = &self->slots[self->heap[h]];
+
+        if (!slot->cancelled && slot->connection == connection) {
+            slot->cancelled = true;
+            self->stats.inFlight--;
+            self->stats.cancelled++;
+        }
+    }
+
+    for (int l = 0; l < self->linkCount; l++) {
+        if (self->links[l].selectedBy == connection)
+            self->links[l].selectedBy = NULL;
+    }
+
+    Semaphore_post(self->lock);
+}
+
+void
+CommandEngine_getStats(CommandEngine self, CommandStats *stats)
+{
+    Semaphore_wait(self->lock);
+    *stats = self->stats;
+    Semaphore_post(self->lock);
+}
@@ -0,0 +1,86 @@
+// =======================
+// VYKONÁVÁNÍ COMMANDŮ SERVEREM (COMMANDDELAY, CMD=, DELAY=)
+// =======================
+//
+// Command (45/46, žádané hodnoty 48–50 i varianty s časovou značkou) se
+// nevykoná hned: dostane termín podle rozdělení doby vykonání svého bodu a
+// čeká v jedné haldě seřazené podle termínů. Hlavní smyčka v každém ticku
+// vybere commandy, kterým termín vypršel, a pro každý pošle ACT_CON, změní
+// navázaný stavový bod (zpráva s COT 11) a pošle ACT_TERM. Rozpracovaných
+// commandů mohou být desetitisíce bez vlákna nebo časovače na command.
+//
+// Zápis v konfiguraci (volby stavového bodu):
+//   CMD=ioa[,SBO]     bod ovládá command s tímto IOA (bez IOA = stejné IOA jako bod),
+//                     SBO = command vyžaduje předchozí výběr (select before operate)
+//   DELAY=rozdělení   vlastní doba vykonání, jinak platí COMMANDDELAY:
+//     FIX,doba | UNIFORM,min,max | NORMAL,střed,odchylka | EXP,střed  (doby jako 200ms, 1.5)
+//
+// Command bez vazby CMD= ovládá stavový bod odpovídajícího typu se stejným IOA
+// (jednobitový 1/2/30 pro 45, dvoubitový 3/4/31 pro 46, měření 9–14/34–36 pro
+// žádané hodnoty 48–50). Výběr SBO platí jen pro spojení, které ho poslalo, do
+// SBOTIMEOUT; výběr bodu bez SBO se jen potvrdí. Deaktivace (COT 8) zruší
+// čekající command téhož spojení.
+
+#ifndef UNI_COMMANDS_H_
+#define UNI_COMMANDS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "iec60870_slave.h"
+#include "uni_points.h"
+
+typedef struct sCommandEngine* CommandEngine;
+
+// Co má volající s přijatým ASDU udělat hned
+typedef enum {
+    COMMAND_IGNORED,          // Není to command pro engine (jiný typ nebo COT)
+    COMMAND_QUEUED,           // Čeká na termín, odpovědi pošle CommandEngine_process
+    COMMAND_CONFIRM,          // Pozitivní potvrzení hned (výběr SBO, zrušení deaktivací)
+    COMMAND_REJECT,           // Negativní potvrzení hned (chybí výběr, jiný typ bodu, plná fronta)
+    COMMAND_UNKNOWN_IOA       // Žádný stavový bod pro IOA commandu
+} CommandVerdict;
+
+typedef struct {
+    uint64_t received;        // Přijaté commandy (aktivace)
+    uint64_t executed;        // Vykonané (ACT_CON + ACT_TERM)
+    uint64_t selected;        // Potvrzené výběry (select)
+    uint64_t rejected;        // Negativně potvrzené (včetně neznámého IOA)
+    uint64_t cancelled;       // Zrušené deaktivací nebo zavřením spojení
+    int inFlight;             // Právě čekající commandy
+    int maxInFlight;          // Nejvíc čekajících najednou
+} CommandStats;
+
+// Vykonání commandu: volá se z CommandEngine_process pod zámkem enginu, asdu je kopie přijatého (platí jen během volání)
+// commandu (pro ACT_CON a ACT_TERM), point = index navázaného stavového bodu, value = jeho nová hodnota
+typedef void (*CommandExecuteHandler)(void *parameter, IMasterConnection connection, CS101_ASDU asdu, int point,
+                                      float value);
+
+// Rozebere text za "DELAY=" (nebo hodnotu COMMANDDELAY), vrací false při chybě
+bool CommandDelay_parse(const char *text, CommandDelay *delay);
+
+// Rozebere text za "CMD=" do vazby (ostatní položky nechá), vrací false při chybě
+bool CommandLink_parse(const char *text, PointCommand *command);
+
+// defaultDelay = rozdělení pro body bez DELAY=, selectTimeoutMs = platnost výběru SBO, capacity = max.
+// čekajících commandů. NULL = chyba.
+CommandEngine CommandEngine_create(PointTable points, const CommandDelay *defaultDelay, int selectTimeoutMs,
+                                   int capacity);
+
+void CommandEngine_destroy(CommandEngine self);
+
+// Tabulka bodů byla vyměněna (hot reload) – znovu sestaví vazby, čekající commandy zůstanou
+bool CommandEngine_setPoints(CommandEngine self, PointTable points);
+
+// Přijatý command (volá se z vlákna spojení)
+CommandVerdict CommandEngine_submit(CommandEngine self, IMasterConnection connection, CS101_ASDU asdu);
+
+// Vykoná commandy, kterým vypršel termín, vrací jejich počet
+int CommandEngine_process(CommandEngine self, CommandExecuteHandler handler, void *parameter);
+
+// Spojení se zavřelo – zahodí jeho čekající commandy a výběry (volat z handleru událostí spojení)
+void CommandEngine_dropConnection(CommandEngine self, IMasterConnection connection);
+
+void CommandEngine_getStats(CommandEngine self, CommandStats *stats);
+
+#endif /* UNI_COMMANDS_H_ */
@@ -0,0 +1,898 @@
+// =======================
+// NAČÍTÁNÍ KONFIGURACE – implementace
+// =======================
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#include "uni_config.h"
+#include "uni_timer.h"
+#include "uni_generator.h"
+#include "uni_commands.h"
+#include "lib_memory.h"
+
+#define SNAPSHOT_MAGIC "UNICFG01"
+#define SNAPSHOT_VERSION 5
+#define SNAPSHOT_SUFFIX ".snap"
+#define SNAPSHOT_PATH_MAX 300
+
+// =======================
+// TABULKA KLÍČŮ
+// =======================
+
+typedef enum {
+    KEY_STRING,
+    KEY_INT,
+    KEY_DURATION,      // "20", "0.5", "250ms" -> ms
+    KEY_SPONTANEOUS,   // "x;min;max"
+    KEY_LOGFORMAT,     // "TEXT" / "BIN"
+    KEY_LOAD,          // "rate;ASDU|IO[;iosPerAsdu]"
+    KEY_DEADBAND,      // "0.5" nebo "2%"
+    KEY_EVENTS,        // "POISSON;rate" / "BURST;rate;burstRate;burstMs;quietMs"
+    KEY_STATEEXPORT,   // "cesta;perioda"
+    KEY_REPLAY,        // "cesta;rychlost" (1, 10, 0.5, MAX)
+    KEY_STATIONS,      // "počet[;PORT|CA]"
+    KEY_SHAREDPOINTS,  // "cesta;perioda"
+    KEY_PLAYBACK,      // "cesta;rychlost" (1, 10, 100, MAX)
+    KEY_SCENARIO       // "cesta;rychlost" (1, 10, 0.5)
+} KeyKind;
+
+typedef struct {
+    const char *name;
+    KeyKind kind;
+    size_t offset;
+    size_t size;
+} ConfigKey;
+
+#define FIELD(field) offsetof(Config, field), sizeof(((Config *) 0)->field)
+
+static const ConfigKey configKeys[] = {
+    {"PROTOCOL", KEY_STRING, FIELD(protocol)},
+    {"ROLE", KEY_STRING, FIELD(role)},
+    {"IP", KEY_STRING, FIELD(ip)},
+    {"PORT", KEY_INT, FIELD(port)},
+    {"INTERFACE", KEY_STRING, FIELD(interface)},
+    {"BANDWIDTH", KEY_INT, FIELD(bandwidth)},
+    {"ORIGINATOR_ADDRESS", KEY_INT, FIELD(originatorAddress)},
+    {"COMMON_ADDRESS", KEY_INT, FIELD(commonAddress)},
+    {"DATALOGS", KEY_INT, FIELD(dataLogs)},
+    {"DATAPATH", KEY_STRING, FIELD(dataPath)},
+    {"DATALOGFORMAT", KEY_LOGFORMAT, FIELD(dataLogBinary)},
+    {"SERVICELOGS", KEY_INT, FIELD(serviceLogs)},
+    {"SERVICEPATH", KEY_STRING, FIELD(servicePath)},
+    {"PERIOD", KEY_DURATION, FIELD(periodMs)},
+    {"SPONTANEOUS", KEY_SPONTANEOUS, FIELD(spontaneousEnable)},
+    {"MULTI", KEY_INT, FIELD(multiplier)},
+    {"SYNC", KEY_INT, FIELD(sync)},
+    {"DISCONNECTAFTERSEND", KEY_INT, FIELD(disconnectAfterSend)},
+    {"LOGMAXSIZE", KEY_INT, FIELD(logMaxSizeMB)},
+    {"LOGROTATE", KEY_DURATION, FIELD(logRotateMs)},
+    {"CONFIGSNAPSHOT", KEY_INT, FIELD(configSnapshot)},
+    {"HOTRELOAD", KEY_INT, FIELD(hotReload)},
+    {"RELOADEVENTS", KEY_INT, FIELD(reloadEvents)},
+    {"LOAD", KEY_LOAD, FIELD(loadRate)},
+    {"LOADREPORT", KEY_DURATION, FIELD(loadReportMs)},
+    {"GENTICK", KEY_DURATION, FIELD(generatorTickMs)},
+    {"DEADBAND", KEY_DEADBAND, FIELD(deadband)},
+    {"EVENTS", KEY_EVENTS, FIELD(eventRate)},
+    {"QUIET", KEY_INT, FIELD(quiet)},
+    {"TRACESAMPLE", KEY_INT, FIELD(traceSample)},
+    {"STATSREPORT", KEY_DURATION, FIELD(statsReportMs)},
+    {"STATETABLE", KEY_INT, FIELD(stateTable)},
+    {"STATEEXPORT", KEY_STATEEXPORT, FIELD(stateExportPath)},
+    {"CAPTURE", KEY_STRING, FIELD(capturePath)},
+    {"REPLAY", KEY_REPLAY, FIELD(replayPath)},
+    {"CLIENTS", KEY_INT, FIELD(clients)},
+    {"CLIENTTARGETS", KEY_STRING, FIELD(clientTargets)},
+    {"GIPERIOD", KEY_DURATION, FIELD(giPeriodMs)},
+    {"SYNCPERIOD", KEY_DURATION, FIELD(syncPeriodMs)},
+    {"COMMANDPERIOD", KEY_DURATION, FIELD(commandPeriodMs)},
+    {"LATENCY", KEY_INT, FIELD(commandLatency)},
+    {"LATENCYREPORT", KEY_DURATION, FIELD(latencyReportMs)},
+    {"COMMANDTIMEOUT", KEY_DURATION, FIELD(commandTimeoutMs)},
+    {"STATIONS", KEY_STATIONS, FIELD(stations)},
+    {"STATIONPOINTS", KEY_STRING, FIELD(stationPointsPath)},
+    {"WORKERS", KEY_INT, FIELD(stationWorkers)},
+    {"SHAREDPOINTS", KEY_SHAREDPOINTS, FIELD(sharedPointsPath)},
+    {"PLAYBACK", KEY_PLAYBACK, FIELD(playbackPath)},
+    {"COMMANDDELAY", KEY_STRING, FIELD(commandDelay)},
+    {"SBOTIMEOUT", KEY_DURATION, FIELD(selectTimeoutMs)},
+    {"SCENARIO", KEY_SCENARIO, FIELD(scenarioPath)},
+};
+
+#define NUMBER_OF_KEYS ((int) (sizeof(configKeys) / sizeof(configKeys[0])))
+
+// Deadband "0.5" (absolutní) nebo "2%" (z poslední hlášené hodnoty)
+static bool
+parseDeadband(const char *text, float *deadband, bool *percent)
+{
+    char *end;
+    *deadband = strtof(text, &end);
+
+    if (end == text || *deadband < 0)
+        return false;
+
+    while (*end == ' ')
+        end++;
+
+    *percent = (*end == '%');
+    return true;
+}
+
+static void
+setKey(Config *cfg, const ConfigKey *key, const char *value)
+{
+    void *field = (uint8_t *) cfg + key->offset;
+
+    switch (key->kind) {
+        case KEY_STRING:
+            strncpy((char *) field, value, key->size - 1);
+            ((char *) field)[key->size - 1] = '\0';
+            break;
+        case KEY_INT:
+            *(int *) field = atoi(value);
+            break;
+        case KEY_DURATION:
+            *(int *) field = (int) TimerWheel_parseDuration(value);
+            break;
+        case KEY_SPONTANEOUS: {
+            // x;min;max – min/max v sekundách nebo s jednotkou (např. 1;200ms;1.5)
+            char minText[32] = "", maxText[32] = "";
+            sscanf(value, "%d;%31[^;];%31s", &cfg->spontaneousEnable, minText, maxText);
+            cfg->spontaneousMinMs = (int) TimerWheel_parseDuration(minText);
+            cfg->spontaneousMaxMs = (int) TimerWheel_parseDuration(maxText);
+            break;
+        }
+        case KEY_LOGFORMAT:
+            *(int *) field = (strncmp(value, "BIN", 3) == 0);
+            break;
+        case KEY_LOAD: {
+            // rate;ASDU|IO[;iosPerAsdu] – např. 5000;ASDU nebo 100000;IO;10
+            char unit[8] = "";
+            cfg->loadIosPerAsdu = 0;
+            sscanf(value, "%d;%7[^;];%d", &cfg->loadRate, unit, &cfg->loadIosPerAsdu);
+            cfg->loadPerIo = (strcmp(unit, "IO") == 0);
+            break;
+        }
+        case KEY_DEADBAND: {
+            bool percent;
+            if (parseDeadband(value, &cfg->deadband, &percent)) {
+                cfg->deadbandEnable = 1;
+                cfg->deadbandPercent = percent;
+            }
+            break;
+        }
+        case KEY_EVENTS: {
+            // POISSON;rate nebo BURST;rate;burstRate;délka laviny;doba klidu (např. BURST;10;50000;2s;30s)
+            char model[16] = "", burstText[32] = "", quietText[32] = "";
+            cfg->eventRate = 0;
+            cfg->eventBurstRate = 0;
+            sscanf(value, "%15[^;];%d;%d;%31[^;];%31s", model, &cfg->eventRate, &cfg->eventBurstRate, burstText, quietText);
+            if (strcmp(model, "BURST") == 0) {
+                cfg->eventBurstMs = (int) TimerWheel_parseDuration(burstText);
+                cfg->eventQuietMs = (int) TimerWheel_parseDuration(quietText);
+                if (cfg->eventBurstRate <= 0 || cfg->eventBurstMs <= 0 || cfg->eventQuietMs <= 0) {
+                    fprintf(stderr, "Neplatný model lavin: EVENTS=%s\n", value);
+                    cfg->eventBurstRate = 0;
+                }
+            } else {
+                cfg->eventBurstRate = 0;
+            }
+            break;
+        }
+        case KEY_STATEEXPORT: {
+            // cesta;perioda – např. state.csv;5s nebo state.bin;500ms (bez periody jen při ukončení)
+            char periodText[32] = "";
+            cfg->stateExportPath[0] = '\0';
+            sscanf(value, "%127[^;];%31s", cfg->stateExportPath, periodText);
+            cfg->stateExportMs = periodText[0] ? (int) TimerWheel_parseDuration(periodText) : 0;
+            if (cfg->stateExportMs < 0) {
+                fprintf(stderr, "Neplatná perioda snímku: STATEEXPORT=%s\n", value);
+                cfg->stateExportMs = 0;
+            }
+            break;
+        }
+        case KEY_REPLAY: {
+            // cesta;rychlost – např. incident.pcap;1, incident.pcap;20 nebo incident.pcap;MAX (výchozí 1)
+            char speedText[16] = "1";
+            cfg->replayPath[0] = '\0';
+            sscanf(value, "%127[^;];%15s", cfg->replayPath, speedText);
+            cfg->replaySpeed = (strcmp(speedText, "MAX") == 0) ? 0 : strtof(speedText, NULL);
+            if (cfg->replaySpeed < 0 || (cfg->replaySpeed == 0 && strcmp(speedText, "MAX") != 0)) {
+                fprintf(stderr, "Neplatná rychlost přehrávání: REPLAY=%s\n", value);
+                cfg->replaySpeed = 1;
+            }
+            break;
+        }
+        case KEY_SHAREDPOINTS: {
+            // cesta;perioda – např. /dev/shm/uni_points;10ms (bez periody výchozí)
+            char periodText[32] = "";
+            cfg->sharedPointsPath[0] = '\0';
+            sscanf(value, "%127[^;];%31s", cfg->sharedPointsPath, periodText);
+            cfg->sharedScanMs = periodText[0] ? (int) TimerWheel_parseDuration(periodText) : 0;
+            if (cfg->sharedScanMs < 0) {
+                fprintf(stderr, "Neplatná perioda sdílených bodů: SHAREDPOINTS=%s\n", value);
+                cfg->sharedScanMs = 0;
+            }
+            break;
+        }
+        case KEY_PLAYBACK: {
+            // cesta;rychlost – např. mereni.csv;1, mereni.bin;50 nebo mereni.bin;MAX (výchozí 1)
+            char speedText[16] = "1";
+            cfg->playbackPath[0] = '\0';
+            sscanf(value, "%127[^;];%15s", cfg->playbackPath, speedText);
+            cfg->playbackSpeed = (strcmp(speedText, "MAX") == 0) ? 0 : strtof(speedText, NULL);
+            if (cfg->playbackSpeed < 0 || (cfg->playbackSpeed == 0 && strcmp(speedText, "MAX") != 0)) {
+                fprintf(stderr, "Neplatná rychlost přehrávání: PLAYBACK=%s\n", value);
+                cfg->playbackSpeed = 1;
+            }
+            break;
+        }
+        case KEY_SCENARIO: {
+            // cesta;rychlost – např. vypadek.txt nebo vypadek.txt;10 (výchozí 1)
+            char speedText[16] = "1";
+            cfg->scenarioPath[0] = '\0';
+            sscanf(value, "%127[^;];%15s", cfg->scenarioPath, speedText);
+            cfg->scenarioSpeed = strtof(speedText, NULL);
+            if (cfg->scenarioSpeed <= 0) {
+                fprintf(stderr, "Neplatná rychlost scénáře: SCENARIO=%s\n", value);
+                cfg->scenarioSpeed = 1;
+            }
+            break;
+        }
+        case KEY_STATIONS: {
+            // počet;adresování – např. 200;PORT (porty PORT..PORT+199) nebo 50;CA (jeden port, CA..CA+49)
+            char mode[8] = "PORT";
+            cfg->stations = 0;
+            sscanf(value, "%d;%7s", &cfg->stations, mode);
+            cfg->stationsByCa = (strcmp(mode, "CA") == 0);
+            if (cfg->stations < 0 || (!cfg->stationsByCa && strcmp(mode, "PORT") != 0)) {
+                fprintf(stderr, "Neplatné stanice: STATIONS=%s\n", value);
+                cfg->stations = 0;
+            }
+            break;
+        }
+    }
+}
+
+// =======================
+// PARSER TEXTOVÉHO SOUBORU
+// =======================
+
+static char *
+trim(char *text)
+{
+    while (*text == ' ' || *text == '\t')
+        text++;
+
+    char *end = text + strlen(text);
+
+    while (end > text && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r'))
+        *--end = '\0';
+
+    return text;
+}
+
+// Volba bodu za hodnotami (...;KLÍČ=HODNOTA)
+static void
+parsePointOption(PointTable points, int index, const char *option, const char *line)
+{
+    if (strncmp(option, "PERIOD=", 7) == 0) {
+        int64_t periodMs = TimerWheel_parseDuration(option + 7);
+        if (periodMs > 0)
+            PointTable_setPeriod(points, index, (uint32_t) periodMs);
+        else
+            fprintf(stderr, "Neplatná perioda bodu: %s\n", line);
+    }
+    else if (strncmp(option, "DB=", 3) == 0) {
+        float deadband;
+        bool percent;
+        if (parseDeadband(option + 3, &deadband, &percent))
+            PointTable_setDeadband(points, index, deadband, percent);
+        else
+            fprintf(stderr, "Neplatný deadband bodu: %s\n", line);
+    }
+    else if (strncmp(option, "GROUP=", 6) == 0) {
+        // Seznam skupin 1–16 oddělený čárkou (GROUP=1,3)
+        uint16_t groups = 0;
+        const char *p = option + 6;
+        char *end;
+        for (;;) {
+            long group = strtol(p, &end, 10);
+            if (end == p || group < 1 || group > 16) {
+                groups = 0;
+                break;
+            }
+            groups |= (uint16_t) (1u << (group - 1));
+            if (*end != ',')
+                break;
+            p = end + 1;
+        }
+        if (groups)
+            PointTable_setGroups(points, index, groups);
+        else
+            fprintf(stderr, "Neplatná skupina bodu (1–16): %s\n", line);
+    }
+    else if (strncmp(option, "GEN=", 4) == 0) {
+        PointGenerator generator;
+        if (points->flags[index] & POINT_FLAG_TOGGLE)
+            fprintf(stderr, "Generátor nelze použít u dual bodu: %s\n", line);
+        else if (!Generator_parse(option + 4, &generator) || !PointTable_setGenerator(points, index, &generator))
+            fprintf(stderr, "Neplatný generátor bodu: %s\n", line);
+    }
+    else if (strncmp(option, "CMD=", 4) == 0 || strncmp(option, "DELAY=", 6) == 0) {
+        // CMD= a DELAY= se skládají do jedné vazby bodu na command
+        PointCommand command;
+        const PointCommand *current = PointTable_getCommand(points, index);
+        memset(&command, 0, sizeof(command));
+        command.ioa = -1;
+        if (current)
+            command = *current;
+        bool valid;
+        if (option[0] == 'C')
+            valid = CommandLink_parse(option + 4, &command);
+        else
+            valid = (command.hasDelay = CommandDelay_parse(option + 6, &command.delay));
+        if (!valid || !PointTable_setCommand(points, index, &command))
+            fprintf(stderr, "Neplatná vazba bodu na command: %s\n", line);
+    }
+}
+
+// Rozebere začátek řádku bodu TYPE;IOA;VALUE[;VALUE2], rest ukazuje za hodnoty (na volby)
+static bool
+scanPoint(char *line, long *type, long *ioa, float *value1, float *value2, bool *dual, char **rest)
+{
+    char *end;
+    *type = strtol(line, &end, 10);
+    if (end == line || *end != ';') return false;
+
+    char *p = end + 1;
+    *ioa = strtol(p, &end, 10);
+    if (end == p || *end != ';') return false;
+
+    p = end + 1;
+    *value1 = strtof(p, &end);
+    if (end == p) return false;
+    p = end;
+
+    *value2 = *value1;
+    *dual = false;
+
+    // Dual bod: druhá hodnota hned za první
+    if (*p == ';') {
+        float v = strtof(p + 1, &end);
+        if (end != p + 1) {
+            *value2 = v;
+            *dual = true;
+            p = end;
+        }
+    }
+
+    *rest = p;
+    return true;
+}
+
+// Řádek bodu: TYPE;IOA;VALUE[;VALUE2][;KLÍČ=HODNOTA…], vrací false při plné tabulce
+static bool
+parsePointLine(char *line, PointTable points, bool permanent)
+{
+    long type, ioa;
+    float value1, value2;
+    bool dual;
+    char *p;
+
+    if (!scanPoint(line, &type, &ioa, &value1, &value2, &dual, &p))
+        return true;
+
+    uint8_t flags = permanent ? POINT_FLAG_PERMANENT : 0;
+    if (dual)
+        flags |= POINT_FLAG_TOGGLE;
+
+    int index = PointTable_add(points, (int) type, (int) ioa, value1, value2, flags);
+
+    if (index < 0) {
+        fprintf(stderr, "Tabulka bodů je plná, zbytek konfigurace se ignoruje\n");
+        return false;
+    }
+
+    for (char *option = strchr(p, ';'); option != NULL; option = strchr(option + 1, ';'))
+        parsePointOption(points, index, trim(option + 1), line);
+
+    return true;
+}
+
+// Jeden průchod textem: klíče do cfg, body do points (text se při parsování mění)
+static void
+parseText(char *text, Config *cfg, PointTable points)
+{
+    uint64_t seen = 0;   // U duplicitních klíčů platí první výskyt
+    bool permanent = false;
+    bool pointsFull = false;
+
+    char *line = text;
+
+    while (line != NULL && *line != '\0') {
+        char *next = strchr(line, '\n');
+        if (next)
+            *next++ = '\0';
+
+        char *content = trim(line);
+        line = next;
+
+        if (*content == '\0')
+            continue;
+
+        // Body začínají číslem, klíče písmenem
+        if (isdigit((unsigned char) content[0]) || content[0] == '-') {
+            if (points && !pointsFull)
+                pointsFull = !parsePointLine(content, points, permanent);
+            continue;
+        }
+
+        char *equal = strchr(content, '=');
+        if (equal == NULL)
+            continue;
+
+        *equal = '\0';
+        char *key = trim(content);
+        char *value = trim(equal + 1);
+
+        if (strcmp(key, "PERM_MESS") == 0) { permanent = true; continue; }
+        if (strcmp(key, "TEMP_MESS") == 0) { permanent = false; continue; }
+
+        for (int k = 0; k < NUMBER_OF_KEYS; k++) {
+            if ((seen & (1ULL << k)) == 0 && strcmp(key, configKeys[k].name) == 0) {
+                setKey(cfg, &configKeys[k], value);
+                seen |= 1ULL << k;
+                break;
+            }
+        }
+    }
+}
+
+// =======================
+// BINÁRNÍ SNÍMEK
+// =======================
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t configSize;      // sizeof(Config) – jiná verze programu = neplatný snímek
+    int64_t mtimeNs;
+    int64_t size;
+    uint64_t hash;            // FNV-1a textového souboru
+    uint32_t count;
+    uint32_t generatorCount;
+    uint32_t commandCount;
+    uint32_t reserved;
+} SnapshotHeader;
+
+static uint64_t
+hashText(const char *data, size_t size)
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (size_t i = 0; i < size; i++) {
+        hash ^= (uint8_t) data[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+static bool
+getStamp(const char *path, ConfigStamp *stamp)
+{
+    struct stat st;
+
+    if (stat(path, &st) != 0)
+        return false;
+
+    stamp->mtimeNs = (int64_t) st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+    stamp->size = (int64_t) st.st_size;
+    return true;
+}
+
+// Načte textový soubor celý do paměti (zakončený nulou)
+static char *
+readText(const char *path, size_t *size)
+{
+    FILE *file = fopen(path, "rb");
+
+    if (file == NULL)
+        return NULL;
+
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *text = (length >= 0) ? (char *) GLOBAL_MALLOC((size_t) length + 1) : NULL;
+
+    if (text) {
+        *size = fread(text, 1, (size_t) length, file);
+        text[*size] = '\0';
+    }
+
+    fclose(file);
+    return text;
+}
+
+// Pole bodů ve snímku za hlavičkou a Config (zarovnání na 4 B u 32bitových polí)
+typedef struct {
+    const int32_t *ioa;
+    const float *valueA;
+    const float *valueB;
+    const uint32_t *periodMs;
+    const float *deadband;
+    const uint16_t *groups;
+    const uint8_t *type;
+    const uint8_t *flags;
+    const PointGenerator *generators;
+    const PointCommand *commands;
+} SnapshotArrays;
+
+static size_t
+snapshotArrays(const uint8_t *base, uint32_t count, uint32_t generatorCount, uint32_t commandCount,
+               SnapshotArrays *arrays)
+{
+    size_t offset = sizeof(SnapshotHeader) + ((sizeof(Config) + 7) & ~(size_t) 7);
+
+    arrays->ioa = (const int32_t *) (base + offset);
+    offset += count * sizeof(int32_t);
+    arrays->valueA = (const float *) (base + offset);
+    offset += count * sizeof(float);
+    arrays->valueB = (const float *) (base + offset);
+    offset += count * sizeof(float);
+    arrays->periodMs = (const uint32_t *) (base + offset);
+    offset += count * sizeof(uint32_t);
+    arrays->deadband = (const float *) (base + offset);
+    offset += count * sizeof(float);
+    arrays->groups = (const uint16_t *) (base + offset);
+    offset += count * sizeof(uint16_t);
+    arrays->type = base + offset;
+    offset += count;
+    arrays->flags = base + offset;
+    offset += count;
+    offset = (offset + 3) & ~(size_t) 3;
+    arrays->generators = (const PointGenerator *) (base + offset);
+    offset += generatorCount * sizeof(PointGenerator);
+    arrays->commands = (const PointCommand *) (base + offset);
+    offset += commandCount * sizeof(PointCommand);
+
+    return offset;
+}
+
+static bool
+loadSnapshot(const char *snapshotPath, const ConfigStamp *stamp, uint64_t hash, Config *cfg, PointTable points)
+{
+    int fd = open(snapshotPath, O_RDONLY);
+
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    bool ok = false;
+
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t) sizeof(SnapshotHeader)) {
+        const uint8_t *base = (const uint8_t *) mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (base != MAP_FAILED) {
+            const SnapshotHeader *header = (const SnapshotHeader *) base;
+            SnapshotArrays arrays;
+
+            if (memcmp(header->magic, SNAPSHOT_MAGIC, 8) == 0 && header->version == SNAPSHOT_VERSION &&
+                header->configSize == sizeof(Config) && header->mtimeNs == stamp->mtimeNs &&
+                header->size == stamp->size && header->hash == hash &&
+                snapshotArrays(base, header->count, header->generatorCount, header->commandCount, &arrays) <=
+                    (size_t) st.st_size) {
+
+                memcpy(cfg, base + sizeof(SnapshotHeader), sizeof(Config));
+
+                if (points) {
+                    PointTable_clear(points);
+                    PointTable_reserve(points, (int) header->count);
+
+                    for (uint32_t i = 0; i < header->count; i++) {
+                        int index = PointTable_add(points, arrays.type[i], arrays.ioa[i], arrays.valueA[i],
+                                                   arrays.valueB[i], arrays.flags[i]);
+                        if (index < 0)
+                            break;
+                        PointTable_setPeriod(points, index, arrays.periodMs[i]);
+                        if (arrays.flags[i] & POINT_FLAG_DEADBAND)
+                            PointTable_setDeadband(points, index, arrays.deadband[i],
+                                                   arrays.flags[i] & POINT_FLAG_DEADBAND_PERCENT);
+                        PointTable_setGroups(points, index, arrays.groups[i]);
+                    }
+
+                    for (uint32_t g = 0; g < header->generatorCount; g++)
+                        PointTable_setGenerator(points, arrays.generators[g].point, &arrays.generators[g]);
+
+                    for (uint32_t c = 0; c < header->commandCount; c++)
+                        PointTable_setCommand(points, arrays.commands[c].point, &arrays.commands[c]);
+                }
+
+                ok = true;
+            }
+
+            munmap((void *) base, (size_t) st.st_size);
+        }
+    }
+
+    close(fd);
+    return ok;
+}
+
+static void
+saveSnapshot(const char *snapshotPath, const ConfigStamp *stamp, uint64_t hash, const Config *cfg, PointTable points)
+{
+    uint32_t count = (uint32_t) points->count;
+    uint32_t generatorCount = (uint32_t) points->generatorCount;
+    uint32_t commandCount = (uint32_t) points->commandCount;
+    SnapshotArrays arrays;
+    size_t size = snapshotArrays(NULL, count, generatorCount, commandCount, &arrays);
+
+    uint8_t *data = (uint8_t *) GLOBAL_CALLOC(1, size);
+
+    if (data == NULL)
+        return;
+
+    SnapshotHeader *header = (SnapshotHeader *) data;
+    memcpy(header->magic, SNAPSHOT_MAGIC, 8);
+    header->version = SNAPSHOT_VERSION;
+    header->configSize = sizeof(Config);
+    header->mtimeNs = stamp->mtimeNs;
+    header->size = stamp->size;
+    header->hash = hash;
+    header->count = count;
+    header->generatorCount = generatorCount;
+    header->commandCount = commandCount;
+
+    memcpy(data + sizeof(SnapshotHeader), cfg, sizeof(Config));
+
+    snapshotArrays(data, count, generatorCount, commandCount, &arrays);
+    memcpy((void *) arrays.ioa, points->ioa, count * sizeof(int32_t));
+    memcpy((void *) arrays.valueA, points->valueA, count * sizeof(float));
+    memcpy((void *) arrays.valueB, points->valueB, count * sizeof(float));
+    memcpy((void *) arrays.periodMs, points->periodMs, count * sizeof(uint32_t));
+    memcpy((void *) arrays.deadband, points->deadband, count * sizeof(float));
+    memcpy((void *) arrays.groups, points->groups, count * sizeof(uint16_t));
+    memcpy((void *) arrays.type, points->type, count);
+    memcpy((void *) arrays.flags, points->flags, count);
+    memcpy((void *) arrays.generators, points->generators, generatorCount * sizeof(PointGenerator));
+    memcpy((void *) arrays.commands, points->commands, commandCount * sizeof(PointCommand));
+
+    // Zápis přes dočasný soubor – souběžně startující instance nikdy neuvidí půlku snímku
+    char tempPath[SNAPSHOT_PATH_MAX + sizeof(".tmp")];
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", snapshotPath);
+
+    FILE *file = fopen(tempPath, "wb");
+
+    if (file) {
+        bool written = (fwrite(data, 1, size, file) == size);
+        fclose(file);
+
+        if (written)
+            rename(tempPath, snapshotPath);
+        else
+            remove(tempPath);
+    }
+
+    GLOBAL_FREEMEM(data);
+}
+
+bool
+ConfigFile_load(const char *path, Config *cfg, PointTable points)
+{
+    memset(cfg, 0, sizeof(Config));
+
+    ConfigStamp stamp;
+    size_t size = 0;
+    char *text;
+
+    if (!getStamp(path, &stamp) || (text = readText(path, &size)) == NULL) {
+        perror("Failed to open configuration file");
+        if (points)
+            PointTable_clear(points);
+        return false;
+    }
+
+    uint64_t hash = hashText(text, size);
+
+    // Příliš dlouhá cesta by se zkrátila na jiný soubor – snímek se pak nepoužije
+    char snapshotPath[SNAPSHOT_PATH_MAX];
+    int pathLength = snprintf(snapshotPath, sizeof(snapshotPath), "%s%s", path, SNAPSHOT_SUFFIX);
+    bool snapshotUsable = pathLength > 0 && pathLength < (int) sizeof(snapshotPath);
+
+    if (snapshotUsable && loadSnapshot(snapshotPath, &stamp, hash, cfg, points)) {
+        GLOBAL_FREEMEM(text);
+        return true;
+    }
+
+    if (points)
+        PointTable_clear(points);
+
+    parseText(text, cfg, points);
+    GLOBAL_FREEMEM(text);
+
+    if (cfg->configSnapshot && snapshotUsable && points)
+        saveSnapshot(snapshotPath, &stamp, hash, cfg, points);
+
+    return true;
+}
+
+bool
+ConfigFile_hasChanged(const char *path, ConfigStamp *stamp)
+{
+    ConfigStamp current;
+
+    if (!getStamp(path, &current))
+        return false;
+
+    if (current.mtimeNs == stamp->mtimeNs && current.size == stamp->size)
+        return false;
+
+    *stamp = current;
+    return true;
+}
+
+bool
+ConfigFile_filterPoints(const char *path, ConfigPointFilter filter, void *parameter)
+{
+    size_t size = 0;
+    char *text = readText(path, &size);
+
+    if (text == NULL)
+        return false;
+
+    char tempPath[300];
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", path);
+
+    FILE *file = fopen(tempPath, "wb");
+
+    if (file == NULL) {
+        GLOBAL_FREEMEM(text);
+        return false;
+    }
+
+    bool permanent = false;
+    char scratch[512];
+    char *line = text;
+
+    // Řádky se zapisují beze změny, jen odmítnuté body se vynechají
+    while (*line != '\0') {
+        char *next = strchr(line, '\n');
+        size_t length = next ? (size_t) (next - line + 1) : strlen(line);
+
+        snprintf(scratch, sizeof(scratch), "%.*s", (int) length, line);
+        scratch[strcspn(scratch, "\r\n")] = '\0';
+        char *content = trim(scratch);
+
+        bool keep = true;
+
+        if (isdigit((unsigned char) content[0]) || content[0] == '-') {
+            long type, ioa;
+            float value1, value2;
+            bool dual;
+            char *rest;
+
+            if (scanPoint(content, &type, &ioa, &value1, &value2, &dual, &rest))
+                keep = filter(parameter, (int) type, (int) ioa, value1, value2, permanent);
+        }
+        else if (strncmp(content, "PERM_MESS", 9) == 0) {
+            permanent = true;
+        }
+        else if (strncmp(content, "TEMP_MESS", 9) == 0) {
+            permanent = false;
+        }
+
+        if (keep)
+            fwrite(line, 1, length, file);
+
+        line += length;
+    }
+
+    GLOBAL_FREEMEM(text);
+
+    bool written = (fflush(file) == 0);
+    fclose(file);
+
+    if (!written || rename(tempPath, path) != 0) {
+        remove(tempPath);
+        return false;
+    }
+
+    return true;
+}
+
+// =======================
+// SLEDOVÁNÍ ZMĚN SOUBORU
+// =======================
+
+struct sConfigWatcher {
+    char path[256];
+    const char *fileName;     // Jméno souboru bez adresáře (porovnává se s událostmi inotify)
+    int fd;                   // inotify deskriptor, -1 = jen porovnání otisku
+    ConfigStamp stamp;
+};
+
+ConfigWatcher
+ConfigWatcher_create(const char *path)
+{
+    ConfigWatcher self = (ConfigWatcher) GLOBAL_CALLOC(1, sizeof(struct sConfigWatcher));
+
+    if (self == NULL)
+        return NULL;
+
+    snprintf(self->path, sizeof(self->path), "%s", path);
+    ConfigFile_hasChanged(self->path, &self->stamp);
+
+    const char *slash = strrchr(self->path, '/');
+    self->fileName = slash ? slash + 1 : self->path;
+    self->fd = -1;
+
+#ifdef __linux__
+    // Sleduje se adresář – editory ukládají přes přejmenování dočasného souboru
+    char directory[256] = ".";
+    if (slash)
+        snprintf(directory, sizeof(directory), "%.*s", (int) (slash - self->path), self->path);
+
+    self->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if ((self->fd >= 0) && (inotify_add_watch(self->fd, directory, IN_CLOSE_WRITE | IN_MOVED_TO) < 0)) {
+        close(self->fd);
+        self->fd = -1;
+    }
+#endif
+
+    return self;
+}
+
+bool
+ConfigWatcher_poll(ConfigWatcher self)
+{
+#ifdef __linux__
+    if (self->fd >= 0) {
+        char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+        bool touched = false;
+        ssize_t length;
+
+        while ((length = read(self->fd, buffer, sizeof(buffer))) > 0) {
+            for (char *ptr = buffer; ptr < buffer + length;) {
+                struct inotify_event *event = (struct inotify_event *) ptr;
+
+                if ((event->len > 0) && (strcmp(event->name, self->fileName) == 0))
+                    touched = true;
+
+                ptr += sizeof(struct inotify_event) + event->len;
+            }
+        }
+
+        if (!touched)
+            return false;
+    }
+#endif
+
+    return ConfigFile_hasChanged(self->path, &self->stamp);
+}
+
+void
+ConfigWatcher_destroy(ConfigWatcher self)
+{
+    if (self == NULL)
+        return;
+
+    if (self->fd >= 0)
+        close(self->fd);
+
+    GLOBAL_FREEMEM(self);
+}
@@ -0,0 +1,116 @@
+// =======================
+// NAČÍTÁNÍ KONFIGURACE (iec_config.txt)
+// =======================
+//
+// Soubor se čte jednou celý do paměti a jedním průchodem se z něj naplní
+// struktura Config i tabulka bodů. Volitelně (CONFIGSNAPSHOT=1) se výsledek
+// uloží do binárního snímku <soubor>.snap; při dalším startu se snímek jen
+// namapuje, pokud sedí mtime, velikost a hash textového souboru.
+
+#ifndef UNI_CONFIG_H_
+#define UNI_CONFIG_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "uni_points.h"
+
+// Hlavní konfigurační struktura pro celý simulátor
+typedef struct {
+    char protocol[4];         // "104" nebo "101"
+    char role[8];             // "SERVER"/"CLIENT"
+    char ip[64];              // IP adresa (104)
+    int port;                 // TCP port (104)
+    char interface[64];       // Název rozhraní (101)
+    int bandwidth;            // Rychlost (101)
+    int originatorAddress;    // OA (většinou server)
+    int commonAddress;        // CA (adresa stanice)
+    int dataLogs;             // 1=datové logy zapnuty
+    char dataPath[128];       // Cesta k datovým logům
+    int dataLogBinary;        // 1=datový log v binárním formátu (DATALOGFORMAT=BIN)
+    int serviceLogs;          // 1=servisní logy zapnuty
+    char servicePath[128];    // Cesta k servisním logům
+    int periodMs;             // Perioda odesílání zpráv v ms
+    int spontaneousEnable;    // 1=spontánní zapnuty (jen server)
+    int spontaneousMinMs;     // Min. interval spontánních zpráv v ms
+    int spontaneousMaxMs;     // Max. interval spontánních zpráv v ms
+    int multiplier;           // Kolikrát poslat každou zprávu
+    int sync;                 // 1=klient posílá SYNC zprávy
+    int disconnectAfterSend;  // 1=klient se odpojí po odeslání
+    int logMaxSizeMB;         // Rotace logu po dosažení velikosti v MB (0 = bez limitu)
+    int logRotateMs;          // Rotace logu po uplynutí doby v ms (0 = bez limitu)
+    int configSnapshot;       // 1=ukládat binární snímek konfigurace (<soubor>.snap)
+    int hotReload;            // 1=server sleduje soubor a změny bodů aplikuje za běhu
+    int reloadEvents;         // 1=změněné body po reloadu poslat jako spontánní zprávy
+    int loadRate;             // Zátěžový režim: cílová rychlost (0 = vypnuto)
+    int loadPerIo;            // 1=rychlost v IO/s, 0=v ASDU/s
+    int loadIosPerAsdu;       // Max. IO v jednom ASDU (0 = co se vejde)
+    int loadReportMs;         // Interval výpisu statistiky zátěže v ms
+    int generatorTickMs;      // Jak často se přepočítávají generátory hodnot (GEN=) v ms
+    int deadbandEnable;       // 1=klíč DEADBAND zadán – spontánní zprávy jen ze změněných bodů
+    float deadband;           // Výchozí deadband bodů bez volby DB=
+    int deadbandPercent;      // 1=výchozí deadband v procentech poslední hlášené hodnoty
+    int eventRate;            // Poissonovy události: střední rychlost za s (0 = vypnuto)
+    int eventBurstRate;       // Rychlost během laviny (0 = bez lavin)
+    int eventBurstMs;         // Střední délka laviny v ms
+    int eventQuietMs;         // Střední doba klidu mezi lavinami v ms
+    int quiet;                // 1=tichý režim: místo výpisu IO jen statistika provozu
+    int traceSample;          // V tichém režimu vypsat celé každé N-té ASDU (0 = žádné)
+    int statsReportMs;        // Interval výpisu statistiky v ms
+    int stateTable;           // 1=klient ukládá přijaté hodnoty do stavové tabulky bodů
+    char stateExportPath[128]; // Soubor snímku stavové tabulky (.bin = binární, jinak CSV)
+    int stateExportMs;        // Perioda ukládání snímku v ms (0 = jen při ukončení)
+    char capturePath[128];    // Záznam surových rámců do pcap (prázdné = vypnuto)
+    char replayPath[128];     // Přehrání záznamu pcap místo vlastního provozu (prázdné = vypnuto)
+    float replaySpeed;        // Rychlost přehrávání (1 = původní tempo, 0 = co nejrychleji)
+    int clients;              // Klient 104: počet spojení v jednom procesu (0/1 = jedno spojení)
+    char clientTargets[512];  // Cíle spojení "ip:port/ca,..." (prázdné = IP, PORT, COMMON_ADDRESS)
+    int giPeriodMs;           // Perioda GI každého spojení v ms (0 = PERIOD)
+    int syncPeriodMs;         // Perioda synchronizace času každého spojení v ms (0 = PERIOD, jen se SYNC=1)
+    int commandPeriodMs;      // Perioda commandů každého spojení v ms (0 = PERIOD)
+    int commandLatency;       // 1=klient měří latenci commandů do ACT_CON/ACT_TERM
+    int latencyReportMs;      // Interval výpisu latence commandů v ms
+    int commandTimeoutMs;     // Command bez ACT_CON po této době je timeout (ms)
+    int stations;             // Server 104: počet virtuálních stanic v jednom procesu (0/1 = jedna stanice)
+    int stationsByCa;         // 1=stanice na jednom portu s CA+i, 0=stanice na portech PORT+i
+    char stationPointsPath[128]; // Soubor bodů stanice s %d = číslo stanice (chybí = iec_config.txt)
+    int stationWorkers;       // Počet vláken pro stanice (0 = podle počtu CPU)
+    char sharedPointsPath[128]; // Server: soubor sdílených bodů pro externí zdroj hodnot (prázdné = vypnuto)
+    int sharedScanMs;         // Perioda převzetí změn ze sdílených bodů v ms
+    char playbackPath[128];   // Server: záznam hodnot (CSV nebo .bin) přehrávaný do tabulky bodů (prázdné = vypnuto)
+    float playbackSpeed;      // Zrychlení přehrávání záznamu hodnot (1 = původní tempo, 0 = co nejrychleji)
+    char commandDelay[64];    // Server: doba vykonání commandů (viz uni_commands.h, prázdné = jen s CMD= u bodů)
+    int selectTimeoutMs;      // Server: platnost výběru SBO v ms (0 = výchozí)
+    char scenarioPath[128];   // Server: soubor scénáře (viz uni_scenario.h, prázdné = vypnuto)
+    float scenarioSpeed;      // Zrychlení scénáře (1 = reálný čas)
+} Config;
+
+// Otisk souboru pro rychlé zjištění změny (bez čtení obsahu)
+typedef struct {
+    int64_t mtimeNs;
+    int64_t size;
+} ConfigStamp;
+
+// Načte konfiguraci i body (points může být NULL = jen Config), vrací false pokud soubor nejde přečíst
+bool ConfigFile_load(const char *path, Config *cfg, PointTable points);
+
+// Vrací true, pokud se soubor od posledního volání změnil (a otisk aktualizuje)
+bool ConfigFile_hasChanged(const char *path, ConfigStamp *stamp);
+
+// Filtr pro ConfigFile_filterPoints – vrací false, pokud se má řádek bodu ze souboru vynechat
+typedef bool (*ConfigPointFilter)(void *parameter, int type, int ioa, float valueA, float valueB, bool permanent);
+
+// Přepíše soubor (dočasný soubor + rename) bez bodů odmítnutých filtrem, ostatní řádky zůstanou beze změny
+bool ConfigFile_filterPoints(const char *path, ConfigPointFilter filter, void *parameter);
+
+// Sledování souboru přes inotify (jinde jen porovnání otisku), volá se z hlavní smyčky
+typedef struct sConfigWatcher* ConfigWatcher;
+
+ConfigWatcher ConfigWatcher_create(const char *path);
+
+// Neblokující – vrací true, pokud byl soubor od posledního volání zapsán a jeho otisk se změnil
+bool ConfigWatcher_poll(ConfigWatcher self);
+
+void ConfigWatcher_destroy(ConfigWatcher self);
+
+#endif /* UNI_CONFIG_H_ */
@@ -0,0 +1,131 @@
+// =======================
+// DETEKCE ZMĚN S DEADBANDEM – implementace
+// =======================
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "uni_deadband.h"
+#include "lib_memory.h"
+
+// Typy s ID od 45 jsou příkazy – ty se spontánně nehlásí
+#define FIRST_COMMAND_TYPE 45
+
+struct sChangeDetector {
+    int count;
+    float *reported;          // Poslední hlášená hodnota
+    float *absolute;          // Absolutní práh (INFINITY = bod se nehlásí)
+    float *relative;          // Podíl z |hlášené hodnoty| (2 % → 0.02)
+    uint8_t *changed;         // Výsledek porovnání (1 = změna)
+    int32_t *changes;         // Indexy změněných bodů v pořadí PointTable_getOrder
+};
+
+// Jádro: |value - reported| > absolute + relative * |reported|
+static void
+compareValues(int n, const float *restrict value, const float *restrict reported, const float *restrict absolute,
+              const float *restrict relative, uint8_t *restrict changed)
+{
+    for (int i = 0; i < n; i++) {
+        float threshold = absolute[i] + relative[i] * fabsf(reported[i]);
+        changed[i] = fabsf(value[i] - reported[i]) > threshold;
+    }
+}
+
+// Měřené hodnoty (9–14, 34–36) – jen u nich platí výchozí deadband, ostatní se hlásí při každé změně
+static bool
+isAnalogType(int type)
+{
+    return (type >= 9 && type <= 14) || (type >= 34 && type <= 36);
+}
+
+ChangeDetector
+ChangeDetector_create(PointTable points, float defaultDeadband, bool defaultPercent)
+{
+    ChangeDetector self = (ChangeDetector) GLOBAL_CALLOC(1, sizeof(struct sChangeDetector));
+
+    if (self == NULL)
+        return NULL;
+
+    size_t size = (size_t) (points->count > 0 ? points->count : 1);
+
+    self->reported = (float *) GLOBAL_MALLOC(size * sizeof(float));
+    self->absolute = (float *) GLOBAL_MALLOC(size * sizeof(float));
+    self->relative = (float *) GLOBAL_MALLOC(size * sizeof(float));
+    self->changed = (uint8_t *) GLOBAL_MALLOC(size);
+    self->changes = (int32_t *) GLOBAL_MALLOC(size * sizeof(int32_t));
+
+    if (!self->reported || !self->absolute || !self->relative || !self->changed || !self->changes) {
+        ChangeDetector_destroy(self);
+        return NULL;
+    }
+
+    self->count = points->count;
+
+    for (int i = 0; i < points->count; i++) {
+        uint8_t flags = points->flags[i];
+        float deadband = (flags & POINT_FLAG_DEADBAND) ? points->deadband[i] :
+                         isAnalogType(points->type[i]) ? defaultDeadband : 0.0f;
+        bool percent = (flags & POINT_FLAG_DEADBAND) ? (flags & POINT_FLAG_DEADBAND_PERCENT) != 0 : defaultPercent;
+
+        self->reported[i] = points->value[i];
+        self->absolute[i] = percent ? 0.0f : deadband;
+        self->relative[i] = percent ? deadband / 100.0f : 0.0f;
+
+        if (points->type[i] >= FIRST_COMMAND_TYPE)
+            self->absolute[i] = INFINITY;
+    }
+
+    return self;
+}
+
+void
+ChangeDetector_destroy(ChangeDetector self)
+{
+    if (self == NULL)
+        return;
+
+    GLOBAL_FREEMEM(self->reported);
+    GLOBAL_FREEMEM(self->absolute);
+    GLOBAL_FREEMEM(self->relative);
+    GLOBAL_FREEMEM(self->changed);
+    GLOBAL_FREEMEM(self->changes);
+    GLOBAL_FREEMEM(self);
+}
+
+int
+ChangeDetector_scan(ChangeDetector self, PointTable points, const int32_t **changes)
+{
+    *changes = self->changes;
+
+    const int32_t *order = PointTable_getOrder(points);
+
+    if (order == NULL || points->count != self->count)
+        return 0;
+
+    compareValues(self->count, points->value, self->reported, self->absolute, self->relative, self->changed);
+
+    // Bez změny stačí porovnání – pořadí se neprochází
+    if (memchr(self->changed, 1, (size_t) self->count) == NULL)
+        return 0;
+
+    // Změny se sbírají v pořadí (typ, IOA), aby šly rovnou balit po typech
+    int numChanges = 0;
+
+    for (int k = 0; k < self->count; k++) {
+        int p = order[k];
+        if (self->changed[p]) {
+            self->changes[numChanges++] = p;
+            self->reported[p] = points->value[p];
+        }
+    }
+
+    return numChanges;
+}
+
+void
+ChangeDetector_setReported(ChangeDetector self, PointTable points, int index)
+{
+    if (index >= 0 && index < self->count && index < points->count)
+        self->reported[index] = points->value[index];
+}
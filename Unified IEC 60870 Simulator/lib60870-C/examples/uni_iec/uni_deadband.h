@@ -0,0 +1,33 @@
+// =======================
+// DETEKCE ZMĚN S DEADBANDEM (spontánní zprávy jen ze změněných bodů)
+// =======================
+//
+// Detektor drží pro každý bod poslední hlášenou hodnotu a práh (absolutní
+// deadband + procenta z poslední hlášené hodnoty). Jeden průchod porovná
+// celé pole points->value s polem hlášených hodnot (souvislá pole → SIMD)
+// a vrátí jen body, které se změnily o víc než deadband, seřazené podle
+// typu a IOA – připravené k zabalení do ASDU po typech.
+
+#ifndef UNI_DEADBAND_H_
+#define UNI_DEADBAND_H_
+
+#include <stdbool.h>
+
+#include "uni_points.h"
+
+typedef struct sChangeDetector* ChangeDetector;
+
+// Vytvoří detektor nad tabulkou (výchozí deadband platí pro měřené hodnoty bez volby DB=),
+// hlášené hodnoty = aktuální hodnoty bodů
+ChangeDetector ChangeDetector_create(PointTable points, float defaultDeadband, bool defaultPercent);
+
+void ChangeDetector_destroy(ChangeDetector self);
+
+// Najde body změněné o víc než deadband a převezme jejich hodnoty jako hlášené.
+// Vrací počet změn, *changes = indexy bodů seřazené podle typu a IOA (patří detektoru)
+int ChangeDetector_scan(ChangeDetector self, PointTable points, const int32_t **changes);
+
+// Převezme aktuální hodnotu bodu jako hlášenou (bod odeslaný jinou cestou, např. po reloadu)
+void ChangeDetector_setReported(ChangeDetector self, PointTable points, int index);
+
+#endif /* UNI_DEADBAND_H_ */
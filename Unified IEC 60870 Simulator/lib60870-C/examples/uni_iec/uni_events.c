@@ -0,0 +1,232 @@
+// =======================
+// GENERÁTOR UDÁLOSTÍ – implementace
+// =======================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "uni_events.h"
+#include "uni_math.h"
+#include "lib_memory.h"
+
+struct sEventEngine {
+    int32_t *candidates;      // Indexy bodů v pořadí (typ, IOA)
+    int candidateCount;
+
+    EventModel model;
+    bool burst;               // Právě běží lavina
+    double nextUs;            // Čas další události (virtuální čas v us)
+    double phaseEndUs;        // Konec aktuální fáze (jen režim lavin)
+    uint64_t state;           // xorshift64*
+
+    int32_t *slots;           // Vylosovaní kandidáti za jedno volání run
+    int32_t *events;          // Totéž převedené na indexy bodů
+    int maxPerTick;
+
+    uint64_t phaseStartUs;
+    uint64_t phaseEvents;
+    uint64_t phaseDropped;    // Události nad kapacitu ticku
+    const char *label;
+};
+
+static double
+uniform(EventEngine self)
+{
+    self->state ^= self->state >> 12;
+    self->state ^= self->state << 25;
+    self->state ^= self->state >> 27;
+    uint64_t x = self->state * 0x2545F4914F6CDD1DULL;
+
+    // (0, 1] – logaritmus nuly nenastane
+    return (double) ((x >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+// Exponenciální rozestup se střední hodnotou meanUs
+static double
+exponential(EventEngine self, double meanUs)
+{
+    return -UniMath_naturalLog(uniform(self)) * meanUs;
+}
+
+static double
+currentRate(EventEngine self)
+{
+    return self->burst ? self->model.burstRate : self->model.rate;
+}
+
+static double
+nextGap(EventEngine self)
+{
+    double rate = currentRate(self);
+    return rate > 0 ? exponential(self, 1e6 / rate) : INFINITY;
+}
+
+static int
+compareSlots(const void *a, const void *b)
+{
+    int32_t x = *(const int32_t *) a;
+    int32_t y = *(const int32_t *) b;
+    return (x > y) - (x < y);
+}
+
+// Přechod mezi klidem a lavinou v čase phaseEndUs (proces je bez paměti, rozestup se losuje znovu)
+static void
+switchPhase(EventEngine self)
+{
+    double at = self->phaseEndUs;
+
+    if (self->burst) {
+        printf("%s Lavina skončila po %.1f s: %llu událostí", self->label,
+               (at - (double) self->phaseStartUs) / 1e6, (unsigned long long) self->phaseEvents);
+        if (self->phaseDropped > 0)
+            printf(", nad kapacitu ticku zahozeno %llu", (unsigned long long) self->phaseDropped);
+        printf("\n");
+    }
+
+    self->burst = !self->burst;
+    self->phaseStartUs = (uint64_t) at;
+    self->phaseEvents = 0;
+    self->phaseDropped = 0;
+    self->phaseEndUs = at + exponential(self, 1000.0 * (self->burst ? self->model.burstMs : self->model.quietMs));
+    self->nextUs = at + nextGap(self);
+
+    if (self->burst)
+        printf("%s Lavina událostí: %d/s\n", self->label, self->model.burstRate);
+}
+
+EventEngine
+EventEngine_create(PointTable points, const EventModel *model, EventTypeFilter filter, int maxPerTick,
+                   uint64_t nowMs, const char *label)
+{
+    const int32_t *order = PointTable_getOrder(points);
+
+    if (order == NULL || maxPerTick <= 0)
+        return NULL;
+
+    int candidateCount = 0;
+    for (int k = 0; k < points->count; k++) {
+        if (filter(points->type[order[k]]))
+            candidateCount++;
+    }
+
+    if (candidateCount == 0)
+        return NULL;
+
+    EventEngine self = (EventEngine) GLOBAL_CALLOC(1, sizeof(struct sEventEngine));
+
+    if (self == NULL)
+        return NULL;
+
+    self->candidates = (int32_t *) GLOBAL_MALLOC((size_t) candidateCount * sizeof(int32_t));
+    self->slots = (int32_t *) GLOBAL_MALLOC((size_t) maxPerTick * sizeof(int32_t));
+    self->events = (int32_t *) GLOBAL_MALLOC((size_t) maxPerTick * sizeof(int32_t));
+
+    if (self->candidates == NULL || self->slots == NULL || self->events == NULL) {
+        EventEngine_destroy(self);
+        return NULL;
+    }
+
+    for (int k = 0; k < points->count; k++) {
+        if (filter(points->type[order[k]]))
+            self->candidates[self->candidateCount++] = order[k];
+    }
+
+    self->model = *model;
+    self->maxPerTick = maxPerTick;
+    self->label = label;
+    self->state = 0x9E3779B97F4A7C15ULL ^ (uint64_t) rand();
+
+    double nowUs = (double) nowMs * 1000.0;
+    self->phaseStartUs = (uint64_t) nowUs;
+    self->phaseEndUs = (model->burstRate > 0) ? nowUs + exponential(self, 1000.0 * model->quietMs) : INFINITY;
+    self->nextUs = nowUs + nextGap(self);
+
+    return self;
+}
+
+void
+EventEngine_destroy(EventEngine self)
+{
+    if (self == NULL)
+        return;
+
+    GLOBAL_FREEMEM(self->candidates);
+    GLOBAL_FREEMEM(self->slots);
+    GLOBAL_FREEMEM(self->events);
+    GLOBAL_FREEMEM(self);
+}
+
+int
+EventEngine_getCandidateCount(EventEngine self)
+{
+    return self->candidateCount;
+}
+
+bool
+EventEngine_setModel(EventEngine self, const EventModel *model, int maxPerTick, uint64_t nowMs)
+{
+    if (maxPerTick > self->maxPerTick) {
+        int32_t *slots = (int32_t *) GLOBAL_REALLOC(self->slots, (size_t) maxPerTick * sizeof(int32_t));
+        if (slots == NULL)
+            return false;
+        self->slots = slots;
+
+        int32_t *events = (int32_t *) GLOBAL_REALLOC(self->events, (size_t) maxPerTick * sizeof(int32_t));
+        if (events == NULL)
+            return false;
+        self->events = events;
+
+        self->maxPerTick = maxPerTick;
+    }
+
+    // Proces začne znovu klidovou fází (rozestupy jsou bez paměti)
+    double nowUs = (double) nowMs * 1000.0;
+    self->model = *model;
+    self->burst = false;
+    self->phaseStartUs = (uint64_t) nowUs;
+    self->phaseEvents = 0;
+    self->phaseDropped = 0;
+    self->phaseEndUs = (model->burstRate > 0) ? nowUs + exponential(self, 1000.0 * model->quietMs) : INFINITY;
+    self->nextUs = nowUs + nextGap(self);
+
+    return true;
+}
+
+int
+EventEngine_run(EventEngine self, uint64_t nowMs, const int32_t **events)
+{
+    double limitUs = (double) nowMs * 1000.0;
+    int count = 0;
+
+    for (;;) {
+        if (self->phaseEndUs <= self->nextUs && self->phaseEndUs <= limitUs) {
+            switchPhase(self);
+            continue;
+        }
+
+        if (self->nextUs > limitUs)
+            break;
+
+        if (count < self->maxPerTick)
+            self->slots[count++] = (int32_t) (uniform(self) * self->candidateCount);
+        else
+            self->phaseDropped++;
+
+        self->phaseEvents++;
+        self->nextUs += nextGap(self);
+    }
+
+    if (count > 1)
+        qsort(self->slots, (size_t) count, sizeof(int32_t), compareSlots);
+
+    for (int i = 0; i < count; i++) {
+        int32_t slot = self->slots[i];
+        // uniform() může vrátit přesně 1.0
+        self->events[i] = self->candidates[slot < self->candidateCount ? slot : self->candidateCount - 1];
+    }
+
+    *events = self->events;
+    return count;
+}
@@ -0,0 +1,49 @@
+// =======================
+// GENERÁTOR UDÁLOSTÍ (Poissonův proces a laviny)
+// =======================
+//
+// Spontánní události přicházejí s exponenciálně rozdělenými rozestupy
+// (Poissonův proces) se střední rychlostí až stovky tisíc událostí za sekundu.
+// V režimu lavin se střídá klidová fáze a lavina s vlastní rychlostí, délky
+// obou fází jsou také exponenciální (model bouřky, kdy naráz hlásí stovky
+// ochran). Kandidáti jsou předem vybrané body v pořadí (typ, IOA), událost
+// jen vylosuje index – bez alokace. Události jednoho ticku se vrátí seřazené,
+// takže se zabalí do společných ASDU.
+
+#ifndef UNI_EVENTS_H_
+#define UNI_EVENTS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "uni_points.h"
+
+typedef struct sEventEngine* EventEngine;
+
+// Parametry procesu událostí
+typedef struct {
+    int rate;                 // Střední rychlost (událostí/s), v režimu lavin rychlost v klidu
+    int burstRate;            // Rychlost během laviny (0 = čistý Poissonův proces)
+    int burstMs;              // Střední délka laviny
+    int quietMs;              // Střední doba klidu mezi lavinami
+} EventModel;
+
+// Vrací true pro typy bodů, ze kterých se losují události
+typedef bool (*EventTypeFilter)(int type);
+
+// Vybere kandidáty z tabulky bodů; maxPerTick = kapacita jednoho volání run (NULL = žádný kandidát)
+EventEngine EventEngine_create(PointTable points, const EventModel *model, EventTypeFilter filter, int maxPerTick,
+                               uint64_t nowMs, const char *label);
+
+void EventEngine_destroy(EventEngine self);
+
+int EventEngine_getCandidateCount(EventEngine self);
+
+// Nový model procesu od času nowMs (kandidáti zůstanou, kapacita ticku může jen růst), false = chyba
+bool EventEngine_setModel(EventEngine self, const EventModel *model, int maxPerTick, uint64_t nowMs);
+
+// Vygeneruje události do času nowMs. Vrací jejich počet, *events = indexy bodů
+// seřazené podle (typ, IOA); stejný bod se může opakovat. Platí do dalšího volání.
+int EventEngine_run(EventEngine self, uint64_t nowMs, const int32_t **events);
+
+#endif /* UNI_EVENTS_H_ */
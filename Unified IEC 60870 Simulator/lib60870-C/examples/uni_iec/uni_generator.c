@@ -0,0 +1,405 @@
+// =======================
+// GENERÁTORY HODNOT BODŮ – implementace
+// =======================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "uni_generator.h"
+#include "uni_timer.h"
+#include "lib_memory.h"
+
+// Body jednoho druhu generátoru v souvislých polích
+typedef struct {
+    int count;
+    int32_t *point;           // Index bodu v tabulce
+    float *value;             // Aktuální hodnota (výstup jádra / stav)
+    float *a;                 // SINE: fáze v otáčkách | RAMP: min | WALK: min | NOISE: základ | STEP: zbývající ms
+    float *b;                 // SINE: otáček/s         | RAMP: rozsah | WALK: max | NOISE: amplituda
+    float *c;                 // SINE: amplituda        | RAMP: změna/s | WALK: krok
+    float *d;                 // SINE: základ           | RAMP: 1/rozsah
+    uint32_t *state;          // WALK, NOISE: xorshift32 | STEP: index úseku
+    PointGenerator *steps;    // STEP: kopie předpisů
+} GeneratorLane;
+
+struct sGeneratorSet {
+    GeneratorLane lanes[POINT_GEN_STEP + 1];
+    int count;
+};
+
+// =======================
+// JÁDRA (bez větvení, jen souvislá pole → SIMD)
+// =======================
+
+// sin(2π p) pro p z [0, 1) – redukce na [0, π/2] bez větvení a lichý polynom (chyba < 1e-6)
+static inline __attribute__((always_inline)) float
+sinTurns(float p)
+{
+    float q = p - (float) (int32_t) (p + 0.5f);       // [-0.5, 0.5)
+    float a = 0.25f - fabsf(0.25f - fabsf(q));         // sin(π - x) = sin(x) → [0, 0.25]
+
+    float x = a * 6.28318531f;
+    float x2 = x * x;
+    float s = x * (1.0f + x2 * (-1.66666667e-1f + x2 * (8.33333333e-3f + x2 * (-1.98412698e-4f +
+              x2 * (2.75573192e-6f + x2 * -2.50521084e-8f)))));
+
+    return copysignf(s, q);
+}
+
+// Náhodné číslo z [-1, 1] (xorshift32, stav každého bodu zvlášť)
+static inline __attribute__((always_inline)) float
+nextRandom(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return (float) (int32_t) x * 4.65661287e-10f;
+}
+
+static void
+updateSine(int n, float *restrict value, float *restrict phase, const float *restrict frequency,
+           const float *restrict amplitude, const float *restrict base, float dt)
+{
+    for (int i = 0; i < n; i++) {
+        float p = phase[i] + frequency[i] * dt;
+        p -= (float) (int32_t) p;
+        phase[i] = p;
+        value[i] = base[i] + amplitude[i] * sinTurns(p);
+    }
+}
+
+static void
+updateRamp(int n, float *restrict value, const float *restrict min, const float *restrict span,
+           const float *restrict slope, const float *restrict inverseSpan, float dt)
+{
+    for (int i = 0; i < n; i++) {
+        float v = value[i] + slope[i] * dt;
+        // Přetečení za max se vrátí o celé násobky rozsahu (pila)
+        value[i] = v - span[i] * (float) (int32_t) ((v - min[i]) * inverseSpan[i]);
+    }
+}
+
+static void
+updateWalk(int n, float *restrict value, const float *restrict min, const float *restrict max,
+           const float *restrict step, uint32_t *restrict state)
+{
+    for (int i = 0; i < n; i++) {
+        float v = value[i] + step[i] * nextRandom(&state[i]);
+        v = (v < min[i]) ? min[i] : v;
+        value[i] = (v > max[i]) ? max[i] : v;
+    }
+}
+
+static void
+updateNoise(int n, float *restrict value, const float *restrict base, const float *restrict amplitude,
+            uint32_t *restrict state)
+{
+    for (int i = 0; i < n; i++)
+        value[i] = base[i] + amplitude[i] * nextRandom(&state[i]);
+}
+
+// Rozvrh má proměnný počet úseků – skalárně, body se STEP bývá málo
+static void
+updateStep(GeneratorLane *lane, uint32_t dtMs)
+{
+    for (int i = 0; i < lane->count; i++) {
+        const PointGenerator *generator = &lane->steps[i];
+        float remaining = lane->a[i] - (float) dtMs;
+        uint32_t segment = lane->state[i];
+
+        while (remaining <= 0) {
+            segment = (segment + 1 == generator->stepCount) ? 0 : segment + 1;
+            remaining += (float) generator->stepMs[segment];
+        }
+
+        lane->a[i] = remaining;
+        lane->state[i] = segment;
+        lane->value[i] = generator->stepValue[segment];
+    }
+}
+
+// =======================
+// SESTAVENÍ
+// =======================
+
+static void
+freeLane(GeneratorLane *lane)
+{
+    GLOBAL_FREEMEM(lane->point);
+    GLOBAL_FREEMEM(lane->value);
+    GLOBAL_FREEMEM(lane->a);
+    GLOBAL_FREEMEM(lane->b);
+    GLOBAL_FREEMEM(lane->c);
+    GLOBAL_FREEMEM(lane->d);
+    GLOBAL_FREEMEM(lane->state);
+    GLOBAL_FREEMEM(lane->steps);
+}
+
+static bool
+allocateLane(GeneratorLane *lane, int capacity, bool steps)
+{
+    size_t size = (size_t) capacity;
+
+    lane->point = (int32_t *) GLOBAL_CALLOC(size, sizeof(int32_t));
+    lane->value = (float *) GLOBAL_CALLOC(size, sizeof(float));
+    lane->a = (float *) GLOBAL_CALLOC(size, sizeof(float));
+    lane->b = (float *) GLOBAL_CALLOC(size, sizeof(float));
+    lane->c = (float *) GLOBAL_CALLOC(size, sizeof(float));
+    lane->d = (float *) GLOBAL_CALLOC(size, sizeof(float));
+    lane->state = (uint32_t *) GLOBAL_CALLOC(size, sizeof(uint32_t));
+
+    if (steps)
+        lane->steps = (PointGenerator *) GLOBAL_CALLOC(size, sizeof(PointGenerator));
+
+    return lane->point && lane->value && lane->a && lane->b && lane->c && lane->d && lane->state &&
+           (!steps || lane->steps);
+}
+
+// Nenulový počáteční stav xorshift32 pro bod
+static uint32_t
+seedFor(PointTable points, int index)
+{
+    uint32_t seed = ((uint32_t) points->ioa[index] * 2654435761u) ^ ((uint32_t) (index + 1) * 2246822519u);
+    return seed ? seed : 1;
+}
+
+static void
+addToLane(GeneratorLane *lane, PointTable points, const PointGenerator *generator)
+{
+    int i = lane->count++;
+    int p = generator->point;
+    float base = points->valueA[p];
+
+    lane->point[i] = p;
+    lane->value[i] = base;
+
+    switch (generator->kind) {
+        case POINT_GEN_SINE: {
+            float phase = generator->param[2] / 360.0f;
+            lane->a[i] = phase - (float) (int32_t) phase + ((phase < 0) ? 1.0f : 0.0f);
+            lane->b[i] = 1.0f / generator->param[1];
+            lane->c[i] = generator->param[0];
+            lane->d[i] = base;
+            lane->value[i] = base + generator->param[0] * sinTurns(lane->a[i]);
+            break;
+        }
+        case POINT_GEN_RAMP: {
+            float span = generator->param[1] - generator->param[0];
+            lane->a[i] = generator->param[0];
+            lane->b[i] = span;
+            lane->c[i] = span / generator->param[2];
+            lane->d[i] = (span > 0) ? 1.0f / span : 0.0f;
+            if ((base < generator->param[0]) || (base >= generator->param[1]))
+                lane->value[i] = generator->param[0];
+            break;
+        }
+        case POINT_GEN_WALK:
+            lane->a[i] = generator->param[1];
+            lane->b[i] = generator->param[2];
+            lane->c[i] = generator->param[0];
+            lane->state[i] = seedFor(points, p);
+            break;
+        case POINT_GEN_NOISE:
+            lane->a[i] = base;
+            lane->b[i] = generator->param[0];
+            lane->state[i] = seedFor(points, p);
+            break;
+        case POINT_GEN_STEP:
+            lane->steps[i] = *generator;
+            lane->a[i] = (float) generator->stepMs[0];
+            lane->state[i] = 0;
+            lane->value[i] = generator->stepValue[0];
+            break;
+    }
+}
+
+GeneratorSet
+GeneratorSet_create(PointTable points)
+{
+    if (points->generatorCount == 0)
+        return NULL;
+
+    GeneratorSet self = (GeneratorSet) GLOBAL_CALLOC(1, sizeof(struct sGeneratorSet));
+
+    if (self == NULL)
+        return NULL;
+
+    int counts[POINT_GEN_STEP + 1] = {0};
+
+    for (int g = 0; g < points->generatorCount; g++)
+        counts[points->generators[g].kind]++;
+
+    for (int kind = POINT_GEN_SINE; kind <= POINT_GEN_STEP; kind++) {
+        if (counts[kind] > 0 && !allocateLane(&self->lanes[kind], counts[kind], kind == POINT_GEN_STEP)) {
+            GeneratorSet_destroy(self);
+            return NULL;
+        }
+    }
+
+    for (int g = 0; g < points->generatorCount; g++) {
+        const PointGenerator *generator = &points->generators[g];
+        addToLane(&self->lanes[generator->kind], points, generator);
+    }
+
+    self->count = points->generatorCount;
+
+    return self;
+}
+
+void
+GeneratorSet_destroy(GeneratorSet self)
+{
+    if (self == NULL)
+        return;
+
+    for (int kind = POINT_GEN_SINE; kind <= POINT_GEN_STEP; kind++)
+        freeLane(&self->lanes[kind]);
+
+    GLOBAL_FREEMEM(self);
+}
+
+int
+GeneratorSet_getCount(GeneratorSet self)
+{
+    return self ? self->count : 0;
+}
+
+void
+GeneratorSet_update(GeneratorSet self, PointTable points, uint32_t dtMs)
+{
+    if (self == NULL)
+        return;
+
+    float dt = (float) dtMs / 1000.0f;
+    GeneratorLane *lane;
+
+    lane = &self->lanes[POINT_GEN_SINE];
+    updateSine(lane->count, lane->value, lane->a, lane->b, lane->c, lane->d, dt);
+
+    lane = &self->lanes[POINT_GEN_RAMP];
+    updateRamp(lane->count, lane->value, lane->a, lane->b, lane->c, lane->d, dt);
+
+    lane = &self->lanes[POINT_GEN_WALK];
+    updateWalk(lane->count, lane->value, lane->a, lane->b, lane->c, lane->state);
+
+    lane = &self->lanes[POINT_GEN_NOISE];
+    updateNoise(lane->count, lane->value, lane->a, lane->b, lane->state);
+
+    updateStep(&self->lanes[POINT_GEN_STEP], dtMs);
+
+    // Rozkopírování výsledků do tabulky bodů
+    float *pointValues = points->value;
+
+    for (int kind = POINT_GEN_SINE; kind <= POINT_GEN_STEP; kind++) {
+        lane = &self->lanes[kind];
+        for (int i = 0; i < lane->count; i++)
+            pointValues[lane->point[i]] = lane->value[i];
+    }
+}
+
+// =======================
+// PARSER VOLBY GEN=
+// =======================
+
+static const struct {
+    const char *name;
+    PointGeneratorKind kind;
+    int minArgs;
+    int maxArgs;
+} generatorNames[] = {
+    {"SINE", POINT_GEN_SINE, 2, 3},
+    {"RAMP", POINT_GEN_RAMP, 3, 3},
+    {"WALK", POINT_GEN_WALK, 3, 3},
+    {"NOISE", POINT_GEN_NOISE, 1, 1},
+    {"STEP", POINT_GEN_STEP, 1, POINT_GEN_MAX_STEPS},
+};
+
+static bool
+parseNumber(const char *text, float *value)
+{
+    char *end;
+    *value = strtof(text, &end);
+    return end != text;
+}
+
+// Doba v sekundách (stejný zápis jako PERIOD: "60", "0.5", "250ms")
+static bool
+parseSeconds(const char *text, float *seconds)
+{
+    int64_t ms = TimerWheel_parseDuration(text);
+    *seconds = (float) ms / 1000.0f;
+    return ms > 0;
+}
+
+bool
+Generator_parse(const char *text, PointGenerator *generator)
+{
+    memset(generator, 0, sizeof(PointGenerator));
+
+    // Volba končí středníkem nebo koncem řádku
+    char buffer[256];
+    size_t length = strcspn(text, ";\r\n");
+    if (length >= sizeof(buffer))
+        return false;
+    memcpy(buffer, text, length);
+    buffer[length] = '\0';
+
+    char *args[POINT_GEN_MAX_STEPS + 1];
+    int argc = 0;
+
+    for (char *token = strtok(buffer, ","); token != NULL; token = strtok(NULL, ",")) {
+        if (argc == POINT_GEN_MAX_STEPS + 1)
+            return false;
+        while (*token == ' ')
+            token++;
+        args[argc++] = token;
+    }
+
+    if (argc == 0)
+        return false;
+
+    int k = 0;
+    int count = (int) (sizeof(generatorNames) / sizeof(generatorNames[0]));
+    while (k < count && strcmp(args[0], generatorNames[k].name) != 0)
+        k++;
+
+    if (k == count || argc - 1 < generatorNames[k].minArgs || argc - 1 > generatorNames[k].maxArgs)
+        return false;
+
+    generator->kind = (uint8_t) generatorNames[k].kind;
+    float *param = generator->param;
+
+    switch (generatorNames[k].kind) {
+        case POINT_GEN_SINE:
+            return parseNumber(args[1], &param[0]) && parseSeconds(args[2], &param[1]) &&
+                   (argc < 4 || parseNumber(args[3], &param[2]));
+        case POINT_GEN_RAMP:
+            return parseNumber(args[1], &param[0]) && parseNumber(args[2], &param[1]) &&
+                   parseSeconds(args[3], &param[2]) && param[1] >= param[0];
+        case POINT_GEN_WALK:
+            return parseNumber(args[1], &param[0]) && parseNumber(args[2], &param[1]) &&
+                   parseNumber(args[3], &param[2]) && param[2] >= param[1];
+        case POINT_GEN_NOISE:
+            return parseNumber(args[1], &param[0]);
+        case POINT_GEN_STEP:
+            // Úsek = hodnota@doba
+            for (int i = 1; i < argc; i++) {
+                char *at = strchr(args[i], '@');
+                if (at == NULL)
+                    return false;
+                *at = '\0';
+                int64_t ms = TimerWheel_parseDuration(at + 1);
+                if (!parseNumber(args[i], &generator->stepValue[i - 1]) || ms <= 0)
+                    return false;
+                generator->stepMs[i - 1] = (uint32_t) ms;
+            }
+            generator->stepCount = (uint8_t) (argc - 1);
+            return true;
+        default:
+            return false;
+    }
+}
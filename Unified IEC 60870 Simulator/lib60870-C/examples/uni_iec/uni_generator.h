@@ -0,0 +1,41 @@
+// =======================
+// GENERÁTORY HODNOT BODŮ (sinus, pila, náhodná procházka, šum, rozvrh)
+// =======================
+//
+// Body s volbou GEN= mění hodnotu v každém ticku. Generátory jsou rozdělené
+// podle druhu do souvislých polí (structure of arrays), takže výpočet je jedna
+// jednoduchá smyčka na druh, kterou překladač převede na SIMD instrukce
+// (sin přes polynom, náhoda přes xorshift32 v každém bodě). Výsledky se pak
+// jen rozkopírují do points->value.
+//
+// Zápis v konfiguraci (za hodnotou bodu, čísla oddělená čárkou):
+//   GEN=SINE,amplituda,perioda[,fáze°]   hodnota + amplituda * sin(2π t / perioda + fáze)
+//   GEN=RAMP,min,max,perioda             pila z min do max za periodu
+//   GEN=WALK,krok,min,max                náhodná procházka, změna max. o krok za tick
+//   GEN=NOISE,amplituda                  hodnota ± amplituda
+//   GEN=STEP,h1@doba1,h2@doba2,…         hodnoty po dobách (dokola, max. 8 úseků)
+
+#ifndef UNI_GENERATOR_H_
+#define UNI_GENERATOR_H_
+
+#include <stdbool.h>
+
+#include "uni_points.h"
+
+typedef struct sGeneratorSet* GeneratorSet;
+
+// Rozebere text za "GEN=", vrací false při chybě
+bool Generator_parse(const char *text, PointGenerator *generator);
+
+// Připraví generátory všech bodů tabulky s POINT_FLAG_GENERATED (NULL = žádné nejsou)
+GeneratorSet GeneratorSet_create(PointTable points);
+
+void GeneratorSet_destroy(GeneratorSet self);
+
+// Počet bodů s generátorem
+int GeneratorSet_getCount(GeneratorSet self);
+
+// Posune generátory o dtMs a zapíše nové hodnoty do points->value
+void GeneratorSet_update(GeneratorSet self, PointTable points, uint32_t dtMs);
+
+#endif /* UNI_GENERATOR_H_ */
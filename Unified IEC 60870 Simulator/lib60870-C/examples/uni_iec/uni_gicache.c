@@ -0,0 +1,351 @@
+// =======================
+// CACHE ODPOVĚDÍ NA DOTAZ – implementace
+// =======================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "uni_gicache.h"
+#include "uni_template.h"
+#include "hal_time.h"
+#include "lib_memory.h"
+
+// Počet bodů v úseku – změna jednoho bodu sestaví znovu nejvýš tolik IO
+#define GI_CHUNK_SIZE 256
+
+// Úsek seznamu: body stejného typu a jejich zakódovaná ASDU
+typedef struct {
+    int32_t firstMember;
+    int32_t memberCount;
+    int32_t firstAsdu;
+    int32_t asduCount;
+    uint32_t epoch;           // Epocha generátorů, ze které úsek pochází
+    uint8_t timeSize;         // Časová značka na konci každého IO (0, 3 nebo 7 B), přepisuje se při odeslání
+    bool generated;           // Obsahuje body s generátorem
+    bool dirty;
+} GiChunk;
+
+// Odpověď na jeden dotaz (stanice nebo skupina)
+typedef struct {
+    int32_t *members;         // Indexy bodů v pořadí (typ, IOA), bez duplicitních IOA
+    int32_t *ranks;           // Pozice členů v PointTable_getOrder (pro hledání úseku)
+    int memberCount;
+    GiChunk *chunks;
+    int chunkCount;
+    CS101_ASDU *asdus;        // Klony ASDU z CS101_ASDU_pack
+    int asduCount;
+    int asduCapacity;
+} GiList;
+
+struct sGiCache {
+    CS101_AppLayerParameters alParams;
+    int oa;
+    int ca;
+    GiCreateIOFunction createIO;
+    GiList lists[GI_CACHE_GROUPS + 1];   // 0 = stanice, 1–16 = skupiny
+    int32_t *rank;                       // Pozice bodu v PointTable_getOrder
+    int count;
+    uint32_t epoch;
+};
+
+// Kontext pack handleru při sestavení úseku
+typedef struct {
+    GiList *list;
+    GiChunk *chunk;
+    bool initial;             // První sestavení – ASDU se přidávají na konec
+    int index;
+} ChunkBuild;
+
+static void
+storeAsdu(void *parameter, CS101_ASDU asdu)
+{
+    ChunkBuild *build = (ChunkBuild *) parameter;
+    GiList *list = build->list;
+
+    if (build->initial) {
+        if (list->asduCount == list->asduCapacity) {
+            int capacity = list->asduCapacity ? list->asduCapacity * 2 : 64;
+            CS101_ASDU *asdus = (CS101_ASDU *) GLOBAL_REALLOC(list->asdus, (size_t) capacity * sizeof(CS101_ASDU));
+            if (asdus == NULL)
+                return;
+            list->asdus = asdus;
+            list->asduCapacity = capacity;
+        }
+
+        CS101_ASDU clone = CS101_ASDU_clone(asdu, NULL);
+        if (clone == NULL)
+            return;
+
+        list->asdus[list->asduCount++] = clone;
+        build->chunk->asduCount++;
+    }
+    else if (build->index < build->chunk->asduCount) {
+        // Stejné body a typ → stejný počet ASDU, klon se přepíše na místě
+        CS101_ASDU_clone(asdu, (CS101_StaticASDU) list->asdus[build->chunk->firstAsdu + build->index]);
+    }
+
+    build->index++;
+}
+
+static void
+buildChunk(GiCache self, PointTable points, GiList *list, GiChunk *chunk, int group, bool initial)
+{
+    InformationObject ios[GI_CHUNK_SIZE];
+    int numIos = 0;
+
+    for (int m = chunk->firstMember; m < chunk->firstMember + chunk->memberCount; m++) {
+        int p = list->members[m];
+        InformationObject io = self->createIO(points->type[p], points->ioa[p], points->value[p]);
+        if (io != NULL)
+            ios[numIos++] = io;
+        else if (initial)
+            fprintf(stderr, "Failed to create IO (Type %d, IOA %d)\n", points->type[p], points->ioa[p]);
+    }
+
+    ChunkBuild build = {list, chunk, initial, 0};
+
+    if (initial) {
+        chunk->firstAsdu = list->asduCount;
+        chunk->asduCount = 0;
+    }
+
+    if (numIos > 0 &&
+        CS101_ASDU_pack(self->alParams, (CS101_CauseOfTransmission) (CS101_COT_INTERROGATED_BY_STATION + group),
+                        self->oa, self->ca, false, false, ios, numIos, storeAsdu, &build) < 0) {
+        fprintf(stderr, "Failed to pack IOs of type %d\n", InformationObject_getType(ios[0]));
+    }
+
+    for (int i = 0; i < numIos; i++)
+        InformationObject_destroy(ios[i]);
+
+    chunk->dirty = false;
+    chunk->epoch = self->epoch;
+}
+
+static bool
+buildList(GiCache self, PointTable points, const int32_t *order, int group)
+{
+    GiList *list = &self->lists[group];
+    uint16_t mask = group ? (uint16_t) (1u << (group - 1)) : 0;
+
+    int memberCount = 0;
+    for (int k = 0; k < points->count; k++) {
+        if (group == 0 || (points->groups[order[k]] & mask))
+            memberCount++;
+    }
+
+    if (memberCount == 0)
+        return true;
+
+    list->members = (int32_t *) GLOBAL_MALLOC((size_t) memberCount * sizeof(int32_t));
+    list->ranks = (int32_t *) GLOBAL_MALLOC((size_t) memberCount * sizeof(int32_t));
+    // Horní odhad počtu úseků – nový úsek při změně typu nebo po GI_CHUNK_SIZE bodech
+    list->chunks = (GiChunk *) GLOBAL_CALLOC((size_t) memberCount, sizeof(GiChunk));
+
+    if (list->members == NULL || list->ranks == NULL || list->chunks == NULL)
+        return false;
+
+    GiChunk *chunk = NULL;
+
+    for (int k = 0; k < points->count; k++) {
+        int p = order[k];
+
+        if (group != 0 && (points->groups[p] & mask) == 0)
+            continue;
+
+        // Duplicitní IOA stejného typu jen jednou
+        if (list->memberCount > 0) {
+            int last = list->members[list->memberCount - 1];
+            if (points->type[last] == points->type[p] && points->ioa[last] == points->ioa[p])
+                continue;
+        }
+
+        if (chunk == NULL || chunk->memberCount == GI_CHUNK_SIZE ||
+            points->type[list->members[chunk->firstMember]] != points->type[p]) {
+            chunk = &list->chunks[list->chunkCount++];
+            chunk->firstMember = list->memberCount;
+            chunk->timeSize = (uint8_t) AsduTemplate_getTimeSize(points->type[p]);
+        }
+
+        list->members[list->memberCount] = p;
+        list->ranks[list->memberCount] = k;
+        list->memberCount++;
+        chunk->memberCount++;
+
+        if (points->flags[p] & POINT_FLAG_GENERATED)
+            chunk->generated = true;
+    }
+
+    for (int c = 0; c < list->chunkCount; c++)
+        buildChunk(self, points, list, &list->chunks[c], group, true);
+
+    return true;
+}
+
+static void
+freeList(GiList *list)
+{
+    for (int i = 0; i < list->asduCount; i++)
+        GLOBAL_FREEMEM(list->asdus[i]);
+
+    GLOBAL_FREEMEM(list->asdus);
+    GLOBAL_FREEMEM(list->members);
+    GLOBAL_FREEMEM(list->ranks);
+    GLOBAL_FREEMEM(list->chunks);
+}
+
+GiCache
+GiCache_create(CS101_AppLayerParameters alParams, PointTable points, int oa, int ca, GiCreateIOFunction createIO)
+{
+    const int32_t *order = PointTable_getOrder(points);
+
+    if (order == NULL)
+        return NULL;
+
+    GiCache self = (GiCache) GLOBAL_CALLOC(1, sizeof(struct sGiCache));
+
+    if (self == NULL)
+        return NULL;
+
+    self->alParams = alParams;
+    self->oa = oa;
+    self->ca = ca;
+    self->createIO = createIO;
+    self->count = points->count;
+    self->rank = (int32_t *) GLOBAL_MALLOC((size_t) (points->count + 1) * sizeof(int32_t));
+
+    if (self->rank == NULL) {
+        GiCache_destroy(self);
+        return NULL;
+    }
+
+    for (int k = 0; k < points->count; k++)
+        self->rank[order[k]] = k;
+
+    for (int g = 0; g <= GI_CACHE_GROUPS; g++) {
+        if (!buildList(self, points, order, g)) {
+            GiCache_destroy(self);
+            return NULL;
+        }
+    }
+
+    return self;
+}
+
+void
+GiCache_destroy(GiCache self)
+{
+    if (self == NULL)
+        return;
+
+    for (int g = 0; g <= GI_CACHE_GROUPS; g++)
+        freeList(&self->lists[g]);
+
+    GLOBAL_FREEMEM(self->rank);
+    GLOBAL_FREEMEM(self);
+}
+
+// Úsek, do kterého patří pozice rank (poslední úsek s prvním členem <= rank)
+static GiChunk *
+findChunk(GiList *list, int32_t rank)
+{
+    int low = 0;
+    int high = list->chunkCount - 1;
+    GiChunk *found = NULL;
+
+    while (low <= high) {
+        int middle = (low + high) / 2;
+        if (list->ranks[list->chunks[middle].firstMember] <= rank) {
+            found = &list->chunks[middle];
+            low = middle + 1;
+        }
+        else {
+            high = middle - 1;
+        }
+    }
+
+    return found;
+}
+
+void
+GiCache_invalidate(GiCache self, PointTable points, int index)
+{
+    if (self == NULL || index < 0 || index >= self->count)
+        return;
+
+    int32_t rank = self->rank[index];
+    uint32_t groups = (uint32_t) points->groups[index] << 1;   // bit 0 = stanice
+
+    groups |= 1;
+
+    for (int g = 0; g <= GI_CACHE_GROUPS; g++) {
+        if ((groups & (1u << g)) == 0)
+            continue;
+
+        GiChunk *chunk = findChunk(&self->lists[g], rank);
+        if (chunk)
+            chunk->dirty = true;
+    }
+}
+
+void
+GiCache_invalidateGenerated(GiCache self)
+{
+    if (self)
+        self->epoch++;
+}
+
+// Přepíše časové značky všech IO uloženého ASDU (typy s časem jsou vždy SQ=0,
+// značka je na konci každého IO)
+static void
+applyTime(CS101_ASDU asdu, int timeSize, const TemplateTime *time)
+{
+    int numberOfElements = CS101_ASDU_getNumberOfElements(asdu);
+
+    if (numberOfElements == 0 || CS101_ASDU_isSequence(asdu))
+        return;
+
+    const uint8_t *encodedTime = (timeSize == 3) ? time->cp24 : time->cp56;
+    uint8_t *payload = CS101_ASDU_getPayload(asdu);
+    int elementSize = CS101_ASDU_getPayloadSize(asdu) / numberOfElements;
+
+    for (int i = 0; i < numberOfElements; i++)
+        memcpy(payload + (i + 1) * elementSize - timeSize, encodedTime, (size_t) timeSize);
+}
+
+int
+GiCache_send(GiCache self, PointTable points, int group, CS101_ASDUPackHandler handler, void *parameter)
+{
+    if (self == NULL || group < 0 || group > GI_CACHE_GROUPS)
+        return -1;
+
+    GiList *list = &self->lists[group];
+    int sent = 0;
+
+    // Odpověď nese čas dotazu, ne čas sestavení úseku
+    TemplateTime time;
+    bool timeSet = false;
+
+    for (int c = 0; c < list->chunkCount; c++) {
+        GiChunk *chunk = &list->chunks[c];
+
+        if (chunk->dirty || (chunk->generated && chunk->epoch != self->epoch))
+            buildChunk(self, points, list, chunk, group, false);
+
+        if (chunk->timeSize > 0 && !timeSet) {
+            TemplateTime_set(&time, Hal_getTimeInMs());
+            timeSet = true;
+        }
+
+        for (int a = chunk->firstAsdu; a < chunk->firstAsdu + chunk->asduCount; a++) {
+            if (chunk->timeSize > 0)
+                applyTime(list->asdus[a], chunk->timeSize, &time);
+
+            handler(parameter, list->asdus[a]);
+            sent++;
+        }
+    }
+
+    return sent;
+}
@@ -0,0 +1,44 @@
+// =======================
+// CACHE ODPOVĚDÍ NA GENERÁLNÍ DOTAZ (QOI 20) A DOTAZY SKUPIN (QOI 21–36)
+// =======================
+//
+// Odpověď na dotaz se sestaví jednou (createIO + CS101_ASDU_pack, SQ=1 pro
+// souvislé IOA typů bez času) a zakódovaná ASDU se uloží. Další dotazy – i od
+// mnoha masterů – jen pošlou uložená ASDU; časové značky CP24/CP56 se při
+// každém odeslání přepíšou na aktuální čas (jako u šablon). Body každého seznamu (stanice a 16
+// skupin podle volby GROUP=) jsou rozdělené na úseky; změna bodu zneplatní
+// jen jeho úseky, které se znovu sestaví až při dalším dotazu. Úseky
+// s generovanými body (GEN=) se zneplatní najednou po každém ticku generátorů.
+//
+// Cache není vláknově bezpečná – volající drží zámek tabulky bodů.
+
+#ifndef UNI_GICACHE_H_
+#define UNI_GICACHE_H_
+
+#include "iec60870_common.h"
+#include "uni_points.h"
+
+#define GI_CACHE_GROUPS 16
+
+typedef struct sGiCache* GiCache;
+
+// Vytvoření IO pro bod (NULL = typ nelze poslat)
+typedef InformationObject (*GiCreateIOFunction)(int type, int ioa, float value);
+
+// Sestaví odpovědi pro stanici a všechny skupiny z aktuálních hodnot bodů
+GiCache GiCache_create(CS101_AppLayerParameters alParams, PointTable points, int oa, int ca,
+                       GiCreateIOFunction createIO);
+
+void GiCache_destroy(GiCache self);
+
+// Hodnota bodu se změnila – zneplatní úseky, ve kterých bod je
+void GiCache_invalidate(GiCache self, PointTable points, int index);
+
+// Generátory změnily hodnoty – zneplatní všechny úseky s generovanými body
+void GiCache_invalidateGenerated(GiCache self);
+
+// Pošle odpověď na dotaz (group 0 = stanice, 1–16 = skupina) přes handler,
+// zneplatněné úseky předtím sestaví znovu. Vrací počet ASDU, -1 = neplatná skupina
+int GiCache_send(GiCache self, PointTable points, int group, CS101_ASDUPackHandler handler, void *parameter);
+
+#endif /* UNI_GICACHE_H_ */
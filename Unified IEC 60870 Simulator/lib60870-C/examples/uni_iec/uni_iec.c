@@ -15,96 +15,94 @@
 #include "iec60870_common.h"
 #include "lib_memory.h"
 #include <setjmp.h>
+#include <ctype.h>
 #include "cs101_master.h"
 #include "cs104_connection.h"
 #include "cs101_slave.h"
+#include "uni_template.h"
+#include "uni_points.h"
+#include "uni_timer.h"
+#include "uni_log.h"
+#include "uni_binlog.h"
+#include "uni_config.h"
+#include "uni_journal.h"
+#include "uni_load.h"
+#include "uni_generator.h"
+#include "uni_deadband.h"
+#include "uni_gicache.h"
+#include "uni_events.h"
+#include "uni_stats.h"
+#include "uni_state.h"
+#include "uni_capture.h"
+#include "uni_clients.h"
+#include "uni_latency.h"
+#include "uni_periodic.h"
+#include "uni_stations.h"
+#include "uni_shared.h"
+#include "uni_playback.h"
+#include "uni_commands.h"
+#include "uni_scenario.h"
 
 // =======================
 // KONSTANTY A GLOBÁLNÍ PROMĚNNÉ
 // =======================
 
-#define MAX_MESSAGES 100           // Max počet zpráv v konfiguraci
 #define MAX_MESSAGE_TYPES 40       // Max počet typů zpráv (pro indexaci)
-#define MAX_MESSAGE_CONFIGS 50
-#define MAX_IO_CONTENTS 20
+#define GI_BATCH_SIZE 1024         // Počet IO, které GI najednou předá CS101_ASDU_pack
 
-int numPermMessageConfigs = 0;
-int numTempMessageConfigs = 0;
 int dataConfig = 0;                // Přepínač datových logů (1=loguje)
 int serviceConfig = 0;             // Přepínač servisních logů (1=loguje)
 
 static char *dataPath = "DATALOG.txt";       // Výchozí cesta k datovým logům
 static char *servicePath = "SERVICELOG.txt"; // Výchozí cesta k servisním logům
 
-// =======================
-// STRUKTURY PRO KONFIGURACI
-// =======================
-
-// IOContent - jeden datový bod (typicky jeden IOA a hodnota)
-typedef struct {
-    int ioa;
-    float value;            // Pro 1-hodnotovou zprávu (TEMP, PERM-statická)
-    float toggleValueA;     // Dual: první hodnota
-    float toggleValueB;     // Dual: druhá hodnota
-    bool toggleEnabled;     // True, pokud se má přepínat mezi dvěma hodnotami
-    bool toggleState;       // Uchovává aktuální stav (true=A, false=B)
-} IOContent;
-
-// MessageConfig - jeden typ zprávy s polem IO bodů
-typedef struct {
-    int messageType;
-    IOContent ioContent[10];
-    int ioContentCount;
-    bool isPermanent;       // True = PERM, False = TEMP
-} MessageConfig;
-
-MessageConfig permMessageConfigs[MAX_MESSAGE_CONFIGS];
-MessageConfig tempMessageConfigs[MAX_MESSAGE_CONFIGS];
-
-// Hlavní konfigurační struktura pro celý simulátor
-typedef struct {
-    char protocol[4];         // "104" nebo "101"
-    char role[8];             // "SERVER"/"CLIENT"
-    char ip[64];              // IP adresa (104)
-    int port;                 // TCP port (104)
-    char interface[64];       // Název rozhraní (101)
-    int bandwidth;            // Rychlost (101)
-    int originatorAddress;    // OA (většinou server)
-    int commonAddress;        // CA (adresa stanice)
-    int dataLogs;             // 1=datové logy zapnuty
-    char dataPath[128];       // Cesta k datovým logům
-    int serviceLogs;          // 1=servisní logy zapnuty
-    char servicePath[128];    // Cesta k servisním logům
-    int period;               // Perioda odesílání zpráv v sekundách
-    int spontaneousEnable;    // 1=spontánní zapnuty (jen server)
-    int spontaneousMin;       // Min. interval spontánních zpráv
-    int spontaneousMax;       // Max. interval spontánních zpráv
-    int multiplier;           // Kolikrát poslat každou zprávu
-    int sync;                 // 1=klient posílá SYNC zprávy
-    int disconnectAfterSend;  // 1=klient se odpojí po odeslání
-} Config;
-
 // =======================
 // PROMĚNNÉ PRO ZPRÁVY A STAV
 // =======================
 
-static MessageConfig messageConfigs[MAX_MESSAGES];  // Pole konfigurací zpráv
-static int numMessageConfigs = 0;                  // Počet načtených zpráv
-bool isPermanent; // true = PERM_MESS, false = TEMP_MESS
+static PointTable points = NULL;       // Všechny datové body z konfigurace (viz uni_points.h)
+static Semaphore pointsLock = NULL;    // Chrání points při hot reloadu (GI běží ve vláknech spojení 104)
+static GeneratorSet generators = NULL; // Generátory hodnot bodů s volbou GEN= (viz uni_generator.h)
+static ChangeDetector changeDetector = NULL; // Spontánní zprávy ze změn nad deadband (viz uni_deadband.h)
+static GiCache giCache = NULL;     // Zakódované odpovědi na dotaz stanice a skupin (viz uni_gicache.h)
+static TrafficStats trafficStats = NULL; // Tichý režim: čítače provozu místo výpisu IO (viz uni_stats.h)
+static StateTable clientState = NULL;  // Klient: poslední přijaté hodnoty bodů (viz uni_state.h)
+static FrameCapture frameCapture = NULL; // Záznam surových rámců do pcap (viz uni_capture.h)
+static CommandLatency commandLatency = NULL; // Klient: latence commandů do ACT_CON/ACT_TERM (viz uni_latency.h)
+static SharedPoints sharedPoints = NULL; // Server: body zapisované externím zdrojem (viz uni_shared.h)
+static ValuePlayback valuePlayback = NULL; // Server: přehrávaný záznam hodnot bodů (viz uni_playback.h)
+static CommandEngine commandEngine = NULL; // Server: vykonávání commandů s dobou odezvy (viz uni_commands.h)
+static Scenario scenario = NULL;       // Server: scénář událostí podle časové osy (viz uni_scenario.h)
+
+// Výpis v handlerech ASDU – v tichém režimu jen vzorkovaná ASDU (lokální proměnná trace)
+#define TRACE(...) do { if (trace) printf(__VA_ARGS__); } while (0)
 static bool running = true;            // Hlavní smyčka běží/neběží
-static time_t lastSentTime = 0;        // Poslední čas odeslání zprávy
 
 // Spontánní zprávy (jen pro server)
 static bool spontaneousEnabled = false;
-static int minSpontaneousInterval = 2;
-static int maxSpontaneousInterval = 10;
-static time_t nextSpontaneousTime = 0;
+static int minSpontaneousInterval = 2000;  // ms
+static int maxSpontaneousInterval = 10000; // ms
 
 static int multiplier = 1;                 // Multiplikátor zpráv
 static int originatorAddress;              // OA z konfigu
 static int commonAddress;                  // CA z konfigu
 static CS104_Connection con = NULL;
 
+// Předkódované šablony periodických zpráv stanice (viz uni_periodic.h)
+static PeriodicSet periodicSet = NULL;
+
+// Funkce, která zařadí ASDU do odesílací fronty (104 nebo 101 slave)
+typedef void (*EnqueueFunction)(void *target, CS101_ASDU asdu);
+
+// Kam posílá periodické zprávy server
+typedef struct {
+    EnqueueFunction enqueue;
+    void *target;
+    const char *label;        // Prefix výpisu, např. "[SERVER - 104]"
+} PeriodicTarget;
+
+static PeriodicTarget periodicTarget;
+
 bool allowMessages = false;                // Povoluje interaktivní zadávání zpráv
 volatile sig_atomic_t configInterrupted = 0;   // Signalizace přerušení konfigurace
 static jmp_buf configJump;                 // Pro návrat při přerušení konfigurace
@@ -156,230 +154,6 @@ const char* getCOTName(int cot) {
 }
 
 
-// =======================
-// BLOK: LOGOVACÍ FUNKCE (pro server i klienta)
-// =======================
-
-// Zaloguje spuštění instance (Client/Server)
-void LogSTART(const char *role) {
-    time_t t = time(NULL);
-    struct tm tm = *localtime(&t);
-    FILE *fp = fopen(servicePath, "a");
-    fprintf(fp, "%d-%02d-%02d %02d:%02d:%02d %s started \n",
-            tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
-            tm.tm_hour, tm.tm_min, tm.tm_sec, role);
-    fclose(fp);
-}
-
-// Log přijetí požadavku na spojení (server i klient)
-void LogCONREQ(const char *ipAddress) {
-    time_t t = time(NULL);
-    struct tm tm = *localtime(&t);
-    FILE *fp = fopen(servicePath, "a");
-    fprintf(fp, "%d-%02d-%02d %02d:%02d:%02d New connection request from %s\n",
-            tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
-            tm.tm_hour, tm.tm_min, tm.tm_sec, ipAddress);
-    fclose(fp);
-}
-
-// Log otevření spojení (SERVER)/navázání spojení (CLIENT)
-void LogCONOPEN() {
-    time_t t = time(NULL);
-    struct tm tm = *localtime(&t);
-    FILE *fp = fopen(servicePath, "a");
-    fprintf(fp, "%d-%02d-%02d %02d:%02d:%02d Connection opened\n",
-            tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
-            tm.tm_hour, tm.tm_min, tm.tm_sec);
-    fclose(fp);
-}
-
-// Log ukončení spojení
-void LogCONCLOSED() {
-    time_t t = time(NULL);
-    struct tm tm = *localtime(&t);
-    FILE *fp = fopen(servicePath, "a");
-    fprintf(fp, "%d-%02d-%02d %02d:%02d:%02d Connection closed\n",
-            tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
-            tm.tm_hour, tm.tm_min, tm.tm_sec);
-    fclose(fp);
-}
-
-// (Používá se na serveru pro stav spojení)
-void LogCONACT() {
-    time_t t = time(NULL);
-    struct tm tm = *localtime(&t);
-    FILE *fp = fopen(servicePath, "a");
-    fprintf(fp, "%d-%02d-%02d %02d:%02d:%02d Connection activated\n",
-            tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
-            tm.tm_hour, tm.tm_min, tm.tm_sec);
-    fclose(fp);
-}
-void LogCONDEACT() {
-    time_t t = time(NULL);
-    struct tm tm = *localtime(&t);
-    FILE *fp = fopen(servicePath, "a");
-    fprintf(fp, "%d-%02d-%02d %02d:%02d:%02d Connection deactivated\n",
-            tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
-            tm.tm_hour, tm.tm_min, tm.tm_sec);
-    fclose(fp);
-}
-
-// Pouze klient (navázání TCP spojení)
-void LogCONEST() {
-    time_t t = time(NULL);
-    struct tm tm = *localtime(&t);
-    FILE *fp = fopen(servicePath, "a");
-    fprintf(fp, "%d-%02d-%02d %02d:%02d:%02d Connection established\n",
-            tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
-            tm.tm_hour, tm.tm_min, tm.tm_sec);
-    fclose(fp);
-}
-
-// Přijetí řídících zpráv (STARTDT/STOPDT) na klientovi
-void LogCONSTARTTD() {
-    time_t t = time(NULL);
-    struct tm tm = *localtime(&t);
-    FILE *fp = fopen(servicePath, "a");
-    fprintf(fp, "%d-%02d-%02d %02d:%02d:%02d Received STARTDT_CON\n",
-            tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
-            tm.tm_hour, tm.tm_min, tm.tm_sec);
-    fclose(fp);
-}
-void LogCONSTOPTD() {
-    time_t t = time(NULL);
-    struct tm tm = *localtime(&t);
-    FILE *fp = fopen(servicePath, "a");
-    fprintf(fp, "%d-%02d-%02d %02d:%02d:%02d Received STOPDT_CON\n",
-            tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
-            tm.tm_hour, tm.tm_min, tm.tm_sec);
-    fclose(fp);
-}
-
-
-
-
-
-/*void LogCONREF() { // (Nepoužíváno, možno odstranit)
-    time_t t = time(NULL);
-    struct tm tm = *localtime(&t);
-    FILE *fp = fopen(servicePath, "a");
-    fprintf(fp, "%d-%02d-%02d %02d:%02d:%02d Connections refreshed\n",
-            tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
-            tm.tm_hour, tm.tm_min, tm.tm_sec);
-    fclose(fp);
-}*/
-
-
-
-// =======================
-// DATOVÉ LOGY – společné pro server i klienta
-// =======================
-
-// Log odeslané zprávy (datová vrstva)
-void LogTX(int type, int elements, int oa, int ca) {
-    time_t t = time(NULL);
-    struct tm tm = *localtime(&t);
-    FILE *fp = fopen(dataPath, "a");
-    fprintf(fp, "%d-%02d-%02d %02d:%02d:%02d oa: %i ca: %i type:(%i) elements: %i\n",
-            tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
-            tm.tm_hour, tm.tm_min, tm.tm_sec, oa, ca, type, elements);
-    fclose(fp);
-}
-
-// Log přijaté zprávy (datová vrstva)
-void LogRX(int type, int elements, int oa, int ca) {
-    time_t t = time(NULL);
-    struct tm tm = *localtime(&t);
-    FILE *fp = fopen(dataPath, "a");
-    fprintf(fp, "%d-%02d-%02d %02d:%02d:%02d oa: %i ca: %i type:(%i) elements: %i\n",
-            tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
-            tm.tm_hour, tm.tm_min, tm.tm_sec, oa, ca, type, elements);
-    fclose(fp);
-}
-
-// Log hodnoty (odeslané/přijaté) bez časové známky
-void LogTXwoT(int ioa, float value) {
-    time_t t = time(NULL);
-    struct tm tm = *localtime(&t);
-    FILE *fp = fopen(dataPath, "a");
-    fprintf(fp, "%d-%02d-%02d %02d:%02d:%02d IOA: %i value: %f\n",
-            tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
-            tm.tm_hour, tm.tm_min, tm.tm_sec, ioa, value);
-    fclose(fp);
-}
-void LogRXwoT(int ioa, float value) {
-    time_t t = time(NULL);
-    struct tm tm = *localtime(&t);
-    FILE *fp = fopen(dataPath, "a");
-    fprintf(fp, "%d-%02d-%02d %02d:%02d:%02d IOA: %i value: %f\n",
-            tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
-            tm.tm_hour, tm.tm_min, tm.tm_sec, ioa, value);
-    fclose(fp);
-}
-
-// Log s časovou známkou (CP56Time2a)
-void LogTXwT(int ioa, float value, CP56Time2a timestamp) {
-    time_t t = time(NULL);
-    struct tm tm = *localtime(&t);
-    FILE *fp = fopen(dataPath, "a");
-    fprintf(fp, "%d-%02d-%02d %02d:%02d:%02d IOA: %i value: %f with timestamp: %04i-%02i-%02i %02i:%02i:%02i \n",
-            tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, ioa, value,
-            CP56Time2a_getYear(timestamp) + 2000, CP56Time2a_getMonth(timestamp), CP56Time2a_getDayOfMonth(timestamp),
-            CP56Time2a_getHour(timestamp), CP56Time2a_getMinute(timestamp), CP56Time2a_getSecond(timestamp));
-    fclose(fp);
-}
-
-void LogTXwT24(int ioa, float value, CP24Time2a timestamp) {
-    time_t t = time(NULL);
-    struct tm tm = *localtime(&t);
-    FILE *fp = fopen(dataPath, "a");
-    fprintf(fp, "%d-%02d-%02d %02d:%02d:%02d IOA: %i value: %f with timestamp: %02i:%02i:%03i \n",
-            tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, ioa, value,
-            CP24Time2a_getMinute(timestamp), CP24Time2a_getSecond(timestamp), CP24Time2a_getMillisecond(timestamp));
-    fclose(fp);
-}
-
-void LogRXwT(int ioa, float value, CP56Time2a timestamp) {
-    time_t t = time(NULL);
-    struct tm tm = *localtime(&t);
-    FILE *fp = fopen(dataPath, "a");
-    fprintf(fp, "%d-%02d-%02d %02d:%02d:%02d IOA: %i value: %f with timestamp: %04i-%02i-%02i %02i:%02i:%02i \n",
-            tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, ioa, value,
-            CP56Time2a_getYear(timestamp) + 2000, CP56Time2a_getMonth(timestamp), CP56Time2a_getDayOfMonth(timestamp),
-            CP56Time2a_getHour(timestamp), CP56Time2a_getMinute(timestamp), CP56Time2a_getSecond(timestamp));
-    fclose(fp);
-}
-
-void LogRXwT24(int ioa, float value, CP24Time2a timestamp) {
-    time_t t = time(NULL);
-    struct tm tm = *localtime(&t);
-    FILE *fp = fopen(dataPath, "a");
-    fprintf(fp, "%d-%02d-%02d %02d:%02d:%02d IOA: %i value: %f with timestamp: %02i:%02i:%03i \n",
-            tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, ioa, value,
-            CP24Time2a_getMinute(timestamp), CP24Time2a_getSecond(timestamp), CP24Time2a_getMillisecond(timestamp));
-    fclose(fp);
-}
-
-// Log odeslané/přijaté zprávy typu "interrogation" (QOI)
-void LogRXrequest(int qoi) { // server přijme dotaz
-    time_t t = time(NULL);
-    struct tm tm = *localtime(&t);
-    FILE *fp = fopen(servicePath, "a");
-    fprintf(fp, "%d-%02d-%02d %02d:%02d:%02d Received interrogation for group (%i).\n",
-            tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
-            tm.tm_hour, tm.tm_min, tm.tm_sec, qoi);
-    fclose(fp);
-}
-void LogTXrequest(int qoi) { // klient posílá interrogation
-    time_t t = time(NULL);
-    struct tm tm = *localtime(&t);
-    FILE *fp = fopen(servicePath, "a");
-    fprintf(fp, "%d-%02d-%02d %02d:%02d:%02d Transceived interrogation for group (%i).\n",
-            tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
-            tm.tm_hour, tm.tm_min, tm.tm_sec, qoi);
-    fclose(fp);
-}
-
 // =======================
 // FUNKCE PRO ČASOVÉ TISKY (tisk CP24, CP56 do konzole)
 // =======================
@@ -402,94 +176,34 @@ void printCP24Time2a(CP24Time2a time) {
            CP24Time2a_getSecond(time));
 }
 
-// =======================
-// ČTENÍ HODNOT Z KONFIGURAČNÍHO SOUBORU (funkce na čtení jednoho klíče)
-// =======================
-
-char *readConfigValue(const char *filePath, const char *key) {
-    FILE *file = fopen(filePath, "r");
-    if (file == NULL) {
-        perror("Failed to open file");
-        return NULL;
+// Nastaví přepínače a cesty logů a spustí zapisovací vlákno (viz uni_log.h)
+static void startLogging(Config *cfg, const char *role) {
+    if (cfg->dataLogs) dataConfig = 1;
+    if (cfg->serviceLogs) serviceConfig = 1;
+    if (strlen(cfg->dataPath) > 0) dataPath = cfg->dataPath;
+    else if (cfg->dataLogBinary) dataPath = "DATALOG.bin";
+    if (strlen(cfg->servicePath) > 0) servicePath = cfg->servicePath;
+
+    if (dataConfig == 0 && serviceConfig == 0) return;
+
+    uint64_t maxSize = (uint64_t) (cfg->logMaxSizeMB > 0 ? cfg->logMaxSizeMB : 0) * 1024 * 1024;
+    uint64_t rotateMs = cfg->logRotateMs > 0 ? (uint64_t) cfg->logRotateMs : 0;
+    if (!Logger_start(dataPath, servicePath, cfg->dataLogBinary && dataConfig, maxSize, rotateMs)) {
+        fprintf(stderr, "Nepodařilo se spustit logování, logy jsou vypnuté\n");
+        dataConfig = 0;
+        serviceConfig = 0;
+        return;
     }
-    char *value = NULL;
-    char line[1024];
 
-    while (fgets(line, sizeof(line), file)) {
-        char *equalPos = strchr(line, '=');
-        if (equalPos) {
-            char keyInFile[128];
-            strncpy(keyInFile, line, equalPos - line);
-            keyInFile[equalPos - line] = '\0';
-
-            // Ořízni mezery vlevo
-            char *trimmedKey = keyInFile;
-            while (*trimmedKey == ' ') trimmedKey++;
-
-            if (strcmp(trimmedKey, key) == 0) {
-                char *startOfValue = equalPos + 1;
-                while (*startOfValue == ' ') startOfValue++;
-                char *endOfValue = startOfValue + strcspn(startOfValue, "\r\n");
-                *endOfValue = '\0';
-                value = strdup(startOfValue);
-                break;
-            }
-        }
-    }
-    fclose(file);
-    return value;
+    if (serviceConfig == 1) LogSTART(role);
 }
 
-// =======================
-// FUNKCE PRO NAČTENÍ CELÉ KONFIGURACE
-// =======================
-
-// Načte všechny hodnoty z konfiguračního souboru do struktury Config
-Config readFullConfig(const char* path) {
-    Config cfg;
-    memset(&cfg, 0, sizeof(Config));
-
-    char* val;
-
-    val = readConfigValue(path, "PROTOCOL");
-    if (val) { strncpy(cfg.protocol, val, sizeof(cfg.protocol)); free(val); }
-    val = readConfigValue(path, "ROLE");
-    if (val) { strncpy(cfg.role, val, sizeof(cfg.role)); free(val); }
-    val = readConfigValue(path, "IP");
-    if (val) { strncpy(cfg.ip, val, sizeof(cfg.ip)); free(val); }
-    val = readConfigValue(path, "PORT");
-    if (val) { cfg.port = atoi(val); free(val); }
-    val = readConfigValue(path, "INTERFACE");
-    if (val) { strncpy(cfg.interface, val, sizeof(cfg.interface)); free(val); }
-    val = readConfigValue(path, "BANDWIDTH");
-    if (val) { cfg.bandwidth = atoi(val); free(val); }
-    val = readConfigValue(path, "ORIGINATOR_ADDRESS");
-    if (val) { cfg.originatorAddress = atoi(val); free(val); }
-    val = readConfigValue(path, "COMMON_ADDRESS");
-    if (val) { cfg.commonAddress = atoi(val); free(val); }
-    val = readConfigValue(path, "DATALOGS");
-    if (val) { cfg.dataLogs = atoi(val); free(val); }
-    val = readConfigValue(path, "DATAPATH");
-    if (val) { strncpy(cfg.dataPath, val, sizeof(cfg.dataPath)); free(val); }
-    val = readConfigValue(path, "SERVICELOGS");
-    if (val) { cfg.serviceLogs = atoi(val); free(val); }
-    val = readConfigValue(path, "SERVICEPATH");
-    if (val) { strncpy(cfg.servicePath, val, sizeof(cfg.servicePath)); free(val); }
-    val = readConfigValue(path, "PERIOD");
-    if (val) { cfg.period = atoi(val); free(val); }
-    val = readConfigValue(path, "SPONTANEOUS");
-    if (val) {
-        sscanf(val, "%d;%d;%d", &cfg.spontaneousEnable, &cfg.spontaneousMin, &cfg.spontaneousMax);
-        free(val);
-    }
-    val = readConfigValue(path, "MULTI");
-    if (val) { cfg.multiplier = atoi(val); free(val); }
-    val = readConfigValue(path, "SYNC");
-    if (val) { cfg.sync = atoi(val); free(val); }
-    val = readConfigValue(path, "DISCONNECTAFTERSEND");
-    if (val) { cfg.disconnectAfterSend = atoi(val); free(val); }
-
-    return cfg;
+// Zapíše zbývající logy a ukončí zapisovací vlákno
+static void stopLogging(void) {
+    uint64_t dropped = Logger_getDropped();
+    Logger_stop();
+    if (dropped > 0)
+        fprintf(stderr, "Log: %llu záznamů zahozeno kvůli plnému bufferu\n", (unsigned long long) dropped);
 }
 
 // =======================
@@ -526,6 +240,11 @@ CP24Time2a CP24Time2a_createFromMsTimestamp(CP24Time2a self, uint64_t msTimestam
 
 InformationObject createIO(int messageType, int ioa, float value) {
     InformationObject io = NULL;
+    // Časové značky a BCR se do IO kopírují, stačí je mít na zásobníku
+    struct sCP24Time2a ts24;
+    struct sCP56Time2a ts56;
+    struct sBinaryCounterReading bcrValue;
+    memset(&bcrValue, 0, sizeof(bcrValue));
     switch (messageType) {
         case 1: // Single Point Information
         {
@@ -536,7 +255,7 @@ InformationObject createIO(int messageType, int ioa, float value) {
         case 2: // Single Point w/ CP24Time2a
         {
             bool valbool = (value != 0.0);
-            CP24Time2a timestamp = CP24Time2a_createFromMsTimestamp(NULL, Hal_getTimeInMs());
+            CP24Time2a timestamp = CP24Time2a_createFromMsTimestamp(&ts24, Hal_getTimeInMs());
             io = (InformationObject) SinglePointWithCP24Time2a_create(NULL, ioa, valbool, IEC60870_QUALITY_GOOD, timestamp);
             break;
         }
@@ -549,7 +268,7 @@ InformationObject createIO(int messageType, int ioa, float value) {
         case 4: // Double Point w/ CP24Time2a
         {
             int valint = (int) value;
-            CP24Time2a timestamp = CP24Time2a_createFromMsTimestamp(NULL, Hal_getTimeInMs());
+            CP24Time2a timestamp = CP24Time2a_createFromMsTimestamp(&ts24, Hal_getTimeInMs());
             io = (InformationObject) DoublePointWithCP24Time2a_create(NULL, ioa, valint, IEC60870_QUALITY_GOOD, timestamp);
             break;
         }
@@ -562,7 +281,7 @@ InformationObject createIO(int messageType, int ioa, float value) {
         case 6: { // M_ST_TA_1 Step Position + CP24
             int val = (int)value;
             bool isTransient = false;
-            CP24Time2a ts = CP24Time2a_createFromMsTimestamp(NULL, Hal_getTimeInMs());
+            CP24Time2a ts = CP24Time2a_createFromMsTimestamp(&ts24, Hal_getTimeInMs());
             io = (InformationObject) StepPositionWithCP24Time2a_create(NULL, ioa, val, isTransient, IEC60870_QUALITY_GOOD, ts);
             break;
         }
@@ -574,7 +293,7 @@ InformationObject createIO(int messageType, int ioa, float value) {
         case 8: { // M_BO_TA_1 Bitstring32 + CP24
             uint32_t v = (uint32_t)((int)value);
             io = (InformationObject) Bitstring32WithCP24Time2a_createEx(NULL, ioa, v, IEC60870_QUALITY_GOOD,
-                                                                        CP24Time2a_createFromMsTimestamp(NULL, Hal_getTimeInMs()));
+                                                                        CP24Time2a_createFromMsTimestamp(&ts24, Hal_getTimeInMs()));
             break;
         }
         case 9: // Measured Normalized
@@ -584,7 +303,7 @@ InformationObject createIO(int messageType, int ioa, float value) {
         }
         case 10: // Measured Normalized w/ CP24Time2a
         {
-            CP24Time2a timestamp = CP24Time2a_createFromMsTimestamp(NULL, Hal_getTimeInMs());
+            CP24Time2a timestamp = CP24Time2a_createFromMsTimestamp(&ts24, Hal_getTimeInMs());
             io = (InformationObject) MeasuredValueNormalizedWithCP24Time2a_create(NULL, ioa, value, IEC60870_QUALITY_GOOD, timestamp);
             break;
         }
@@ -597,7 +316,7 @@ InformationObject createIO(int messageType, int ioa, float value) {
         case 12: // Measured Scaled w/ CP24Time2a
         {
             int valint = (int) value;
-            CP24Time2a timestamp = CP24Time2a_createFromMsTimestamp(NULL, Hal_getTimeInMs());
+            CP24Time2a timestamp = CP24Time2a_createFromMsTimestamp(&ts24, Hal_getTimeInMs());
             io = (InformationObject) MeasuredValueScaledWithCP24Time2a_create(NULL, ioa, valint, IEC60870_QUALITY_GOOD, timestamp);
             break;
         }
@@ -608,75 +327,75 @@ InformationObject createIO(int messageType, int ioa, float value) {
         }
         case 14: // Measured Short w/ CP24Time2a
         {
-            CP24Time2a timestamp = CP24Time2a_createFromMsTimestamp(NULL, Hal_getTimeInMs());
+            CP24Time2a timestamp = CP24Time2a_createFromMsTimestamp(&ts24, Hal_getTimeInMs());
             io = (InformationObject) MeasuredValueShortWithCP24Time2a_create(NULL, ioa, value, IEC60870_QUALITY_GOOD, timestamp);
             break;
         }
         case 15: { // M_IT_NA_1 Integrated totals (BCR)
-            BinaryCounterReading bcr = GLOBAL_CALLOC(1, sizeof(struct sBinaryCounterReading));
+            BinaryCounterReading bcr = &bcrValue;
             BinaryCounterReading_setValue(bcr, (int32_t)value);
             // volitelně: BinaryCounterReading_setSequenceNumber(bcr, 0); BinaryCounterReading_setCarry(bcr, false);
             io = (InformationObject) IntegratedTotals_create(NULL, ioa, bcr);
             break;
         }
         case 16: { // M_IT_TA_1 BCR + CP24
-            BinaryCounterReading bcr = GLOBAL_CALLOC(1, sizeof(struct sBinaryCounterReading));
+            BinaryCounterReading bcr = &bcrValue;
             BinaryCounterReading_setValue(bcr, (int32_t)value);
             io = (InformationObject) IntegratedTotalsWithCP24Time2a_create(NULL, ioa, bcr,
-                                                                           CP24Time2a_createFromMsTimestamp(NULL, Hal_getTimeInMs()));
+                                                                           CP24Time2a_createFromMsTimestamp(&ts24, Hal_getTimeInMs()));
             break;
         }
         case 30: // Single Point w/ CP56Time2a
         {
             bool valbool = (value != 0.0);
             io = (InformationObject) SinglePointWithCP56Time2a_create(NULL, ioa, valbool, IEC60870_QUALITY_GOOD,
-                                                                      CP56Time2a_createFromMsTimestamp(NULL, Hal_getTimeInMs()));
+                                                                      CP56Time2a_createFromMsTimestamp(&ts56, Hal_getTimeInMs()));
             break;
         }
         case 31: // Double Point w/ CP56Time2a
         {
             int valint = (int) value;
             io = (InformationObject) DoublePointWithCP56Time2a_create(NULL, ioa, valint, IEC60870_QUALITY_GOOD,
-                                                                      CP56Time2a_createFromMsTimestamp(NULL, Hal_getTimeInMs()));
+                                                                      CP56Time2a_createFromMsTimestamp(&ts56, Hal_getTimeInMs()));
             break;
         }
         case 32: { // M_ST_TB_1 Step Position + CP56
             int val = (int)value;
             bool isTransient = false;
             io = (InformationObject) StepPositionWithCP56Time2a_create(NULL, ioa, val, isTransient, IEC60870_QUALITY_GOOD,
-                                                                       CP56Time2a_createFromMsTimestamp(NULL, Hal_getTimeInMs()));
+                                                                       CP56Time2a_createFromMsTimestamp(&ts56, Hal_getTimeInMs()));
             break;
         }
         case 33: { // M_BO_TB_1 Bitstring32 + CP56
             uint32_t v = (uint32_t)((int)value);
             io = (InformationObject) Bitstring32WithCP56Time2a_createEx(NULL, ioa, v, IEC60870_QUALITY_GOOD,
-                                                                        CP56Time2a_createFromMsTimestamp(NULL, Hal_getTimeInMs()));
+                                                                        CP56Time2a_createFromMsTimestamp(&ts56, Hal_getTimeInMs()));
             break;
         }
         case 34: // Measured Normalized w/ CP56Time2a
         {
             io = (InformationObject) MeasuredValueNormalizedWithCP56Time2a_create(NULL, ioa, value, IEC60870_QUALITY_GOOD,
-                                                                                  CP56Time2a_createFromMsTimestamp(NULL, Hal_getTimeInMs()));
+                                                                                  CP56Time2a_createFromMsTimestamp(&ts56, Hal_getTimeInMs()));
             break;
         }
         case 35: // Measured Scaled w/ CP56Time2a
         {
             int valint = (int) value;
             io = (InformationObject) MeasuredValueScaledWithCP56Time2a_create(NULL, ioa, valint, IEC60870_QUALITY_GOOD,
-                                                                              CP56Time2a_createFromMsTimestamp(NULL, Hal_getTimeInMs()));
+                                                                              CP56Time2a_createFromMsTimestamp(&ts56, Hal_getTimeInMs()));
             break;
         }
         case 36: // Measured Short w/ CP56Time2a
         {
             io = (InformationObject) MeasuredValueShortWithCP56Time2a_create(NULL, ioa, value, IEC60870_QUALITY_GOOD,
-                                                                             CP56Time2a_createFromMsTimestamp(NULL, Hal_getTimeInMs()));
+                                                                             CP56Time2a_createFromMsTimestamp(&ts56, Hal_getTimeInMs()));
             break;
         }
         case 37: { // M_IT_TB_1 BCR + CP56
-            BinaryCounterReading bcr = GLOBAL_CALLOC(1, sizeof(struct sBinaryCounterReading));
+            BinaryCounterReading bcr = &bcrValue;
             BinaryCounterReading_setValue(bcr, (int32_t)value);
             io = (InformationObject) IntegratedTotalsWithCP56Time2a_create(NULL, ioa, bcr,
-                                                                           CP56Time2a_createFromMsTimestamp(NULL, Hal_getTimeInMs()));
+                                                                           CP56Time2a_createFromMsTimestamp(&ts56, Hal_getTimeInMs()));
             break;
         }
     }
@@ -687,63 +406,31 @@ InformationObject createIO(int messageType, int ioa, float value) {
 // FUNKCE PRO NAČTENÍ KONFIGURACE ZPRÁV (iec_config.txt)
 // =======================
 
-// Načte konfiguraci zpráv do globálního pole messageConfigs[]
+// Načte konfiguraci zpráv do globální tabulky bodů points (parser viz uni_config.c)
 void readMessageConfig(const char *filename) {
-    FILE *file = fopen(filename, "r");
-    if (!file) { perror("Failed to open configuration file"); return; }
-    char line[256];
-    int currentMessageType = -1;
-    bool currentPermanentFlag = false;
-    numMessageConfigs = 0;
-
-    while (fgets(line, sizeof(line), file) != NULL) {
-        // Odstraň nový řádek
-        line[strcspn(line, "\r\n")] = '\0';
-
-        int messageType, ioa;
-        float value1, value2;
-
-        if (strcmp(line, "PERM_MESS=") == 0) { currentPermanentFlag = true; continue; }
-        if (strcmp(line, "TEMP_MESS=") == 0) { currentPermanentFlag = false; continue; }
-        if (strlen(line) == 0 || strchr(line, '=') != NULL) continue;
-
-        // Nejprve dualní: typ;ioa;val1;val2
-        if (sscanf(line, "%d;%d;%f;%f", &messageType, &ioa, &value1, &value2) == 4) {
-            messageConfigs[numMessageConfigs].messageType = messageType;
-            messageConfigs[numMessageConfigs].ioContent[0].ioa = ioa;
-            messageConfigs[numMessageConfigs].ioContent[0].toggleValueA = value1;
-            messageConfigs[numMessageConfigs].ioContent[0].toggleValueB = value2;
-            messageConfigs[numMessageConfigs].ioContent[0].toggleEnabled = true;
-            messageConfigs[numMessageConfigs].ioContent[0].toggleState = false;
-            messageConfigs[numMessageConfigs].ioContentCount = 1;
-            messageConfigs[numMessageConfigs].isPermanent = currentPermanentFlag;
-            numMessageConfigs++;
-            continue;
-        }
-
-        // Pak statické: typ;ioa;val
-        if (sscanf(line, "%d;%d;%f", &messageType, &ioa, &value1) == 3) {
-            messageConfigs[numMessageConfigs].messageType = messageType;
-            messageConfigs[numMessageConfigs].ioContent[0].ioa = ioa;
-            messageConfigs[numMessageConfigs].ioContent[0].value = value1;
-            messageConfigs[numMessageConfigs].ioContent[0].toggleEnabled = false;
-            messageConfigs[numMessageConfigs].ioContentCount = 1;
-            messageConfigs[numMessageConfigs].isPermanent = currentPermanentFlag;
-            numMessageConfigs++;
-            continue;
-        }
+    if (points == NULL) {
+        points = PointTable_create(1024);
     }
-    fclose(file);
+    Config ignored;
+    ConfigFile_load(filename, &ignored, points);
 }
 
 // Handler pro odeslaný ASDU – vypíše, zaloguje, zpracuje IO podle typu
 static bool asduTransmitHandler(CS101_ASDU asdu) {
-    printf("TRANSMITTED ASDU - OA: %i CA: %i TYPE: %s(%i) NUMBER OF IOs: %i \n",
-           CS101_ASDU_getOA(asdu),
-           CS101_ASDU_getCA(asdu),
-           TypeID_toString(CS101_ASDU_getTypeID(asdu)),
-           CS101_ASDU_getTypeID(asdu),
-           CS101_ASDU_getNumberOfElements(asdu));
+    // V tichém režimu jen čítače, celé ASDU se vypíše vzorkovaně (datový log běží dál)
+    bool trace = true;
+    if (trafficStats) {
+        trace = TrafficStats_onAsdu(trafficStats, STATS_TX, CS101_ASDU_getTypeID(asdu), CS101_ASDU_getCOT(asdu),
+                                    CS101_ASDU_getNumberOfElements(asdu));
+        if (!trace && dataConfig == 0) return true;
+    }
+
+    TRACE("TRANSMITTED ASDU - OA: %i CA: %i TYPE: %s(%i) NUMBER OF IOs: %i \n",
+          CS101_ASDU_getOA(asdu),
+          CS101_ASDU_getCA(asdu),
+          TypeID_toString(CS101_ASDU_getTypeID(asdu)),
+          CS101_ASDU_getTypeID(asdu),
+          CS101_ASDU_getNumberOfElements(asdu));
 
     if (dataConfig == 1) { // Filtration of general messages
         LogTX(CS101_ASDU_getTypeID(asdu), CS101_ASDU_getNumberOfElements(asdu), CS101_ASDU_getOA(asdu),
@@ -752,11 +439,11 @@ static bool asduTransmitHandler(CS101_ASDU asdu) {
 
     switch (CS101_ASDU_getTypeID(asdu)) {
         case M_SP_NA_1: {
-            printf("  single point information:\n");
+            TRACE("  single point information:\n");
             for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 SinglePointInformation io = (SinglePointInformation) CS101_ASDU_getElement(asdu, i);
                 if (io == NULL) {
-                    printf("Error: Failed to retrieve information object at index %d.\n", i);
+                    TRACE("Error: Failed to retrieve information object at index %d.\n", i);
                     continue;
                 }
 
@@ -764,9 +451,9 @@ static bool asduTransmitHandler(CS101_ASDU asdu) {
                 bool booleanValue = (value != 0); // Assuming 0 is False, any non-zero is True
 
                 // Display the Information Object Address and the value in a descriptive format
-                printf("    IOA: %i value: %s\n",
-                       InformationObject_getObjectAddress((InformationObject) io),
-                       booleanValue ? "True" : "False");
+                TRACE("    IOA: %i value: %s\n",
+                      InformationObject_getObjectAddress((InformationObject) io),
+                      booleanValue ? "True" : "False");
 
                 // Conditionally log the data if logging is enabled
                 if (dataConfig == 1) {
@@ -775,24 +462,24 @@ static bool asduTransmitHandler(CS101_ASDU asdu) {
                 }
 
                 SinglePointInformation_destroy(io);
-                printf("\n"); // New line for each point for better readability
+                TRACE("\n"); // New line for each point for better readability
             }
             break;
         }
         case M_SP_TA_1: {
-            printf("  single point information with CP24Time2a timestamp:\n");
+            TRACE("  single point information with CP24Time2a timestamp:\n");
             int i;
             for (i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 SinglePointWithCP24Time2a io = (SinglePointWithCP24Time2a) CS101_ASDU_getElement(asdu, i);
                 bool value = SinglePointInformation_getValue(io); // Gets the boolean state
 
                 // Print the IOA, value as True/False, and the formatted timestamp
-                printf("    IOA: %i value: %s time: ",
-                       InformationObject_getObjectAddress((InformationObject) io),
-                       value ? "True" : "False");
+                TRACE("    IOA: %i value: %s time: ",
+                      InformationObject_getObjectAddress((InformationObject) io),
+                      value ? "True" : "False");
 
                 // Function to print the timestamp in a readable format
-                printCP24Time2a(SinglePointWithCP24Time2a_getTimestamp(io));
+                if (trace) printCP24Time2a(SinglePointWithCP24Time2a_getTimestamp(io));
 
                 // Optionally log the data if logging is enabled
                 if (dataConfig == 1) {
@@ -803,12 +490,12 @@ static bool asduTransmitHandler(CS101_ASDU asdu) {
 
                 // Cleanup after use
                 SinglePointWithCP24Time2a_destroy(io);
-                printf("\n"); // New line for each point for better readability
+                TRACE("\n"); // New line for each point for better readability
             }
             break;
         }
         case M_DP_NA_1: {
-            printf("  double point information:\n");
+            TRACE("  double point information:\n");
             int i;
             for (i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 DoublePointInformation io = (DoublePointInformation) CS101_ASDU_getElement(asdu, i);
@@ -834,8 +521,8 @@ static bool asduTransmitHandler(CS101_ASDU asdu) {
                 }
 
                 // Displaying the IOA and the descriptive value
-                printf("    IOA: %i value: %s\n", InformationObject_getObjectAddress((InformationObject) io),
-                       valueDescription);
+                TRACE("    IOA: %i value: %s\n", InformationObject_getObjectAddress((InformationObject) io),
+                      valueDescription);
 
                 // Conditionally log the data if logging is enabled
                 if (dataConfig == 1) {
@@ -844,12 +531,12 @@ static bool asduTransmitHandler(CS101_ASDU asdu) {
                 }
 
                 DoublePointInformation_destroy(io);
-                printf("\n");
+                TRACE("\n");
             }
             break;
         }
         case M_DP_TA_1: {
-            printf("  double point information with CP24Time2a timestamp:\n");
+            TRACE("  double point information with CP24Time2a timestamp:\n");
             int i;
             for (i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 DoublePointWithCP24Time2a io = (DoublePointWithCP24Time2a) CS101_ASDU_getElement(asdu, i);
@@ -875,11 +562,11 @@ static bool asduTransmitHandler(CS101_ASDU asdu) {
                 }
 
                 // Displaying the IOA, value description and timestamp
-                printf("    IOA: %i value: %s time: ", InformationObject_getObjectAddress((InformationObject) io),
-                       valueDescription);
+                TRACE("    IOA: %i value: %s time: ", InformationObject_getObjectAddress((InformationObject) io),
+                      valueDescription);
 
                 // Function to print time in a readable format
-                printCP24Time2a(DoublePointWithCP24Time2a_getTimestamp(io));
+                if (trace) printCP24Time2a(DoublePointWithCP24Time2a_getTimestamp(io));
 
                 // Optionally log the data if logging is enabled
                 if (dataConfig == 1) {
@@ -889,20 +576,20 @@ static bool asduTransmitHandler(CS101_ASDU asdu) {
                 }
 
                 DoublePointWithCP24Time2a_destroy(io);
-                printf("\n");  // Ensuring each entry is visually separated
+                TRACE("\n");  // Ensuring each entry is visually separated
             }
             break;
         }
         case M_ME_NA_1: {
-            printf("  measured value, normalized value:\n");
+            TRACE("  measured value, normalized value:\n");
             int i;
             for (i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 MeasuredValueNormalized io = (MeasuredValueNormalized) CS101_ASDU_getElement(asdu, i);
                 float normalizedValue = MeasuredValueNormalized_getValue(io);
 
                 // Display detailed information
-                printf("    IOA: %i, Normalized Value: %6.3f\n",
-                       InformationObject_getObjectAddress((InformationObject) io), normalizedValue);
+                TRACE("    IOA: %i, Normalized Value: %6.3f\n",
+                      InformationObject_getObjectAddress((InformationObject) io), normalizedValue);
 
                 // Optionally log the data if enabled
                 if (dataConfig == 1) {
@@ -912,12 +599,12 @@ static bool asduTransmitHandler(CS101_ASDU asdu) {
 
                 // Cleanup to avoid memory leaks
                 MeasuredValueNormalized_destroy(io);
-                printf("\n");  // Ensuring each entry is visually separated
+                TRACE("\n");  // Ensuring each entry is visually separated
             }
             break;
         }
         case M_ME_TA_1: {
-            printf("  measured normalized value with CP24Time2a timestamp:\n");
+            TRACE("  measured normalized value with CP24Time2a timestamp:\n");
             int i;
             for (i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 MeasuredValueNormalizedWithCP24Time2a io =
@@ -926,10 +613,10 @@ static bool asduTransmitHandler(CS101_ASDU asdu) {
                 CP24Time2a timestamp = MeasuredValueNormalizedWithCP24Time2a_getTimestamp(io);
 
                 // Display detailed information including time stamp
-                printf("    IOA: %i, Normalized Value: %6.3f, Timestamp: ",
-                       InformationObject_getObjectAddress((InformationObject) io),
-                       normalizedValue);
-                printCP24Time2a(timestamp);
+                TRACE("    IOA: %i, Normalized Value: %6.3f, Timestamp: ",
+                      InformationObject_getObjectAddress((InformationObject) io),
+                      normalizedValue);
+                if (trace) printCP24Time2a(timestamp);
 
                 // Optionally log the data if enabled
                 if (dataConfig == 1) {
@@ -939,12 +626,12 @@ static bool asduTransmitHandler(CS101_ASDU asdu) {
 
                 // Cleanup to avoid memory leaks
                 MeasuredValueNormalizedWithCP24Time2a_destroy(io);
-                printf("\n"); // Ensure each entry is on a new line
+                TRACE("\n"); // Ensure each entry is on a new line
             }
             break;
         }
         case M_ME_NB_1: {
-            printf("  measured value, scaled value:\n");
+            TRACE("  measured value, scaled value:\n");
             int i;
             for (i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 MeasuredValueScaled io =
@@ -952,9 +639,9 @@ static bool asduTransmitHandler(CS101_ASDU asdu) {
                 int value = MeasuredValueScaled_getValue(io); // Extract value
 
                 // Print IOA and value with better formatting
-                printf("    IOA: %i, Scaled Value: %d\n",
-                       InformationObject_getObjectAddress((InformationObject) io),
-                       value);
+                TRACE("    IOA: %i, Scaled Value: %d\n",
+                      InformationObject_getObjectAddress((InformationObject) io),
+                      value);
 
                 // Optionally log the data if data logging is enabled
                 if (dataConfig == 1) {
@@ -963,12 +650,12 @@ static bool asduTransmitHandler(CS101_ASDU asdu) {
 
                 // Cleanup to avoid memory leaks
                 MeasuredValueScaled_destroy(io);
-                printf("\n");  // Ensuring each entry is visually separated
+                TRACE("\n");  // Ensuring each entry is visually separated
             }
             break;
         }
         case M_ME_TB_1: {
-            printf("  measured value, scaled value with CP24Time2a timestamp:\n");
+            TRACE("  measured value, scaled value with CP24Time2a timestamp:\n");
             int i;
             for (i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 MeasuredValueScaled io =
@@ -976,10 +663,10 @@ static bool asduTransmitHandler(CS101_ASDU asdu) {
                 int value = MeasuredValueScaled_getValue(io); // Get the scaled value
 
                 // Print IOA, value and timestamp in a structured way
-                printf("    IOA: %i, value: %d, time: ",
-                       InformationObject_getObjectAddress((InformationObject) io),
-                       value);
-                printCP24Time2a(MeasuredValueScaledWithCP24Time2a_getTimestamp(io)); // Output the timestamp
+                TRACE("    IOA: %i, value: %d, time: ",
+                      InformationObject_getObjectAddress((InformationObject) io),
+                      value);
+                if (trace) printCP24Time2a(MeasuredValueScaledWithCP24Time2a_getTimestamp(io)); // Output the timestamp
 
                 // Optionally log the data if logging is enabled
                 if (dataConfig == 1) {
@@ -990,21 +677,21 @@ static bool asduTransmitHandler(CS101_ASDU asdu) {
 
                 // Cleanup after use
                 MeasuredValueScaledWithCP24Time2a_destroy(io);
-                printf("\n"); // Ensure new line for next data point
+                TRACE("\n"); // Ensure new line for next data point
             }
             break;
         }
         case M_ME_NC_1: {
-            printf("  measured value, short value:\n");
+            TRACE("  measured value, short value:\n");
             int i;
             for (i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 MeasuredValueShort io = (MeasuredValueShort) CS101_ASDU_getElement(asdu, i);
                 int value = MeasuredValueShort_getValue(io); // Get the short value
 
                 // Print the IOA and value with improved formatting for clarity
-                printf("    IOA: %i, value: %d\n",
-                       InformationObject_getObjectAddress((InformationObject) io),
-                       value);
+                TRACE("    IOA: %i, value: %d\n",
+                      InformationObject_getObjectAddress((InformationObject) io),
+                      value);
 
                 // Optionally log the data if logging is enabled
                 if (dataConfig == 1) {
@@ -1014,25 +701,25 @@ static bool asduTransmitHandler(CS101_ASDU asdu) {
 
                 // Cleanup after use
                 MeasuredValueShort_destroy(io);
-                printf("\n");  // Ensuring each entry is visually separated
+                TRACE("\n");  // Ensuring each entry is visually separated
             }
             break;
         }
 
         case M_ME_TC_1: { //TADY TOE DOBRY MYSLIM
-            printf("  measured value, short value with CP24Time2a timestamp:\n");
+            TRACE("  measured value, short value with CP24Time2a timestamp:\n");
             int i;
             for (i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 MeasuredValueShortWithCP24Time2a io = (MeasuredValueShortWithCP24Time2a) CS101_ASDU_getElement(asdu, i);
                 int value = MeasuredValueShort_getValue(io); // Get the short value
 
                 // Print the IOA, value, and format the timestamp
-                printf("    IOA: %i value: %d time: ",
-                       InformationObject_getObjectAddress((InformationObject) io),
-                       value);
+                TRACE("    IOA: %i value: %d time: ",
+                      InformationObject_getObjectAddress((InformationObject) io),
+                      value);
 
                 // Function to print the timestamp in a readable format
-                printCP24Time2a(MeasuredValueShortWithCP24Time2a_getTimestamp(io));
+                if (trace) printCP24Time2a(MeasuredValueShortWithCP24Time2a_getTimestamp(io));
 
                 // Optionally log the data if logging is enabled
                 if (dataConfig == 1) {
@@ -1042,24 +729,24 @@ static bool asduTransmitHandler(CS101_ASDU asdu) {
 
                 // Cleanup after use
                 MeasuredValueShortWithCP24Time2a_destroy(io);
-                printf("\n"); // New line for each point for better readability
+                TRACE("\n"); // New line for each point for better readability
             }
             break;
         }
         case M_SP_TB_1: {
-            printf("  single point information with CP56Time2a timestamp:\n");
+            TRACE("  single point information with CP56Time2a timestamp:\n");
             int i;
             for (i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 SinglePointWithCP56Time2a io = (SinglePointWithCP56Time2a) CS101_ASDU_getElement(asdu, i);
                 bool value = SinglePointInformation_getValue(io); // Gets the boolean state
 
                 // Print the IOA, value as True/False, and the formatted timestamp
-                printf("    IOA: %i value: %s time: ",
-                       InformationObject_getObjectAddress((InformationObject) io),
-                       value ? "True" : "False");
+                TRACE("    IOA: %i value: %s time: ",
+                      InformationObject_getObjectAddress((InformationObject) io),
+                      value ? "True" : "False");
 
                 // Function to print the timestamp in a readable format
-                printCP56Time2a(SinglePointWithCP56Time2a_getTimestamp(io));
+                if (trace) printCP56Time2a(SinglePointWithCP56Time2a_getTimestamp(io));
 
                 // Optionally log the data if logging is enabled
                 if (dataConfig == 1) {
@@ -1069,13 +756,13 @@ static bool asduTransmitHandler(CS101_ASDU asdu) {
 
                 // Cleanup after use
                 SinglePointWithCP56Time2a_destroy(io);
-                printf("\n"); // New line for each point for better readability
+                TRACE("\n"); // New line for each point for better readability
             }
             break;
         }
 
         case M_DP_TB_1: {
-            printf("  double point information with CP56Time2a timestamp:\n");
+            TRACE("  double point information with CP56Time2a timestamp:\n");
             int i;
             for (i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 DoublePointWithCP56Time2a io = (DoublePointWithCP56Time2a) CS101_ASDU_getElement(asdu, i);
@@ -1101,11 +788,11 @@ static bool asduTransmitHandler(CS101_ASDU asdu) {
                 }
 
                 // Displaying the IOA, descriptive value and timestamp
-                printf("    IOA: %i value: %s time: ", InformationObject_getObjectAddress((InformationObject) io),
-                       valueDescription);
+                TRACE("    IOA: %i value: %s time: ", InformationObject_getObjectAddress((InformationObject) io),
+                      valueDescription);
 
                 // Function to print time in a readable format
-                printCP56Time2a(DoublePointWithCP56Time2a_getTimestamp(io));
+                if (trace) printCP56Time2a(DoublePointWithCP56Time2a_getTimestamp(io));
 
                 // Optionally log the data if logging is enabled
                 if (dataConfig == 1) {
@@ -1115,7 +802,7 @@ static bool asduTransmitHandler(CS101_ASDU asdu) {
                 }
 
                 DoublePointWithCP56Time2a_destroy(io);
-                printf("\n");  // Ensuring each entry is visually separated
+                TRACE("\n");  // Ensuring each entry is visually separated
             }
             break;
         }
@@ -1127,7 +814,7 @@ static bool asduTransmitHandler(CS101_ASDU asdu) {
                         asdu, i);
                 float normalizedValue = MeasuredValueNormalized_getValue(io);
                 //InformationObject_getObjectAddress((InformationObject) io), normalizedValue;
-                printCP56Time2a(MeasuredValueNormalizedWithCP56Time2a_getTimestamp(io));
+                if (trace) printCP56Time2a(MeasuredValueNormalizedWithCP56Time2a_getTimestamp(io));
                 if (dataConfig == 1) {
                     LogTXwT(InformationObject_getObjectAddress((InformationObject) io),
                             MeasuredValueNormalized_getValue((MeasuredValueNormalized) io),
@@ -1135,12 +822,12 @@ static bool asduTransmitHandler(CS101_ASDU asdu) {
                 }
 
                 MeasuredValueNormalizedWithCP56Time2a_destroy(io);
-                printf("\n");  // Ensuring each entry is separated clearly
+                TRACE("\n");  // Ensuring each entry is separated clearly
             }
             break;
         }
         case M_ME_TE_1: {
-            printf("  measured scaled value with CP56Time2a timestamp:\n");
+            TRACE("  measured scaled value with CP56Time2a timestamp:\n");
 
             int i;
 
@@ -1149,180 +836,180 @@ static bool asduTransmitHandler(CS101_ASDU asdu) {
                                                                                                                  i);
                 int value = MeasuredValueScaled_getValue(io); // Extract value
                 // Assuming the values are scaled and should be displayed as floating-point for better precision
-                printf("    IOA: %i, value: %d, time: ",
-                       InformationObject_getObjectAddress((InformationObject) io),
-                       value);
-                printCP56Time2a(MeasuredValueScaledWithCP56Time2a_getTimestamp(io));
+                TRACE("    IOA: %i, value: %d, time: ",
+                      InformationObject_getObjectAddress((InformationObject) io),
+                      value);
+                if (trace) printCP56Time2a(MeasuredValueScaledWithCP56Time2a_getTimestamp(io));
                 if (dataConfig == 1) {
                     LogTXwT(InformationObject_getObjectAddress((InformationObject) io),
                             MeasuredValueScaled_getValue((MeasuredValueScaled) io),
                             MeasuredValueScaledWithCP56Time2a_getTimestamp(io));
                 }
                 MeasuredValueScaledWithCP56Time2a_destroy(io);
-                printf("\n"); // Adding a newline for better readability between entries
+                TRACE("\n"); // Adding a newline for better readability between entries
             }
             break;
         }
         case M_ME_TF_1: {
-            printf("  measured short float value with CP56Time2a timestamp:\n");
+            TRACE("  measured short float value with CP56Time2a timestamp:\n");
             int i;
             for (i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 MeasuredValueShortWithCP56Time2a io = (MeasuredValueShortWithCP56Time2a) CS101_ASDU_getElement(asdu, i);
-                printf("    IOA: %i value: %.2f time: ",
-                       InformationObject_getObjectAddress((InformationObject) io),
-                       MeasuredValueShort_getValue((MeasuredValueShort) io));
-                printCP56Time2a(MeasuredValueShortWithCP56Time2a_getTimestamp(io));
+                TRACE("    IOA: %i value: %.2f time: ",
+                      InformationObject_getObjectAddress((InformationObject) io),
+                      MeasuredValueShort_getValue((MeasuredValueShort) io));
+                if (trace) printCP56Time2a(MeasuredValueShortWithCP56Time2a_getTimestamp(io));
                 if (dataConfig == 1) {
                     LogTXwT(InformationObject_getObjectAddress((InformationObject) io),
                             MeasuredValueShort_getValue((MeasuredValueShort) io),
                             MeasuredValueShortWithCP56Time2a_getTimestamp(io));
                 }
                 MeasuredValueShortWithCP56Time2a_destroy(io);
-                printf("\n");
+                TRACE("\n");
             }
             break;
         }
             /* === NEW: Step position (5,6,32) === */
         case M_ST_NA_1: { // 5
-            printf("  step position information:\n");
+            TRACE("  step position information:\n");
             for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 StepPositionInformation io = (StepPositionInformation) CS101_ASDU_getElement(asdu, i);
                 int v = StepPositionInformation_getValue(io);            // -64..+63
                 bool tr = StepPositionInformation_isTransient(io);
-                printf("    IOA: %i value: %d transient: %s\n",
-                       InformationObject_getObjectAddress((InformationObject) io), v, tr ? "true" : "false");
+                TRACE("    IOA: %i value: %d transient: %s\n",
+                      InformationObject_getObjectAddress((InformationObject) io), v, tr ? "true" : "false");
                 if (dataConfig == 1) LogTXwoT(InformationObject_getObjectAddress((InformationObject) io), v);
                 StepPositionInformation_destroy(io);
-                printf("\n");
+                TRACE("\n");
             }
             break;
         }
         case M_ST_TA_1: { // 6 + CP24
-            printf("  step position information with CP24Time2a:\n");
+            TRACE("  step position information with CP24Time2a:\n");
             for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 StepPositionWithCP24Time2a io = (StepPositionWithCP24Time2a) CS101_ASDU_getElement(asdu, i);
                 int v = StepPositionInformation_getValue((StepPositionInformation) io);
                 bool tr = StepPositionInformation_isTransient((StepPositionInformation) io);
-                printf("    IOA: %i value: %d transient: %s time: ",
-                       InformationObject_getObjectAddress((InformationObject) io), v, tr ? "true" : "false");
-                printCP24Time2a(StepPositionWithCP24Time2a_getTimestamp(io));
+                TRACE("    IOA: %i value: %d transient: %s time: ",
+                      InformationObject_getObjectAddress((InformationObject) io), v, tr ? "true" : "false");
+                if (trace) printCP24Time2a(StepPositionWithCP24Time2a_getTimestamp(io));
                 if (dataConfig == 1) LogTXwT24(InformationObject_getObjectAddress((InformationObject) io), v,
                                                StepPositionWithCP24Time2a_getTimestamp(io));
                 StepPositionWithCP24Time2a_destroy(io);
-                printf("\n");
+                TRACE("\n");
             }
             break;
         }
         case M_ST_TB_1: { // 32 + CP56
-            printf("  step position information with CP56Time2a:\n");
+            TRACE("  step position information with CP56Time2a:\n");
             for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 StepPositionWithCP56Time2a io = (StepPositionWithCP56Time2a) CS101_ASDU_getElement(asdu, i);
                 int v = StepPositionInformation_getValue((StepPositionInformation) io);
                 bool tr = StepPositionInformation_isTransient((StepPositionInformation) io);
-                printf("    IOA: %i value: %d transient: %s time: ",
-                       InformationObject_getObjectAddress((InformationObject) io), v, tr ? "true" : "false");
-                printCP56Time2a(StepPositionWithCP56Time2a_getTimestamp(io));
+                TRACE("    IOA: %i value: %d transient: %s time: ",
+                      InformationObject_getObjectAddress((InformationObject) io), v, tr ? "true" : "false");
+                if (trace) printCP56Time2a(StepPositionWithCP56Time2a_getTimestamp(io));
                 if (dataConfig == 1) LogTXwT(InformationObject_getObjectAddress((InformationObject) io), v,
                                              StepPositionWithCP56Time2a_getTimestamp(io));
                 StepPositionWithCP56Time2a_destroy(io);
-                printf("\n");
+                TRACE("\n");
             }
             break;
         }
 
             /* === NEW: Bitstring32 (7,8,33) === */
         case M_BO_NA_1: { // 7
-            printf("  bitstring32 value:\n");
+            TRACE("  bitstring32 value:\n");
             for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 BitString32 io = (BitString32) CS101_ASDU_getElement(asdu, i);
                 uint32_t v = BitString32_getValue(io);
-                printf("    IOA: %i value: 0x%08x\n",
-                       InformationObject_getObjectAddress((InformationObject) io), v);
+                TRACE("    IOA: %i value: 0x%08x\n",
+                      InformationObject_getObjectAddress((InformationObject) io), v);
                 if (dataConfig == 1) LogTXwoT(InformationObject_getObjectAddress((InformationObject) io), (float)v);
                 BitString32_destroy(io);
-                printf("\n");
+                TRACE("\n");
             }
             break;
         }
         case M_BO_TA_1: { // 8 + CP24
-            printf("  bitstring32 value with CP24Time2a:\n");
+            TRACE("  bitstring32 value with CP24Time2a:\n");
             for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 Bitstring32WithCP24Time2a io = (Bitstring32WithCP24Time2a) CS101_ASDU_getElement(asdu, i);
                 uint32_t v = BitString32_getValue((BitString32) io);
-                printf("    IOA: %i value: 0x%08x time: ",
-                       InformationObject_getObjectAddress((InformationObject) io), v);
-                printCP24Time2a(Bitstring32WithCP24Time2a_getTimestamp(io));
+                TRACE("    IOA: %i value: 0x%08x time: ",
+                      InformationObject_getObjectAddress((InformationObject) io), v);
+                if (trace) printCP24Time2a(Bitstring32WithCP24Time2a_getTimestamp(io));
                 if (dataConfig == 1) LogTXwT24(InformationObject_getObjectAddress((InformationObject) io), (float)v,
                                                Bitstring32WithCP24Time2a_getTimestamp(io));
                 Bitstring32WithCP24Time2a_destroy(io);
-                printf("\n");
+                TRACE("\n");
             }
             break;
         }
         case M_BO_TB_1: { // 33 + CP56
-            printf("  bitstring32 value with CP56Time2a:\n");
+            TRACE("  bitstring32 value with CP56Time2a:\n");
             for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 Bitstring32WithCP56Time2a io = (Bitstring32WithCP56Time2a) CS101_ASDU_getElement(asdu, i);
                 uint32_t v = BitString32_getValue((BitString32) io);
-                printf("    IOA: %i value: 0x%08x time: ",
-                       InformationObject_getObjectAddress((InformationObject) io), v);
-                printCP56Time2a(Bitstring32WithCP56Time2a_getTimestamp(io));
+                TRACE("    IOA: %i value: 0x%08x time: ",
+                      InformationObject_getObjectAddress((InformationObject) io), v);
+                if (trace) printCP56Time2a(Bitstring32WithCP56Time2a_getTimestamp(io));
                 if (dataConfig == 1) LogTXwT(InformationObject_getObjectAddress((InformationObject) io), (float)v,
                                              Bitstring32WithCP56Time2a_getTimestamp(io));
                 Bitstring32WithCP56Time2a_destroy(io);
-                printf("\n");
+                TRACE("\n");
             }
             break;
         }
 
             /* === NEW: Integrated totals / BCR (15,16,37) === */
         case M_IT_NA_1: { // 15
-            printf("  integrated totals (BCR):\n");
+            TRACE("  integrated totals (BCR):\n");
             for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 IntegratedTotals io = (IntegratedTotals) CS101_ASDU_getElement(asdu, i);
                 BinaryCounterReading b = IntegratedTotals_getBCR(io);
                 int32_t val = BinaryCounterReading_getValue(b);
                 /* NOTE: některé verze knihovny nemají getCarry/getAdjusted -> nevolat */
                 /* int seq = BinaryCounterReading_getSequenceNumber(b);  // volitelné, pokud chceš */
-                printf("    IOA: %i value: %d\n",
-                       InformationObject_getObjectAddress((InformationObject) io), val);
+                TRACE("    IOA: %i value: %d\n",
+                      InformationObject_getObjectAddress((InformationObject) io), val);
                 if (dataConfig == 1) LogTXwoT(InformationObject_getObjectAddress((InformationObject) io), (float)val);
                 IntegratedTotals_destroy(io);
-                printf("\n");
+                TRACE("\n");
             }
             break;
         }
 
         case M_IT_TA_1: { // 16 + CP24
-            printf("  integrated totals (BCR) with CP24Time2a:\n");
+            TRACE("  integrated totals (BCR) with CP24Time2a:\n");
             for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 IntegratedTotalsWithCP24Time2a io = (IntegratedTotalsWithCP24Time2a) CS101_ASDU_getElement(asdu, i);
                 BinaryCounterReading b = IntegratedTotals_getBCR((IntegratedTotals) io);
                 int32_t val = BinaryCounterReading_getValue(b);
-                printf("    IOA: %i value: %d time: ",
-                       InformationObject_getObjectAddress((InformationObject) io), val);
-                printCP24Time2a(IntegratedTotalsWithCP24Time2a_getTimestamp(io));
+                TRACE("    IOA: %i value: %d time: ",
+                      InformationObject_getObjectAddress((InformationObject) io), val);
+                if (trace) printCP24Time2a(IntegratedTotalsWithCP24Time2a_getTimestamp(io));
                 if (dataConfig == 1) LogTXwT24(InformationObject_getObjectAddress((InformationObject) io), (float)val,
                                                IntegratedTotalsWithCP24Time2a_getTimestamp(io));
                 IntegratedTotalsWithCP24Time2a_destroy(io);
-                printf("\n");
+                TRACE("\n");
             }
             break;
         }
 
         case M_IT_TB_1: { // 37 + CP56
-            printf("  integrated totals (BCR) with CP56Time2a:\n");
+            TRACE("  integrated totals (BCR) with CP56Time2a:\n");
             for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 IntegratedTotalsWithCP56Time2a io = (IntegratedTotalsWithCP56Time2a) CS101_ASDU_getElement(asdu, i);
                 BinaryCounterReading b = IntegratedTotals_getBCR((IntegratedTotals) io);
                 int32_t val = BinaryCounterReading_getValue(b);
-                printf("    IOA: %i value: %d time: ",
-                       InformationObject_getObjectAddress((InformationObject) io), val);
-                printCP56Time2a(IntegratedTotalsWithCP56Time2a_getTimestamp(io));
+                TRACE("    IOA: %i value: %d time: ",
+                      InformationObject_getObjectAddress((InformationObject) io), val);
+                if (trace) printCP56Time2a(IntegratedTotalsWithCP56Time2a_getTimestamp(io));
                 if (dataConfig == 1) LogTXwT(InformationObject_getObjectAddress((InformationObject) io), (float)val,
                                              IntegratedTotalsWithCP56Time2a_getTimestamp(io));
                 IntegratedTotalsWithCP56Time2a_destroy(io);
-                printf("\n");
+                TRACE("\n");
             }
             break;
         }
@@ -1334,33 +1021,82 @@ static bool asduTransmitHandler(CS101_ASDU asdu) {
 
 
 
+// =======================
+// PERIODICKÉ ZPRÁVY PŘES PŘEDKÓDOVANÉ ŠABLONY
+// =======================
+
+// Jednou "zkompiluje" tabulku bodů do šablon ASDU (volat po readMessageConfig a po výměně tabulky)
+void compilePeriodicTemplates(CS101_AppLayerParameters alParams) {
+    PeriodicSet_destroy(periodicSet);
+    periodicSet = PeriodicSet_create(alParams, points, originatorAddress, commonAddress);
+}
+
+// Odeslání ASDU periodické skupiny: výpis, multiplikace a zařazení do fronty
+static void sendPeriodicAsdu(void *parameter, uint32_t periodMs, int index, CS101_ASDU asdu) {
+    PeriodicTarget *target = (PeriodicTarget *) parameter;
+    if (index == 0 && trafficStats == NULL) {
+        if (periodMs == 0)
+            printf("%s Posílám periodické zprávy:\n", target->label);
+        else
+            printf("%s Posílám periodické zprávy (perioda %u ms):\n", target->label, periodMs);
+    }
+    // Multiplikace (pošle stejnou zprávu vícekrát)
+    for (int m = 0; m < multiplier; ++m) {
+        target->enqueue(target->target, asdu);
+        asduTransmitHandler(asdu);
+    }
+}
+
+// Založí časovače pro všechny skupiny periodických zpráv
+static void startPeriodicTimers(TimerWheel wheel, int defaultPeriodMs, EnqueueFunction enqueue, void *target,
+                                const char *label) {
+    if (periodicSet == NULL) return;
+    periodicTarget.enqueue = enqueue;
+    periodicTarget.target = target;
+    periodicTarget.label = label;
+    PeriodicSet_start(periodicSet, wheel, defaultPeriodMs, 0, sendPeriodicAsdu, &periodicTarget);
+}
+
+// Zruší časovače všech skupin periodických zpráv (před novou kompilací šablon)
+static void stopPeriodicTimers(void) {
+    if (periodicSet) PeriodicSet_stop(periodicSet);
+}
+
+static void enqueue104(void *target, CS101_ASDU asdu) {
+    CS104_Slave_enqueueASDU((CS104_Slave) target, asdu);
+}
+
+static void enqueue101(void *target, CS101_ASDU asdu) {
+    CS101_Slave_enqueueUserDataClass1((CS101_Slave) target, asdu);
+}
+
+// Typy, ze kterých se vybírají spontánní zprávy (s časovou značkou CP56)
+static bool isSpontaneousType(int type) {
+    return type == 30 || type == 31 || type == 34 || type == 35 || type == 36;
+}
+
 // Odešle spontánní zprávu (náhodně z vybraných typů pro spontánní)
 void sendSpontaneousMessage104(CS104_Slave slave, CS101_AppLayerParameters alparams, int multiplier) {
     CS101_ASDU newAsdu = CS101_ASDU_create(alparams, true, CS101_COT_SPONTANEOUS, originatorAddress, commonAddress,
                                            false, false);
-    InformationObject ios[MAX_MESSAGES];
+    // Spočítej body vhodné pro spontánní zprávy a jeden z nich náhodně vyber
     int numSpontIos = 0;
-    // Projdi konfiguraci, najdi správné typy pro spontánní zprávy
-    for (int i = 0; i < numMessageConfigs; ++i) {
-        if (messageConfigs[i].messageType != 30 &&
-            messageConfigs[i].messageType != 31 &&
-            messageConfigs[i].messageType != 34 &&
-            messageConfigs[i].messageType != 35 &&
-            messageConfigs[i].messageType != 36) {
-            continue;
-        }
-        MessageConfig msg = messageConfigs[i];
-        for (int j = 0; j < msg.ioContentCount; ++j) {
-            IOContent ioContent = msg.ioContent[j];
-            ios[numSpontIos] = createIO(msg.messageType, ioContent.ioa, ioContent.value);
+    for (int i = 0; i < points->count; ++i) {
+        if (isSpontaneousType(points->type[i])) {
             ++numSpontIos;
         }
     }
     InformationObject io;
     // Vyber náhodně jednu IO nebo použij defaultní, pokud nejsou žádné
     if (numSpontIos != 0) {
-        int index = rand() % (numSpontIos);
-        io = ios[index];
+        int selected = rand() % (numSpontIos);
+        int i = 0;
+        for (; i < points->count; ++i) {
+            if (isSpontaneousType(points->type[i]) && selected-- == 0) {
+                break;
+            }
+        }
+        io = createIO(points->type[i], points->ioa[i], points->value[i]);
     } else {
         io = (InformationObject) SinglePointWithCP56Time2a_create(NULL, 9999, 1, IEC60870_QUALITY_GOOD,
                                                                   CP56Time2a_createFromMsTimestamp(NULL, Hal_getTimeInMs()));
@@ -1370,9 +1106,7 @@ void sendSpontaneousMessage104(CS104_Slave slave, CS101_AppLayerParameters alpar
         CS104_Slave_enqueueASDU(slave, newAsdu);
         asduTransmitHandler(newAsdu);
     }
-    if (numSpontIos == 0) {
-        InformationObject_destroy(io);
-    }
+    InformationObject_destroy(io);
     CS101_ASDU_destroy(newAsdu);
 }
 
@@ -1380,29 +1114,24 @@ void sendSpontaneousMessage104(CS104_Slave slave, CS101_AppLayerParameters alpar
 void sendSpontaneousMessage101(CS104_Slave slave, CS101_AppLayerParameters alparams, int multiplier) {
     CS101_ASDU newAsdu = CS101_ASDU_create(alparams, true, CS101_COT_SPONTANEOUS, originatorAddress, commonAddress,
                                            false, false);
-    InformationObject ios[MAX_MESSAGES];
+    // Spočítej body vhodné pro spontánní zprávy a jeden z nich náhodně vyber
     int numSpontIos = 0;
-    // Projdi konfiguraci, najdi správné typy pro spontánní zprávy
-    for (int i = 0; i < numMessageConfigs; ++i) {
-        if (messageConfigs[i].messageType != 30 &&
-            messageConfigs[i].messageType != 31 &&
-            messageConfigs[i].messageType != 34 &&
-            messageConfigs[i].messageType != 35 &&
-            messageConfigs[i].messageType != 36) {
-            continue;
-        }
-        MessageConfig msg = messageConfigs[i];
-        for (int j = 0; j < msg.ioContentCount; ++j) {
-            IOContent ioContent = msg.ioContent[j];
-            ios[numSpontIos] = createIO(msg.messageType, ioContent.ioa, ioContent.value);
+    for (int i = 0; i < points->count; ++i) {
+        if (isSpontaneousType(points->type[i])) {
             ++numSpontIos;
         }
     }
     InformationObject io;
     // Vyber náhodně jednu IO nebo použij defaultní, pokud nejsou žádné
     if (numSpontIos != 0) {
-        int index = rand() % (numSpontIos);
-        io = ios[index];
+        int selected = rand() % (numSpontIos);
+        int i = 0;
+        for (; i < points->count; ++i) {
+            if (isSpontaneousType(points->type[i]) && selected-- == 0) {
+                break;
+            }
+        }
+        io = createIO(points->type[i], points->ioa[i], points->value[i]);
     } else {
         io = (InformationObject) SinglePointWithCP56Time2a_create(NULL, 9999, 1, IEC60870_QUALITY_GOOD,
                                                                   CP56Time2a_createFromMsTimestamp(NULL, Hal_getTimeInMs()));
@@ -1412,35 +1141,1410 @@ void sendSpontaneousMessage101(CS104_Slave slave, CS101_AppLayerParameters alpar
         CS101_Slave_enqueueUserDataClass1(slave, newAsdu);
         asduTransmitHandler(newAsdu);
     }
-    if (numSpontIos == 0) {
+    InformationObject_destroy(io);
+    CS101_ASDU_destroy(newAsdu);
+}
+
+
+// Nastaví parametry spontánních zpráv z řetězce "1;min;max" (min/max jako PERIOD, např. 2 nebo 500ms)
+void configureSpontaneousMessages(const char *config) {
+    char *configCopy = strdup(config);
+    char *token = strtok(configCopy, ";");
+    if (token && atoi(token) == 1) {
+        spontaneousEnabled = true;
+        token = strtok(NULL, ";");
+        int64_t ms = TimerWheel_parseDuration(token);
+        if (ms >= 0) minSpontaneousInterval = (int) ms;
+        token = strtok(NULL, ";");
+        ms = TimerWheel_parseDuration(token);
+        if (ms >= 0) maxSpontaneousInterval = (int) ms;
+    }
+    free(configCopy);
+}
+
+// Náhodná prodleva do další spontánní zprávy v intervalu <min, max> ms
+static int getNextSpontaneousDelay(void) {
+    if (maxSpontaneousInterval <= minSpontaneousInterval) return minSpontaneousInterval;
+    return minSpontaneousInterval + rand() % (maxSpontaneousInterval - minSpontaneousInterval + 1);
+}
+
+// Stav časovače spontánních zpráv (104 nebo 101 slave)
+typedef struct {
+    TimerWheel wheel;
+    Timer timer;
+    bool is104;
+    void *slave;
+    CS101_AppLayerParameters alParams;
+    const char *label;
+} SpontaneousContext;
+
+// Callback časovače: pošle spontánní zprávu a naplánuje další s náhodnou prodlevou
+static void onSpontaneousTimer(void *parameter, uint64_t now) {
+    (void) now;
+    SpontaneousContext *ctx = (SpontaneousContext *) parameter;
+    if (trafficStats == NULL) printf("%s Posílám spontánní zprávu...\n", ctx->label);
+    if (ctx->is104)
+        sendSpontaneousMessage104((CS104_Slave) ctx->slave, ctx->alParams, multiplier);
+    else
+        sendSpontaneousMessage101((CS104_Slave) ctx->slave, ctx->alParams, multiplier);
+    TimerWheel_start(ctx->wheel, ctx->timer, getNextSpontaneousDelay(), 0);
+}
+
+// Naplánuje první spontánní zprávu (pokud jsou povolené)
+static void startSpontaneousTimer(SpontaneousContext *ctx) {
+    if (!spontaneousEnabled) return;
+    ctx->timer = TimerWheel_addTimer(ctx->wheel, onSpontaneousTimer, ctx);
+    TimerWheel_start(ctx->wheel, ctx->timer, getNextSpontaneousDelay(), 0);
+}
+
+// Cíl spontánních zpráv pro CS101_ASDU_pack
+typedef struct {
+    EnqueueFunction enqueue;
+    void *target;
+} SpontaneousTarget;
+
+static void enqueueSpontaneous(void *parameter, CS101_ASDU asdu) {
+    SpontaneousTarget *target = (SpontaneousTarget *) parameter;
+    for (int m = 0; m < multiplier; ++m) {
+        target->enqueue(target->target, asdu);
+        asduTransmitHandler(asdu);
+    }
+}
+
+// Pošle body jako spontánní zprávy (COT 3) zabalené po typech; indexy musí být seřazené
+// podle typu a IOA, duplicitní IOA se pošle jen jednou. Typy s časovou značkou (30/31/34/35/36,
+// CP24) CS101_ASDU_pack nikdy nebalí do sekvence – norma je definuje jen se SQ=0.
+static void sendSpontaneousPoints(CS101_AppLayerParameters alParams, EnqueueFunction enqueue, void *target,
+                                  const int32_t *indexes, int count) {
+    SpontaneousTarget spontaneousTarget = {enqueue, target};
+    InformationObject ios[GI_BATCH_SIZE];
+    int numIos = 0;
+    int lastIoa = -1;
+
+    for (int c = 0; c <= count; ++c) {
+        int p = (c < count) ? indexes[c] : -1;
+
+        if (numIos > 0 && (p < 0 || numIos == GI_BATCH_SIZE || points->type[p] != InformationObject_getType(ios[0]))) {
+            if (CS101_ASDU_pack(alParams, CS101_COT_SPONTANEOUS, originatorAddress, commonAddress, false, false,
+                                ios, numIos, enqueueSpontaneous, &spontaneousTarget) < 0) {
+                fprintf(stderr, "Failed to pack IOs of type %d\n", InformationObject_getType(ios[0]));
+            }
+            for (int i = 0; i < numIos; i++) {
+                InformationObject_destroy(ios[i]);
+            }
+            numIos = 0;
+            lastIoa = -1;
+        }
+
+        if (p < 0) break;
+        if (numIos > 0 && points->ioa[p] == lastIoa) continue; // Duplicitní IOA jen jednou
+
+        InformationObject io = createIO(points->type[p], points->ioa[p], points->value[p]);
+        if (io != NULL) {
+            ios[numIos++] = io;
+            lastIoa = points->ioa[p];
+        }
+    }
+}
+
+
+// =======================
+// GENERÁTORY HODNOT (GEN=) A DETEKCE ZMĚN (DEADBAND, DB=), jen server
+// =======================
+
+#define DEFAULT_GENERATOR_TICK_MS 100
+
+// Stav časovače generátorů jednoho serveru
+typedef struct {
+    TimerWheel wheel;
+    Timer timer;
+    uint64_t lastMs;
+    CS101_AppLayerParameters alParams;
+    EnqueueFunction enqueue;
+    void *target;
+} GeneratorContext;
+
+// Detektor změn, pokud je zadán DEADBAND nebo má některý bod volbu DB=
+static ChangeDetector createChangeDetector(Config *cfg) {
+    bool enabled = cfg->deadbandEnable;
+    for (int i = 0; i < points->count && !enabled; ++i)
+        enabled = (points->flags[i] & POINT_FLAG_DEADBAND) != 0;
+    if (!enabled) return NULL;
+    return ChangeDetector_create(points, cfg->deadband, cfg->deadbandPercent);
+}
+
+// Callback časovače: posune generátory o uplynulý čas (GI čte hodnoty z jiných vláken)
+// a body změněné o víc než deadband pošle jako spontánní zprávy
+static void onGeneratorTimer(void *parameter, uint64_t now) {
+    GeneratorContext *ctx = (GeneratorContext *) parameter;
+    uint32_t dtMs = (uint32_t) (now - ctx->lastMs);
+    ctx->lastMs = now;
+
+    if (generators == NULL && changeDetector == NULL) return;
+
+    // Porovnání čte hodnoty, které commandy mění ve vláknech spojení – běží pod zámkem, posílá se až po něm
+    const int32_t *changes = NULL;
+    int numChanges = 0;
+    Semaphore_wait(pointsLock);
+    if (generators) {
+        GeneratorSet_update(generators, points, dtMs);
+        GiCache_invalidateGenerated(giCache);
+    }
+    if (changeDetector)
+        numChanges = ChangeDetector_scan(changeDetector, points, &changes);
+    Semaphore_post(pointsLock);
+
+    if (numChanges > 0)
+        sendSpontaneousPoints(ctx->alParams, ctx->enqueue, ctx->target, changes, numChanges);
+}
+
+// Sestaví generátory a detektor změn z tabulky bodů; časovač běží vždy, aby je mohl přidat i hot reload
+static void startGenerators(GeneratorContext *ctx, Config *cfg, const char *label) {
+    generators = GeneratorSet_create(points);
+    changeDetector = createChangeDetector(cfg);
+    int tickMs = cfg->generatorTickMs > 0 ? cfg->generatorTickMs : DEFAULT_GENERATOR_TICK_MS;
+    ctx->lastMs = TimerWheel_now(ctx->wheel);
+    ctx->timer = TimerWheel_addTimer(ctx->wheel, onGeneratorTimer, ctx);
+    TimerWheel_start(ctx->wheel, ctx->timer, tickMs, tickMs);
+    if (generators)
+        printf("%s Generátory hodnot: %d bodů, přepočet každých %d ms\n", label, GeneratorSet_getCount(generators), tickMs);
+    if (changeDetector)
+        printf("%s Spontánní zprávy jen ze změn nad deadband (výchozí %g%s), kontrola každých %d ms\n",
+               label, cfg->deadband, cfg->deadbandPercent ? " %" : "", tickMs);
+}
+
+static void stopGenerators(void) {
+    GeneratorSet_destroy(generators);
+    generators = NULL;
+    ChangeDetector_destroy(changeDetector);
+    changeDetector = NULL;
+}
+
+
+// =======================
+// SDÍLENÉ BODY PRO EXTERNÍ ZDROJ HODNOT (SHAREDPOINTS, jen server)
+// =======================
+
+#define DEFAULT_SHARED_SCAN_MS 10
+
+// Stav časovače sdílených bodů jednoho serveru
+typedef struct {
+    TimerWheel wheel;
+    Timer timer;
+    CS101_AppLayerParameters alParams;
+    EnqueueFunction enqueue;
+    void *target;
+} SharedContext;
+
+// Callback časovače: převezme zápisy zdroje do tabulky (GI čte hodnoty z jiných vláken). Změny pošle
+// jako spontánní zprávy, s detekcí změn (DEADBAND) je pošle detektor, až přesáhnou deadband.
+static void onSharedTimer(void *parameter, uint64_t now) {
+    (void) now;
+    SharedContext *ctx = (SharedContext *) parameter;
+    const int32_t *changes;
+
+    Semaphore_wait(pointsLock);
+    int numChanges = SharedPoints_scan(sharedPoints, points, &changes);
+    for (int c = 0; c < numChanges; ++c)
+        GiCache_invalidate(giCache, points, changes[c]);
+    Semaphore_post(pointsLock);
+
+    if (numChanges > 0 && changeDetector == NULL)
+        sendSpontaneousPoints(ctx->alParams, ctx->enqueue, ctx->target, changes, numChanges);
+}
+
+// Vystaví tabulku bodů v souboru SHAREDPOINTS a naplánuje převzetí změn
+static void startSharedPoints(SharedContext *ctx, Config *cfg, const char *label) {
+    if (cfg->sharedPointsPath[0] == '\0') return;
+    sharedPoints = SharedPoints_create(cfg->sharedPointsPath, points);
+    if (sharedPoints == NULL) {
+        printf("%s Sdílené body %s nelze vytvořit\n", label, cfg->sharedPointsPath);
+        return;
+    }
+    int scanMs = cfg->sharedScanMs > 0 ? cfg->sharedScanMs : DEFAULT_SHARED_SCAN_MS;
+    ctx->timer = TimerWheel_addTimer(ctx->wheel, onSharedTimer, ctx);
+    TimerWheel_start(ctx->wheel, ctx->timer, scanMs, scanMs);
+    printf("%s Sdílené body: %s (%d bodů), převzetí změn každých %d ms\n", label, cfg->sharedPointsPath,
+           SharedPoints_getCount(sharedPoints), scanMs);
+}
+
+// Volat až po zrušení časovačů (kola)
+static void stopSharedPoints(const char *label) {
+    if (sharedPoints == NULL) return;
+    printf("%s Sdílené body: převzato %llu hodnot\n", label,
+           (unsigned long long) SharedPoints_getUpdates(sharedPoints));
+    SharedPoints_destroy(sharedPoints);
+    sharedPoints = NULL;
+}
+
+
+// =======================
+// PŘEHRÁVÁNÍ ZÁZNAMU HODNOT DO TABULKY BODŮ (PLAYBACK, jen server)
+// =======================
+
+#define PLAYBACK_TICK_MS 10
+#define PLAYBACK_REPORT_MS 10000
+
+// Stav přehrávání záznamu hodnot jednoho serveru
+typedef struct {
+    TimerWheel wheel;
+    Timer timer;
+    Timer reportTimer;
+    CS101_AppLayerParameters alParams;
+    EnqueueFunction enqueue;
+    void *target;
+    float speed;
+    bool started;
+    uint64_t startMs;
+    const char *label;
+} PlaybackContext;
+
+static void printPlaybackProgress(PlaybackContext *ctx, const char *what) {
+    uint64_t records, unknown, invalid;
+    double percent;
+    ValuePlayback_getProgress(valuePlayback, &records, &unknown, &invalid, &percent);
+    printf("%s %s: %llu záznamů (%.1f %% souboru)", ctx->label, what, (unsigned long long) records, percent);
+    if (unknown > 0) printf(", neznámé IOA %llu", (unsigned long long) unknown);
+    if (invalid > 0) printf(", vadné řádky %llu", (unsigned long long) invalid);
+    printf("\n");
+}
+
+// Callback časovače: zapíše do tabulky záznamy, jejichž čas (dělený rychlostí) už nastal, a změny
+// pošle jako spontánní zprávy (s detekcí změn je pošle detektor, až přesáhnou deadband)
+static void onPlaybackTimer(void *parameter, uint64_t now) {
+    PlaybackContext *ctx = (PlaybackContext *) parameter;
+    const int32_t *changes;
+
+    if (!ctx->started) {
+        ctx->started = true;
+        ctx->startMs = now;
+        ValuePlayback_start(valuePlayback, now, ctx->speed);
+    }
+
+    Semaphore_wait(pointsLock);
+    int numChanges = ValuePlayback_advance(valuePlayback, points, now, &changes);
+    for (int c = 0; c < numChanges; ++c)
+        GiCache_invalidate(giCache, points, changes[c]);
+    Semaphore_post(pointsLock);
+
+    if (numChanges > 0 && changeDetector == NULL)
+        sendSpontaneousPoints(ctx->alParams, ctx->enqueue, ctx->target, changes, numChanges);
+
+    if (ValuePlayback_isFinished(valuePlayback)) {
+        char what[64];
+        snprintf(what, sizeof(what), "Přehrávání hodnot dokončeno za %.2f s", (now - ctx->startMs) / 1000.0);
+        printPlaybackProgress(ctx, what);
+        TimerWheel_stop(ctx->wheel, ctx->timer);
+        TimerWheel_stop(ctx->wheel, ctx->reportTimer);
+    }
+}
+
+static void onPlaybackReportTimer(void *parameter, uint64_t now) {
+    (void) now;
+    PlaybackContext *ctx = (PlaybackContext *) parameter;
+    if (ctx->started) printPlaybackProgress(ctx, "Přehráno hodnot");
+}
+
+// Otevře záznam PLAYBACK=soubor;rychlost a naplánuje přehrávání
+static void startPlayback(PlaybackContext *ctx, Config *cfg) {
+    if (cfg->playbackPath[0] == '\0') return;
+    valuePlayback = ValuePlayback_open(cfg->playbackPath, points);
+    if (valuePlayback == NULL) {
+        printf("%s Chyba: Záznam hodnot %s nelze přehrát\n", ctx->label, cfg->playbackPath);
+        return;
+    }
+    ctx->speed = cfg->playbackSpeed;
+    ctx->timer = TimerWheel_addTimer(ctx->wheel, onPlaybackTimer, ctx);
+    TimerWheel_start(ctx->wheel, ctx->timer, PLAYBACK_TICK_MS, PLAYBACK_TICK_MS);
+    ctx->reportTimer = TimerWheel_addTimer(ctx->wheel, onPlaybackReportTimer, ctx);
+    TimerWheel_start(ctx->wheel, ctx->reportTimer, PLAYBACK_REPORT_MS, PLAYBACK_REPORT_MS);
+
+    if (ctx->speed > 0)
+        printf("%s PLAYBACK: %s rychlostí %gx (náhodné spontánní zprávy vypnuty)\n", ctx->label,
+               cfg->playbackPath, ctx->speed);
+    else
+        printf("%s PLAYBACK: %s co nejrychleji (náhodné spontánní zprávy vypnuty)\n", ctx->label,
+               cfg->playbackPath);
+}
+
+// Volat až po zrušení časovačů (kola)
+static void stopPlayback(void) {
+    ValuePlayback_close(valuePlayback);
+    valuePlayback = NULL;
+}
+
+// =======================
+// VYKONÁVÁNÍ COMMANDŮ (COMMANDDELAY, CMD=, DELAY=, jen server)
+// =======================
+
+#define COMMAND_TICK_MS 5              // Přesnost termínů vykonání
+#define COMMAND_CAPACITY 100000        // Max. čekajících commandů, další se odmítnou
+#define DEFAULT_SELECT_TIMEOUT_MS 10000
+
+// Stav časovače commandů jednoho serveru
+typedef struct {
+    TimerWheel wheel;
+    Timer timer;
+    CS101_AppLayerParameters alParams;
+    const char *label;
+} CommandContext;
+
+// Okamžitá odpověď z asduHandleru podle verdiktu enginu (ASDU se tím změní)
+static void respondCommand(IMasterConnection connection, CS101_ASDU asdu, CommandVerdict verdict) {
+    if (verdict == COMMAND_UNKNOWN_IOA) {
+        CS101_ASDU_setCOT(asdu, CS101_COT_UNKNOWN_IOA);
+        CS101_ASDU_setNegative(asdu, true);
+        IMasterConnection_sendASDU(connection, asdu);
+    } else if (verdict == COMMAND_CONFIRM || verdict == COMMAND_REJECT) {
+        bool negative = verdict == COMMAND_REJECT;
+        if (CS101_ASDU_getCOT(asdu) == CS101_COT_DEACTIVATION) {
+            CS101_ASDU_setCOT(asdu, CS101_COT_DEACTIVATION_CON);
+            CS101_ASDU_setNegative(asdu, negative);
+            IMasterConnection_sendASDU(connection, asdu);
+        } else {
+            IMasterConnection_sendACT_CON(connection, asdu, negative);
+        }
+    }
+}
+
+// Vykonání commandu po uplynutí doby: ACT_CON, nová hodnota stavového bodu (zpětné hlášení COT 11
+// stejnému spojení, aby přišlo před ACT_TERM) a ACT_TERM
+static void executeCommand(void *parameter, IMasterConnection connection, CS101_ASDU asdu, int point, float value) {
+    CommandContext *ctx = (CommandContext *) parameter;
+
+    if (point < 0) {
+        IMasterConnection_sendACT_CON(connection, asdu, true);
+        return;
+    }
+    IMasterConnection_sendACT_CON(connection, asdu, false);
+
+    Semaphore_wait(pointsLock);
+    if (points->value[point] != value) {
+        PointTable_setValues(points, point, value, value);
+        GiCache_invalidate(giCache, points, point);
+    }
+    InformationObject io = createIO(points->type[point], points->ioa[point], points->value[point]);
+    Semaphore_post(pointsLock);
+
+    if (io != NULL) {
+        sCS101_StaticASDU storage;
+        CS101_ASDU report = CS101_ASDU_initializeStatic(&storage, ctx->alParams, false, CS101_COT_RETURN_INFO_REMOTE,
+                                                        originatorAddress, commonAddress, false, false);
+        CS101_ASDU_addInformationObject(report, io);
         InformationObject_destroy(io);
+        IMasterConnection_sendASDU(connection, report);
+        asduTransmitHandler(report);
     }
-    CS101_ASDU_destroy(newAsdu);
+
+    IMasterConnection_sendACT_TERM(connection, asdu);
+}
+
+static void onCommandTimer(void *parameter, uint64_t now) {
+    (void) now;
+    CommandEngine_process(commandEngine, executeCommand, parameter);
+}
+
+// Engine vzniká před spuštěním serveru – asduHandler ho čte z vláken spojení
+static void createCommandEngine(Config *cfg, const char *label) {
+    if (cfg->commandDelay[0] == '\0' && points->commandCount == 0) return;
+
+    CommandDelay delay = {COMMAND_DELAY_FIXED, {0, 0}};
+    if (cfg->commandDelay[0] && !CommandDelay_parse(cfg->commandDelay, &delay))
+        printf("%s Neplatné COMMANDDELAY=%s, commandy se vykonají hned\n", label, cfg->commandDelay);
+
+    int selectTimeoutMs = cfg->selectTimeoutMs > 0 ? cfg->selectTimeoutMs : DEFAULT_SELECT_TIMEOUT_MS;
+    commandEngine = CommandEngine_create(points, &delay, selectTimeoutMs, COMMAND_CAPACITY);
+    if (commandEngine == NULL) {
+        printf("%s Vykonávání commandů nelze spustit\n", label);
+        return;
+    }
+    printf("%s Commandy: vykonání s dobou odezvy (%d bodů s CMD=/DELAY=), výběr SBO platí %d ms\n", label,
+           points->commandCount, selectTimeoutMs);
+}
+
+static void startCommands(CommandContext *ctx) {
+    if (commandEngine == NULL) return;
+    ctx->timer = TimerWheel_addTimer(ctx->wheel, onCommandTimer, ctx);
+    TimerWheel_start(ctx->wheel, ctx->timer, COMMAND_TICK_MS, COMMAND_TICK_MS);
+}
+
+// Volat až po zastavení serveru a zrušení časovačů (kola)
+static void stopCommands(const char *label) {
+    if (commandEngine == NULL) return;
+    CommandStats stats;
+    CommandEngine_getStats(commandEngine, &stats);
+    printf("%s Commandy: přijato %llu, vykonáno %llu, výběrů %llu, odmítnuto %llu, zrušeno %llu, "
+           "nejvíc rozpracovaných %d\n", label, (unsigned long long) stats.received,
+           (unsigned long long) stats.executed, (unsigned long long) stats.selected,
+           (unsigned long long) stats.rejected, (unsigned long long) stats.cancelled, stats.maxInFlight);
+    CommandEngine_destroy(commandEngine);
+    commandEngine = NULL;
+}
+
+// =======================
+// UDÁLOSTI S POISSONOVÝM ROZDĚLENÍM A LAVINY (EVENTS, jen server)
+// =======================
+
+#define EVENT_TICK_MS 10           // Události jednoho ticku se zabalí do společných ASDU
+#define EVENT_MAX_RATE 100000      // Max. rychlost událostí za sekundu
+
+static EventEngine eventEngine = NULL; // Generátor událostí (viz uni_events.h)
+
+// Stav časovače událostí (104 nebo 101 slave)
+typedef struct {
+    TimerWheel wheel;
+    Timer timer;
+    CS101_AppLayerParameters alParams;
+    EnqueueFunction enqueue;
+    void *target;
+    const char *label;
+} EventContext;
+
+// Kapacita ticku se čtyřnásobnou rezervou nad střední počet událostí
+static int eventTickCapacity(const EventModel *model) {
+    int peakRate = model->burstRate > model->rate ? model->burstRate : model->rate;
+    return peakRate * EVENT_TICK_MS / 1000 * 4 + 64;
+}
+
+// Generátor událostí podle EVENTS (NULL = vypnuto nebo žádný bod s časovou značkou CP56)
+static EventEngine createEventEngine(Config *cfg, uint64_t nowMs, const char *label) {
+    if (cfg->eventRate <= 0 && cfg->eventBurstRate <= 0) return NULL;
+
+    EventModel model = {cfg->eventRate, cfg->eventBurstRate, cfg->eventBurstMs, cfg->eventQuietMs};
+    if (model.rate > EVENT_MAX_RATE) model.rate = EVENT_MAX_RATE;
+    if (model.burstRate > EVENT_MAX_RATE) model.burstRate = EVENT_MAX_RATE;
+
+    return EventEngine_create(points, &model, isSpontaneousType, eventTickCapacity(&model), nowMs, label);
+}
+
+// Pošle události jako spontánní zprávy (COT 3) v ASDU se samostatnými IOA (SQ=0);
+// indexy jsou seřazené podle typu a IOA, bod s více událostmi se opakuje
+static void sendEventPoints(CS101_AppLayerParameters alParams, EnqueueFunction enqueue, void *target,
+                            const int32_t *indexes, int count) {
+    sCS101_StaticASDU storage;
+    CS101_ASDU asdu = NULL;
+
+    for (int c = 0; c <= count; ++c) {
+        int p = (c < count) ? indexes[c] : -1;
+
+        // ASDU odešleme při změně typu a na konci
+        if (asdu != NULL && (p < 0 || points->type[p] != CS101_ASDU_getTypeID(asdu))) {
+            enqueue(target, asdu);
+            asduTransmitHandler(asdu);
+            asdu = NULL;
+        }
+
+        if (p < 0) break;
+
+        InformationObject io = createIO(points->type[p], points->ioa[p], points->value[p]);
+        if (io == NULL) continue;
+
+        if (asdu == NULL)
+            asdu = CS101_ASDU_initializeStatic(&storage, alParams, false, CS101_COT_SPONTANEOUS, originatorAddress,
+                                               commonAddress, false, false);
+
+        // Plné ASDU odešleme a pokračujeme v novém
+        if (!CS101_ASDU_addInformationObject(asdu, io)) {
+            enqueue(target, asdu);
+            asduTransmitHandler(asdu);
+            asdu = CS101_ASDU_initializeStatic(&storage, alParams, false, CS101_COT_SPONTANEOUS, originatorAddress,
+                                               commonAddress, false, false);
+            CS101_ASDU_addInformationObject(asdu, io);
+        }
+        InformationObject_destroy(io);
+    }
+}
+
+// Callback časovače: události od minulého ticku pošle zabalené do společných ASDU
+static void onEventTimer(void *parameter, uint64_t now) {
+    EventContext *ctx = (EventContext *) parameter;
+    if (eventEngine == NULL) return;
+
+    const int32_t *events;
+    int numEvents = EventEngine_run(eventEngine, now, &events);
+    if (numEvents > 0)
+        sendEventPoints(ctx->alParams, ctx->enqueue, ctx->target, events, numEvents);
+}
+
+// Spustí generátor událostí (pokud je EVENTS nastaveno); vrací false, když neběží
+static bool startEvents(EventContext *ctx, Config *cfg) {
+    eventEngine = createEventEngine(cfg, TimerWheel_now(ctx->wheel), ctx->label);
+    if (eventEngine == NULL) {
+        if (cfg->eventRate > 0 || cfg->eventBurstRate > 0)
+            printf("%s EVENTS: v konfiguraci není žádný bod typu 30/31/34/35/36\n", ctx->label);
+        return false;
+    }
+
+    ctx->timer = TimerWheel_addTimer(ctx->wheel, onEventTimer, ctx);
+    TimerWheel_start(ctx->wheel, ctx->timer, EVENT_TICK_MS, EVENT_TICK_MS);
+
+    if (cfg->eventBurstRate > 0)
+        printf("%s EVENTS: %d událostí/s, laviny %d/s (průměrně %d ms každých %d ms), %d bodů\n", ctx->label,
+               cfg->eventRate, cfg->eventBurstRate, cfg->eventBurstMs, cfg->eventQuietMs,
+               EventEngine_getCandidateCount(eventEngine));
+    else
+        printf("%s EVENTS: Poissonův proces %d událostí/s, %d bodů\n", ctx->label, cfg->eventRate,
+               EventEngine_getCandidateCount(eventEngine));
+    if (cfg->eventRate > EVENT_MAX_RATE || cfg->eventBurstRate > EVENT_MAX_RATE)
+        printf("%s EVENTS: rychlost omezena na %d událostí/s\n", ctx->label, EVENT_MAX_RATE);
+    return true;
+}
+
+static void stopEvents(void) {
+    EventEngine_destroy(eventEngine);
+    eventEngine = NULL;
+}
+
+
+// =======================
+// SCÉNÁŘ UDÁLOSTÍ PODLE ČASOVÉ OSY (SCENARIO, jen server)
+// =======================
+
+#define SCENARIO_REPORT_MS 10000
+#define SCENARIO_MAX_CONNECTIONS 100   // Jako CONFIG_CS104_MAX_CLIENT_CONNECTIONS knihovny
+
+// Otevřená spojení serveru 104 (pro DROP), mění je handler událostí spojení z vláken spojení
+static IMasterConnection openConnections[SCENARIO_MAX_CONNECTIONS];
+static int openConnectionCount = 0;
+static Semaphore connectionsLock = NULL;
+static volatile bool connectionsBlocked = false; // DROP: server nepřijímá nová spojení
+
+// Stav scénáře jednoho serveru
+typedef struct {
+    TimerWheel wheel;
+    Timer timer;
+    Timer reportTimer;
+    CS101_AppLayerParameters alParams;
+    EnqueueFunction enqueue;
+    void *target;
+    EventContext *events;     // RATE mění (nebo spouští) generátor událostí
+    bool is104;
+    float speed;
+    bool started;
+    uint64_t startMs;
+    const char *label;
+} ScenarioContext;
+
+static void trackConnection(IMasterConnection con, bool open) {
+    if (connectionsLock == NULL) return;
+    Semaphore_wait(connectionsLock);
+    if (open && openConnectionCount < SCENARIO_MAX_CONNECTIONS) {
+        openConnections[openConnectionCount++] = con;
+    } else if (!open) {
+        for (int i = 0; i < openConnectionCount; ++i) {
+            if (openConnections[i] == con) {
+                openConnections[i] = openConnections[--openConnectionCount];
+                break;
+            }
+        }
+    }
+    Semaphore_post(connectionsLock);
+}
+
+// Zavře všechna spojení (vlákna spojení je ukončí a ohlásí CLOSED)
+static int closeAllConnections(void) {
+    Semaphore_wait(connectionsLock);
+    int count = openConnectionCount;
+    for (int i = 0; i < openConnectionCount; ++i)
+        IMasterConnection_close(openConnections[i]);
+    Semaphore_post(connectionsLock);
+    return count;
+}
+
+// Konec inicializace (M_EI_NA_1, COT 4) – master na něj odpoví generálním dotazem
+static void sendEndOfInitialization(ScenarioContext *ctx, int coi) {
+    sCS101_StaticASDU storage;
+    CS101_ASDU asdu = CS101_ASDU_initializeStatic(&storage, ctx->alParams, false, CS101_COT_INITIALIZED,
+                                                  originatorAddress, commonAddress, false, false);
+    InformationObject io = (InformationObject) EndOfInitialization_create(NULL, (uint8_t) coi);
+    CS101_ASDU_addInformationObject(asdu, io);
+    InformationObject_destroy(io);
+    ctx->enqueue(ctx->target, asdu);
+    asduTransmitHandler(asdu);
 }
 
+// RATE: nový model generátoru událostí, bez EVENTS v konfiguraci ho spustí
+static void setEventRate(ScenarioContext *ctx, const ScenarioAction *action) {
+    EventModel model = {action->rate, action->burstRate, action->burstMs, action->quietMs};
+    if (model.rate > EVENT_MAX_RATE) model.rate = EVENT_MAX_RATE;
+    if (model.burstRate > EVENT_MAX_RATE) model.burstRate = EVENT_MAX_RATE;
+    uint64_t now = TimerWheel_now(ctx->wheel);
+    EventContext *events = ctx->events;
+
+    if (eventEngine == NULL) {
+        if (model.rate <= 0 && model.burstRate <= 0) return;
+        eventEngine = EventEngine_create(points, &model, isSpontaneousType, eventTickCapacity(&model), now,
+                                         ctx->label);
+        if (eventEngine == NULL) {
+            printf("%s Scénář RATE: v konfiguraci není žádný bod typu 30/31/34/35/36\n", ctx->label);
+            return;
+        }
+        if (events->timer == NULL) events->timer = TimerWheel_addTimer(ctx->wheel, onEventTimer, events);
+        TimerWheel_start(ctx->wheel, events->timer, EVENT_TICK_MS, EVENT_TICK_MS);
+    } else if (!EventEngine_setModel(eventEngine, &model, eventTickCapacity(&model), now)) {
+        printf("%s Scénář RATE: nový model událostí nelze nastavit\n", ctx->label);
+        return;
+    }
+
+    if (model.burstRate > 0)
+        printf("%s Scénář: EVENTS %d událostí/s, laviny %d/s\n", ctx->label, model.rate, model.burstRate);
+    else
+        printf("%s Scénář: EVENTS %d událostí/s\n", ctx->label, model.rate);
+}
+
+// Akce scénáře, které nemění body (volá se z Scenario_advance pod zámkem bodů)
+static void onScenarioAction(void *parameter, const ScenarioAction *action) {
+    ScenarioContext *ctx = (ScenarioContext *) parameter;
+
+    switch (action->kind) {
+        case SCENARIO_DROP:
+            if (!ctx->is104) {
+                printf("%s Scénář DROP: sériová linka se neodpojuje\n", ctx->label);
+                break;
+            }
+            connectionsBlocked = true;
+            printf("%s Scénář: výpadek – zavřeno %d spojení, nová se nepřijímají\n", ctx->label,
+                   closeAllConnections());
+            break;
+        case SCENARIO_RESTORE:
+            connectionsBlocked = false;
+            if (ctx->is104) printf("%s Scénář: obnovení – spojení se znovu přijímají\n", ctx->label);
+            break;
+        case SCENARIO_RATE:
+            setEventRate(ctx, action);
+            break;
+        case SCENARIO_GI:
+            printf("%s Scénář: konec inicializace (COI %d), master pošle GI\n", ctx->label, action->coi);
+            sendEndOfInitialization(ctx, action->coi);
+            break;
+        default:
+            break;
+    }
+}
+
+static void printScenarioProgress(ScenarioContext *ctx, const char *what) {
+    uint64_t actions, events, unknown, invalid, maxLateMs;
+    int maxPending;
+    Scenario_getProgress(scenario, &actions, &events, &unknown, &invalid, &maxPending, &maxLateMs);
+    printf("%s %s: %llu akcí, %llu událostí lavin, nejvíc %d akcí na dohled, největší zpoždění %llu ms", ctx->label,
+           what, (unsigned long long) actions, (unsigned long long) events, maxPending,
+           (unsigned long long) maxLateMs);
+    if (unknown > 0) printf(", neznámé IOA %llu", (unsigned long long) unknown);
+    if (invalid > 0) printf(", vadné řádky %llu", (unsigned long long) invalid);
+    printf("\n");
+}
+
+// Callback časovače: provede splatné akce, změny pošle spontánně (s detekcí změn je pošle detektor)
+// a časovač nastaví přesně na další akci
+static void onScenarioTimer(void *parameter, uint64_t now) {
+    ScenarioContext *ctx = (ScenarioContext *) parameter;
+    now = TimerWheel_now(ctx->wheel);
+
+    if (!ctx->started) {
+        ctx->started = true;
+        ctx->startMs = now;
+        Scenario_start(scenario, now, ctx->speed);
+    }
+
+    ScenarioStep step;
+    Semaphore_wait(pointsLock);
+    bool more = Scenario_advance(scenario, points, now, onScenarioAction, ctx, &step);
+    for (int c = 0; c < step.changeCount; ++c)
+        GiCache_invalidate(giCache, points, step.changes[c]);
+    Semaphore_post(pointsLock);
+
+    if (step.changeCount > 0 && changeDetector == NULL)
+        sendSpontaneousPoints(ctx->alParams, ctx->enqueue, ctx->target, step.changes, step.changeCount);
+    if (step.eventCount > 0)
+        sendEventPoints(ctx->alParams, ctx->enqueue, ctx->target, step.events, step.eventCount);
+
+    if (Scenario_isFinished(scenario)) {
+        char what[64];
+        snprintf(what, sizeof(what), "Scénář dokončen za %.2f s", (now - ctx->startMs) / 1000.0);
+        printScenarioProgress(ctx, what);
+        TimerWheel_stop(ctx->wheel, ctx->reportTimer);
+        return;
+    }
+
+    uint64_t next = more ? now : Scenario_getNextMs(scenario);
+    TimerWheel_start(ctx->wheel, ctx->timer, next > now ? next - now : 0, 0);
+}
+
+static void onScenarioReportTimer(void *parameter, uint64_t now) {
+    (void) now;
+    ScenarioContext *ctx = (ScenarioContext *) parameter;
+    if (ctx->started) printScenarioProgress(ctx, "Scénář");
+}
+
+// Otevře scénář SCENARIO=soubor;rychlost a naplánuje první akci
+static void startScenario(ScenarioContext *ctx, Config *cfg) {
+    if (cfg->scenarioPath[0] == '\0') return;
+    scenario = Scenario_open(cfg->scenarioPath, points, isSpontaneousType);
+    if (scenario == NULL) {
+        printf("%s Chyba: Scénář %s nelze spustit\n", ctx->label, cfg->scenarioPath);
+        return;
+    }
+    ctx->speed = cfg->scenarioSpeed > 0 ? cfg->scenarioSpeed : 1;
+    ctx->timer = TimerWheel_addTimer(ctx->wheel, onScenarioTimer, ctx);
+    TimerWheel_start(ctx->wheel, ctx->timer, 0, 0);
+    ctx->reportTimer = TimerWheel_addTimer(ctx->wheel, onScenarioReportTimer, ctx);
+    TimerWheel_start(ctx->wheel, ctx->reportTimer, SCENARIO_REPORT_MS, SCENARIO_REPORT_MS);
+    printf("%s SCENARIO: %s rychlostí %gx (náhodné spontánní zprávy vypnuty)\n", ctx->label, cfg->scenarioPath,
+           ctx->speed);
+}
+
+// Volat až po zrušení časovačů (kola)
+static void stopScenario(void) {
+    Scenario_close(scenario);
+    scenario = NULL;
+    connectionsBlocked = false;
+}
+
+
+// =======================
+// HOT RELOAD KONFIGURACE (jen server)
+// =======================
+
+#define RELOAD_CHECK_MS 250        // Jak často se kontroluje změna konfiguračního souboru
+
+// Stav hot reloadu jednoho serveru (104 nebo 101)
+typedef struct {
+    const char *path;
+    ConfigWatcher watcher;
+    TimerWheel wheel;
+    Timer timer;
+    CS101_AppLayerParameters alParams;
+    Config *cfg;                  // Platná konfigurace serveru (mění se jen přenášené položky)
+    EnqueueFunction enqueue;
+    void *target;
+    const char *label;
+} ReloadContext;
+
+// Body s novou hodnotou nebo nově přidané – páry indexů (stará tabulka, nová tabulka)
+typedef struct {
+    int32_t *oldIndex;
+    int32_t *newIndex;
+    int count;
+    int capacity;
+} ReloadChanges;
+
+// Callback PointTable_diff – zapamatuje si body, které se mají přepsat / poslat spontánně
+static void collectReloadChange(void *parameter, PointDiffKind kind, int oldIndex, int newIndex) {
+    ReloadChanges *changes = (ReloadChanges *) parameter;
+    if (kind != POINT_DIFF_VALUE && kind != POINT_DIFF_ADDED) return;
+
+    if (changes->count == changes->capacity) {
+        int capacity = changes->capacity ? changes->capacity * 2 : 256;
+        int32_t *oldArray = (int32_t *) realloc(changes->oldIndex, capacity * sizeof(int32_t));
+        if (oldArray) changes->oldIndex = oldArray;
+        int32_t *newArray = (int32_t *) realloc(changes->newIndex, capacity * sizeof(int32_t));
+        if (newArray) changes->newIndex = newArray;
+        if (oldArray == NULL || newArray == NULL) return;
+        changes->capacity = capacity;
+    }
+    changes->oldIndex[changes->count] = oldIndex;
+    changes->newIndex[changes->count] = newIndex;
+    changes->count++;
+}
+
+// Pošle změněné body jako spontánní zprávy (změny jsou seřazené podle typu a IOA z PointTable_diff)
+static void sendReloadEvents(ReloadContext *ctx, ReloadChanges *changes, bool swapped) {
+    int32_t *indexes = (int32_t *) malloc(changes->count * sizeof(int32_t));
+    if (indexes == NULL) return;
+    int count = 0;
+    for (int c = 0; c < changes->count; ++c) {
+        int p = swapped ? changes->newIndex[c] : changes->oldIndex[c];
+        if (p >= 0) indexes[count++] = p; // Přidaný bod bez výměny tabulky nenastane
+    }
+    sendSpontaneousPoints(ctx->alParams, ctx->enqueue, ctx->target, indexes, count);
+    free(indexes);
+}
+
+// Načte změněný konfigurační soubor a rozdíl proti živé tabulce bodů aplikuje najednou:
+// samotné změny hodnot se přepíšou na místě, přidané/odebrané body nebo jiné periody
+// znamenají výměnu celé tabulky a novou kompilaci šablon (spojení zůstávají otevřená).
+static void applyConfigReload(ReloadContext *ctx) {
+    Config newCfg;
+    PointTable newPoints = PointTable_create(points->count);
+    if (newPoints == NULL) return;
+    if (!ConfigFile_load(ctx->path, &newCfg, newPoints)) {
+        PointTable_destroy(newPoints);
+        return;
+    }
+
+    ReloadChanges changes;
+    memset(&changes, 0, sizeof(changes));
+    PointDiff diff = PointTable_diff(points, newPoints, collectReloadChange, &changes);
+
+    Config *cfg = ctx->cfg;
+    if (strcmp(newCfg.protocol, cfg->protocol) != 0 || strcmp(newCfg.role, cfg->role) != 0 ||
+        strcmp(newCfg.ip, cfg->ip) != 0 || newCfg.port != cfg->port ||
+        strcmp(newCfg.interface, cfg->interface) != 0 || newCfg.bandwidth != cfg->bandwidth) {
+        printf("%s Změna PROTOCOL/ROLE/IP/PORT/INTERFACE/BANDWIDTH se projeví až po restartu\n", ctx->label);
+    }
+
+    bool settingsChanged = newCfg.periodMs != cfg->periodMs || newCfg.originatorAddress != cfg->originatorAddress ||
+                           newCfg.commonAddress != cfg->commonAddress;
+    bool swap = diff.added > 0 || diff.removed > 0 || diff.changedLayout > 0 || settingsChanged;
+
+    printf("%s Reload konfigurace: přidáno %d, odebráno %d, nové hodnoty %d, nové periody/příznaky %d\n",
+           ctx->label, diff.added, diff.removed, diff.changedValue, diff.changedLayout);
+
+    if (swap) stopPeriodicTimers();
+
+    // Generátory se sestaví znovu při výměně tabulky nebo změně výchozí hodnoty generovaného bodu
+    bool regenerate = swap;
+    for (int c = 0; c < changes.count && !regenerate; ++c)
+        regenerate = changes.oldIndex[c] >= 0 && (points->flags[changes.oldIndex[c]] & POINT_FLAG_GENERATED);
+
+    Semaphore_wait(pointsLock);
+    if (swap) {
+        PointTable_copyToggleStates(newPoints, points);
+        PointTable previousPoints = points;
+        points = newPoints;
+        newPoints = previousPoints;
+        originatorAddress = newCfg.originatorAddress;
+        commonAddress = newCfg.commonAddress;
+        compilePeriodicTemplates(ctx->alParams);
+        GiCache_destroy(giCache);
+        giCache = GiCache_create(ctx->alParams, points, originatorAddress, commonAddress, createIO);
+        if (sharedPoints) {
+            // Jiné body = jiné rozložení oblasti, zdroj se musí namapovat znovu
+            SharedPoints_destroy(sharedPoints);
+            sharedPoints = SharedPoints_create(cfg->sharedPointsPath, points);
+            printf("%s Sdílené body %s založeny znovu (%d bodů)\n", ctx->label, cfg->sharedPointsPath,
+                   sharedPoints ? SharedPoints_getCount(sharedPoints) : 0);
+        }
+        if (valuePlayback && !ValuePlayback_setPoints(valuePlayback, points))
+            printf("%s PLAYBACK: body nové tabulky nelze připravit, přehrávání stojí\n", ctx->label);
+        if (scenario && !Scenario_setPoints(scenario, points))
+            printf("%s SCENARIO: body nové tabulky nelze připravit, scénář stojí\n", ctx->label);
+    } else {
+        for (int c = 0; c < changes.count; ++c) {
+            int n = changes.newIndex[c];
+            PointTable_setValues(points, changes.oldIndex[c], newPoints->valueA[n], newPoints->valueB[n]);
+            GiCache_invalidate(giCache, points, changes.oldIndex[c]);
+            // Hodnotu pošle sendReloadEvents – detektor ji už nesmí hlásit podruhé
+            if (changeDetector && newCfg.reloadEvents)
+                ChangeDetector_setReported(changeDetector, points, changes.oldIndex[c]);
+        }
+    }
+    if (regenerate) {
+        GeneratorSet_destroy(generators);
+        generators = GeneratorSet_create(points);
+    }
+    Semaphore_post(pointsLock);
+
+    bool deadbandChanged = newCfg.deadbandEnable != cfg->deadbandEnable || newCfg.deadband != cfg->deadband ||
+                           newCfg.deadbandPercent != cfg->deadbandPercent;
+
+    cfg->periodMs = newCfg.periodMs;
+    cfg->originatorAddress = newCfg.originatorAddress;
+    cfg->commonAddress = newCfg.commonAddress;
+    cfg->multiplier = newCfg.multiplier;
+    cfg->reloadEvents = newCfg.reloadEvents;
+    cfg->deadbandEnable = newCfg.deadbandEnable;
+    cfg->deadband = newCfg.deadband;
+    cfg->deadbandPercent = newCfg.deadbandPercent;
+    multiplier = cfg->multiplier > 0 ? cfg->multiplier : 1;
+    if (newCfg.spontaneousEnable) {
+        minSpontaneousInterval = newCfg.spontaneousMinMs;
+        maxSpontaneousInterval = newCfg.spontaneousMaxMs;
+    }
+
+    // Nová tabulka nebo jiný DEADBAND = nový detektor (hlášené hodnoty = hodnoty po reloadu)
+    if (swap || deadbandChanged) {
+        Semaphore_wait(pointsLock);
+        ChangeDetector_destroy(changeDetector);
+        changeDetector = createChangeDetector(cfg);
+        Semaphore_post(pointsLock);
+    }
+
+    // Vazby commandů ukazují na indexy bodů
+    if (swap && commandEngine && !CommandEngine_setPoints(commandEngine, points))
+        printf("%s Vazby commandů na nové body nelze sestavit\n", ctx->label);
+
+    // Běžící generátor událostí potřebuje nové kandidáty (a případně nový model)
+    bool eventsChanged = newCfg.eventRate != cfg->eventRate || newCfg.eventBurstRate != cfg->eventBurstRate ||
+                         newCfg.eventBurstMs != cfg->eventBurstMs || newCfg.eventQuietMs != cfg->eventQuietMs;
+    cfg->eventRate = newCfg.eventRate;
+    cfg->eventBurstRate = newCfg.eventBurstRate;
+    cfg->eventBurstMs = newCfg.eventBurstMs;
+    cfg->eventQuietMs = newCfg.eventQuietMs;
+    if (eventEngine && (swap || eventsChanged)) {
+        EventEngine_destroy(eventEngine);
+        eventEngine = createEventEngine(cfg, TimerWheel_now(ctx->wheel), ctx->label);
+    }
+
+    if (swap && cfg->loadRate <= 0) {
+        int periodicInterval = cfg->periodMs > 0 ? cfg->periodMs : 20000;
+        startPeriodicTimers(ctx->wheel, periodicInterval, ctx->enqueue, ctx->target, ctx->label);
+    }
+
+    if (cfg->reloadEvents && changes.count > 0)
+        sendReloadEvents(ctx, &changes, swap);
+
+    PointTable_destroy(newPoints);
+    free(changes.oldIndex);
+    free(changes.newIndex);
+}
+
+// Callback časovače: neblokující kontrola změny souboru (inotify)
+static void onReloadTimer(void *parameter, uint64_t now) {
+    (void) now;
+    ReloadContext *ctx = (ReloadContext *) parameter;
+    if (ConfigWatcher_poll(ctx->watcher))
+        applyConfigReload(ctx);
+}
+
+// Začne sledovat konfigurační soubor (pokud je HOTRELOAD=1)
+static void startConfigReload(ReloadContext *ctx) {
+    if (!ctx->cfg->hotReload) return;
+    ctx->watcher = ConfigWatcher_create(ctx->path);
+    if (ctx->watcher == NULL) return;
+    ctx->timer = TimerWheel_addTimer(ctx->wheel, onReloadTimer, ctx);
+    TimerWheel_start(ctx->wheel, ctx->timer, RELOAD_CHECK_MS, RELOAD_CHECK_MS);
+    printf("%s Hot reload: sleduji změny %s\n", ctx->label, ctx->path);
+}
+
+static void stopConfigReload(ReloadContext *ctx) {
+    ConfigWatcher_destroy(ctx->watcher);
+    ctx->watcher = NULL;
+}
+
+
+
+// =======================
+// ZÁTĚŽOVÝ REŽIM (LOAD, jen server)
+// =======================
+
+#define LOAD_RUN_MS 1              // Jak často generátor dohání rozvrh
+#define LOAD_QUEUE_SIZE 10000      // Fronta 104 v zátěžovém režimu (místo 10 ASDU)
+
+// Stav zátěžového režimu jednoho serveru (104 nebo 101)
+typedef struct {
+    LoadGenerator generator;
+    TimerWheel wheel;
+    Timer runTimer;
+    Timer reportTimer;
+    bool is104;
+    void *slave;
+    const char *label;
+} LoadContext;
+
+static void onLoadRunTimer(void *parameter, uint64_t now) {
+    (void) now;
+    LoadGenerator_run(((LoadContext *) parameter)->generator);
+}
+
+static void onLoadReportTimer(void *parameter, uint64_t now) {
+    (void) now;
+    LoadContext *ctx = (LoadContext *) parameter;
+    int64_t dropped = ctx->is104 ? (int64_t) CS104_Slave_getNumberOfDroppedQueueEntries((CS104_Slave) ctx->slave, NULL) : -1;
+    LoadGenerator_report(ctx->generator, ctx->label, dropped);
+}
+
+// Raw handler 104: odeslaný I-rámec = ASDU na lince
+static void loadRawMessageHandler104(void *parameter, IMasterConnection connection, uint8_t *msg, int msgSize, bool sent) {
+    if (trafficStats) TrafficStats_onFrame(trafficStats, sent ? STATS_TX : STATS_RX, msgSize);
+    if (frameCapture) FrameCapture_add(frameCapture, connection, msg, msgSize, sent);
+    if (sent && msgSize >= 6 && (msg[2] & 1) == 0)
+        LoadGenerator_onWire((LoadGenerator) parameter);
+}
+
+// Raw handler 101: odeslaný rámec s proměnnou délkou = ASDU na lince
+static void loadRawMessageHandler101(void *parameter, uint8_t *msg, int msgSize, bool sent) {
+    if (trafficStats) TrafficStats_onFrame(trafficStats, sent ? STATS_TX : STATS_RX, msgSize);
+    if (frameCapture) FrameCapture_add(frameCapture, NULL, msg, msgSize, sent);
+    if (sent && msgSize > 0 && msg[0] == 0x68)
+        LoadGenerator_onWire((LoadGenerator) parameter);
+}
+
+// Potvrzení ASDU masterem (jen 104, viz CS104_Slave_setASDUAckHandler)
+static void loadAckHandler(void *parameter, IMasterConnection connection, uint32_t latencyUs) {
+    LoadGenerator_onAck((LoadGenerator) parameter, latencyUs);
+}
+
+// Spustí generátor (pokud je LOAD nastaveno); vrací false, když zátěžový režim neběží
+static bool startLoad(LoadContext *ctx, Config *cfg, CS101_AppLayerParameters alParams, EnqueueFunction enqueue) {
+    if (cfg->loadRate <= 0) return false;
+
+    ctx->generator = LoadGenerator_create(alParams, points, cfg->originatorAddress, cfg->commonAddress, cfg->loadRate,
+                                          cfg->loadPerIo, cfg->loadIosPerAsdu, enqueue, ctx->slave);
+    if (ctx->generator == NULL) {
+        printf("%s LOAD: v konfiguraci není žádný bod, který lze poslat\n", ctx->label);
+        return false;
+    }
+
+    if (ctx->is104) {
+        CS104_Slave_setRawMessageHandler((CS104_Slave) ctx->slave, loadRawMessageHandler104, ctx->generator);
+        CS104_Slave_setASDUAckHandler((CS104_Slave) ctx->slave, loadAckHandler, ctx->generator);
+    } else {
+        CS101_Slave_setRawMessageHandler((CS101_Slave) ctx->slave, loadRawMessageHandler101, ctx->generator);
+    }
+
+    int reportMs = cfg->loadReportMs > 0 ? cfg->loadReportMs : 1000;
+    ctx->runTimer = TimerWheel_addTimer(ctx->wheel, onLoadRunTimer, ctx);
+    TimerWheel_start(ctx->wheel, ctx->runTimer, LOAD_RUN_MS, LOAD_RUN_MS);
+    ctx->reportTimer = TimerWheel_addTimer(ctx->wheel, onLoadReportTimer, ctx);
+    TimerWheel_start(ctx->wheel, ctx->reportTimer, reportMs, reportMs);
+
+    printf("%s LOAD: %d %s/s, max. %d IO v ASDU, výpis každých %d ms (periodické a spontánní zprávy vypnuty)\n",
+           ctx->label, cfg->loadRate, cfg->loadPerIo ? "IO" : "ASDU", cfg->loadIosPerAsdu, reportMs);
+    return true;
+}
+
+// Volat až po zastavení slave (handlery už nesmí generátor používat)
+static void stopLoad(LoadContext *ctx) {
+    LoadGenerator_destroy(ctx->generator);
+    ctx->generator = NULL;
+}
+
+
+// =======================
+// TICHÝ REŽIM SE STATISTIKOU PROVOZU (QUIET)
+// =======================
+
+// Stav výpisu statistiky jednoho serveru nebo klienta
+typedef struct {
+    TimerWheel wheel;
+    Timer timer;
+    CS104_Slave slave104;      // Hloubka fronty a zahozená ASDU (jen server 104)
+    const char *label;
+} StatsContext;
+
+// Raw handlery tichého režimu a záznamu CAPTURE: jen počet rámců a bajtů, kopie do záznamu
+static void rawFrameHandler104(void *parameter, IMasterConnection connection, uint8_t *msg, int msgSize, bool sent) {
+    if (trafficStats) TrafficStats_onFrame(trafficStats, sent ? STATS_TX : STATS_RX, msgSize);
+    if (frameCapture) FrameCapture_add(frameCapture, connection, msg, msgSize, sent);
+}
+
+// parameter = klíč spojení v záznamu (NULL = jediné spojení)
+static void rawFrameHandler(void *parameter, uint8_t *msg, int msgSize, bool sent) {
+    if (trafficStats) TrafficStats_onFrame(trafficStats, sent ? STATS_TX : STATS_RX, msgSize);
+    if (frameCapture) FrameCapture_add(frameCapture, parameter, msg, msgSize, sent);
+}
+
+static void onStatsTimer(void *parameter, uint64_t now) {
+    (void) now;
+    StatsContext *ctx = (StatsContext *) parameter;
+    int64_t queueDepth = -1;
+    int64_t dropped = -1;
+    if (ctx->slave104) {
+        queueDepth = CS104_Slave_getNumberOfQueueEntries(ctx->slave104, NULL);
+        dropped = (int64_t) CS104_Slave_getNumberOfDroppedQueueEntries(ctx->slave104, NULL);
+    }
+    TrafficStats_report(trafficStats, ctx->label, queueDepth, dropped);
+}
+
+// Zapne tichý režim (QUIET=1) – volat před registrací handlerů
+static void createTrafficStats(Config *cfg) {
+    if (cfg->quiet) trafficStats = TrafficStats_create(cfg->traceSample);
+}
+
+// Naplánuje výpis statistiky (jen v tichém režimu)
+static void startStats(StatsContext *ctx, Config *cfg) {
+    if (trafficStats == NULL) return;
+    int reportMs = cfg->statsReportMs > 0 ? cfg->statsReportMs : 1000;
+    ctx->timer = TimerWheel_addTimer(ctx->wheel, onStatsTimer, ctx);
+    TimerWheel_start(ctx->wheel, ctx->timer, reportMs, reportMs);
+    if (cfg->traceSample > 0)
+        printf("%s Tichý režim: statistika každých %d ms, vypíše se každé %d. ASDU\n", ctx->label, reportMs,
+               cfg->traceSample);
+    else
+        printf("%s Tichý režim: statistika každých %d ms, ASDU se nevypisují\n", ctx->label, reportMs);
+}
+
+// Volat až po zastavení protokolu (handlery už nesmí čítače používat)
+static void stopStats(void) {
+    TrafficStats_destroy(trafficStats);
+    trafficStats = NULL;
+}
+
+
+// =======================
+// STAVOVÁ TABULKA BODŮ KLIENTA (STATETABLE)
+// =======================
+
+// Periodické ukládání snímku stavové tabulky
+typedef struct {
+    TimerWheel wheel;
+    Timer timer;
+    const char *path;
+    const char *label;
+} StateContext;
+
+static void exportState(StateContext *ctx) {
+    if (StateTable_export(clientState, ctx->path))
+        printf("%s Stav %d bodů uložen do %s\n", ctx->label, StateTable_getCount(clientState), ctx->path);
+    else
+        printf("%s Chyba: Stav bodů nelze uložit do %s\n", ctx->label, ctx->path);
+}
+
+static void onStateTimer(void *parameter, uint64_t now) {
+    (void) now;
+    exportState((StateContext *) parameter);
+}
+
+// Zapne stavovou tabulku (STATETABLE=1) – volat před připojením
+static void createStateTable(Config *cfg, int sizeOfIOA) {
+    if (cfg->stateTable) clientState = StateTable_create(sizeOfIOA);
+}
+
+// Naplánuje ukládání snímku (jen se STATEEXPORT a nenulovou periodou)
+static void startStateExport(StateContext *ctx, Config *cfg) {
+    if (clientState == NULL) return;
+    if (cfg->stateExportPath[0] && cfg->stateExportMs > 0) {
+        ctx->timer = TimerWheel_addTimer(ctx->wheel, onStateTimer, ctx);
+        TimerWheel_start(ctx->wheel, ctx->timer, cfg->stateExportMs, cfg->stateExportMs);
+    }
+    printf("%s Stavová tabulka bodů zapnuta%s%s\n", ctx->label, cfg->stateExportPath[0] ? ", snímek: " : "",
+           cfg->stateExportPath);
+}
+
+// Volat až po zastavení protokolu – uloží poslední snímek a tabulku uvolní
+static void stopStateTable(StateContext *ctx) {
+    if (clientState == NULL) return;
+    if (ctx->path[0]) exportState(ctx);
+    StateTable_destroy(clientState);
+    clientState = NULL;
+}
+
+
+// =======================
+// LATENCE COMMANDŮ KLIENTA (LATENCY)
+// =======================
+
+// Periodický výpis latence commandů
+typedef struct {
+    TimerWheel wheel;
+    Timer timer;
+    const char *label;
+} LatencyContext;
+
+static void onLatencyTimer(void *parameter, uint64_t now) {
+    (void) now;
+    LatencyContext *ctx = (LatencyContext *) parameter;
+    CommandLatency_report(commandLatency, ctx->label, false);
+}
+
+// Zapne měření latence (LATENCY=1) – volat před připojením; capacity = kolik commandů může čekat najednou
+static void createCommandLatency(Config *cfg, int capacity, int sizeOfIOA) {
+    if (cfg->commandLatency) commandLatency = CommandLatency_create(capacity, cfg->commandTimeoutMs, sizeOfIOA);
+}
+
+static void startLatencyReport(LatencyContext *ctx, Config *cfg) {
+    if (commandLatency == NULL) return;
+    int reportMs = cfg->latencyReportMs > 0 ? cfg->latencyReportMs : 10000;
+    ctx->timer = TimerWheel_addTimer(ctx->wheel, onLatencyTimer, ctx);
+    TimerWheel_start(ctx->wheel, ctx->timer, reportMs, reportMs);
+    printf("%s Latence commandů: výpis každých %d ms, timeout %d ms\n", ctx->label, reportMs,
+           cfg->commandTimeoutMs > 0 ? cfg->commandTimeoutMs : 10000);
+}
+
+// Volat až po uzavření spojení – vypíše souhrn za celý běh
+static void stopCommandLatency(const char *label) {
+    if (commandLatency == NULL) return;
+    CommandLatency_report(commandLatency, label, true);
+    CommandLatency_destroy(commandLatency);
+    commandLatency = NULL;
+}
+
+
+// =======================
+// ZÁZNAM A PŘEHRÁVÁNÍ RÁMCŮ (CAPTURE / REPLAY)
+// =======================
+
+#define REPLAY_RUN_MS 1               // Jak často přehrávání dohání záznam
+#define REPLAY_MAX_PER_RUN 1000       // Max. ASDU za jeden běh (REPLAY=...;MAX nezablokuje časovače)
+#define REPLAY_REPORT_MS 1000         // Interval výpisu průběhu
+#define REPLAY_QUEUE_SIZE 10000       // Fronta 104 serveru při přehrávání
+#define REPLAY_QUEUE_LIMIT 5000       // Nad tuto hloubku fronty přehrávání počká (nic se nezahodí)
+
+// Odeslání ASDU ze záznamu; false = zatím nelze (plná fronta nebo okno k), zkusí se znovu
+typedef bool (*ReplaySendFunction)(void *target, CS101_ASDU asdu);
+
+// Stav přehrávání jednoho serveru nebo klienta
+typedef struct {
+    TimerWheel wheel;
+    Timer runTimer;
+    Timer reportTimer;
+    CS101_AppLayerParameters alParams;
+    int linkAddressLength;        // 101: velikost linkové adresy v rámci
+    bool server;                  // Přehrávají se rámce serveru (jinak klienta)
+    ReplaySendFunction send;
+    void *target;
+    const char *label;
+
+    CaptureReader reader;
+    float speed;                  // 0 = co nejrychleji
+    int stream;                   // Přehrává se jen první spojení ze záznamu (-1 = zatím nevíme)
+    CaptureFrame frame;
+    const uint8_t *asduData;      // ASDU aktuálního rámce (čeká na odeslání, pokud pending)
+    int asduLength;
+    bool pending;
+    bool started;
+    uint64_t firstNs;             // Čas prvního ASDU v záznamu
+    uint64_t startNs;             // Kdy se začalo přehrávat (monotónní)
+    int64_t lagNs;                // Zpoždění za rozvrhem záznamu
+    uint64_t sent;
+    uint64_t lastSent;
+    uint64_t skipped;             // ASDU, která nejde sestavit s parametry této strany
+    sCS101_StaticASDU asdu;
+} ReplayContext;
+
+// Zapne záznam (CAPTURE=soubor) – volat před registrací handlerů
+static void createFrameCapture(Config *cfg, bool is104, bool server, const char *label) {
+    if (cfg->capturePath[0] == '\0') return;
+    frameCapture = FrameCapture_create(cfg->capturePath, is104, server, cfg->port);
+    if (frameCapture)
+        printf("%s Záznam rámců do %s\n", label, cfg->capturePath);
+    else
+        printf("%s Chyba: Záznam rámců nelze vytvořit: %s\n", label, cfg->capturePath);
+}
+
+// Volat až po zastavení protokolu – zapíše zbytek bufferu a zavře soubor
+static void stopCapture(const char *label) {
+    if (frameCapture == NULL) return;
+    uint64_t frames, dropped;
+    FrameCapture_getCounts(frameCapture, &frames, &dropped);
+    FrameCapture_destroy(frameCapture);
+    frameCapture = NULL;
+    printf("%s Záznam: %llu rámců uloženo, %llu zahozeno (plný buffer)\n", label, (unsigned long long) frames,
+           (unsigned long long) dropped);
+}
+
+static bool replaySend104(void *target, CS101_ASDU asdu) {
+    if (CS104_Slave_getNumberOfQueueEntries((CS104_Slave) target, NULL) >= REPLAY_QUEUE_LIMIT) return false;
+    CS104_Slave_enqueueASDU((CS104_Slave) target, asdu);
+    return true;
+}
+
+static bool replaySend101(void *target, CS101_ASDU asdu) {
+    if (CS101_Slave_isClass1QueueFull((CS101_Slave) target)) return false;
+    CS101_Slave_enqueueUserDataClass1((CS101_Slave) target, asdu);
+    return true;
+}
+
+// Klient 104: knihovna čísluje N(S)/N(R) sama a při plném okně k nic nepošle
+static bool replaySendClient104(void *target, CS101_ASDU asdu) {
+    if (con == NULL) return false;
+    return CS104_Connection_sendASDU(con, asdu);
+}
+
+// Další ASDU přehrávané strany; false = konec záznamu
+static bool nextReplayAsdu(ReplayContext *ctx) {
+    while (CaptureReader_next(ctx->reader, &ctx->frame)) {
+        if (ctx->frame.fromServer != ctx->server) continue;
+        if (ctx->stream < 0) ctx->stream = ctx->frame.stream;
+        if (ctx->frame.stream != ctx->stream) continue;
+
+        // S/U rámce a potvrzení linkové vrstvy vytváří knihovna sama
+        ctx->asduLength = CaptureFrame_getAsdu(&ctx->frame, ctx->linkAddressLength, &ctx->asduData);
+        if (ctx->asduLength > 0) return true;
+    }
+    return false;
+}
+
+static void finishReplay(ReplayContext *ctx) {
+    double seconds = ctx->started ? (double) (TimerWheel_monotonicNs() - ctx->startNs) / 1e9 : 0;
+    printf("%s Přehrávání dokončeno: %llu ASDU za %.2f s", ctx->label, (unsigned long long) ctx->sent, seconds);
+    if (ctx->skipped > 0)
+        printf(", přeskočeno %llu (jiné parametry ASDU)", (unsigned long long) ctx->skipped);
+    printf("\n");
+
+    TimerWheel_stop(ctx->wheel, ctx->runTimer);
+    TimerWheel_stop(ctx->wheel, ctx->reportTimer);
+    CaptureReader_close(ctx->reader);
+    ctx->reader = NULL;
+}
+
+// Odešle ASDU, která už podle časů záznamu (dělených rychlostí) měla odejít, v původním pořadí
+static void onReplayRunTimer(void *parameter, uint64_t now) {
+    (void) now;
+    ReplayContext *ctx = (ReplayContext *) parameter;
+    uint64_t nowNs = TimerWheel_monotonicNs();
+
+    for (int n = 0; n < REPLAY_MAX_PER_RUN; n++) {
+        if (!ctx->pending) {
+            if (!nextReplayAsdu(ctx)) {
+                finishReplay(ctx);
+                return;
+            }
+            ctx->pending = true;
+        }
+
+        if (!ctx->started) {
+            ctx->started = true;
+            ctx->firstNs = ctx->frame.timestampNs;
+            ctx->startNs = nowNs;
+        }
+
+        if (ctx->speed > 0) {
+            uint64_t offsetNs = ctx->frame.timestampNs > ctx->firstNs ? ctx->frame.timestampNs - ctx->firstNs : 0;
+            uint64_t dueNs = ctx->startNs + (uint64_t) ((double) offsetNs / ctx->speed);
+            if (dueNs > nowNs) return;
+            ctx->lagNs = (int64_t) (nowNs - dueNs);
+        }
+
+        CS101_ASDU asdu = CaptureFrame_decodeAsdu(&ctx->asdu, ctx->alParams, ctx->asduData, ctx->asduLength);
+        if (asdu == NULL) {
+            ctx->skipped++;
+            ctx->pending = false;
+            continue;
+        }
+
+        if (!ctx->send(ctx->target, asdu)) return;
 
-// Nastaví parametry spontánních zpráv z řetězce "1;min;max"
-void configureSpontaneousMessages(const char *config) {
-    char *configCopy = strdup(config);
-    char *token = strtok(configCopy, ";");
-    if (token && atoi(token) == 1) {
-        spontaneousEnabled = true;
-        token = strtok(NULL, ";");
-        minSpontaneousInterval = atoi(token);
-        token = strtok(NULL, ";");
-        maxSpontaneousInterval = atoi(token);
+        if (trafficStats)
+            TrafficStats_onAsdu(trafficStats, STATS_TX, CS101_ASDU_getTypeID(asdu), CS101_ASDU_getCOT(asdu),
+                                CS101_ASDU_getNumberOfElements(asdu));
+        ctx->sent++;
+        ctx->pending = false;
     }
-    free(configCopy);
 }
 
-// Určí náhodný čas další spontánní zprávy v intervalu <min, max>
-void scheduleNextSpontaneousMessage() {
-    if (!spontaneousEnabled) return;
-    int interval = minSpontaneousInterval + rand() % (maxSpontaneousInterval - minSpontaneousInterval + 1);
-    nextSpontaneousTime = time(NULL) + interval;
+static void onReplayReportTimer(void *parameter, uint64_t now) {
+    (void) now;
+    ReplayContext *ctx = (ReplayContext *) parameter;
+    if (!ctx->started) return;
+    printf("%s Přehráno %llu ASDU (%.0f ASDU/s)", ctx->label, (unsigned long long) ctx->sent,
+           (ctx->sent - ctx->lastSent) * 1000.0 / REPLAY_REPORT_MS);
+    if (ctx->speed > 0)
+        printf(", zpoždění za záznamem %.1f ms", ctx->lagNs / 1e6);
+    printf("\n");
+    ctx->lastSent = ctx->sent;
 }
 
+// Spustí přehrávání (REPLAY=soubor;rychlost); vrací false, když neběží
+static bool startReplay(ReplayContext *ctx, Config *cfg) {
+    if (cfg->replayPath[0] == '\0') return false;
+
+    ctx->reader = CaptureReader_open(cfg->replayPath, cfg->port);
+    if (ctx->reader == NULL) {
+        printf("%s Chyba: Záznam %s nelze přehrát (chybí, nebo není pcap)\n", ctx->label, cfg->replayPath);
+        cfg->replayPath[0] = '\0';
+        return false;
+    }
+
+    ctx->speed = cfg->replaySpeed;
+    ctx->stream = -1;
+    ctx->runTimer = TimerWheel_addTimer(ctx->wheel, onReplayRunTimer, ctx);
+    TimerWheel_start(ctx->wheel, ctx->runTimer, REPLAY_RUN_MS, REPLAY_RUN_MS);
+    ctx->reportTimer = TimerWheel_addTimer(ctx->wheel, onReplayReportTimer, ctx);
+    TimerWheel_start(ctx->wheel, ctx->reportTimer, REPLAY_REPORT_MS, REPLAY_REPORT_MS);
+
+    if (ctx->speed > 0)
+        printf("%s REPLAY: %s rychlostí %gx (vlastní zprávy vypnuty)\n", ctx->label, cfg->replayPath, ctx->speed);
+    else
+        printf("%s REPLAY: %s co nejrychleji (vlastní zprávy vypnuty)\n", ctx->label, cfg->replayPath);
+    return true;
+}
 
+static void stopReplay(ReplayContext *ctx) {
+    CaptureReader_close(ctx->reader);
+    ctx->reader = NULL;
+}
 
 
 /* Handler pro logování surových zpráv (nepovinné, hlavně pro ladění) */
@@ -1469,60 +2573,31 @@ static bool clockSyncHandler(void *parameter, IMasterConnection connection, CS10
     return true;
 }
 
+// Odešle ASDU vytvořené CS101_ASDU_pack přímo na spojení
+static void sendPackedASDU(void *parameter, CS101_ASDU asdu) {
+    IMasterConnection connection = (IMasterConnection) parameter;
+    IMasterConnection_sendASDU(connection, asdu);
+    asduTransmitHandler(asdu);
+}
+
 /* Handler pro přijetí interrogation příkazu (klient se ptá na data) */
 static bool interrogationHandler(void *parameter, IMasterConnection connection, CS101_ASDU requestAsdu, uint8_t qoi) {
     printf("[SERVER] Received interrogation for group %i\n", qoi);
 
-    if (qoi == 20) { // Odpovídáme pouze na QOI = 20 (typická volba)
-        printf("[SERVER] Answering the interrogation command (QOI = 20)\n");
-        CS101_AppLayerParameters alParams = IMasterConnection_getApplicationLayerParameters(connection);
+    // QOI 20 = stanice, 21–36 = skupiny 1–16 (body s volbou GROUP=)
+    if (qoi >= IEC60870_QOI_STATION && qoi <= IEC60870_QOI_STATION + GI_CACHE_GROUPS) {
+        printf("[SERVER] Answering the interrogation command (QOI = %i)\n", qoi);
         if (serviceConfig == 1) {
             LogRXrequest(qoi);
         }
         IMasterConnection_sendACT_CON(connection, requestAsdu, false);
 
-        // Připravíme ASDU pro každý typ zprávy
-        CS101_ASDU asdus[MAX_MESSAGE_TYPES] = {0};
-
-        for (int i = 0; i < numMessageConfigs; i++) {
-            MessageConfig msg = messageConfigs[i];
-            if (msg.messageType < MAX_MESSAGE_TYPES) {
-                if (!asdus[msg.messageType]) {
-                    asdus[msg.messageType] = CS101_ASDU_create(alParams, false, CS101_COT_INTERROGATED_BY_STATION,
-                                                               originatorAddress, commonAddress, false, false);
-                    if (asdus[msg.messageType] == NULL) {
-                        fprintf(stderr, "Failed to create ASDU for type %d\n", msg.messageType);
-                        continue;
-                    }
-                }
-                // Přidáme všechny IO pro tento typ
-                for (int j = 0; j < msg.ioContentCount; j++) {
-                    IOContent ioContent = msg.ioContent[j];
-                    InformationObject io = createIO(msg.messageType, ioContent.ioa, ioContent.value);
-
-                    if (io != NULL) {
-                        if (!CS101_ASDU_addInformationObject(asdus[msg.messageType], io)) {
-                            printf("Failed to add IO (Type %d, IOA %d) to ASDU\n", msg.messageType, ioContent.ioa);
-                        }
-                        InformationObject_destroy(io);
-                    } else {
-                        printf("Failed to create IO (Type %d, IOA %d)\n", msg.messageType, ioContent.ioa);
-                    }
-                }
-            } else {
-                fprintf(stderr, "Message type %d out of bounds\n", msg.messageType);
-            }
-        }
-        // Odeslání všech odpovědí
-        for (int k = 0; k < MAX_MESSAGE_TYPES; k++) {
-            if (asdus[k] && CS101_ASDU_getNumberOfElements(asdus[k]) > 0) {
-                IMasterConnection_sendASDU(connection, asdus[k]);
-                asduTransmitHandler(asdus[k]);
-            }
-            if (asdus[k]) {
-                CS101_ASDU_destroy(asdus[k]);
-            }
+        // Odpověď se posílá z cache – znovu se sestaví jen úseky se změněnými body
+        Semaphore_wait(pointsLock);
+        if (GiCache_send(giCache, points, qoi - IEC60870_QOI_STATION, sendPackedASDU, connection) < 0) {
+            fprintf(stderr, "Interrogation cache is not available\n");
         }
+        Semaphore_post(pointsLock);
     } else {
         // Na jiné QOI pouze pozitivně potvrdíme
         IMasterConnection_sendACT_CON(connection, requestAsdu, true);
@@ -1538,8 +2613,20 @@ static bool asduHandler(void *parameter, IMasterConnection connection, CS101_ASD
     int ca = CS101_ASDU_getCA(asdu);
     int numIO = CS101_ASDU_getNumberOfElements(asdu);
 
-    printf("RECVD ASDU | OA: %d | CA: %d | TYPE: %s(%d) | COT: %d (%s) | IOs: %d\n",
-           oa, ca, TypeID_toString(type), type, cot, getCOTName(cot), numIO);
+    // Command pro engine se zařadí hned, odpověď se pošle až po výpisu (mění COT v ASDU)
+    CommandVerdict verdict = commandEngine ? CommandEngine_submit(commandEngine, connection, asdu) : COMMAND_IGNORED;
+
+    bool trace = true;
+    if (trafficStats) {
+        trace = TrafficStats_onAsdu(trafficStats, STATS_RX, type, cot, numIO);
+        if (!trace && dataConfig == 0) {
+            respondCommand(connection, asdu, verdict);
+            return true;
+        }
+    }
+
+    TRACE("RECVD ASDU | OA: %d | CA: %d | TYPE: %s(%d) | COT: %d (%s) | IOs: %d\n",
+          oa, ca, TypeID_toString(type), type, cot, getCOTName(cot), numIO);
     if (dataConfig == 1) {
         LogRX(CS101_ASDU_getTypeID(asdu), CS101_ASDU_getNumberOfElements(asdu),
               CS101_ASDU_getOA(asdu), CS101_ASDU_getCA(asdu));
@@ -1547,12 +2634,12 @@ static bool asduHandler(void *parameter, IMasterConnection connection, CS101_ASD
 
     switch (CS101_ASDU_getTypeID(asdu)) {
         case C_SC_NA_1: // 45 Single Command
-            printf("  Single command:\n");
+            TRACE("  Single command:\n");
             for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 SingleCommand io = (SingleCommand) CS101_ASDU_getElement(asdu, i);
                 bool value = SingleCommand_getState(io);
-                printf("    IOA: %i value: %s \n",
-                       InformationObject_getObjectAddress((InformationObject) io), value ? "true" : "false");
+                TRACE("    IOA: %i value: %s \n",
+                      InformationObject_getObjectAddress((InformationObject) io), value ? "true" : "false");
                 if (dataConfig == 1) {
                     LogRXwoT(InformationObject_getObjectAddress((InformationObject) io), (float)value);
                 }
@@ -1560,7 +2647,7 @@ static bool asduHandler(void *parameter, IMasterConnection connection, CS101_ASD
             }
             break;
         case C_DC_NA_1: // 46 Double Command
-            printf("  Double command:\n");
+            TRACE("  Double command:\n");
             for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 DoubleCommand io = (DoubleCommand) CS101_ASDU_getElement(asdu, i);
                 int value = DoubleCommand_getState(io);
@@ -1572,7 +2659,7 @@ static bool asduHandler(void *parameter, IMasterConnection connection, CS101_ASD
                     case 3: valueDescription = "NOT PERMITTED"; break;
                     default: valueDescription = "UNKNOWN"; break;
                 }
-                printf("    IOA: %i value: %s\n", InformationObject_getObjectAddress((InformationObject) io), valueDescription);
+                TRACE("    IOA: %i value: %s\n", InformationObject_getObjectAddress((InformationObject) io), valueDescription);
                 if (dataConfig == 1) {
                     LogRXwoT(InformationObject_getObjectAddress((InformationObject) io), (float)value);
                 }
@@ -1580,6 +2667,7 @@ static bool asduHandler(void *parameter, IMasterConnection connection, CS101_ASD
             }
             break;
     }
+    respondCommand(connection, asdu, verdict);
     return true;
 }
 
@@ -1644,6 +2732,10 @@ static void resetCUHandler(void* parameter)
 static bool connectionRequestHandler(void *parameter, const char *ipAddress) {
     printf("[SERVER - 104] New connection request from %s\n", ipAddress);
     if (serviceConfig == 1) LogCONREQ(ipAddress);
+    if (connectionsBlocked) {
+        printf("[SERVER - 104] Spojení odmítnuto (výpadek ze scénáře)\n");
+        return false;
+    }
     // Přijímáme všechny spojení (v budoucnu můžeš přidat podmínky)
     return true;
 }
@@ -1652,9 +2744,12 @@ static bool connectionRequestHandler(void *parameter, const char *ipAddress) {
 static void connectionEventHandler(void *parameter, IMasterConnection con, CS104_PeerConnectionEvent event) {
     if (event == CS104_CON_EVENT_CONNECTION_OPENED) {
         printf("[SERVER - 104] Connection opened (%p)\n", con);
+        trackConnection(con, true);
         if (serviceConfig == 1) LogCONOPEN();
     } else if (event == CS104_CON_EVENT_CONNECTION_CLOSED) {
         printf("[SERVER - 104] Connection closed (%p)\n", con);
+        if (commandEngine) CommandEngine_dropConnection(commandEngine, con);
+        trackConnection(con, false);
         if (serviceConfig == 1) LogCONCLOSED();
     } else if (event == CS104_CON_EVENT_ACTIVATED) {
         printf("[SERVER - 104] Connection activated (%p)\n", con);
@@ -1772,7 +2867,7 @@ void runInteractiveEditor(const char* configPath) {
     }
 
     // --- Periodické zprávy ---
-    printf("Zadej periodu posílaných zpráv (v sekundách): ");
+    printf("Zadej periodu posílaných zpráv (např. 20 = 20 s, 250ms): ");
     scanf("%s", input);
     fprintf(config, "PERIOD=%s\n", input);
 
@@ -1876,7 +2971,10 @@ void printHelp() {
     printf("  --helpconfig      Zobrazí nápovědu k editování konfiguračnáho souboru\n");
     printf("  --edit      Spustí interaktivního průvodce pro vytvoření/úpravu iec_config.txt\n");
     printf("  --show      Zobrazí obsah aktuálního iec_config.txt\n");
-    printf("  --help      Zobrazí tuto nápovědu\n\n");
+    printf("  --help      Zobrazí tuto nápovědu\n");
+    printf("  --query <soubor> <IOA|*> [od] [do]\n");
+    printf("              Vypíše hodnoty IOA z binárního datového logu (DATALOGFORMAT=BIN) v časovém\n");
+    printf("              intervalu, čas jako \"2025-01-31 12:00:00\" nebo 2025-01-31T12:00:00\n\n");
     printf("Bez parametrů se program pokusí načíst konfiguraci a spustit příslušný simulátor.\n");
 }
 
@@ -1913,13 +3011,22 @@ void printHelpConfig() {
 
     printf("DATAPATH / SERVICEPATH = cesta k log souborům\n\n");
 
-    printf("PERIOD = celé číslo\n");
-    printf("  - Interval mezi periodickým odesíláním zpráv (např. 6 = každých 6s).\n\n");
+    printf("DATALOGFORMAT = TEXT / BIN\n");
+    printf("  - BIN: datový log v binárním formátu (32 B na hodnotu) s indexem <DATAPATH>.idx,\n");
+    printf("    výchozí DATAPATH je DATALOG.bin. Prohledává se přes --query.\n\n");
+    printf("LOGMAXSIZE = celé číslo (MB)\n");
+    printf("  - Po dosažení velikosti se log přejmenuje na .1 (starší na .2 … .5) a začne nový. 0 = bez limitu.\n\n");
+
+    printf("LOGROTATE = číslo[ms]\n");
+    printf("  - Rotace logu po uplynutí doby (např. 3600 = každou hodinu). 0 = bez limitu.\n\n");
+
+    printf("PERIOD = číslo[ms]\n");
+    printf("  - Interval mezi periodickým odesíláním zpráv (např. 6 = každých 6s, 0.5 = 500 ms, 250ms).\n\n");
 
     printf("SPONTANEOUS = x;y;z\n");
     printf("  - x = 0/1 - vypnuto/zapnuto.\n");
-    printf("  - y = celé číslo - min. interval v sekundách pro poslání spontánní zprávy.\n");
-    printf("  - z = celé číslo - max. interval v sekundách pro poslání spontánní zprávy.\n");
+    printf("  - y = číslo[ms] - min. interval pro poslání spontánní zprávy (v sekundách, nebo např. 200ms).\n");
+    printf("  - z = číslo[ms] - max. interval pro poslání spontánní zprávy (v sekundách, nebo např. 800ms).\n");
     printf("  - Aktivní pouze pro SERVER.\n\n");
 
     printf("MULTI = celé číslo\n");
@@ -1931,8 +3038,154 @@ void printHelpConfig() {
     printf("DISCONNECTAFTERSEND = 0/1\n");
     printf("  - Pokud je 1, klient ukončí spojení po přijetí dat od serveru, pokud 0, klient zůstane aktivní do ukončení spojení.\n\n");
 
+    printf("HOTRELOAD = 0/1\n");
+    printf("  - Pokud je 1, server sleduje iec_config.txt (inotify) a změny bodů, period, MULTI a PERIOD\n");
+    printf("    aplikuje za běhu bez odpojení klientů. Změna IP/PORT/INTERFACE vyžaduje restart.\n\n");
+
+    printf("RELOADEVENTS = 0/1\n");
+    printf("  - Pokud je 1, body změněné nebo přidané při hot reloadu se pošlou jako spontánní zprávy (COT 3).\n\n");
+
+    printf("DEADBAND = číslo[%%]\n");
+    printf("  - Zapne detekci změn: spontánní zprávy (COT 3) se pošlou jen za body, jejichž hodnota se od\n");
+    printf("    posledního hlášení změnila víc než o deadband (absolutně, nebo v %% poslední hlášené hodnoty).\n");
+    printf("    Platí pro měřené hodnoty bez vlastní volby DB= (ostatní typy se hlásí při každé změně),\n");
+    printf("    kontroluje se každý GENTICK. Náhodné SPONTANEOUS zprávy se pak neposílají.\n\n");
+
+    printf("EVENTS = POISSON;rychlost  nebo  BURST;rychlost;rychlost laviny;délka laviny;doba klidu\n");
+    printf("  - Spontánní události (COT 3) bodů typu 30/31/34/35/36 s exponenciálními rozestupy (Poissonův proces),\n");
+    printf("    až %d událostí/s. BURST střídá klid a laviny (např. BURST;10;50000;2s;30s = bouřka).\n", EVENT_MAX_RATE);
+    printf("    Události z jednoho %d ms ticku se zabalí do společných ASDU. Nahrazuje SPONTANEOUS.\n\n", EVENT_TICK_MS);
+
+    printf("GENTICK = číslo[ms]\n");
+    printf("  - Jak často se přepočítají generátory hodnot bodů (výchozí 100 ms), viz volba GEN= u bodů.\n\n");
+
+    printf("LOAD = rychlost;ASDU|IO[;max. IO v ASDU]\n");
+    printf("  - Zátěžový režim serveru: body se posílají dokola danou rychlostí (např. 5000;ASDU nebo 100000;IO;10).\n");
+    printf("    Tempo je open-loop podle hodin – pomalý klient rychlost nesníží, projeví se na zahozených ASDU.\n");
+    printf("    Periodické a spontánní zprávy jsou v tomto režimu vypnuté.\n\n");
+
+    printf("LOADREPORT = číslo[ms]\n");
+    printf("  - Interval výpisu zátěže (výchozí 1 s): dosažená rychlost, ASDU na lince, zahozené ASDU\n");
+    printf("    a percentily latence do potvrzení klientem (p50/p90/p99/p99.9/max, jen 104).\n\n");
+
+    printf("QUIET = 0/1\n");
+    printf("  - Pokud je 1, ASDU se nevypisují po IO, handlery jen počítají provoz (po typech, COT, rámce, bajty)\n");
+    printf("    a jednou za STATSREPORT se vypíše řádek s rychlostmi, frontou a zahozenými ASDU (fronta jen server 104).\n\n");
+
+    printf("TRACESAMPLE = číslo\n");
+    printf("  - V tichém režimu se celé vypíše každé N-té ASDU v každém směru (0 = žádné, výchozí).\n\n");
+
+    printf("STATSREPORT = číslo[ms]\n");
+    printf("  - Interval výpisu statistiky v tichém režimu (výchozí 1 s).\n\n");
+
+    printf("STATETABLE = 0/1\n");
+    printf("  - Pokud je 1, klient ukládá přijaté hodnoty do tabulky bodů (hodnota, kvalita, časová značka, čas příjmu)\n");
+    printf("    přímo z ASDU bez alokace na IO. IO se pak nevypisují (s QUIET jen vzorek podle TRACESAMPLE).\n\n");
+
+    printf("STATEEXPORT = soubor[;perioda]\n");
+    printf("  - Snímek stavové tabulky, např. state.csv;5s. Přípona .bin = binární záznamy, jinak CSV.\n");
+    printf("    Bez periody se snímek uloží jen při ukončení klienta.\n\n");
+
+    printf("CAPTURE = soubor\n");
+    printf("  - Uloží všechny surové rámce (oba směry, čas v ns) do pcap, např. CAPTURE=incident.pcap.\n");
+    printf("    Zápis běží ve vlastním vlákně. 104 jako IPv4/TCP (otevře Wireshark), 101 jako USER0 + bajt směru.\n\n");
+
+    printf("REPLAY = soubor[;rychlost]\n");
+    printf("  - Přehraje ASDU ze záznamu pcap místo vlastních zpráv: server posílá ASDU serveru, klient ASDU klienta\n");
+    printf("    (jen první spojení v záznamu). Rychlost 1 = původní tempo, 20 = 20x rychleji, MAX = co nejrychleji.\n");
+    printf("    Pořadová čísla N(S)/N(R) přidělí knihovna znovu, při plné frontě nebo okně k se čeká.\n");
+    printf("    Umí i záznamy z Wiresharku (Ethernet/IPv4, server podle PORT). Klient 101 přehrávání neumí.\n\n");
+
+    printf("CLIENTS = číslo\n");
+    printf("  - Klient 104 otevře N spojení z jednoho procesu (např. CLIENTS=1000). Připojování je rozložené v čase,\n");
+    printf("    spadlá spojení se znovu připojí s rostoucím odstupem. Každé STATSREPORT se vypíše souhrn spojení\n");
+    printf("    a rychlostí. Příjem se nevypisuje po IO (s QUIET vzorek podle TRACESAMPLE, se STATETABLE tabulka).\n\n");
+
+    printf("CLIENTTARGETS = ip[:port][/ca],...\n");
+    printf("  - Servery, mezi které se spojení CLIENTS rozdělí po řadě (výchozí IP, PORT a COMMON_ADDRESS).\n\n");
+
+    printf("GIPERIOD / SYNCPERIOD / COMMANDPERIOD = číslo[ms]\n");
+    printf("  - Rozvrh každého spojení při CLIENTS (výchozí PERIOD). SYNC jen se SYNC=1, commandy jen PERM body 45/46.\n");
+    printf("    Fáze rozvrhů jsou rozprostřené, aby spojení neposílala najednou.\n\n");
+
+    printf("LATENCY = 0/1\n");
+    printf("  - Pokud je 1, klient měří dobu od odeslání commandu (45/46, GI, SYNC) do ACT_CON a ACT_TERM\n");
+    printf("    zvlášť pro každý typ (spárování podle spojení, typu, CA a IOA). Jednou za LATENCYREPORT a při\n");
+    printf("    ukončení se vypíše p50/p99/p99.9/max, timeouty a negativní potvrzení.\n\n");
+
+    printf("LATENCYREPORT = číslo[ms]\n");
+    printf("  - Interval výpisu latence commandů (výchozí 10 s).\n\n");
+
+    printf("COMMANDTIMEOUT = číslo[ms]\n");
+    printf("  - Command bez ACT_CON po této době se započítá jako timeout (výchozí 10 s).\n\n");
+
+    printf("SHAREDPOINTS = soubor[;perioda]\n");
+    printf("  - Server vystaví body v souboru namapovaném do paměti (např. /dev/shm/uni_points), do kterého\n");
+    printf("    zapisuje externí zdroj hodnot (model sítě) přes SharedPoints_write z uni_shared.h – bez systémových\n");
+    printf("    volání. Změny se převezmou každou periodu (výchozí 10 ms) a pošlou jako spontánní zprávy\n");
+    printf("    (s DEADBAND jen změny nad deadband). Náhodné spontánní zprávy se pak neposílají.\n");
+    printf("    Hot reload, který změní body, založí soubor znovu – zdroj se musí namapovat znovu.\n\n");
+
+    printf("PLAYBACK = soubor[;rychlost]\n");
+    printf("  - Server přehraje do bodů záznam hodnot z provozu v pořadí časových značek, rychlost 1, 10, 100 nebo\n");
+    printf("    MAX (výchozí 1). CSV má řádky TIMESTAMP_MS;IOA;VALUE[;QUALITY] (řádky nezačínající číslicí se\n");
+    printf("    přeskočí), soubor .bin hlavičku UNIVALUE a 24bajtové záznamy (viz uni_playback.h). Soubor se\n");
+    printf("    mapuje do paměti a čte postupně, takže může mít i několik GB. Změny jdou jako spontánní zprávy\n");
+    printf("    (s DEADBAND jen změny nad deadband), náhodné spontánní zprávy se pak neposílají.\n\n");
+
+    printf("COMMANDDELAY = rozdělení\n");
+    printf("  - Server vykoná commandy 45/46 a žádané hodnoty 48–50 jako zařízení: po době z rozdělení pošle ACT_CON,\n");
+    printf("    změní stavový bod (zpráva COT 11 stejnému spojení) a pošle ACT_TERM. Rozdělení: FIX,200ms,\n");
+    printf("    UNIFORM,100ms,500ms, NORMAL,300ms,50ms nebo EXP,200ms. Command ovládá bod odpovídajícího typu se\n");
+    printf("    stejným IOA, pokud žádný bod nemá volbu CMD=. Neznámé IOA dostane COT 47, deaktivace (COT 8) zruší\n");
+    printf("    čekající command. Bez COMMANDDELAY a bez voleb CMD=/DELAY= se commandy jen vypíšou.\n\n");
+
+    printf("SBOTIMEOUT = číslo[ms]\n");
+    printf("  - Jak dlouho platí výběr (select) u bodů s CMD=…,SBO (výchozí 10 s).\n\n");
+
+    printf("SCENARIO = soubor[;rychlost]\n");
+    printf("  - Server provede scénář: časově seřazené řádky ČAS;AKCE[;parametry], ČAS od začátku (1.5, 250ms)\n");
+    printf("    nebo od předchozího řádku (+100ms), rychlost 10 = 10x rychleji. Akce:\n");
+    printf("      SET;ioa[-ioa];hodnota[;kvalita]    nastaví bod(y), změny jdou spontánně\n");
+    printf("      BURST;počet;doba[;ioa-ioa]         lavina událostí rovnoměrně za dobu (bez rozsahu body 30–36)\n");
+    printf("      DROP[;doba] / RESTORE              zavře spojení a nepřijímá nová (do RESTORE nebo po době)\n");
+    printf("      RATE;rychlost[;lavina;délka;klid]  změní EVENTS (0 = zastaví)\n");
+    printf("      GI[;coi]                           konec inicializace, master pošle generální dotaz\n");
+    printf("    Soubor se čte po blocích jen na dohled, akce čekají v jedné haldě a provedou se s přesností na ms.\n");
+    printf("    Např. vypnutí rozvodny: 10s;SET;1000-1199;0 a 10s;BURST;50000;2s, obnova po blackoutu:\n");
+    printf("    60s;DROP;30s a 90s;GI. Laviny losují s pevným semínkem, scénář se opakuje stejně.\n\n");
+
+    printf("STATIONS = číslo[;PORT|CA]\n");
+    printf("  - Server 104 spustí N virtuálních stanic v jednom procesu (např. STATIONS=200). PORT = stanice\n");
+    printf("    naslouchají na portech PORT až PORT+N-1 se stejným CA, CA = jeden port a CA až CA+N-1. Každá stanice\n");
+    printf("    má vlastní body, generátory, periodické zprávy (fáze rozprostřené) a odpovídá na GI, SYNC a commandy.\n");
+    printf("    SPONTANEOUS, EVENTS, DEADBAND, LOAD, REPLAY a HOTRELOAD platí jen pro jednu stanici.\n\n");
+
+    printf("STATIONPOINTS = soubor\n");
+    printf("  - Body stanice podle vzoru s %%d = číslo stanice od 1 (např. stanice_%%d.txt). Stanice bez vlastního\n");
+    printf("    souboru použijí body z iec_config.txt.\n\n");
+
+    printf("WORKERS = číslo\n");
+    printf("  - Počet vláken, mezi která se stanice rozdělí (výchozí počet CPU).\n\n");
+
+    printf("CONFIGSNAPSHOT = 0/1\n");
+    printf("  - Pokud je 1, uloží se načtená konfigurace do binárního snímku iec_config.txt.snap.\n");
+    printf("    Dokud se textový soubor nezmění (čas, velikost, hash), další start načte jen snímek.\n\n");
+
     printf("Typy zpráv a hodnoty (MESSAGES):\n");
-    printf("  Formát: TYPE;IOA;VALUE\n\n");
+    printf("  Formát: TYPE;IOA;VALUE\n");
+    printf("  Volitelně vlastní perioda bodu: TYPE;IOA;VALUE;PERIOD=100ms (jinak platí globální PERIOD)\n");
+    printf("  Volitelně generátor hodnoty (jen server, VALUE = výchozí hodnota):\n");
+    printf("    GEN=SINE,amplituda,perioda[,fáze°]   např. 13;200;50;GEN=SINE,10,60s\n");
+    printf("    GEN=RAMP,min,max,perioda             pila z min do max\n");
+    printf("    GEN=WALK,krok,min,max                náhodná procházka (max. krok za tick)\n");
+    printf("    GEN=NOISE,amplituda                  VALUE ± amplituda\n");
+    printf("    GEN=STEP,hodnota@doba,…              např. 1;100;0;GEN=STEP,0@5s,1@2s\n");
+    printf("  Volitelně vlastní deadband bodu (zapne detekci změn): DB=0.5 nebo DB=2%%\n");
+    printf("  Volitelně skupiny bodu pro dotaz skupiny (QOI 21–36 = skupina 1–16): GROUP=1,3\n");
+    printf("  Volitelně command, který stavový bod ovládá (jen server, viz COMMANDDELAY):\n");
+    printf("    CMD=ioa[,SBO]                        např. 3;100;1;CMD=5000,SBO (bez ioa = IOA bodu)\n");
+    printf("    DELAY=rozdělení                      vlastní doba vykonání, např. DELAY=UNIFORM,1s,3s\n\n");
 
     printf("  +------+--------------------------------------------------------------+-------------------------------+\n");
     printf("  | Typ  | Popis                                                       | Povolené hodnoty             |\n");
@@ -1977,14 +3230,12 @@ void printHelpConfig() {
 // Spuštění serveru IEC 104 podle načtené konfigurace
 void runServer104(Config cfg) {
     printf("[SERVER - 104] Spuštěn s IP %s, port %d, OA %d, CA %d\n", cfg.ip, cfg.port, cfg.originatorAddress, cfg.commonAddress);
-    printf("[SERVER - 104] Perioda: %ds | Multiplier: %d | Spontánní zprávy: %s\n", cfg.period, cfg.multiplier, cfg.spontaneousEnable ? "ANO" : "NE");
+    printf("[SERVER - 104] Perioda: %d ms | Multiplier: %d | Spontánní zprávy: %s\n", cfg.periodMs, cfg.multiplier, cfg.spontaneousEnable ? "ANO" : "NE");
 
     // Zapnutí logování dle configu
-    if (cfg.serviceLogs) LogSTART("Server");
-    if (cfg.dataLogs) dataConfig = 1;
-    if (cfg.serviceLogs) serviceConfig = 1;
-    if (strlen(cfg.dataPath) > 0) dataPath = cfg.dataPath;
-    if (strlen(cfg.servicePath) > 0) servicePath = cfg.servicePath;
+    startLogging(&cfg, "Server");
+    createTrafficStats(&cfg);
+    createFrameCapture(&cfg, true, true, "[SERVER - 104]");
 
     // Načti parametry pro ASDU
     originatorAddress = cfg.originatorAddress;
@@ -1994,15 +3245,14 @@ void runServer104(Config cfg) {
     // Spontánní zprávy – povol, nastav min/max interval a naplánuj první
     if (cfg.spontaneousEnable)
         spontaneousEnabled = true;
-    minSpontaneousInterval = cfg.spontaneousMin;
-    maxSpontaneousInterval = cfg.spontaneousMax;
-    scheduleNextSpontaneousMessage();
+    minSpontaneousInterval = cfg.spontaneousMinMs;
+    maxSpontaneousInterval = cfg.spontaneousMaxMs;
 
-    int periodicInterval = cfg.period > 0 ? cfg.period : 20;
-    readMessageConfig("iec_config.txt");
+    int periodicInterval = cfg.periodMs > 0 ? cfg.periodMs : 20000;
 
     // Vytvoření a konfigurace slave serveru
-    CS104_Slave slave = CS104_Slave_create(10, 10);
+    CS104_Slave slave = cfg.loadRate > 0 ? CS104_Slave_create(LOAD_QUEUE_SIZE, 10)
+                      : cfg.replayPath[0] ? CS104_Slave_create(REPLAY_QUEUE_SIZE, 10) : CS104_Slave_create(10, 10);
     CS104_Slave_setLocalAddress(slave, cfg.ip);
     CS104_Slave_setLocalPort(slave, cfg.port);
     CS104_Slave_setServerMode(slave, CS104_MODE_SINGLE_REDUNDANCY_GROUP);
@@ -2013,70 +3263,111 @@ void runServer104(Config cfg) {
     CS104_Slave_setClockSyncHandler(slave, clockSyncHandler, NULL);
     CS104_Slave_setInterrogationHandler(slave, interrogationHandler, NULL);
     CS104_Slave_setASDUHandler(slave, asduHandler, NULL);
+    if (trafficStats || frameCapture) CS104_Slave_setRawMessageHandler(slave, rawFrameHandler104, NULL);
     CS104_Slave_setConnectionRequestHandler(slave, connectionRequestHandler, NULL);
     CS104_Slave_setConnectionEventHandler(slave, connectionEventHandler, NULL);
 
+    // Zkompiluj periodické zprávy do šablon (jednou, ne v každé periodě)
+    compilePeriodicTemplates(alParams);
+
+    // Předem sestavené odpovědi na dotaz stanice a skupin
+    giCache = GiCache_create(alParams, points, originatorAddress, commonAddress, createIO);
+    createCommandEngine(&cfg, "[SERVER - 104]");
+    connectionsLock = Semaphore_create(1);
+
     // Spusť server
     CS104_Slave_start(slave);
-    lastSentTime = time(NULL);
 
-    // Hlavní smyčka: periodicky posílej zprávy + spontánní pokud mají přijít
-    while (running) {
-        time_t currentTime = time(NULL);
-
-        if (difftime(currentTime, lastSentTime) >= periodicInterval) {
-            printf("[SERVER - 104] Posílám periodické zprávy:\n");
-            for (int i = 0; i < numMessageConfigs; ++i) {
-                MessageConfig msg = messageConfigs[i];
-                CS101_ASDU asdu = CS101_ASDU_create(alParams, false, CS101_COT_PERIODIC, originatorAddress, commonAddress, false, false);
-                // Přidej IO objekty podle konfigurace
-                for (int j = 0; j < msg.ioContentCount; ++j) {
-                    IOContent ioContent = msg.ioContent[j];
-                    InformationObject io = createIO(msg.messageType, ioContent.ioa, ioContent.value);
-                    CS101_ASDU_addInformationObject(asdu, io);
-                    InformationObject_destroy(io);
-                }
-                // Multiplikace (pošle stejnou zprávu vícekrát)
-                for (int k = 0; k < multiplier; ++k) {
-                    CS104_Slave_enqueueASDU(slave, asdu);
-                    asduTransmitHandler(asdu);
-                }
+    // Časovače: každá skupina periodických zpráv + spontánní zprávy (v zátěžovém režimu jen generátor)
+    TimerWheel wheel = TimerWheel_create();
+    LoadContext load = {NULL, wheel, NULL, NULL, true, slave, "[SERVER - 104]"};
+
+    GeneratorContext generator = {wheel, NULL, 0, alParams, enqueue104, slave};
+    startGenerators(&generator, &cfg, "[SERVER - 104]");
+    SharedContext shared = {wheel, NULL, alParams, enqueue104, slave};
+    startSharedPoints(&shared, &cfg, "[SERVER - 104]");
+    PlaybackContext playback = {wheel, NULL, NULL, alParams, enqueue104, slave, 0, false, 0, "[SERVER - 104]"};
+    startPlayback(&playback, &cfg);
+    CommandContext commands = {wheel, NULL, alParams, "[SERVER - 104]"};
+    startCommands(&commands);
+
+    // Události EVENTS, jinak náhodné spontánní zprávy jen bez detekce změn (ta posílá skutečné změny)
+    SpontaneousContext spontaneous = {wheel, NULL, true, slave, alParams, "[SERVER - 104]"};
+    EventContext events = {wheel, NULL, alParams, enqueue104, slave, "[SERVER - 104]"};
+    ScenarioContext scenarioContext = {wheel, NULL, NULL, alParams, enqueue104, slave, &events, true, 0, false, 0,
+                                       "[SERVER - 104]"};
+    startScenario(&scenarioContext, &cfg);
+    ReplayContext replay = {.wheel = wheel, .alParams = alParams, .server = true, .send = replaySend104,
+                            .target = slave, .label = "[SERVER - 104]"};
+    if (!startReplay(&replay, &cfg) && !startLoad(&load, &cfg, alParams, enqueue104)) {
+        startPeriodicTimers(wheel, periodicInterval, enqueue104, slave, "[SERVER - 104]");
+        if (!startEvents(&events, &cfg) && changeDetector == NULL && sharedPoints == NULL &&
+            valuePlayback == NULL && scenario == NULL)
+            startSpontaneousTimer(&spontaneous);
+    }
 
-                CS101_ASDU_destroy(asdu);
-            }
-            lastSentTime = currentTime;
-        }
-        // Spontánní zprávy
-        if (spontaneousEnabled && currentTime >= nextSpontaneousTime) {
-            printf("[SERVER - 104] Posílám spontánní zprávu...\n");
-            sendSpontaneousMessage104(slave, alParams, multiplier);
-            scheduleNextSpontaneousMessage();
-        }
+    ReloadContext reload = {"iec_config.txt", NULL, wheel, NULL, alParams, &cfg, enqueue104, slave, "[SERVER - 104]"};
+    startConfigReload(&reload);
 
-        Thread_sleep(1000);
+    StatsContext stats = {wheel, NULL, slave, "[SERVER - 104]"};
+    startStats(&stats, &cfg);
+
+    // Hlavní smyčka: obslouží časovače a spí přesně do nejbližšího termínu
+    while (running) {
+        TimerWheel_process(wheel);
+        TimerWheel_sleep(wheel, 1000);
     }
     // Při ukončení
-    CS104_Connection_sendStopDT(slave);
+    stopConfigReload(&reload);
+    TimerWheel_destroy(wheel);
     CS104_Slave_destroy(slave);
+    Semaphore_destroy(connectionsLock);
+    connectionsLock = NULL;
+    stopReplay(&replay);
+    stopLoad(&load);
+    stopGenerators();
+    stopSharedPoints("[SERVER - 104]");
+    stopPlayback();
+    stopScenario();
+    stopCommands("[SERVER - 104]");
+    stopEvents();
+    GiCache_destroy(giCache);
+    giCache = NULL;
+    stopCapture("[SERVER - 104]");
+    stopStats();
+    stopLogging();
 }
 
 static bool asduReceivedHandler(void *parameter, int address, CS101_ASDU asdu) {
     int type = CS101_ASDU_getTypeID(asdu);
+    if (commandLatency) CommandLatency_onReceived(commandLatency, 0, asdu);
     if (type == 100 || type == 103) {
         // Interrogation nebo sync command – klient je pouze posílá, nikdy nezpracovává jako přijaté!
         return true;
     }
 
+    bool trace = true;
+    if (trafficStats) {
+        trace = TrafficStats_onAsdu(trafficStats, STATS_RX, type, CS101_ASDU_getCOT(asdu),
+                                    CS101_ASDU_getNumberOfElements(asdu));
+    }
+    if (clientState) {
+        // Hodnoty jdou do tabulky bez CS101_ASDU_getElement, výpis IO jen jako vzorek tichého režimu
+        StateTable_update(clientState, asdu);
+        if (trafficStats == NULL) trace = false;
+    }
+    if (!trace && dataConfig == 0) return true;
+
 
     int cot = CS101_ASDU_getCOT(asdu);
-    printf("RECVD ASDU | OA: %d | CA: %d | TYPE: %s(%d) | COT: %d (%s) | IOs: %d\n",
-           CS101_ASDU_getOA(asdu),
-           CS101_ASDU_getCA(asdu),
-           TypeID_toString(CS101_ASDU_getTypeID(asdu)),
-           CS101_ASDU_getTypeID(asdu),
-           cot,
-           getCOTName(cot),
-           CS101_ASDU_getNumberOfElements(asdu));
+    TRACE("RECVD ASDU | OA: %d | CA: %d | TYPE: %s(%d) | COT: %d (%s) | IOs: %d\n",
+          CS101_ASDU_getOA(asdu),
+          CS101_ASDU_getCA(asdu),
+          TypeID_toString(CS101_ASDU_getTypeID(asdu)),
+          CS101_ASDU_getTypeID(asdu),
+          cot,
+          getCOTName(cot),
+          CS101_ASDU_getNumberOfElements(asdu));
 
     if (dataConfig == 1) { // Filtration of general messages
         LogRX(CS101_ASDU_getTypeID(asdu), CS101_ASDU_getNumberOfElements(asdu), CS101_ASDU_getOA(asdu),
@@ -2085,11 +3376,11 @@ static bool asduReceivedHandler(void *parameter, int address, CS101_ASDU asdu) {
 
     switch (CS101_ASDU_getTypeID(asdu)) {
         case M_SP_NA_1: {
-            printf("  single point information:\n");
+            TRACE("  single point information:\n");
             for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 SinglePointInformation io = (SinglePointInformation) CS101_ASDU_getElement(asdu, i);
                 if (io == NULL) {
-                    printf("Error: Failed to retrieve information object at index %d.\n", i);
+                    TRACE("Error: Failed to retrieve information object at index %d.\n", i);
                     continue;
                 }
 
@@ -2097,9 +3388,9 @@ static bool asduReceivedHandler(void *parameter, int address, CS101_ASDU asdu) {
                 bool booleanValue = (value != 0); // Assuming 0 is False, any non-zero is True
 
                 // Display the Information Object Address and the value in a descriptive format
-                printf("    IOA: %i value: %s\n",
-                       InformationObject_getObjectAddress((InformationObject) io),
-                       booleanValue ? "True" : "False");
+                TRACE("    IOA: %i value: %s\n",
+                      InformationObject_getObjectAddress((InformationObject) io),
+                      booleanValue ? "True" : "False");
 
                 // Conditionally log the data if logging is enabled
                 if (dataConfig == 1) {
@@ -2108,24 +3399,24 @@ static bool asduReceivedHandler(void *parameter, int address, CS101_ASDU asdu) {
                 }
 
                 SinglePointInformation_destroy(io);
-                printf("\n"); // New line for each point for better readability
+                TRACE("\n"); // New line for each point for better readability
             }
             break;
         }
         case M_SP_TA_1: {
-            printf("  single point information with CP24Time2a timestamp:\n");
+            TRACE("  single point information with CP24Time2a timestamp:\n");
             int i;
             for (i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 SinglePointWithCP24Time2a io = (SinglePointWithCP24Time2a) CS101_ASDU_getElement(asdu, i);
                 bool value = SinglePointInformation_getValue(io); // Gets the boolean state
 
                 // Print the IOA, value as True/False, and the formatted timestamp
-                printf("    IOA: %i value: %s time: ",
-                       InformationObject_getObjectAddress((InformationObject) io),
-                       value ? "True" : "False");
+                TRACE("    IOA: %i value: %s time: ",
+                      InformationObject_getObjectAddress((InformationObject) io),
+                      value ? "True" : "False");
 
                 // Function to print the timestamp in a readable format
-                printCP24Time2a(SinglePointWithCP24Time2a_getTimestamp(io));
+                if (trace) printCP24Time2a(SinglePointWithCP24Time2a_getTimestamp(io));
 
                 // Optionally log the data if logging is enabled
                 if (dataConfig == 1) {
@@ -2136,12 +3427,12 @@ static bool asduReceivedHandler(void *parameter, int address, CS101_ASDU asdu) {
 
                 // Cleanup after use
                 SinglePointWithCP24Time2a_destroy(io);
-                printf("\n"); // New line for each point for better readability
+                TRACE("\n"); // New line for each point for better readability
             }
             break;
         }
         case M_DP_NA_1: {
-            printf("  double point information:\n");
+            TRACE("  double point information:\n");
             int i;
             for (i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 DoublePointInformation io = (DoublePointInformation) CS101_ASDU_getElement(asdu, i);
@@ -2167,7 +3458,7 @@ static bool asduReceivedHandler(void *parameter, int address, CS101_ASDU asdu) {
                 }
 
                 // Displaying the IOA and the descriptive value
-                printf("    IOA: %i value: %s\n", InformationObject_getObjectAddress((InformationObject) io), valueDescription);
+                TRACE("    IOA: %i value: %s\n", InformationObject_getObjectAddress((InformationObject) io), valueDescription);
 
                 // Conditionally log the data if logging is enabled
                 if (dataConfig == 1) {
@@ -2176,12 +3467,12 @@ static bool asduReceivedHandler(void *parameter, int address, CS101_ASDU asdu) {
                 }
 
                 DoublePointInformation_destroy(io);
-                printf("\n");
+                TRACE("\n");
             }
             break;
         }
         case M_DP_TA_1: {
-            printf("  double point information with CP24Time2a timestamp:\n");
+            TRACE("  double point information with CP24Time2a timestamp:\n");
             int i;
             for (i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 DoublePointWithCP24Time2a io = (DoublePointWithCP24Time2a) CS101_ASDU_getElement(asdu, i);
@@ -2207,10 +3498,10 @@ static bool asduReceivedHandler(void *parameter, int address, CS101_ASDU asdu) {
                 }
 
                 // Displaying the IOA, value description and timestamp
-                printf("    IOA: %i value: %s time: ", InformationObject_getObjectAddress((InformationObject) io), valueDescription);
+                TRACE("    IOA: %i value: %s time: ", InformationObject_getObjectAddress((InformationObject) io), valueDescription);
 
                 // Function to print time in a readable format
-                printCP24Time2a(DoublePointWithCP24Time2a_getTimestamp(io));
+                if (trace) printCP24Time2a(DoublePointWithCP24Time2a_getTimestamp(io));
 
                 // Optionally log the data if logging is enabled
                 if (dataConfig == 1) {
@@ -2219,20 +3510,20 @@ static bool asduReceivedHandler(void *parameter, int address, CS101_ASDU asdu) {
                 }
 
                 DoublePointWithCP24Time2a_destroy(io);
-                printf("\n");  // Ensuring each entry is visually separated
+                TRACE("\n");  // Ensuring each entry is visually separated
             }
             break;
         }
         case M_ME_NA_1: {
-            printf("  measured value, normalized value:\n");
+            TRACE("  measured value, normalized value:\n");
             int i;
             for (i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 MeasuredValueNormalized io = (MeasuredValueNormalized)CS101_ASDU_getElement(asdu, i);
                 float normalizedValue = MeasuredValueNormalized_getValue(io);
 
                 // Display detailed information
-                printf("    IOA: %i, Normalized Value: %6.3f\n",
-                       InformationObject_getObjectAddress((InformationObject) io), normalizedValue);
+                TRACE("    IOA: %i, Normalized Value: %6.3f\n",
+                      InformationObject_getObjectAddress((InformationObject) io), normalizedValue);
 
                 // Optionally log the data if enabled
                 if (dataConfig == 1) {
@@ -2242,12 +3533,12 @@ static bool asduReceivedHandler(void *parameter, int address, CS101_ASDU asdu) {
 
                 // Cleanup to avoid memory leaks
                 MeasuredValueNormalized_destroy(io);
-                printf("\n");  // Ensuring each entry is visually separated
+                TRACE("\n");  // Ensuring each entry is visually separated
             }
             break;
         }
         case M_ME_TA_1: {
-            printf("  measured normalized value with CP24Time2a timestamp:\n");
+            TRACE("  measured normalized value with CP24Time2a timestamp:\n");
             int i;
             for (i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 MeasuredValueNormalizedWithCP24Time2a io =
@@ -2256,10 +3547,10 @@ static bool asduReceivedHandler(void *parameter, int address, CS101_ASDU asdu) {
                 CP24Time2a timestamp = MeasuredValueNormalizedWithCP24Time2a_getTimestamp(io);
 
                 // Display detailed information including time stamp
-                printf("    IOA: %i, Normalized Value: %6.3f, Timestamp: ",
-                       InformationObject_getObjectAddress((InformationObject) io),
-                       normalizedValue);
-                printCP24Time2a(timestamp);
+                TRACE("    IOA: %i, Normalized Value: %6.3f, Timestamp: ",
+                      InformationObject_getObjectAddress((InformationObject) io),
+                      normalizedValue);
+                if (trace) printCP24Time2a(timestamp);
 
                 // Optionally log the data if enabled
                 if (dataConfig == 1) {
@@ -2268,12 +3559,12 @@ static bool asduReceivedHandler(void *parameter, int address, CS101_ASDU asdu) {
 
                 // Cleanup to avoid memory leaks
                 MeasuredValueNormalizedWithCP24Time2a_destroy(io);
-                printf("\n"); // Ensure each entry is on a new line
+                TRACE("\n"); // Ensure each entry is on a new line
             }
             break;
         }
         case M_ME_NB_1: {
-            printf("  measured value, scaled value:\n");
+            TRACE("  measured value, scaled value:\n");
             int i;
             for (i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 MeasuredValueScaled io =
@@ -2281,9 +3572,9 @@ static bool asduReceivedHandler(void *parameter, int address, CS101_ASDU asdu) {
                 int value = MeasuredValueScaled_getValue(io); // Extract value
 
                 // Print IOA and value with better formatting
-                printf("    IOA: %i, Scaled Value: %d\n",
-                       InformationObject_getObjectAddress((InformationObject) io),
-                       value);
+                TRACE("    IOA: %i, Scaled Value: %d\n",
+                      InformationObject_getObjectAddress((InformationObject) io),
+                      value);
 
                 // Optionally log the data if data logging is enabled
                 if (dataConfig == 1) {
@@ -2292,12 +3583,12 @@ static bool asduReceivedHandler(void *parameter, int address, CS101_ASDU asdu) {
 
                 // Cleanup to avoid memory leaks
                 MeasuredValueScaled_destroy(io);
-                printf("\n");  // Ensuring each entry is visually separated
+                TRACE("\n");  // Ensuring each entry is visually separated
             }
             break;
         }
         case M_ME_TB_1: {
-            printf("  measured value, scaled value with CP24Time2a timestamp:\n");
+            TRACE("  measured value, scaled value with CP24Time2a timestamp:\n");
             int i;
             for (i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 MeasuredValueScaled io =
@@ -2305,10 +3596,10 @@ static bool asduReceivedHandler(void *parameter, int address, CS101_ASDU asdu) {
                 int value = MeasuredValueScaled_getValue(io); // Get the scaled value
 
                 // Print IOA, value and timestamp in a structured way
-                printf("    IOA: %i, value: %d, time: ",
-                       InformationObject_getObjectAddress((InformationObject) io),
-                       value);
-                printCP24Time2a(MeasuredValueScaledWithCP24Time2a_getTimestamp(io)); // Output the timestamp
+                TRACE("    IOA: %i, value: %d, time: ",
+                      InformationObject_getObjectAddress((InformationObject) io),
+                      value);
+                if (trace) printCP24Time2a(MeasuredValueScaledWithCP24Time2a_getTimestamp(io)); // Output the timestamp
 
                 // Optionally log the data if logging is enabled
                 if (dataConfig == 1) {
@@ -2319,21 +3610,21 @@ static bool asduReceivedHandler(void *parameter, int address, CS101_ASDU asdu) {
 
                 // Cleanup after use
                 MeasuredValueScaledWithCP24Time2a_destroy(io);
-                printf("\n"); // Ensure new line for next data point
+                TRACE("\n"); // Ensure new line for next data point
             }
             break;
         }
         case M_ME_NC_1: {
-            printf("  measured value, short value:\n");
+            TRACE("  measured value, short value:\n");
             int i;
             for (i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 MeasuredValueShort io = (MeasuredValueShort)CS101_ASDU_getElement(asdu, i);
                 int value = MeasuredValueShort_getValue(io); // Get the short value
 
                 // Print the IOA and value with improved formatting for clarity
-                printf("    IOA: %i, value: %d\n",
-                       InformationObject_getObjectAddress((InformationObject) io),
-                       value);
+                TRACE("    IOA: %i, value: %d\n",
+                      InformationObject_getObjectAddress((InformationObject) io),
+                      value);
 
                 // Optionally log the data if logging is enabled
                 if (dataConfig == 1) {
@@ -2343,25 +3634,25 @@ static bool asduReceivedHandler(void *parameter, int address, CS101_ASDU asdu) {
 
                 // Cleanup after use
                 MeasuredValueShort_destroy(io);
-                printf("\n");  // Ensuring each entry is visually separated
+                TRACE("\n");  // Ensuring each entry is visually separated
             }
             break;
         }
 
         case M_ME_TC_1: { //TADY TOE DOBRY MYSLIM
-            printf("  measured value, short value with CP24Time2a timestamp:\n");
+            TRACE("  measured value, short value with CP24Time2a timestamp:\n");
             int i;
             for (i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 MeasuredValueShortWithCP24Time2a io = (MeasuredValueShortWithCP24Time2a) CS101_ASDU_getElement(asdu, i);
                 int value = MeasuredValueShort_getValue(io); // Get the short value
 
                 // Print the IOA, value, and format the timestamp
-                printf("    IOA: %i value: %d time: ",
-                       InformationObject_getObjectAddress((InformationObject) io),
-                       value);
+                TRACE("    IOA: %i value: %d time: ",
+                      InformationObject_getObjectAddress((InformationObject) io),
+                      value);
 
                 // Function to print the timestamp in a readable format
-                printCP24Time2a(MeasuredValueShortWithCP24Time2a_getTimestamp(io));
+                if (trace) printCP24Time2a(MeasuredValueShortWithCP24Time2a_getTimestamp(io));
 
                 // Optionally log the data if logging is enabled
                 if (dataConfig == 1) {
@@ -2370,24 +3661,24 @@ static bool asduReceivedHandler(void *parameter, int address, CS101_ASDU asdu) {
 
                 // Cleanup after use
                 MeasuredValueShortWithCP24Time2a_destroy(io);
-                printf("\n"); // New line for each point for better readability
+                TRACE("\n"); // New line for each point for better readability
             }
             break;
         }
         case M_SP_TB_1: {
-            printf("  single point information with CP56Time2a timestamp:\n");
+            TRACE("  single point information with CP56Time2a timestamp:\n");
             int i;
             for (i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 SinglePointWithCP56Time2a io = (SinglePointWithCP56Time2a) CS101_ASDU_getElement(asdu, i);
                 bool value = SinglePointInformation_getValue(io); // Gets the boolean state
 
                 // Print the IOA, value as True/False, and the formatted timestamp
-                printf("    IOA: %i value: %s time: ",
-                       InformationObject_getObjectAddress((InformationObject) io),
-                       value ? "True" : "False");
+                TRACE("    IOA: %i value: %s time: ",
+                      InformationObject_getObjectAddress((InformationObject) io),
+                      value ? "True" : "False");
 
                 // Function to print the timestamp in a readable format
-                printCP56Time2a(SinglePointWithCP56Time2a_getTimestamp(io));
+                if (trace) printCP56Time2a(SinglePointWithCP56Time2a_getTimestamp(io));
 
                 // Optionally log the data if logging is enabled
                 if (dataConfig == 1) {
@@ -2396,13 +3687,13 @@ static bool asduReceivedHandler(void *parameter, int address, CS101_ASDU asdu) {
 
                 // Cleanup after use
                 SinglePointWithCP56Time2a_destroy(io);
-                printf("\n"); // New line for each point for better readability
+                TRACE("\n"); // New line for each point for better readability
             }
             break;
         }
 
         case M_DP_TB_1: {
-            printf("  double point information with CP56Time2a timestamp:\n");
+            TRACE("  double point information with CP56Time2a timestamp:\n");
             int i;
             for (i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 DoublePointWithCP56Time2a io = (DoublePointWithCP56Time2a) CS101_ASDU_getElement(asdu, i);
@@ -2428,10 +3719,10 @@ static bool asduReceivedHandler(void *parameter, int address, CS101_ASDU asdu) {
                 }
 
                 // Displaying the IOA, descriptive value and timestamp
-                printf("    IOA: %i value: %s time: ", InformationObject_getObjectAddress((InformationObject) io), valueDescription);
+                TRACE("    IOA: %i value: %s time: ", InformationObject_getObjectAddress((InformationObject) io), valueDescription);
 
                 // Function to print time in a readable format
-                printCP56Time2a(DoublePointWithCP56Time2a_getTimestamp(io));
+                if (trace) printCP56Time2a(DoublePointWithCP56Time2a_getTimestamp(io));
 
                 // Optionally log the data if logging is enabled
                 if (dataConfig == 1) {
@@ -2441,21 +3732,21 @@ static bool asduReceivedHandler(void *parameter, int address, CS101_ASDU asdu) {
                 }
 
                 DoublePointWithCP56Time2a_destroy(io);
-                printf("\n");  // Ensuring each entry is visually separated
+                TRACE("\n");  // Ensuring each entry is visually separated
             }
             break;
         }
         case M_ME_TD_1: {
-            printf("  measured normalized value with CP56Time2a timestamp:\n");
+            TRACE("  measured normalized value with CP56Time2a timestamp:\n");
             int i;
 
             for (i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 MeasuredValueScaledWithCP56Time2a io = (MeasuredValueScaledWithCP56Time2a)CS101_ASDU_getElement(asdu, i);
                 float normalizedValue = MeasuredValueNormalized_getValue(io);
 
-                printf("    IOA: %i, Normalized Value: %6.3f ",
-                       InformationObject_getObjectAddress((InformationObject) io), normalizedValue);
-                printCP56Time2a(MeasuredValueScaledWithCP56Time2a_getTimestamp(io));
+                TRACE("    IOA: %i, Normalized Value: %6.3f ",
+                      InformationObject_getObjectAddress((InformationObject) io), normalizedValue);
+                if (trace) printCP56Time2a(MeasuredValueScaledWithCP56Time2a_getTimestamp(io));
                 if (dataConfig == 1) {
                     LogRXwT(InformationObject_getObjectAddress((InformationObject) io),
                             MeasuredValueScaled_getValue((MeasuredValueScaled) io),
@@ -2463,12 +3754,12 @@ static bool asduReceivedHandler(void *parameter, int address, CS101_ASDU asdu) {
                 }
 
                 MeasuredValueScaledWithCP56Time2a_destroy(io);
-                printf("\n");  // Ensuring each entry is separated clearly
+                TRACE("\n");  // Ensuring each entry is separated clearly
             }
             break;
         }
         case M_ME_TE_1: {
-            printf("  measured scaled value with CP56Time2a timestamp:\n");
+            TRACE("  measured scaled value with CP56Time2a timestamp:\n");
 
             int i;
 
@@ -2476,178 +3767,178 @@ static bool asduReceivedHandler(void *parameter, int address, CS101_ASDU asdu) {
                 MeasuredValueScaledWithCP56Time2a io = (MeasuredValueScaledWithCP56Time2a)CS101_ASDU_getElement(asdu, i);
                 int value = MeasuredValueScaled_getValue(io); // Extract value
                 // Assuming the values are scaled and should be displayed as floating-point for better precision
-                printf("    IOA: %i, value: %d, time: ",
-                       InformationObject_getObjectAddress((InformationObject) io),
-                       value);
-                printCP56Time2a(MeasuredValueScaledWithCP56Time2a_getTimestamp(io));
+                TRACE("    IOA: %i, value: %d, time: ",
+                      InformationObject_getObjectAddress((InformationObject) io),
+                      value);
+                if (trace) printCP56Time2a(MeasuredValueScaledWithCP56Time2a_getTimestamp(io));
                 if (dataConfig == 1) {
                     LogRXwT(InformationObject_getObjectAddress((InformationObject) io),
                             MeasuredValueScaled_getValue((MeasuredValueScaled) io),
                             MeasuredValueScaledWithCP56Time2a_getTimestamp(io));
                 }
                 MeasuredValueScaledWithCP56Time2a_destroy(io);
-                printf("\n"); // Adding a newline for better readability between entries
+                TRACE("\n"); // Adding a newline for better readability between entries
             }
             break;
         }
         case M_ME_TF_1: {
-            printf("  measured short float value with CP56Time2a timestamp:\n");
+            TRACE("  measured short float value with CP56Time2a timestamp:\n");
             int i;
             for (i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 MeasuredValueShortWithCP56Time2a io = (MeasuredValueShortWithCP56Time2a) CS101_ASDU_getElement(asdu, i);
-                printf("    IOA: %i value: %.2f time: ",
-                       InformationObject_getObjectAddress((InformationObject) io),
-                       MeasuredValueShort_getValue((MeasuredValueShort) io));
-                printCP56Time2a(MeasuredValueShortWithCP56Time2a_getTimestamp(io));
+                TRACE("    IOA: %i value: %.2f time: ",
+                      InformationObject_getObjectAddress((InformationObject) io),
+                      MeasuredValueShort_getValue((MeasuredValueShort) io));
+                if (trace) printCP56Time2a(MeasuredValueShortWithCP56Time2a_getTimestamp(io));
                 if (dataConfig == 1) {
                     LogRXwT(InformationObject_getObjectAddress((InformationObject) io),
                             MeasuredValueShort_getValue((MeasuredValueShort) io),
                             MeasuredValueShortWithCP56Time2a_getTimestamp(io));
                 }
                 MeasuredValueShortWithCP56Time2a_destroy(io);
-                printf("\n");
+                TRACE("\n");
             }
             break;
         }
             /* === NEW RX: Step position (5,6,32) === */
         case M_ST_NA_1: {
-            printf("  step position information:\n");
+            TRACE("  step position information:\n");
             for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 StepPositionInformation io = (StepPositionInformation) CS101_ASDU_getElement(asdu, i);
                 int v = StepPositionInformation_getValue(io);
                 bool tr = StepPositionInformation_isTransient(io);
-                printf("    IOA: %i value: %d transient: %s\n",
-                       InformationObject_getObjectAddress((InformationObject) io), v, tr ? "true" : "false");
+                TRACE("    IOA: %i value: %d transient: %s\n",
+                      InformationObject_getObjectAddress((InformationObject) io), v, tr ? "true" : "false");
                 if (dataConfig == 1) LogRXwoT(InformationObject_getObjectAddress((InformationObject) io), v);
                 StepPositionInformation_destroy(io);
-                printf("\n");
+                TRACE("\n");
             }
             break;
         }
         case M_ST_TA_1: {
-            printf("  step position information with CP24Time2a:\n");
+            TRACE("  step position information with CP24Time2a:\n");
             for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 StepPositionWithCP24Time2a io = (StepPositionWithCP24Time2a) CS101_ASDU_getElement(asdu, i);
                 int v = StepPositionInformation_getValue((StepPositionInformation) io);
                 bool tr = StepPositionInformation_isTransient((StepPositionInformation) io);
-                printf("    IOA: %i value: %d transient: %s time: ",
-                       InformationObject_getObjectAddress((InformationObject) io), v, tr ? "true" : "false");
-                printCP24Time2a(StepPositionWithCP24Time2a_getTimestamp(io));
+                TRACE("    IOA: %i value: %d transient: %s time: ",
+                      InformationObject_getObjectAddress((InformationObject) io), v, tr ? "true" : "false");
+                if (trace) printCP24Time2a(StepPositionWithCP24Time2a_getTimestamp(io));
                 if (dataConfig == 1) LogRXwT24(InformationObject_getObjectAddress((InformationObject) io), v,
                                                StepPositionWithCP24Time2a_getTimestamp(io));
                 StepPositionWithCP24Time2a_destroy(io);
-                printf("\n");
+                TRACE("\n");
             }
             break;
         }
         case M_ST_TB_1: {
-            printf("  step position information with CP56Time2a:\n");
+            TRACE("  step position information with CP56Time2a:\n");
             for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 StepPositionWithCP56Time2a io = (StepPositionWithCP56Time2a) CS101_ASDU_getElement(asdu, i);
                 int v = StepPositionInformation_getValue((StepPositionInformation) io);
                 bool tr = StepPositionInformation_isTransient((StepPositionInformation) io);
-                printf("    IOA: %i value: %d transient: %s time: ",
-                       InformationObject_getObjectAddress((InformationObject) io), v, tr ? "true" : "false");
-                printCP56Time2a(StepPositionWithCP56Time2a_getTimestamp(io));
+                TRACE("    IOA: %i value: %d transient: %s time: ",
+                      InformationObject_getObjectAddress((InformationObject) io), v, tr ? "true" : "false");
+                if (trace) printCP56Time2a(StepPositionWithCP56Time2a_getTimestamp(io));
                 if (dataConfig == 1) LogRXwT(InformationObject_getObjectAddress((InformationObject) io), v,
                                              StepPositionWithCP56Time2a_getTimestamp(io));
                 StepPositionWithCP56Time2a_destroy(io);
-                printf("\n");
+                TRACE("\n");
             }
             break;
         }
 
             /* === NEW RX: Bitstring32 (7,8,33) === */
         case M_BO_NA_1: {
-            printf("  bitstring32 value:\n");
+            TRACE("  bitstring32 value:\n");
             for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 BitString32 io = (BitString32) CS101_ASDU_getElement(asdu, i);
                 uint32_t v = BitString32_getValue(io);
-                printf("    IOA: %i value: 0x%08x\n",
-                       InformationObject_getObjectAddress((InformationObject) io), v);
+                TRACE("    IOA: %i value: 0x%08x\n",
+                      InformationObject_getObjectAddress((InformationObject) io), v);
                 if (dataConfig == 1) LogRXwoT(InformationObject_getObjectAddress((InformationObject) io), (float)v);
                 BitString32_destroy(io);
-                printf("\n");
+                TRACE("\n");
             }
             break;
         }
         case M_BO_TA_1: {
-            printf("  bitstring32 value with CP24Time2a:\n");
+            TRACE("  bitstring32 value with CP24Time2a:\n");
             for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 Bitstring32WithCP24Time2a io = (Bitstring32WithCP24Time2a) CS101_ASDU_getElement(asdu, i);
                 uint32_t v = BitString32_getValue((BitString32) io);
-                printf("    IOA: %i value: 0x%08x time: ",
-                       InformationObject_getObjectAddress((InformationObject) io), v);
-                printCP24Time2a(Bitstring32WithCP24Time2a_getTimestamp(io));
+                TRACE("    IOA: %i value: 0x%08x time: ",
+                      InformationObject_getObjectAddress((InformationObject) io), v);
+                if (trace) printCP24Time2a(Bitstring32WithCP24Time2a_getTimestamp(io));
                 if (dataConfig == 1) LogRXwT24(InformationObject_getObjectAddress((InformationObject) io), (float)v,
                                                Bitstring32WithCP24Time2a_getTimestamp(io));
                 Bitstring32WithCP24Time2a_destroy(io);
-                printf("\n");
+                TRACE("\n");
             }
             break;
         }
         case M_BO_TB_1: {
-            printf("  bitstring32 value with CP56Time2a:\n");
+            TRACE("  bitstring32 value with CP56Time2a:\n");
             for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 Bitstring32WithCP56Time2a io = (Bitstring32WithCP56Time2a) CS101_ASDU_getElement(asdu, i);
                 uint32_t v = BitString32_getValue((BitString32) io);
-                printf("    IOA: %i value: 0x%08x time: ",
-                       InformationObject_getObjectAddress((InformationObject) io), v);
-                printCP56Time2a(Bitstring32WithCP56Time2a_getTimestamp(io));
+                TRACE("    IOA: %i value: 0x%08x time: ",
+                      InformationObject_getObjectAddress((InformationObject) io), v);
+                if (trace) printCP56Time2a(Bitstring32WithCP56Time2a_getTimestamp(io));
                 if (dataConfig == 1) LogRXwT(InformationObject_getObjectAddress((InformationObject) io), (float)v,
                                              Bitstring32WithCP56Time2a_getTimestamp(io));
                 Bitstring32WithCP56Time2a_destroy(io);
-                printf("\n");
+                TRACE("\n");
             }
             break;
         }
 
             /* === NEW RX: Integrated totals / BCR (15,16,37) === */
         case M_IT_NA_1: {
-            printf("  integrated totals (BCR):\n");
+            TRACE("  integrated totals (BCR):\n");
             for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 IntegratedTotals io = (IntegratedTotals) CS101_ASDU_getElement(asdu, i);
                 BinaryCounterReading b = IntegratedTotals_getBCR(io);
                 int32_t val = BinaryCounterReading_getValue(b);
-                printf("    IOA: %i value: %d\n",
-                       InformationObject_getObjectAddress((InformationObject) io), val);
+                TRACE("    IOA: %i value: %d\n",
+                      InformationObject_getObjectAddress((InformationObject) io), val);
                 if (dataConfig == 1) LogRXwoT(InformationObject_getObjectAddress((InformationObject) io), (float)val);
                 IntegratedTotals_destroy(io);
-                printf("\n");
+                TRACE("\n");
             }
             break;
         }
 
         case M_IT_TA_1: {
-            printf("  integrated totals (BCR) with CP24Time2a:\n");
+            TRACE("  integrated totals (BCR) with CP24Time2a:\n");
             for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 IntegratedTotalsWithCP24Time2a io = (IntegratedTotalsWithCP24Time2a) CS101_ASDU_getElement(asdu, i);
                 BinaryCounterReading b = IntegratedTotals_getBCR((IntegratedTotals) io);
                 int32_t val = BinaryCounterReading_getValue(b);
-                printf("    IOA: %i value: %d time: ",
-                       InformationObject_getObjectAddress((InformationObject) io), val);
-                printCP24Time2a(IntegratedTotalsWithCP24Time2a_getTimestamp(io));
+                TRACE("    IOA: %i value: %d time: ",
+                      InformationObject_getObjectAddress((InformationObject) io), val);
+                if (trace) printCP24Time2a(IntegratedTotalsWithCP24Time2a_getTimestamp(io));
                 if (dataConfig == 1) LogRXwT24(InformationObject_getObjectAddress((InformationObject) io), (float)val,
                                                IntegratedTotalsWithCP24Time2a_getTimestamp(io));
                 IntegratedTotalsWithCP24Time2a_destroy(io);
-                printf("\n");
+                TRACE("\n");
             }
             break;
         }
 
         case M_IT_TB_1: {
-            printf("  integrated totals (BCR) with CP56Time2a:\n");
+            TRACE("  integrated totals (BCR) with CP56Time2a:\n");
             for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
                 IntegratedTotalsWithCP56Time2a io = (IntegratedTotalsWithCP56Time2a) CS101_ASDU_getElement(asdu, i);
                 BinaryCounterReading b = IntegratedTotals_getBCR((IntegratedTotals) io);
                 int32_t val = BinaryCounterReading_getValue(b);
-                printf("    IOA: %i value: %d time: ",
-                       InformationObject_getObjectAddress((InformationObject) io), val);
-                printCP56Time2a(IntegratedTotalsWithCP56Time2a_getTimestamp(io));
+                TRACE("    IOA: %i value: %d time: ",
+                      InformationObject_getObjectAddress((InformationObject) io), val);
+                if (trace) printCP56Time2a(IntegratedTotalsWithCP56Time2a_getTimestamp(io));
                 if (dataConfig == 1) LogRXwT(InformationObject_getObjectAddress((InformationObject) io), (float)val,
                                              IntegratedTotalsWithCP56Time2a_getTimestamp(io));
                 IntegratedTotalsWithCP56Time2a_destroy(io);
-                printf("\n");
+                TRACE("\n");
             }
             break;
         }
@@ -2705,42 +3996,222 @@ InformationObject createIO_client(int messageType, int ioa, float value) {
 }
 
 // Spuštění klienta IEC 104 podle konfigurace
+// =======================
+// ČASOVAČE BODŮ KLIENTA S VLASTNÍ PERIODOU
+// =======================
+
+// Odeslání commandu jednoho bodu (index do points)
+typedef void (*PointSendFunction)(void *context, int index);
+
+// Jeden časovač obsluhuje všechny body se stejnou vlastní periodou
+typedef struct {
+    uint32_t periodMs;
+    Timer timer;
+    PointSendFunction send;
+    void *context;
+} PointTimer;
+
+static TimerWheel clientWheel = NULL;
+static PointTimer pointTimers[PERIODIC_MAX_GROUPS];
+static int numPointTimers = 0;
+
+static TempJournal tempJournal = NULL;     // Odeslané TEMP zprávy (viz uni_journal.h)
+static ConfigStamp clientConfigStamp;      // Otisk iec_config.txt při posledním načtení bodů
+
+// Pošle bod; odeslaný TEMP bod se zapíše do deníku a znovu se už neposílá
+static void sendPoint(PointSendFunction send, void *context, int i) {
+    if (points->flags[i] & POINT_FLAG_CONSUMED) return;
+    send(context, i);
+    if (points->lastSent[i] != 0) TempJournal_consume(tempJournal, points, i);
+}
+
+// Callback: pošle všechny body s periodou časovače (TEMP body jen jednou)
+static void onPointTimer(void *parameter, uint64_t now) {
+    (void) now;
+    PointTimer *pt = (PointTimer *) parameter;
+    for (int i = 0; i < points->count; ++i) {
+        if (points->periodMs[i] != pt->periodMs) continue;
+        sendPoint(pt->send, pt->context, i);
+    }
+}
+
+// Po (znovu)načtení konfigurace spustí časovače pro nové periody a zastaví nepoužívané
+static void updatePointTimers(TimerWheel wheel, PointSendFunction send, void *context) {
+    bool used[PERIODIC_MAX_GROUPS] = {false};
+
+    for (int i = 0; i < points->count; ++i) {
+        uint32_t period = points->periodMs[i];
+        if (period == 0) continue;
+
+        int t = 0;
+        while (t < numPointTimers && pointTimers[t].periodMs != period) ++t;
+
+        if (t == numPointTimers) {
+            if (numPointTimers == PERIODIC_MAX_GROUPS) {
+                fprintf(stderr, "Příliš mnoho různých period (max %d), bod IOA %d použije globální PERIOD\n",
+                        PERIODIC_MAX_GROUPS, points->ioa[i]);
+                PointTable_setPeriod(points, i, 0);
+                continue;
+            }
+            pointTimers[t].periodMs = period;
+            pointTimers[t].timer = TimerWheel_addTimer(wheel, onPointTimer, &pointTimers[t]);
+            numPointTimers++;
+        }
+
+        used[t] = true;
+        pointTimers[t].send = send;
+        pointTimers[t].context = context;
+        // Běžící časovač nerestartuj – zachová fázi přes reload konfigurace
+        if (!TimerWheel_isActive(pointTimers[t].timer))
+            TimerWheel_start(wheel, pointTimers[t].timer, period, period);
+    }
+
+    for (int t = 0; t < numPointTimers; ++t) {
+        if (!used[t]) TimerWheel_stop(wheel, pointTimers[t].timer);
+    }
+}
+
+// Otevře deník TEMP zpráv a označí body odeslané v minulém běhu
+static void openTempJournal(void) {
+    tempJournal = TempJournal_open("iec_config.txt");
+    TempJournal_apply(tempJournal, points);
+    ConfigFile_hasChanged("iec_config.txt", &clientConfigStamp);
+}
+
+// Zhustí deník, pokud už je dlouhý (jen tehdy se přepisuje konfigurační soubor)
+static void compactTempJournal(void) {
+    if (TempJournal_getPending(tempJournal) >= TEMP_JOURNAL_COMPACT_AT)
+        TempJournal_compact(tempJournal);
+}
+
+// Znovu načte body jen při změně souboru (toggleState a odeslané TEMP zůstanou zachované)
+static void reloadClientPoints(PointSendFunction send, void *context) {
+    if (!ConfigFile_hasChanged("iec_config.txt", &clientConfigStamp)) return;
+
+    PointTable previousPoints = points;
+    points = NULL;
+    readMessageConfig("iec_config.txt");
+    PointTable_copyToggleStates(points, previousPoints);
+    PointTable_destroy(previousPoints);
+    TempJournal_apply(tempJournal, points);
+    updatePointTimers(clientWheel, send, context);
+}
+
+// Pošle jeden command bodu i (104) a zaloguje ho
+static void sendCommand104(void *parameter, int i) {
+    Config *cfg = (Config *) parameter;
+    if (con == NULL) return;
+
+    bool isPerm = (points->flags[i] & POINT_FLAG_PERMANENT) != 0;
+    bool isToggle = (points->flags[i] & POINT_FLAG_TOGGLE) != 0;
+    float valueToSend = PointTable_getSendValue(points, i);
+
+    InformationObject io = createIO_client(points->type[i], points->ioa[i], valueToSend);
+    // Zaznamenat před odesláním – ACT_CON může přijít dřív, než send vrátí
+    if (commandLatency) CommandLatency_onSent(commandLatency, 0, points->type[i], cfg->commonAddress, points->ioa[i]);
+    CS104_Connection_sendProcessCommandEx(con, CS101_COT_ACTIVATION, cfg->commonAddress, io);
+
+    bool trace = trafficStats ? TrafficStats_onAsdu(trafficStats, STATS_TX, points->type[i], CS101_COT_ACTIVATION, 1) : true;
+    TRACE("[CLIENT - 104] Sent command: TYPE=%d | IOA=%d | VALUE=%.2f (%s)\n",
+          points->type[i],
+          points->ioa[i],
+          valueToSend,
+          isPerm ? (isToggle ? "PERM-DUAL" : "PERM") : "TEMP"
+    );
+    if (dataConfig == 1) {
+        LogTX(points->type[i], 1, cfg->originatorAddress, cfg->commonAddress);
+        LogTXwoT(points->ioa[i], valueToSend);
+    }
+    InformationObject_destroy(io);
+
+    if (isPerm && isToggle) {
+        points->toggleState[i] = !points->toggleState[i];
+    }
+
+    points->lastSent[i] = Hal_getTimeInMs();
+}
+
+// Jeden cyklus klienta 104 (volá ho časovač s globální periodou)
+static void clientCycle104(void *parameter, uint64_t now) {
+    (void) now;
+    Config *cfg = (Config *) parameter;
+
+    // --- Pokud je spojení zavřené, zkus znovu připojit ---
+    if (con == NULL) {
+        con = CS104_Connection_create(cfg->ip, cfg->port);
+        CS104_Connection_setConnectionHandler(con, connectionHandler, NULL);
+        CS104_Connection_setASDUReceivedHandler(con, asduReceivedHandler, NULL);
+        if (trafficStats || frameCapture) CS104_Connection_setRawMessageHandler(con, rawFrameHandler, NULL);
+        if (!CS104_Connection_connect(con)) {
+            printf("Connect failed!\n");
+            CS104_Connection_destroy(con);
+            con = NULL;
+            return;
+        } else {
+            CS104_Connection_sendStartDT(con);
+            Thread_sleep(1000);
+        }
+    }
+
+    // === Při přehrávání záznamu tvoří provoz klienta jen záznam ===
+    if (cfg->replayPath[0]) return;
+
+    // === Odeslání commandů 45/46 (body s vlastní periodou mají svůj časovač) ===
+    for (int i = 0; i < points->count; ++i) {
+        if (points->periodMs[i] != 0) continue;
+        sendPoint(sendCommand104, cfg, i);
+    }
+
+    // === Odeslané TEMP jsou jen v deníku, soubor se přepíše až při zhuštění ===
+    compactTempJournal();
+
+    // === Změny souboru (nové TEMP zprávy, jiné hodnoty) se načtou jen když soubor někdo změnil ===
+    reloadClientPoints(sendCommand104, cfg);
+
+    // === Odeslat SYNC (pokud zapnuto) ===
+    if (cfg->sync == 1) {
+        struct sCP56Time2a newTime;
+        CP56Time2a_createFromMsTimestamp(&newTime, Hal_getTimeInMs());
+        printf("[CLIENT - 104] Sync command sent\n");
+        if (commandLatency) CommandLatency_onSent(commandLatency, 0, C_CS_NA_1, cfg->commonAddress, 0);
+        CS104_Connection_sendClockSyncCommand(con, cfg->commonAddress, &newTime);
+    }
+
+    // === Odeslat INTERROGATION ===
+    if (commandLatency) CommandLatency_onSent(commandLatency, 0, C_IC_NA_1, cfg->commonAddress, 0);
+    CS104_Connection_sendInterrogationCommand(con, CS101_COT_ACTIVATION, cfg->commonAddress,
+                                              IEC60870_QOI_STATION);
+    printf("[CLIENT - 104] Interrogation command sent\n");
+    if (serviceConfig == 1) LogTXrequest(IEC60870_QOI_STATION);
+
+    // === Po periodě případně zavři spojení ===
+    if (cfg->disconnectAfterSend == 1) {
+        Thread_sleep(1000); // nech přijít odpovědi
+        printf("[CLIENT - 104] Disconnecting after read\n");
+        CS104_Connection_close(con);
+        CS104_Connection_destroy(con);
+        con = NULL;
+    }
+}
+
 void runClient104(Config cfg) {
     printf("[CLIENT - 104] Připojuji se na server %s:%d, CA %d, OA %d\n", cfg.ip, cfg.port, cfg.commonAddress,
            cfg.originatorAddress);
-    printf("[CLIENT - 104] Perioda: %ds | SYNC: %s | DisconnectAfterSend: %s | DataLog: %s | ServiceLog: %s\n",
-           cfg.period,
+    printf("[CLIENT - 104] Perioda: %d ms | SYNC: %s | DisconnectAfterSend: %s | DataLog: %s | ServiceLog: %s\n",
+           cfg.periodMs,
            cfg.sync ? "ANO" : "NE",
            cfg.disconnectAfterSend ? "ANO" : "NE",
            cfg.dataLogs ? "ANO" : "NE",
            cfg.serviceLogs ? "ANO" : "NE"
     );
 
-    if (cfg.dataLogs) dataConfig = 1;
-    if (cfg.serviceLogs) serviceConfig = 1;
-    if (strlen(cfg.dataPath) > 0) dataPath = cfg.dataPath;
-    if (strlen(cfg.servicePath) > 0) servicePath = cfg.servicePath;
-
-    if (serviceConfig == 1) {
-        LogSTART("Client");
-    }
+    startLogging(&cfg, "Client");
+    createTrafficStats(&cfg);
+    createFrameCapture(&cfg, true, false, "[CLIENT - 104]");
 
 
     originatorAddress = cfg.originatorAddress;
-    int periodicInterval = cfg.period > 0 ? cfg.period : 20;
-    int syncSwitch = cfg.sync;
-    int discaftersendSwitch = cfg.disconnectAfterSend;
-
-    typedef struct {
-        int messageType;
-        int ioa;
-        bool toggleState;
-    } ToggleBackup;
-
-    ToggleBackup toggleBackup[MAX_MESSAGE_CONFIGS];
-    int numToggleBackup = 0;
-
-    lastSentTime = time(NULL);
+    int periodicInterval = cfg.periodMs > 0 ? cfg.periodMs : 20000;
 
     // Připrav spojení, ale ještě se nemusí připojit (NULL znamená nepřipojený stav)
     con = NULL;
@@ -2754,6 +4225,10 @@ void runClient104(Config cfg) {
     // Nastavení callbacků
     CS104_Connection_setConnectionHandler(con, connectionHandler, NULL);
     CS104_Connection_setASDUReceivedHandler(con, asduReceivedHandler, NULL);
+    if (trafficStats || frameCapture) CS104_Connection_setRawMessageHandler(con, rawFrameHandler, NULL);
+    createStateTable(&cfg, alParams->sizeOfIOA);
+    StateContext state = {NULL, NULL, cfg.stateExportPath, "[CLIENT - 104]"};
+    createCommandLatency(&cfg, points->count + 2, alParams->sizeOfIOA);
 
 
     if (!CS104_Connection_connect(con)) {
@@ -2764,184 +4239,276 @@ void runClient104(Config cfg) {
         CS104_Connection_sendStartDT(con);
         Thread_sleep(1000);
 
-        // 1. Nejprve načti config
-        readMessageConfig("iec_config.txt");
-
-        // 2. Hlavní smyčka klienta
+        // 1. Časovače: hlavní cyklus s globální periodou + body s vlastní periodou
+        openTempJournal();
+        clientWheel = TimerWheel_create();
+        Timer cycleTimer = TimerWheel_addTimer(clientWheel, clientCycle104, &cfg);
+        TimerWheel_start(clientWheel, cycleTimer, periodicInterval, periodicInterval);
+
+        // Parametry ASDU se kopírují – při opětovném připojení vzniká nové spojení
+        struct sCS101_AppLayerParameters replayParams = *alParams;
+        ReplayContext replay = {.wheel = clientWheel, .alParams = &replayParams, .server = false,
+                                .send = replaySendClient104, .label = "[CLIENT - 104]"};
+        if (!startReplay(&replay, &cfg))
+            updatePointTimers(clientWheel, sendCommand104, &cfg);
+
+        StatsContext stats = {clientWheel, NULL, NULL, "[CLIENT - 104]"};
+        startStats(&stats, &cfg);
+        state.wheel = clientWheel;
+        startStateExport(&state, &cfg);
+        LatencyContext latency = {clientWheel, NULL, "[CLIENT - 104]"};
+        startLatencyReport(&latency, &cfg);
+
+        // 2. Hlavní smyčka klienta – spí přesně do nejbližšího termínu
         while (running) {
-            time_t currentTime = time(NULL);
-
-            if (difftime(currentTime, lastSentTime) >= periodicInterval) {
-
-                // --- Pokud je spojení zavřené, zkus znovu připojit ---
-                if (con == NULL) {
-                    con = CS104_Connection_create(cfg.ip, cfg.port);
-                    CS104_Connection_setConnectionHandler(con, connectionHandler, NULL);
-                    CS104_Connection_setASDUReceivedHandler(con, asduReceivedHandler, NULL);
-                    if (!CS104_Connection_connect(con)) {
-                        printf("Connect failed!\n");
-                        CS104_Connection_destroy(con);
-                        con = NULL;
-                        Thread_sleep(1000);
-                        lastSentTime = currentTime;
-                        continue;
-                    } else {
-                        CS104_Connection_sendStartDT(con);
-                        Thread_sleep(1000);
-                    }
-                }
+            TimerWheel_process(clientWheel);
+            TimerWheel_sleep(clientWheel, 1000);
+        }
+
+        TimerWheel_destroy(clientWheel);
+        clientWheel = NULL;
+        numPointTimers = 0;
+        TempJournal_close(tempJournal);
+        tempJournal = NULL;
+
+        // Při ukončení aplikace spojení ukliď (pokud je ještě otevřené)
+        if (con) {
+            CS104_Connection_close(con);
+            CS104_Connection_destroy(con);
+            con = NULL;
+        }
+        stopReplay(&replay);
+    }
+
+    stopStateTable(&state);
+    stopCommandLatency("[CLIENT - 104]");
+    stopCapture("[CLIENT - 104]");
+    stopStats();
+    stopLogging();
+}
+
+
+// =======================
+// VÍCE SPOJENÍ KLIENTA 104 (CLIENTS)
+// =======================
 
-                // === Odeslání commandů 45/46 ===
-                bool toDelete[MAX_MESSAGE_CONFIGS] = {false};
+// Stav klienta s více spojeními předávaný do callbacků
+typedef struct {
+    Config *cfg;
+    ClientPool pool;
+    const char *label;
+} MultiClientContext;
+
+// Příjem ze všech spojení: jen čítače, stavová tabulka a vzorkovaný jednořádkový výpis
+static void multiAsduHandler(void *context, int connection, CS101_ASDU asdu) {
+    MultiClientContext *ctx = (MultiClientContext *) context;
+    bool trace = false;
+    if (trafficStats)
+        trace = TrafficStats_onAsdu(trafficStats, STATS_RX, CS101_ASDU_getTypeID(asdu), CS101_ASDU_getCOT(asdu),
+                                    CS101_ASDU_getNumberOfElements(asdu));
+    if (clientState) StateTable_update(clientState, asdu);
+    if (commandLatency) CommandLatency_onReceived(commandLatency, connection, asdu);
+    TRACE("%s #%d RECVD ASDU | CA: %d | TYPE: %s(%d) | COT: %d | IOs: %d\n", ctx->label, connection,
+          CS101_ASDU_getCA(asdu), TypeID_toString(CS101_ASDU_getTypeID(asdu)), CS101_ASDU_getTypeID(asdu),
+          CS101_ASDU_getCOT(asdu), CS101_ASDU_getNumberOfElements(asdu));
+}
 
-                numToggleBackup = 0;
-                for (int i = 0; i < numMessageConfigs; ++i) {
-                    MessageConfig *msg = &messageConfigs[i];
-                    for (int j = 0; j < msg->ioContentCount; ++j) {
-                        IOContent *ioContent = &msg->ioContent[j];
-                        float valueToSend = ioContent->toggleEnabled
-                                            ? (ioContent->toggleState ? ioContent->toggleValueB : ioContent->toggleValueA)
-                                            : ioContent->value;
+// Commandy jednoho spojení: PERM body 45/46 (TEMP zprávy patří jen jednomu klientovi)
+static void multiCommand(void *context, int index, CS104_Connection connection, int ca) {
+    for (int i = 0; i < points->count; ++i) {
+        int type = points->type[i];
+        if ((type != 45 && type != 46) || !(points->flags[i] & POINT_FLAG_PERMANENT)) continue;
 
+        InformationObject io = createIO_client(type, points->ioa[i], PointTable_getSendValue(points, i));
+        if (commandLatency) CommandLatency_onSent(commandLatency, index, type, ca, points->ioa[i]);
+        if (CS104_Connection_sendProcessCommandEx(connection, CS101_COT_ACTIVATION, ca, io) && trafficStats)
+            TrafficStats_onAsdu(trafficStats, STATS_TX, type, CS101_COT_ACTIVATION, 1);
+        InformationObject_destroy(io);
 
-                        InformationObject io = createIO_client(msg->messageType, ioContent->ioa, valueToSend);
-                        CS104_Connection_sendProcessCommandEx(con, CS101_COT_ACTIVATION, cfg.commonAddress, io);
+        if (points->flags[i] & POINT_FLAG_TOGGLE)
+            points->toggleState[i] = !points->toggleState[i];
+    }
+}
 
-                        printf("[CLIENT - 104] Sent command: TYPE=%d | IOA=%d | VALUE=%.2f (%s)\n",
-                               msg->messageType,
-                               ioContent->ioa,
-                               valueToSend,
-                               msg->isPermanent ? (ioContent->toggleEnabled ? "PERM-DUAL" : "PERM") : "TEMP"
-                        );
-                        if (dataConfig == 1) {
-                            LogTX(msg->messageType, 1, cfg.originatorAddress, cfg.commonAddress);
-                            LogTXwoT(ioContent->ioa, valueToSend);
-                        }
-                        InformationObject_destroy(io);
+// GI a synchronizace, které rozvrh spojení právě odešle
+static void multiSent(void *context, int connection, int type, int ca) {
+    CommandLatency_onSent(commandLatency, connection, type, ca, 0);
+}
 
+static void onMultiReportTimer(void *parameter, uint64_t now) {
+    (void) now;
+    MultiClientContext *ctx = (MultiClientContext *) parameter;
+    ClientPool_report(ctx->pool, ctx->label);
+}
 
-                        if (msg->isPermanent && ioContent->toggleEnabled) {
-                            ioContent->toggleState = !ioContent->toggleState;
-                        }
+void runMultiClient104(Config cfg) {
+    const char *label = "[CLIENT - 104]";
+    ClientTarget targets[CLIENT_MAX_TARGETS];
+    int numTargets = ClientPool_parseTargets(cfg.clientTargets, cfg.ip, cfg.port, cfg.commonAddress, targets,
+                                             CLIENT_MAX_TARGETS);
 
+    printf("%s %d spojení na %d %s, OA %d\n", label, cfg.clients, numTargets, numTargets == 1 ? "server" : "servery",
+           cfg.originatorAddress);
+    for (int t = 0; t < numTargets; t++)
+        printf("%s   cíl %d: %s:%d, CA %d\n", label, t + 1, targets[t].host, targets[t].port, targets[t].ca);
+
+    startLogging(&cfg, "Client");
+    createTrafficStats(&cfg);
+    createFrameCapture(&cfg, true, false, label);
+    createStateTable(&cfg, 3);                  // 104: IOA má vždy 3 bajty
+    createCommandLatency(&cfg, cfg.clients * (points->count + 2), 3);
+    originatorAddress = cfg.originatorAddress;
+    running = true;
 
-                        if (ioContent->toggleEnabled) {
-                            toggleBackup[numToggleBackup].messageType = msg->messageType;
-                            toggleBackup[numToggleBackup].ioa = ioContent->ioa;
-                            toggleBackup[numToggleBackup].toggleState = ioContent->toggleState;
-                            numToggleBackup++;
-                        }
+    MultiClientContext ctx = {&cfg, NULL, label};
+    ctx.pool = ClientPool_create(targets, numTargets, cfg.clients, cfg.originatorAddress, multiAsduHandler,
+                                 (trafficStats || frameCapture) ? rawFrameHandler : NULL, &ctx);
+    if (ctx.pool == NULL) {
+        printf("%s Chyba: Spojení nelze vytvořit\n", label);
+    } else {
+        // Rozvrhy akcí každého spojení (výchozí je globální PERIOD)
+        int periodMs = cfg.periodMs > 0 ? cfg.periodMs : 20000;
+        ClientSchedule schedule = {
+            cfg.giPeriodMs > 0 ? cfg.giPeriodMs : periodMs,
+            cfg.sync ? (cfg.syncPeriodMs > 0 ? cfg.syncPeriodMs : periodMs) : 0,
+            cfg.commandPeriodMs > 0 ? cfg.commandPeriodMs : periodMs
+        };
+        printf("%s GI každých %d ms, SYNC %s, commandy každých %d ms\n", label, schedule.giMs,
+               schedule.syncMs ? "zapnuto" : "vypnuto", schedule.commandMs);
+
+        TimerWheel wheel = TimerWheel_create();
+        if (commandLatency) ClientPool_setSentHandler(ctx.pool, multiSent);
+        ClientPool_start(ctx.pool, wheel, &schedule, multiCommand);
+
+        int reportMs = cfg.statsReportMs > 0 ? cfg.statsReportMs : 1000;
+        Timer reportTimer = TimerWheel_addTimer(wheel, onMultiReportTimer, &ctx);
+        TimerWheel_start(wheel, reportTimer, reportMs, reportMs);
+
+        StatsContext stats = {wheel, NULL, NULL, label};
+        startStats(&stats, &cfg);
+        StateContext state = {wheel, NULL, cfg.stateExportPath, label};
+        startStateExport(&state, &cfg);
+        LatencyContext latency = {wheel, NULL, label};
+        startLatencyReport(&latency, &cfg);
 
+        while (running) {
+            TimerWheel_process(wheel);
+            TimerWheel_sleep(wheel, 1000);
+        }
 
-                        if (!msg->isPermanent)
-                            toDelete[i] = true;
-                    }
-                }
+        printf("%s Zavírám %d spojení...\n", label, cfg.clients);
+        ClientPool_destroy(ctx.pool);
+        TimerWheel_destroy(wheel);
+        stopStateTable(&state);
+    }
 
+    stopCommandLatency(label);
+    stopCapture(label);
+    stopStats();
+    stopLogging();
+}
 
-                // === Smazání TEMP_MESS z konfigu (pouze odeslané TEMP) ===
-                FILE *file = fopen("iec_config.txt", "r");
-                FILE *temp = fopen("iec_config_temp.txt", "w");
-                if (file && temp) {
-                    char line[256];
-                    bool insideTempBlock = false;
-
-                    while (fgets(line, sizeof(line), file)) {
-                        if (strncmp(line, "TEMP_MESS=", 10) == 0) {
-                            insideTempBlock = true;
-                            fputs(line, temp); // zachovej TEMP_MESS=
-                            continue;
-                        }
-                        if (strncmp(line, "PERM_MESS=", 10) == 0) {
-                            insideTempBlock = false;
-                            fputs(line, temp); // zachovej PERM_MESS=
-                            continue;
-                        }
-
-                        if (insideTempBlock) {
-                            int msgType, ioa;
-                            float value;
-                            // Porovnávej s TEMP zprávami označenými ke smazání
-                            if (sscanf(line, "%d;%d;%f", &msgType, &ioa, &value) == 3) {
-                                bool found = false;
-                                for (int k = 0; k < numMessageConfigs; ++k) {
-                                    if (!messageConfigs[k].isPermanent &&
-                                        toDelete[k] &&
-                                        messageConfigs[k].messageType == msgType &&
-                                        messageConfigs[k].ioContent[0].ioa == ioa) {
-                                        found = true;
-                                        break;
-                                    }
-                                }
-                                if (found) continue; // tuto TEMP zprávu již nezapisuj
-                            }
-                        }
-
-                        // Vše ostatní přepiš
-                        fputs(line, temp);
-                    }
-
-                    fclose(file);
-                    fclose(temp);
-                    remove("iec_config.txt");
-                    rename("iec_config_temp.txt", "iec_config.txt");
-                }
 
+// =======================
+// VÍCE STANIC SERVERU 104 (STATIONS)
+// =======================
 
-                // === AŽ TEĎ znovu načti config, už tam TEMP nejsou ===
-                readMessageConfig("iec_config.txt");
-
-                // --- Obnov toggleState zpět pro DUAL zprávy ---
-                for (int i = 0; i < numMessageConfigs; ++i) {
-                    MessageConfig *msg = &messageConfigs[i];
-                    for (int j = 0; j < msg->ioContentCount; ++j) {
-                        IOContent *ioContent = &msg->ioContent[j];
-                        if (ioContent->toggleEnabled) {
-                            for (int k = 0; k < numToggleBackup; ++k) {
-                                if (toggleBackup[k].messageType == msg->messageType &&
-                                    toggleBackup[k].ioa == ioContent->ioa) {
-                                    ioContent->toggleState = toggleBackup[k].toggleState;
-                                    break;
-                                }
-                            }
-                        }
-                    }
-                }
+#define STATIONS_QUEUE_SIZE 100   // Fronta ASDU každé stanice (periodické zprávy čekající na spojení)
 
-                // === Odeslat SYNC (pokud zapnuto) ===
-                if (syncSwitch == 1) {
-                    struct sCP56Time2a newTime;
-                    CP56Time2a_createFromMsTimestamp(&newTime, Hal_getTimeInMs());
-                    printf("[CLIENT - 104] Sync command sent\n");
-                    CS104_Connection_sendClockSyncCommand(con, cfg.commonAddress, &newTime);
-                }
+static void onStationsReportTimer(void *parameter, uint64_t now) {
+    (void) now;
+    StationPool_report((StationPool) parameter);
+}
 
-                // === Odeslat INTERROGATION ===
-                CS104_Connection_sendInterrogationCommand(con, CS101_COT_ACTIVATION, cfg.commonAddress,
-                                                          IEC60870_QOI_STATION);
-                printf("[CLIENT - 104] Interrogation command sent\n");
-                if (serviceConfig == 1) LogTXrequest(IEC60870_QOI_STATION);
-
-                // === Po periodě případně zavři spojení ===
-                if (discaftersendSwitch == 1) {
-                    Thread_sleep(1000); // nech přijít odpovědi
-                    printf("[CLIENT - 104] Disconnecting after read\n");
-                    CS104_Connection_close(con);
-                    CS104_Connection_destroy(con);
-                    con = NULL;
-                }
+void runMultiServer104(Config cfg) {
+    const char *label = "[SERVER - 104]";
 
-                lastSentTime = currentTime;
-            }
-            Thread_sleep(500);
-        }
+    if (cfg.stationsByCa)
+        printf("%s %d stanic na %s:%d, CA %d až %d, OA %d\n", label, cfg.stations, cfg.ip, cfg.port,
+               cfg.commonAddress, cfg.commonAddress + cfg.stations - 1, cfg.originatorAddress);
+    else
+        printf("%s %d stanic na %s:%d až %d, CA %d, OA %d\n", label, cfg.stations, cfg.ip, cfg.port,
+               cfg.port + cfg.stations - 1, cfg.commonAddress, cfg.originatorAddress);
 
-        // Při ukončení aplikace spojení ukliď (pokud je ještě otevřené)
-        if (con) {
-            CS104_Connection_close(con);
-            CS104_Connection_destroy(con);
-            con = NULL;
+    if (cfg.spontaneousEnable || cfg.eventRate > 0 || cfg.deadbandEnable || cfg.loadRate > 0 || cfg.replayPath[0] ||
+        cfg.hotReload)
+        printf("%s SPONTANEOUS, EVENTS, DEADBAND, LOAD, REPLAY a HOTRELOAD se u více stanic nepoužijí\n", label);
+
+    startLogging(&cfg, "Server");
+    createTrafficStats(&cfg);
+    createFrameCapture(&cfg, true, true, label);
+    running = true;
+
+    StationOptions options = {
+        cfg.stations, cfg.stationsByCa != 0, cfg.ip, cfg.port, cfg.originatorAddress, cfg.commonAddress,
+        cfg.stationPointsPath, "iec_config.txt", cfg.stationWorkers, cfg.periodMs, cfg.generatorTickMs,
+        cfg.multiplier, STATIONS_QUEUE_SIZE, createIO, (trafficStats || frameCapture) ? rawFrameHandler104 : NULL
+    };
+
+    StationPool pool = StationPool_create(&options, label);
+
+    if (pool == NULL) {
+        printf("%s Chyba: Stanice nelze vytvořit\n", label);
+    } else {
+        int listening = StationPool_start(pool);
+        printf("%s Naslouchá %d z %d %s\n", label, listening, cfg.stationsByCa ? 1 : cfg.stations,
+               cfg.stationsByCa ? "portu" : "portů");
+
+        TimerWheel wheel = TimerWheel_create();
+        int reportMs = cfg.statsReportMs > 0 ? cfg.statsReportMs : 1000;
+        Timer reportTimer = TimerWheel_addTimer(wheel, onStationsReportTimer, pool);
+        TimerWheel_start(wheel, reportTimer, reportMs, reportMs);
+
+        StatsContext stats = {wheel, NULL, NULL, label};
+        startStats(&stats, &cfg);
+
+        while (running) {
+            TimerWheel_process(wheel);
+            TimerWheel_sleep(wheel, 1000);
         }
+
+        printf("%s Zastavuji %d stanic...\n", label, cfg.stations);
+        StationPool_destroy(pool);
+        TimerWheel_destroy(wheel);
+    }
+
+    stopCapture(label);
+    stopStats();
+    stopLogging();
+}
+
+
+// =======================
+// SMYČKA LINKOVÉ VRSTVY 101
+// =======================
+
+#define SERIAL_IDLE_MS 50   // Nejdelší čekání bez dat – linková vrstva hlídá časové limity ACK a opakování
+
+typedef void (*LinkRunFunction)(void *link);
+
+static void runSlave101(void *link) {
+    CS101_Slave_run((CS101_Slave) link);
+}
+
+static void runMaster101(void *link) {
+    CS101_Master_run((CS101_Master) link);
+}
+
+// Řízeno událostmi: linková vrstva běží, dokud na lince čekají data, pak se obslouží časovače
+// a smyčka spí na sériovém portu do příchodu dat nebo nejbližšího termínu (run nesmí sám čekat)
+static void runSerialLoop(SerialPort port, TimerWheel wheel, LinkRunFunction run, void *link) {
+    while (running) {
+        do {
+            run(link);
+        } while (running && SerialPort_waitForData(port, 0) > 0);
+
+        // Časovače mohly zařadit ASDU – stavový automat je odešle hned v dalším průchodu
+        if (TimerWheel_process(wheel) > 0)
+            continue;
+
+        int64_t ms = TimerWheel_getMsToNext(wheel);
+        if (ms < 0 || ms > SERIAL_IDLE_MS) ms = SERIAL_IDLE_MS;
+        if (ms > 0) SerialPort_waitForData(port, (int) ms);
     }
 }
 
@@ -2949,15 +4516,13 @@ void runClient104(Config cfg) {
 void runServer101(Config cfg) {
     printf("[SERVER - 101] Spuštěn na rozhraní %s (baudrate %d), OA %d, CA %d\n",
            cfg.interface, cfg.bandwidth, cfg.originatorAddress, cfg.commonAddress);
-    printf("[SERVER - 101] Perioda: %ds | Multiplier: %d | Spontánní zprávy: %s\n",
-           cfg.period, cfg.multiplier, cfg.spontaneousEnable ? "ANO" : "NE");
+    printf("[SERVER - 101] Perioda: %d ms | Multiplier: %d | Spontánní zprávy: %s\n",
+           cfg.periodMs, cfg.multiplier, cfg.spontaneousEnable ? "ANO" : "NE");
 
     // Nastavení logování a cest
-    if (cfg.dataLogs) dataConfig = 1;
-    if (cfg.serviceLogs) serviceConfig = 1;
-    if (strlen(cfg.dataPath) > 0) dataPath = cfg.dataPath;
-    if (strlen(cfg.servicePath) > 0) servicePath = cfg.servicePath;
-    if (serviceConfig == 1) LogSTART("Server101");
+    startLogging(&cfg, "Server101");
+    createTrafficStats(&cfg);
+    createFrameCapture(&cfg, false, true, "[SERVER - 101]");
 
     // Adresy a multiplikátor
     originatorAddress = cfg.originatorAddress;
@@ -2966,17 +4531,16 @@ void runServer101(Config cfg) {
 
     // Spontánní zprávy
     if (cfg.spontaneousEnable) spontaneousEnabled = true;
-    minSpontaneousInterval = cfg.spontaneousMin;
-    maxSpontaneousInterval = cfg.spontaneousMax;
-    scheduleNextSpontaneousMessage();
+    minSpontaneousInterval = cfg.spontaneousMinMs;
+    maxSpontaneousInterval = cfg.spontaneousMaxMs;
 
-    int periodicInterval = cfg.period > 0 ? cfg.period : 20;
-    readMessageConfig("iec_config.txt");
+    int periodicInterval = cfg.periodMs > 0 ? cfg.periodMs : 20000;
 
     // === Otevření sériového portu ===
     SerialPort port = SerialPort_create(cfg.interface, cfg.bandwidth, 8, 'E', 1);
     if (!SerialPort_open(port)) {
         printf("Chyba: Nepodařilo se otevřít sériový port %s!\n", cfg.interface);
+        stopCapture("[SERVER - 101]");
         return;
     }
 
@@ -2986,94 +4550,174 @@ void runServer101(Config cfg) {
     // Nastavení linkových adres (pro tvůj use case pravděpodobně 1, případně upravit podle configu)
     CS101_Slave_setLinkLayerAddress(slave, 1);           // adresa stanice (slave)
     CS101_Slave_setLinkLayerAddressOtherStation(slave, 2); // adresa mastera (klienta)
+    CS101_Slave_setMessageTimeout(slave, 0);               // na data čeká hlavní smyčka (runSerialLoop)
 
     // Handlery (společné s 104 pokud už máš stejné prototypy)
     CS101_Slave_setClockSyncHandler(slave, clockSyncHandler, NULL);
     CS101_Slave_setInterrogationHandler(slave, interrogationHandler, NULL);
     CS101_Slave_setASDUHandler(slave, asduHandler, NULL);
+    if (trafficStats || frameCapture) CS101_Slave_setRawMessageHandler(slave, rawFrameHandler, NULL);
 
     // 101 specifické handlery (nutné!):
     CS101_Slave_setLinkLayerStateChanged(slave, linkLayerStateChanged, NULL);
     CS101_Slave_setResetCUHandler(slave, resetCUHandler, (void*)slave);
 
     CS101_AppLayerParameters alParams = CS101_Slave_getAppLayerParameters(slave);
+    compilePeriodicTemplates(alParams);
+
+    // Předem sestavené odpovědi na dotaz stanice a skupin
+    giCache = GiCache_create(alParams, points, originatorAddress, commonAddress, createIO);
+    createCommandEngine(&cfg, "[SERVER - 101]");
+
+    TimerWheel wheel = TimerWheel_create();
+    LoadContext load = {NULL, wheel, NULL, NULL, false, slave, "[SERVER - 101]"};
+
+    GeneratorContext generator = {wheel, NULL, 0, alParams, enqueue101, slave};
+    startGenerators(&generator, &cfg, "[SERVER - 101]");
+    SharedContext shared = {wheel, NULL, alParams, enqueue101, slave};
+    startSharedPoints(&shared, &cfg, "[SERVER - 101]");
+    PlaybackContext playback = {wheel, NULL, NULL, alParams, enqueue101, slave, 0, false, 0, "[SERVER - 101]"};
+    startPlayback(&playback, &cfg);
+    CommandContext commands = {wheel, NULL, alParams, "[SERVER - 101]"};
+    startCommands(&commands);
+
+    // Události EVENTS, jinak náhodné spontánní zprávy jen bez detekce změn (ta posílá skutečné změny)
+    SpontaneousContext spontaneous = {wheel, NULL, false, slave, alParams, "[SERVER - 101]"};
+    EventContext events = {wheel, NULL, alParams, enqueue101, slave, "[SERVER - 101]"};
+    ScenarioContext scenarioContext = {wheel, NULL, NULL, alParams, enqueue101, slave, &events, false, 0, false, 0,
+                                       "[SERVER - 101]"};
+    startScenario(&scenarioContext, &cfg);
+    ReplayContext replay = {.wheel = wheel, .alParams = alParams,
+                            .linkAddressLength = CS101_Slave_getLinkLayerParameters(slave)->addressLength,
+                            .server = true, .send = replaySend101, .target = slave, .label = "[SERVER - 101]"};
+    if (!startReplay(&replay, &cfg) && !startLoad(&load, &cfg, alParams, enqueue101)) {
+        startPeriodicTimers(wheel, periodicInterval, enqueue101, slave, "[SERVER - 101]");
+        if (!startEvents(&events, &cfg) && changeDetector == NULL && sharedPoints == NULL &&
+            valuePlayback == NULL && scenario == NULL)
+            startSpontaneousTimer(&spontaneous);
+    }
 
-    lastSentTime = time(NULL);
+    ReloadContext reload = {"iec_config.txt", NULL, wheel, NULL, alParams, &cfg, enqueue101, slave, "[SERVER - 101]"};
+    startConfigReload(&reload);
 
-    // === Hlavní cyklus ===
-    while (running) {
-        time_t currentTime = time(NULL);
-
-        // Zpracuje příchozí zprávy (blokuje dokud něco nepřijde nebo timeout, takže krátký sleep na idle)
-        CS101_Slave_run(slave);
-        Thread_sleep(100);
-
-        // Periodické zprávy
-        if (difftime(currentTime, lastSentTime) >= periodicInterval) {
-            printf("[SERVER - 101] Posílám periodické zprávy:\n");
-            for (int i = 0; i < numMessageConfigs; ++i) {
-                MessageConfig msg = messageConfigs[i];
-                CS101_ASDU asdu = CS101_ASDU_create(alParams, false, CS101_COT_PERIODIC,
-                                                    originatorAddress, commonAddress, false, false);
-                for (int j = 0; j < msg.ioContentCount; ++j) {
-                    IOContent ioContent = msg.ioContent[j];
-                    InformationObject io = createIO(msg.messageType, ioContent.ioa, ioContent.value);
-                    CS101_ASDU_addInformationObject(asdu, io);
-                    InformationObject_destroy(io);
-                }
-                for (int k = 0; k < multiplier; ++k) {
-                    CS101_Slave_enqueueUserDataClass1(slave, asdu);
-                    asduTransmitHandler(asdu);
-                }
-                CS101_ASDU_destroy(asdu);
-            }
-            lastSentTime = currentTime;
-        }
+    StatsContext stats = {wheel, NULL, NULL, "[SERVER - 101]"};
+    startStats(&stats, &cfg);
 
-        // Spontánní zprávy
-        if (spontaneousEnabled && currentTime >= nextSpontaneousTime) {
-            printf("[SERVER - 101] Posílám spontánní zprávu...\n");
-            sendSpontaneousMessage101(slave, alParams, multiplier);
-            scheduleNextSpontaneousMessage();
-        }
-    }
+    // === Hlavní cyklus ===
+    runSerialLoop(port, wheel, runSlave101, slave);
 
     // Ukončení serveru
+    stopConfigReload(&reload);
+    TimerWheel_destroy(wheel);
     CS101_Slave_destroy(slave);
     SerialPort_close(port);
     SerialPort_destroy(port);
+    stopReplay(&replay);
+    stopLoad(&load);
+    stopGenerators();
+    stopSharedPoints("[SERVER - 101]");
+    stopPlayback();
+    stopScenario();
+    stopCommands("[SERVER - 101]");
+    stopEvents();
+    GiCache_destroy(giCache);
+    giCache = NULL;
+    stopCapture("[SERVER - 101]");
+    stopStats();
+    stopLogging();
+}
+
+
+// Stav klienta 101 předávaný do callbacků časovačů
+typedef struct {
+    Config *cfg;
+    CS101_Master master;
+} Client101Context;
+
+// Pošle jeden command bodu i (101) a zaloguje ho
+static void sendCommand101(void *parameter, int i) {
+    Client101Context *ctx = (Client101Context *) parameter;
+    int type = points->type[i];
+    if (type != 45 && type != 46) return;
+
+    bool isPerm = (points->flags[i] & POINT_FLAG_PERMANENT) != 0;
+    bool isToggle = (points->flags[i] & POINT_FLAG_TOGGLE) != 0;
+    float valueToSend = PointTable_getSendValue(points, i);
+    if (isToggle)
+        points->toggleState[i] = !points->toggleState[i];
+    InformationObject io = createIO_client(type, points->ioa[i], points->value[i]);
+    if (commandLatency) CommandLatency_onSent(commandLatency, 0, type, ctx->cfg->commonAddress, points->ioa[i]);
+    CS101_Master_sendProcessCommand(ctx->master, CS101_COT_ACTIVATION, ctx->cfg->commonAddress, io);
+    bool trace = trafficStats ? TrafficStats_onAsdu(trafficStats, STATS_TX, type, CS101_COT_ACTIVATION, 1) : true;
+    TRACE("[CLIENT - 101] Sent command: TYPE=%d IOA=%d VALUE=%.2f (%s)\n",
+          type,
+          points->ioa[i],
+          valueToSend,
+          isPerm ? (isToggle ? "PERM-DUAL" : "PERM") : "TEMP");
+    if (dataConfig == 1) {
+        LogTX(type, 1, ctx->cfg->originatorAddress, ctx->cfg->commonAddress);
+        LogTXwoT(points->ioa[i], points->value[i]);
+    }
+    InformationObject_destroy(io);
+    points->lastSent[i] = Hal_getTimeInMs();
+}
+
+// Jeden cyklus klienta 101 (volá ho časovač s globální periodou)
+static void clientCycle101(void *parameter, uint64_t now) {
+    (void) now;
+    Client101Context *ctx = (Client101Context *) parameter;
+
+    reloadClientPoints(sendCommand101, ctx);
+    for (int i = 0; i < points->count; ++i) {
+        if (points->periodMs[i] != 0) continue;
+        sendPoint(sendCommand101, ctx, i);
+    }
+
+    // Odeslané TEMP jsou jen v deníku, soubor se přepíše až při zhuštění
+    compactTempJournal();
+
+    // SYNC
+    if (ctx->cfg->sync == 1) {
+        struct sCP56Time2a newTime;
+        CP56Time2a_createFromMsTimestamp(&newTime, Hal_getTimeInMs());
+        printf("[CLIENT - 101] Sync command sent\n");
+        if (commandLatency) CommandLatency_onSent(commandLatency, 0, C_CS_NA_1, ctx->cfg->commonAddress, 0);
+        CS101_Master_sendClockSyncCommand(ctx->master, ctx->cfg->commonAddress, &newTime);
+    }
+
+    // INTERROGATION
+    if (commandLatency) CommandLatency_onSent(commandLatency, 0, C_IC_NA_1, ctx->cfg->commonAddress, 0);
+    CS101_Master_sendInterrogationCommand(ctx->master, CS101_COT_ACTIVATION, ctx->cfg->commonAddress, IEC60870_QOI_STATION);
+    printf("[CLIENT - 101] Interrogation command sent\n");
+    if (serviceConfig == 1) LogTXrequest(IEC60870_QOI_STATION);
 }
 
 
 void runClient101(Config cfg) {
     originatorAddress = cfg.originatorAddress;
     printf("[CLIENT - 101] Připojuji se na rozhraní %s (baudrate %d), CA %d\n", cfg.interface, cfg.bandwidth, cfg.commonAddress);
-    printf("[CLIENT - 101] Perioda: %ds | SYNC: %s | DataLog: %s | ServiceLog: %s\n",
-           cfg.period,
+    printf("[CLIENT - 101] Perioda: %d ms | SYNC: %s | DataLog: %s | ServiceLog: %s\n",
+           cfg.periodMs,
            cfg.sync ? "ANO" : "NE",
            cfg.dataLogs ? "ANO" : "NE",
            cfg.serviceLogs ? "ANO" : "NE"
     );
 
-    if (cfg.dataLogs) dataConfig = 1;
-    if (cfg.serviceLogs) serviceConfig = 1;
-    if (strlen(cfg.dataPath) > 0) dataPath = cfg.dataPath;
-    if (strlen(cfg.servicePath) > 0) servicePath = cfg.servicePath;
-
-    if (serviceConfig == 1) LogSTART("Client101");
+    startLogging(&cfg, "Client101");
+    createTrafficStats(&cfg);
+    createFrameCapture(&cfg, false, false, "[CLIENT - 101]");
+    if (cfg.replayPath[0])
+        printf("[CLIENT - 101] REPLAY: přehrávání záznamu umí jen server 101 a klient/server 104, ignoruji\n");
 
-    int periodicInterval = cfg.period > 0 ? cfg.period : 20;
-    int syncSwitch = cfg.sync;
-    bool toDelete[MAX_MESSAGE_CONFIGS] = {false};
-    int deleteCount = 0;
-
-    lastSentTime = time(NULL);
+    int periodicInterval = cfg.periodMs > 0 ? cfg.periodMs : 20000;
     running = true;
 
     // --- Otevření sériového portu ---
     SerialPort port = SerialPort_create(cfg.interface, cfg.bandwidth, 8, 'E', 1);
     if (!SerialPort_open(port)) {
         printf("Chyba: Nepodařilo se otevřít sériový port %s!\n", cfg.interface);
+        stopCapture("[CLIENT - 101]");
+        stopStats();
         return;
     }
 
@@ -3082,116 +4726,131 @@ void runClient101(Config cfg) {
 
     CS101_Master_setOwnAddress(master, cfg.originatorAddress);
     CS101_Master_useSlaveAddress(master, 1);       // slave adresa (možno z configu)
+    CS101_Master_setMessageTimeout(master, 0);     // na data čeká hlavní smyčka (runSerialLoop)
     CS101_Master_setASDUReceivedHandler(master, asduReceivedHandler, NULL);
+    if (trafficStats || frameCapture) CS101_Master_setRawMessageHandler(master, rawFrameHandler, NULL);
+    createStateTable(&cfg, CS101_Master_getAppLayerParameters(master)->sizeOfIOA);
+    createCommandLatency(&cfg, points->count + 2, CS101_Master_getAppLayerParameters(master)->sizeOfIOA);
     LinkLayerParameters llParams = CS101_Master_getLinkLayerParameters(master);
     llParams->useSingleCharACK = false;
     CS101_Master_setLinkLayerStateChanged(master, linkLayerStateChanged, NULL);
 
     printf("[CLIENT - 101] Master běží, čekám na periodický interval...\n");
 
-    while (running) {
-        CS101_Master_run(master);  // procesuj příchozí zprávy
-        time_t currentTime = time(NULL);
-        Thread_sleep(100);
-
-        if (difftime(currentTime, lastSentTime) >= periodicInterval) {
-            readMessageConfig("iec_config.txt");
-            for (int i = 0; i < numMessageConfigs; ++i) {
-                MessageConfig* msg = &messageConfigs[i];
-                if (msg->messageType == 45 || msg->messageType == 46) {
-                    for (int j = 0; j < msg->ioContentCount; ++j) {
-                        IOContent* ioContent = &msg->ioContent[j];
-                        float valueToSend = ioContent->toggleEnabled ?
-                                            (ioContent->toggleState ? ioContent->toggleValueB : ioContent->toggleValueA) :
-                                            ioContent->value;
-                        if (ioContent->toggleEnabled)
-                            ioContent->toggleState = !ioContent->toggleState;
-                        InformationObject io = createIO_client(msg->messageType, ioContent->ioa, ioContent->value);
-                        CS101_Master_sendProcessCommand(master, CS101_COT_ACTIVATION, cfg.commonAddress, io);
-                        printf("[CLIENT - 101] Sent command: TYPE=%d IOA=%d VALUE=%.2f (%s)\n",
-                               msg->messageType,
-                               ioContent->ioa,
-                               valueToSend,
-                               msg->isPermanent ?
-                               (ioContent->toggleEnabled ? "PERM-DUAL" : "PERM")
-                                                : "TEMP");
-                        if (dataConfig == 1) {
-                            LogTX(msg->messageType, 1, cfg.originatorAddress, cfg.commonAddress);
-                            LogTXwoT(ioContent->ioa, ioContent->value);
-                        }
-                        InformationObject_destroy(io);
-                    }
-
-                    if (!msg->isPermanent) {
-                        toDelete[i] = true;
-                        deleteCount++;
-                    }
-                }
-            }
-
-            // === Smazání TEMP_MESS bloků z konfiguračního souboru ===
-            FILE *file = fopen("iec_config.txt", "r");
-            FILE *temp = fopen("iec_config_temp.txt", "w");
-            if (file && temp) {
-                char line[256];
-                bool insideTempBlock = false;
-
-                while (fgets(line, sizeof(line), file)) {
-                    if (strncmp(line, "TEMP_MESS=", 10) == 0) {
-                        insideTempBlock = true;
-                        fputs(line, temp); // zachovej TEMP_MESS=
-                        continue;
-                    }
-                    if (strncmp(line, "PERM_MESS=", 10) == 0) {
-                        insideTempBlock = false;
-                        fputs(line, temp); // zachovej PERM_MESS=
-                        continue;
-                    }
-
-                    if (insideTempBlock) {
-                        int msgType;
-                        if (sscanf(line, "%d;", &msgType) == 1 && (msgType == 45 || msgType == 46)) {
-                            // Smaž TEMP zprávy (nepíšeme do souboru)
-                            continue;
-                        }
-                    }
-
-                    // Vše ostatní přepiš
-                    fputs(line, temp);
-                }
-
-                fclose(file);
-                fclose(temp);
-                remove("iec_config.txt");
-                rename("iec_config_temp.txt", "iec_config.txt");
-            }
+    Client101Context ctx = {&cfg, master};
 
+    openTempJournal();
+    clientWheel = TimerWheel_create();
+    Timer cycleTimer = TimerWheel_addTimer(clientWheel, clientCycle101, &ctx);
+    TimerWheel_start(clientWheel, cycleTimer, periodicInterval, periodicInterval);
+    updatePointTimers(clientWheel, sendCommand101, &ctx);
 
-            // SYNC
-            if (syncSwitch == 1) {
-                struct sCP56Time2a newTime;
-                CP56Time2a_createFromMsTimestamp(&newTime, Hal_getTimeInMs());
-                printf("[CLIENT - 101] Sync command sent\n");
-                CS101_Master_sendClockSyncCommand(master, cfg.commonAddress, &newTime);
-            }
+    StatsContext stats = {clientWheel, NULL, NULL, "[CLIENT - 101]"};
+    startStats(&stats, &cfg);
+    StateContext state = {clientWheel, NULL, cfg.stateExportPath, "[CLIENT - 101]"};
+    startStateExport(&state, &cfg);
+    LatencyContext latency = {clientWheel, NULL, "[CLIENT - 101]"};
+    startLatencyReport(&latency, &cfg);
 
-            // INTERROGATION
-            CS101_Master_sendInterrogationCommand(master, CS101_COT_ACTIVATION, cfg.commonAddress, IEC60870_QOI_STATION);
-            printf("[CLIENT - 101] Interrogation command sent\n");
-            if (serviceConfig == 1) LogTXrequest(IEC60870_QOI_STATION);
+    runSerialLoop(port, clientWheel, runMaster101, master);
 
-            lastSentTime = currentTime;
-        }
-    }
+    TimerWheel_destroy(clientWheel);
+    clientWheel = NULL;
+    numPointTimers = 0;
+    TempJournal_close(tempJournal);
+    tempJournal = NULL;
 
     CS101_Master_destroy(master);
     SerialPort_close(port);
     SerialPort_destroy(port);
+    stopStateTable(&state);
+    stopCommandLatency("[CLIENT - 101]");
+    stopCapture("[CLIENT - 101]");
+    stopStats();
+    stopLogging();
     printf("[CLIENT - 101] Klient ukončen.\n");
 }
 
 
 
+// =======================
+// DOTAZ NAD BINÁRNÍM DATOVÝM LOGEM (--query)
+// =======================
+
+// Převede "YYYY-MM-DD HH:MM:SS" / "YYYY-MM-DDTHH:MM:SS" (místní čas) na ms od epochy, 0 při chybě
+static uint64_t parseQueryTime(const char *text) {
+    struct tm tm;
+    memset(&tm, 0, sizeof(tm));
+    if (sscanf(text, "%d-%d-%d%*[ T]%d:%d:%d", &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
+               &tm.tm_hour, &tm.tm_min, &tm.tm_sec) < 3)
+        return 0;
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    tm.tm_isdst = -1;
+    time_t t = mktime(&tm);
+    return (t < 0) ? 0 : (uint64_t) t * 1000;
+}
+
+static bool printQueryRecord(void *parameter, const BinLogRecord *record) {
+    time_t t = (time_t) (record->timeMs / 1000);
+    struct tm tm;
+    localtime_r(&t, &tm);
+
+    printf("%d-%02d-%02d %02d:%02d:%02d.%03d %s ca: %i type:(%i) IOA: %u value: %f",
+           tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec,
+           (int) (record->timeMs % 1000), record->direction == BINLOG_DIR_RX ? "RX" : "TX",
+           record->ca, record->type, record->ioa, record->value);
+
+    if (record->hasTimestamp == 56) {
+        struct sCP56Time2a ts;
+        memcpy(ts.encodedValue, record->timestamp, 7);
+        printf(" with timestamp: %04i-%02i-%02i %02i:%02i:%02i.%03i",
+               CP56Time2a_getYear(&ts) + 2000, CP56Time2a_getMonth(&ts), CP56Time2a_getDayOfMonth(&ts),
+               CP56Time2a_getHour(&ts), CP56Time2a_getMinute(&ts), CP56Time2a_getSecond(&ts),
+               CP56Time2a_getMillisecond(&ts));
+    } else if (record->hasTimestamp == 24) {
+        struct sCP24Time2a ts;
+        memcpy(ts.encodedValue, record->timestamp, 3);
+        printf(" with timestamp: %02i:%02i:%03i",
+               CP24Time2a_getMinute(&ts), CP24Time2a_getSecond(&ts), CP24Time2a_getMillisecond(&ts));
+    }
+    printf("\n");
+    return true;
+}
+
+// ./uni_iec --query <soubor> <IOA|*> [od] [do]
+static int runQuery(int argc, char **argv) {
+    if (argc < 4) {
+        fprintf(stderr, "Použití: %s --query <soubor> <IOA|*> [od] [do]\n", argv[0]);
+        return 1;
+    }
+
+    int ioa = (strcmp(argv[3], "*") == 0) ? -1 : atoi(argv[3]);
+    uint64_t fromMs = 0, toMs = UINT64_MAX;
+
+    if (argc > 4 && (fromMs = parseQueryTime(argv[4])) == 0) {
+        fprintf(stderr, "Neplatný čas: %s\n", argv[4]);
+        return 1;
+    }
+    if (argc > 5) {
+        toMs = parseQueryTime(argv[5]);
+        if (toMs == 0) {
+            fprintf(stderr, "Neplatný čas: %s\n", argv[5]);
+            return 1;
+        }
+        toMs += 999; // Včetně celé poslední sekundy
+    }
+
+    int found = BinLog_query(argv[2], ioa, fromMs, toMs, printQueryRecord, NULL);
+    if (found < 0) {
+        fprintf(stderr, "Soubor %s není binární datový log\n", argv[2]);
+        return 1;
+    }
+
+    fprintf(stderr, "Nalezeno záznamů: %d\n", found);
+    return 0;
+}
+
 // Hlavní funkce – spustí editor/show/help nebo konkrétní režim (server/klient)
 int main(int argc, char **argv) {
     srand(time(NULL));
@@ -3210,16 +4869,29 @@ int main(int argc, char **argv) {
         } else if (strcmp(argv[1], "--helpconfig") == 0) {
             printHelpConfig();
             return 0;
+        } else if (strcmp(argv[1], "--query") == 0) {
+            return runQuery(argc, argv);
         }
     }
 
-    Config cfg = readFullConfig("iec_config.txt");
-
+    // Konfigurace i body se načtou jedním průchodem souboru (případně ze snímku .snap)
+    Config cfg;
+    points = PointTable_create(1024);
+    pointsLock = Semaphore_create(1);
+    if (!ConfigFile_load("iec_config.txt", &cfg, points)) {
+        return 1;
+    }
 
     if (strcmp(cfg.protocol, "104") == 0 && strcmp(cfg.role, "SERVER") == 0) {
-        runServer104(cfg);
+        if (cfg.stations > 1)
+            runMultiServer104(cfg);
+        else
+            runServer104(cfg);
     } else if (strcmp(cfg.protocol, "104") == 0 && strcmp(cfg.role, "CLIENT") == 0) {
-        runClient104(cfg);
+        if (cfg.clients > 1)
+            runMultiClient104(cfg);
+        else
+            runClient104(cfg);
     } else if (strcmp(cfg.protocol, "101") == 0 && strcmp(cfg.role, "SERVER") == 0) {
         runServer101(cfg);
     } else if (strcmp(cfg.protocol, "101") == 0 && strcmp(cfg.role, "CLIENT") == 0) {
@@ -0,0 +1,283 @@
+// =======================
+// DENÍK ODESLANÝCH TEMP ZPRÁV – implementace
+// =======================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "uni_journal.h"
+#include "uni_config.h"
+#include "lib_memory.h"
+
+#define JOURNAL_SUFFIX ".consumed"
+
+// Počet odeslaných výskytů jednoho TEMP řádku (klíč = typ, IOA a obě hodnoty)
+typedef struct {
+    uint32_t valueA;          // Bity floatu – porovnání přesně jako v souboru
+    uint32_t valueB;
+    int32_t ioa;
+    uint8_t type;
+    bool used;
+    int32_t count;
+} JournalEntry;
+
+struct sTempJournal {
+    char configPath[256];
+    char path[300];
+    FILE *file;               // Deník otevřený pro připisování
+    JournalEntry *entries;    // Hash tabulka s lineárním zkoušením (velikost = mocnina dvou)
+    int size;
+    int used;
+    int pending;              // Záznamů v deníku od posledního zhuštění
+};
+
+static uint32_t
+floatBits(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static uint32_t
+hashEntry(int type, int ioa, uint32_t valueA, uint32_t valueB)
+{
+    uint32_t hash = ((uint32_t) type << 24) ^ (uint32_t) ioa;
+    hash = (hash ^ valueA) * 2654435761u;
+    return (hash ^ valueB) * 2654435761u;
+}
+
+// Najde položku (případně prázdné místo pro ni), NULL pokud je tabulka prázdná
+static JournalEntry *
+findEntry(JournalEntry *entries, int size, int type, int ioa, uint32_t valueA, uint32_t valueB)
+{
+    if (size == 0)
+        return NULL;
+
+    uint32_t mask = (uint32_t) size - 1;
+    uint32_t slot = hashEntry(type, ioa, valueA, valueB) & mask;
+
+    while (entries[slot].used) {
+        JournalEntry *entry = &entries[slot];
+        if (entry->type == (uint8_t) type && entry->ioa == ioa && entry->valueA == valueA && entry->valueB == valueB)
+            return entry;
+        slot = (slot + 1) & mask;
+    }
+
+    return &entries[slot];
+}
+
+static bool
+grow(TempJournal self)
+{
+    int size = self->size ? self->size * 2 : 256;
+    JournalEntry *entries = (JournalEntry *) GLOBAL_CALLOC(size, sizeof(JournalEntry));
+
+    if (entries == NULL)
+        return false;
+
+    for (int i = 0; i < self->size; i++) {
+        JournalEntry *old = &self->entries[i];
+        if (old->used)
+            *findEntry(entries, size, old->type, old->ioa, old->valueA, old->valueB) = *old;
+    }
+
+    GLOBAL_FREEMEM(self->entries);
+    self->entries = entries;
+    self->size = size;
+    return true;
+}
+
+// Zvýší počet odeslaných výskytů klíče
+static void
+addEntry(TempJournal self, int type, int ioa, float valueA, float valueB)
+{
+    // Max. 50% zaplnění
+    if ((self->used + 1) * 2 > self->size && !grow(self))
+        return;
+
+    JournalEntry *entry = findEntry(self->entries, self->size, type, ioa, floatBits(valueA), floatBits(valueB));
+
+    if (!entry->used) {
+        entry->used = true;
+        entry->type = (uint8_t) type;
+        entry->ioa = ioa;
+        entry->valueA = floatBits(valueA);
+        entry->valueB = floatBits(valueB);
+        entry->count = 0;
+        self->used++;
+    }
+
+    entry->count++;
+}
+
+TempJournal
+TempJournal_open(const char *configPath)
+{
+    TempJournal self = (TempJournal) GLOBAL_CALLOC(1, sizeof(struct sTempJournal));
+
+    if (self == NULL)
+        return NULL;
+
+    snprintf(self->configPath, sizeof(self->configPath), "%s", configPath);
+    snprintf(self->path, sizeof(self->path), "%s%s", configPath, JOURNAL_SUFFIX);
+
+    // Záznamy z minulého běhu (řádek = typ;ioa;valueA;valueB)
+    FILE *old = fopen(self->path, "r");
+
+    if (old) {
+        int type, ioa;
+        float valueA, valueB;
+
+        while (fscanf(old, "%d;%d;%f;%f", &type, &ioa, &valueA, &valueB) == 4) {
+            addEntry(self, type, ioa, valueA, valueB);
+            self->pending++;
+        }
+
+        fclose(old);
+    }
+
+    self->file = fopen(self->path, "a");
+
+    if (self->file == NULL)
+        fprintf(stderr, "Nelze otevřít deník TEMP zpráv %s, odeslané TEMP zprávy se nezapamatují\n", self->path);
+
+    return self;
+}
+
+void
+TempJournal_apply(TempJournal self, PointTable points)
+{
+    if (self == NULL || self->used == 0)
+        return;
+
+    // Kolik výskytů každého klíče ještě zbývá označit (stejné řádky se párují v pořadí souboru)
+    int32_t *remaining = (int32_t *) GLOBAL_MALLOC((size_t) self->size * sizeof(int32_t));
+
+    if (remaining == NULL)
+        return;
+
+    for (int i = 0; i < self->size; i++)
+        remaining[i] = self->entries[i].count;
+
+    for (int i = 0; i < points->count; i++) {
+        if (points->flags[i] & POINT_FLAG_PERMANENT)
+            continue;
+
+        JournalEntry *entry = findEntry(self->entries, self->size, points->type[i], points->ioa[i],
+                                        floatBits(points->valueA[i]), floatBits(points->valueB[i]));
+
+        if (entry->used && remaining[entry - self->entries] > 0) {
+            remaining[entry - self->entries]--;
+            points->flags[i] |= POINT_FLAG_CONSUMED;
+        }
+    }
+
+    GLOBAL_FREEMEM(remaining);
+}
+
+void
+TempJournal_consume(TempJournal self, PointTable points, int index)
+{
+    if (points->flags[index] & (POINT_FLAG_PERMANENT | POINT_FLAG_CONSUMED))
+        return;
+
+    points->flags[index] |= POINT_FLAG_CONSUMED;
+
+    if (self == NULL)
+        return;
+
+    addEntry(self, points->type[index], points->ioa[index], points->valueA[index], points->valueB[index]);
+    self->pending++;
+
+    if (self->file) {
+        // %.9g zachová float beze ztráty, takže se klíč po načtení shoduje
+        fprintf(self->file, "%d;%d;%.9g;%.9g\n", points->type[index], points->ioa[index],
+                (double) points->valueA[index], (double) points->valueB[index]);
+        fflush(self->file);
+    }
+}
+
+int
+TempJournal_getPending(TempJournal self)
+{
+    return self ? self->pending : 0;
+}
+
+// Filtr pro ConfigFile_filterPoints – vynechá tolik výskytů TEMP řádku, kolik jich deník zná
+static bool
+keepPoint(void *parameter, int type, int ioa, float valueA, float valueB, bool permanent)
+{
+    TempJournal self = (TempJournal) parameter;
+
+    if (permanent)
+        return true;
+
+    JournalEntry *entry = findEntry(self->entries, self->size, type, ioa, floatBits(valueA), floatBits(valueB));
+
+    if (entry == NULL || !entry->used || entry->count == 0)
+        return true;
+
+    entry->count--;
+    return false;
+}
+
+bool
+TempJournal_compact(TempJournal self)
+{
+    if (self == NULL)
+        return false;
+
+    if (self->used > 0) {
+        // Filtr počty snižuje – při chybě se vrátí, deník pak platí dál
+        int32_t *counts = (int32_t *) GLOBAL_MALLOC((size_t) self->size * sizeof(int32_t));
+
+        if (counts == NULL)
+            return false;
+
+        for (int i = 0; i < self->size; i++)
+            counts[i] = self->entries[i].count;
+
+        bool filtered = ConfigFile_filterPoints(self->configPath, keepPoint, self);
+
+        if (!filtered) {
+            for (int i = 0; i < self->size; i++)
+                self->entries[i].count = counts[i];
+        }
+
+        GLOBAL_FREEMEM(counts);
+
+        if (!filtered) {
+            fprintf(stderr, "Nelze přepsat %s, deník TEMP zpráv zůstává\n", self->configPath);
+            return false;
+        }
+
+        memset(self->entries, 0, (size_t) self->size * sizeof(JournalEntry));
+    }
+
+    self->used = 0;
+    self->pending = 0;
+
+    if (self->file)
+        fclose(self->file);
+
+    self->file = fopen(self->path, "w");
+    return true;
+}
+
+void
+TempJournal_close(TempJournal self)
+{
+    if (self == NULL)
+        return;
+
+    if (self->pending > 0)
+        TempJournal_compact(self);
+
+    if (self->file)
+        fclose(self->file);
+
+    GLOBAL_FREEMEM(self->entries);
+    GLOBAL_FREEMEM(self);
+}
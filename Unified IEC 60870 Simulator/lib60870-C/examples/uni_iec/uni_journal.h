@@ -0,0 +1,41 @@
+// =======================
+// DENÍK ODESLANÝCH TEMP ZPRÁV
+// =======================
+//
+// Klient si odeslané TEMP_MESS body jen označí v paměti (POINT_FLAG_CONSUMED)
+// a připíše je na konec malého deníku <config>.consumed. Konfigurační soubor
+// se přepisuje až při občasném zhuštění deníku (TempJournal_compact), ne
+// v každé periodě. Stejné TEMP řádky se počítají – pokud jich je v souboru
+// víc, než kolik jich deník zná, ty navíc se pošlou.
+
+#ifndef UNI_JOURNAL_H_
+#define UNI_JOURNAL_H_
+
+#include <stdbool.h>
+
+#include "uni_points.h"
+
+// Po kolika záznamech v deníku se má zhustit (přepsat konfigurační soubor)
+#define TEMP_JOURNAL_COMPACT_AT 256
+
+typedef struct sTempJournal* TempJournal;
+
+// Otevře deník ke konfiguračnímu souboru a načte záznamy z minulého běhu
+TempJournal TempJournal_open(const char *configPath);
+
+// Označí TEMP body tabulky, které deník už obsahuje (volat po každém načtení bodů)
+void TempJournal_apply(TempJournal self, PointTable points);
+
+// Označí TEMP bod jako odeslaný a připíše ho do deníku (PERM body se ignorují)
+void TempJournal_consume(TempJournal self, PointTable points, int index);
+
+// Počet záznamů v deníku od posledního zhuštění
+int TempJournal_getPending(TempJournal self);
+
+// Odstraní odeslané TEMP řádky z konfiguračního souboru a vyprázdní deník
+bool TempJournal_compact(TempJournal self);
+
+// Zhustí deník (pokud v něm něco je) a zavře ho
+void TempJournal_close(TempJournal self);
+
+#endif /* UNI_JOURNAL_H_ */
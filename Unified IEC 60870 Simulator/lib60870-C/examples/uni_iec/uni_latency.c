@@ -0,0 +1,474 @@
+// =======================
+// LATENCE COMMANDŮ KLIENTA – implementace
+// =======================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "uni_latency.h"
+#include "uni_timer.h"
+#include "hal_thread.h"
+#include "lib_memory.h"
+
+// Histogram latence: do 64 us po 1 us, pak 32 podintervalů na každou mocninu dvou (chyba < 3 %)
+#define LATENCY_LINEAR 64
+#define LATENCY_SUB_BUCKETS 32
+#define LATENCY_BUCKETS (LATENCY_LINEAR + (32 - 6) * LATENCY_SUB_BUCKETS)
+
+#define LATENCY_KINDS 16          // Max. různých typů commandů ve výpisu
+
+// Command čekající na ACT_CON/ACT_TERM (otevřené adresování, used = obsazeno)
+typedef struct {
+    bool used;
+    bool confirmed;           // ACT_CON už přišlo, čeká se jen na ACT_TERM
+    uint8_t type;
+    int connection;
+    int ca;
+    int ioa;
+    uint64_t sentUs;
+} PendingCommand;
+
+typedef struct {
+    uint32_t counts[LATENCY_BUCKETS];
+    uint64_t samples;
+} LatencyHistogram;
+
+// Počty jednoho typu commandu za interval nebo za celý běh
+typedef struct {
+    uint64_t sent;
+    uint64_t negative;
+    uint64_t timeouts;
+    uint64_t replaced;        // Odesláno znovu dřív, než přišlo ACT_CON předchozího
+    uint64_t unmatched;       // Potvrzení bez odeslaného commandu (např. po timeoutu)
+    LatencyHistogram confirmation;
+    LatencyHistogram termination;
+} KindStats;
+
+typedef struct {
+    int type;
+    int pending;              // Aktuálně čekajících (spočítá výpis)
+    KindStats interval;
+    KindStats total;
+} CommandKind;
+
+struct sCommandLatency {
+    Semaphore lock;           // Odesílá hlavní smyčka, potvrzení přijímají vlákna spojení
+
+    PendingCommand *pending;
+    uint32_t capacity;        // Mocnina dvou
+    int shift;                // 64 - log2(capacity) pro hash
+    uint64_t overflow;        // Commandy, které se do plné tabulky nevešly
+
+    uint64_t timeoutUs;
+    int sizeOfIOA;
+
+    CommandKind kinds[LATENCY_KINDS];
+    int numKinds;
+
+    uint64_t startUs;
+    uint64_t lastReportUs;
+};
+
+static int
+latencyBucket(uint32_t us)
+{
+    if (us < LATENCY_LINEAR)
+        return (int) us;
+
+    int exponent = 31 - __builtin_clz(us);
+    return LATENCY_LINEAR + (exponent - 6) * LATENCY_SUB_BUCKETS + (int) ((us >> (exponent - 5)) & 31);
+}
+
+// Dolní mez intervalu histogramu v us
+static uint32_t
+bucketValue(int bucket)
+{
+    if (bucket < LATENCY_LINEAR)
+        return (uint32_t) bucket;
+
+    int exponent = (bucket - LATENCY_LINEAR) / LATENCY_SUB_BUCKETS + 6;
+    int sub = (bucket - LATENCY_LINEAR) % LATENCY_SUB_BUCKETS;
+    return (uint32_t) (LATENCY_SUB_BUCKETS + sub) << (exponent - 5);
+}
+
+static void
+histogramAdd(LatencyHistogram *histogram, uint64_t us)
+{
+    histogram->counts[latencyBucket(us > UINT32_MAX ? UINT32_MAX : (uint32_t) us)]++;
+    histogram->samples++;
+}
+
+static void
+mergeStats(KindStats *total, const KindStats *interval)
+{
+    total->sent += interval->sent;
+    total->negative += interval->negative;
+    total->timeouts += interval->timeouts;
+    total->replaced += interval->replaced;
+    total->unmatched += interval->unmatched;
+
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+        total->confirmation.counts[b] += interval->confirmation.counts[b];
+        total->termination.counts[b] += interval->termination.counts[b];
+    }
+
+    total->confirmation.samples += interval->confirmation.samples;
+    total->termination.samples += interval->termination.samples;
+}
+
+// Řídicí směr: commandy 45–64 a systémové 100–107
+static bool
+isCommandType(int type)
+{
+    return (type >= C_SC_NA_1 && type <= C_BO_TA_1) || (type >= C_IC_NA_1 && type <= C_TS_TA_1);
+}
+
+static uint32_t
+slotOf(CommandLatency self, int connection, int type, int ca, int ioa)
+{
+    uint64_t key = ((uint64_t) (uint32_t) connection << 40) ^ ((uint64_t) type << 32) ^
+                   ((uint64_t) (uint32_t) ca << 24) ^ (uint64_t) (uint32_t) ioa;
+
+    return (uint32_t) ((key * 0x9E3779B97F4A7C15ULL) >> self->shift);
+}
+
+static PendingCommand *
+findPending(CommandLatency self, int connection, int type, int ca, int ioa)
+{
+    uint32_t mask = self->capacity - 1;
+
+    for (uint32_t i = slotOf(self, connection, type, ca, ioa);; i = (i + 1) & mask) {
+        PendingCommand *entry = &self->pending[i];
+
+        if (!entry->used)
+            return NULL;
+
+        if (entry->connection == connection && entry->type == type && entry->ca == ca && entry->ioa == ioa)
+            return entry;
+    }
+}
+
+// Odstranění s posunem následujících záznamů zpět (bez náhrobků)
+static void
+removePending(CommandLatency self, PendingCommand *entry)
+{
+    uint32_t mask = self->capacity - 1;
+    uint32_t hole = (uint32_t) (entry - self->pending);
+
+    for (uint32_t i = (hole + 1) & mask; self->pending[i].used; i = (i + 1) & mask) {
+        PendingCommand *next = &self->pending[i];
+        uint32_t home = slotOf(self, next->connection, next->type, next->ca, next->ioa);
+
+        // Záznam smí do díry, jen když díra leží na jeho cestě od domovské pozice
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            self->pending[hole] = *next;
+            hole = i;
+        }
+    }
+
+    self->pending[hole].used = false;
+}
+
+static CommandKind *
+getKind(CommandLatency self, int type)
+{
+    for (int k = 0; k < self->numKinds; k++) {
+        if (self->kinds[k].type == type)
+            return &self->kinds[k];
+    }
+
+    if (self->numKinds == LATENCY_KINDS)
+        return NULL;
+
+    CommandKind *kind = &self->kinds[self->numKinds++];
+    kind->type = type;
+
+    return kind;
+}
+
+CommandLatency
+CommandLatency_create(int capacity, int timeoutMs, int sizeOfIOA)
+{
+    CommandLatency self = (CommandLatency) GLOBAL_CALLOC(1, sizeof(struct sCommandLatency));
+
+    if (self == NULL)
+        return NULL;
+
+    // Tabulka nejvýš z poloviny plná, aby byly řetězce krátké
+    self->capacity = 1024;
+    self->shift = 64 - 10;
+
+    while (self->capacity < (uint32_t) capacity * 2 && self->capacity < (1U << 24)) {
+        self->capacity <<= 1;
+        self->shift--;
+    }
+
+    self->pending = (PendingCommand *) GLOBAL_CALLOC(self->capacity, sizeof(PendingCommand));
+    self->lock = Semaphore_create(1);
+
+    if (self->pending == NULL) {
+        CommandLatency_destroy(self);
+        return NULL;
+    }
+
+    self->timeoutUs = (uint64_t) (timeoutMs > 0 ? timeoutMs : 10000) * 1000ULL;
+    self->sizeOfIOA = sizeOfIOA;
+    self->startUs = TimerWheel_monotonicUs();
+    self->lastReportUs = self->startUs;
+
+    return self;
+}
+
+void
+CommandLatency_destroy(CommandLatency self)
+{
+    if (self == NULL)
+        return;
+
+    if (self->lock)
+        Semaphore_destroy(self->lock);
+
+    GLOBAL_FREEMEM(self->pending);
+    GLOBAL_FREEMEM(self);
+}
+
+void
+CommandLatency_onSent(CommandLatency self, int connection, int type, int ca, int ioa)
+{
+    uint64_t nowUs = TimerWheel_monotonicUs();
+
+    Semaphore_wait(self->lock);
+
+    CommandKind *kind = getKind(self, type);
+
+    if (kind)
+        kind->interval.sent++;
+
+    PendingCommand *entry = findPending(self, connection, type, ca, ioa);
+
+    if (entry) {
+        if (!entry->confirmed && kind)
+            kind->interval.replaced++;
+    }
+    else {
+        // Do tabulky se vejde nejvýš capacity - 1 záznamů, jinak by hledání neskončilo
+        uint32_t used = 0;
+        uint32_t mask = self->capacity - 1;
+        uint32_t i = slotOf(self, connection, type, ca, ioa);
+
+        while (self->pending[i].used && used < mask) {
+            i = (i + 1) & mask;
+            used++;
+        }
+
+        if (used < mask)
+            entry = &self->pending[i];
+        else
+            self->overflow++;
+    }
+
+    if (entry) {
+        entry->used = true;
+        entry->confirmed = false;
+        entry->type = (uint8_t) type;
+        entry->connection = connection;
+        entry->ca = ca;
+        entry->ioa = ioa;
+        entry->sentUs = nowUs;
+    }
+
+    Semaphore_post(self->lock);
+}
+
+bool
+CommandLatency_onReceived(CommandLatency self, int connection, CS101_ASDU asdu)
+{
+    int type = CS101_ASDU_getTypeID(asdu);
+
+    if (!isCommandType(type))
+        return false;
+
+    int cot = CS101_ASDU_getCOT(asdu);
+    bool termination = (cot == CS101_COT_ACTIVATION_TERMINATION);
+
+    // Stanice odmítne neznámý typ/COT/CA/IOA zrcadlením commandu s příslušným COT
+    bool rejected = (cot >= CS101_COT_UNKNOWN_TYPE_ID && cot <= CS101_COT_UNKNOWN_IOA);
+
+    if (cot != CS101_COT_ACTIVATION_CON && !termination && !rejected)
+        return false;
+
+    // IOA přímo z payloadu, bez CS101_ASDU_getElement
+    const uint8_t *payload = CS101_ASDU_getPayload(asdu);
+
+    if (CS101_ASDU_getPayloadSize(asdu) < self->sizeOfIOA)
+        return false;
+
+    int ioa = payload[0];
+
+    if (self->sizeOfIOA > 1)
+        ioa += payload[1] << 8;
+    if (self->sizeOfIOA > 2)
+        ioa += payload[2] << 16;
+
+    int ca = CS101_ASDU_getCA(asdu);
+    uint64_t nowUs = TimerWheel_monotonicUs();
+
+    Semaphore_wait(self->lock);
+
+    CommandKind *kind = getKind(self, type);
+    PendingCommand *entry = findPending(self, connection, type, ca, ioa);
+
+    if (kind == NULL) {
+        // Přes LATENCY_KINDS typů se nic nepočítá
+    }
+    else if (entry == NULL) {
+        kind->interval.unmatched++;
+    }
+    else if (rejected || CS101_ASDU_isNegative(asdu)) {
+        kind->interval.negative++;
+        removePending(self, entry);
+    }
+    else if (termination) {
+        histogramAdd(&kind->interval.termination, nowUs - entry->sentUs);
+        removePending(self, entry);
+    }
+    else if (!entry->confirmed) {
+        histogramAdd(&kind->interval.confirmation, nowUs - entry->sentUs);
+        entry->confirmed = true;
+    }
+
+    Semaphore_post(self->lock);
+
+    return entry != NULL;
+}
+
+static void
+formatUs(char *buffer, size_t size, uint32_t us)
+{
+    if (us < 1000)
+        snprintf(buffer, size, "%u us", us);
+    else if (us < 10000000)
+        snprintf(buffer, size, "%.2f ms", us / 1000.0);
+    else
+        snprintf(buffer, size, "%.1f s", us / 1e6);
+}
+
+static void
+printHistogram(const char *name, const LatencyHistogram *histogram)
+{
+    static const double quantiles[] = {0.5, 0.99, 0.999};
+    static const char *names[] = {"p50", "p99", "p99.9"};
+    uint64_t cumulative = 0;
+    int q = 0;
+    int maxBucket = 0;
+    char text[32];
+
+    printf(" | %s n=%llu", name, (unsigned long long) histogram->samples);
+
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+        if (histogram->counts[b] == 0)
+            continue;
+
+        cumulative += histogram->counts[b];
+        maxBucket = b;
+
+        while (q < 3 && cumulative >= (uint64_t) (quantiles[q] * histogram->samples + 0.5)) {
+            formatUs(text, sizeof(text), bucketValue(b));
+            printf(" %s %s", names[q], text);
+            q++;
+        }
+    }
+
+    formatUs(text, sizeof(text), bucketValue(maxBucket));
+    printf(" max %s", text);
+}
+
+// Commandy bez ACT_CON po timeoutu jsou timeout, potvrzené bez ACT_TERM se jen zahodí
+static void
+expirePending(CommandLatency self, uint64_t nowUs)
+{
+    for (int k = 0; k < self->numKinds; k++)
+        self->kinds[k].pending = 0;
+
+    uint32_t i = 0;
+
+    while (i < self->capacity) {
+        PendingCommand *entry = &self->pending[i];
+
+        if (!entry->used) {
+            i++;
+            continue;
+        }
+
+        CommandKind *kind = getKind(self, entry->type);
+
+        if (nowUs - entry->sentUs < self->timeoutUs) {
+            if (kind)
+                kind->pending++;
+            i++;
+            continue;
+        }
+
+        if (!entry->confirmed && kind)
+            kind->interval.timeouts++;
+
+        // Na pozici i se může posunout další záznam – projde se znovu
+        removePending(self, entry);
+    }
+}
+
+void
+CommandLatency_report(CommandLatency self, const char *label, bool total)
+{
+    uint64_t nowUs = TimerWheel_monotonicUs();
+
+    Semaphore_wait(self->lock);
+
+    expirePending(self, nowUs);
+
+    double seconds = (double) (nowUs - (total ? self->startUs : self->lastReportUs)) / 1e6;
+
+    for (int k = 0; k < self->numKinds; k++) {
+        CommandKind *kind = &self->kinds[k];
+        KindStats interval = kind->interval;
+        mergeStats(&kind->total, &interval);
+        memset(&kind->interval, 0, sizeof(KindStats));
+
+        KindStats *stats = total ? &kind->total : &interval;
+
+        if (stats->sent == 0 && stats->unmatched == 0 && stats->timeouts == 0 && stats->negative == 0 &&
+            stats->confirmation.samples == 0 && stats->termination.samples == 0 && kind->pending == 0)
+            continue;
+
+        printf("%s LATENCE %s (%s %.1f s): odesláno %llu", label, TypeID_toString(kind->type),
+               total ? "celý běh" : "interval", seconds, (unsigned long long) stats->sent);
+
+        if (stats->confirmation.samples > 0)
+            printHistogram("ACT_CON", &stats->confirmation);
+        if (stats->termination.samples > 0)
+            printHistogram("ACT_TERM", &stats->termination);
+
+        printf(" | timeout %llu", (unsigned long long) stats->timeouts);
+
+        if (stats->negative > 0)
+            printf(" | negativní %llu", (unsigned long long) stats->negative);
+        if (stats->replaced > 0)
+            printf(" | znovu odesláno bez ACT_CON %llu", (unsigned long long) stats->replaced);
+        if (stats->unmatched > 0)
+            printf(" | nespárováno %llu", (unsigned long long) stats->unmatched);
+        if (kind->pending > 0)
+            printf(" | čeká %d", kind->pending);
+
+        printf("\n");
+    }
+
+    if (self->overflow > 0)
+        printf("%s LATENCE: %llu commandů se nevešlo do tabulky čekajících (kapacita %u)\n", label,
+               (unsigned long long) self->overflow, self->capacity);
+
+    fflush(stdout);
+    self->lastReportUs = nowUs;
+
+    Semaphore_post(self->lock);
+}
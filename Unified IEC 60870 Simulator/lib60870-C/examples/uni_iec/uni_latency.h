@@ -0,0 +1,38 @@
+// =======================
+// LATENCE COMMANDŮ KLIENTA (LATENCY)
+// =======================
+//
+// Každý odeslaný command (45/46, GI, synchronizace času…) se uloží do tabulky
+// rozpracovaných podle (spojení, typ, CA, IOA) s časem odeslání. Potvrzení
+// ACT_CON a ukončení ACT_TERM od stanice se k němu dohledají a doba od
+// odeslání jde do histogramu typu commandu (stejné rozlišení jako latence
+// LOAD: do 64 us po 1 us, dál 32 podintervalů na mocninu dvou). Commandy bez
+// ACT_CON do timeoutu se počítají jako timeout. Výpis za interval i za celý běh
+// ukazuje p50/p99/p99.9/max zvlášť pro ACT_CON a ACT_TERM.
+
+#ifndef UNI_LATENCY_H_
+#define UNI_LATENCY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "iec60870_common.h"
+
+typedef struct sCommandLatency* CommandLatency;
+
+// capacity = kolik commandů může čekat na potvrzení najednou, sizeOfIOA = velikost IOA v přijatých ASDU
+CommandLatency CommandLatency_create(int capacity, int timeoutMs, int sizeOfIOA);
+
+void CommandLatency_destroy(CommandLatency self);
+
+// Command se právě odešle (connection = číslo spojení, 0 = jediné). Volat před odesláním – ACT_CON
+// může přijít dřív, než funkce send vrátí. Volá se z libovolného vlákna.
+void CommandLatency_onSent(CommandLatency self, int connection, int type, int ca, int ioa);
+
+// Přijaté ASDU – vrací true, pokud to bylo potvrzení/ukončení sledovaného commandu
+bool CommandLatency_onReceived(CommandLatency self, int connection, CS101_ASDU asdu);
+
+// Započítá timeouty a vypíše percentily za interval od minulého výpisu (total = za celý běh)
+void CommandLatency_report(CommandLatency self, const char *label, bool total);
+
+#endif /* UNI_LATENCY_H_ */
@@ -0,0 +1,275 @@
+// =======================
+// ZÁTĚŽOVÝ REŽIM – implementace
+// =======================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "uni_load.h"
+#include "uni_template.h"
+#include "uni_timer.h"
+#include "hal_time.h"
+#include "lib_memory.h"
+
+// Histogram latence: do 64 us po 1 us, pak 32 podintervalů na každou mocninu dvou (chyba < 3 %)
+#define LATENCY_LINEAR 64
+#define LATENCY_SUB_BUCKETS 32
+#define LATENCY_BUCKETS (LATENCY_LINEAR + (32 - 6) * LATENCY_SUB_BUCKETS)
+
+struct sLoadGenerator {
+    AsduTemplate *templates;
+    int *templateIos;         // Počet IO v šabloně
+    int numTemplates;
+    int nextTemplate;         // Šablony se posílají dokola
+
+    uint64_t rate;            // Cílová rychlost (jednotek/s)
+    bool ratePerIo;
+    LoadEnqueueFunction enqueue;
+    void *target;
+
+    uint64_t startUs;         // Začátek rozvrhu (monotónní hodiny)
+    uint64_t sentUnits;       // Jednotek (ASDU nebo IO) zařazených od startu
+
+    // Čítače za aktuální interval (zařazování běží v hlavním vlákně)
+    uint64_t enqueuedAsdus;
+    uint64_t enqueuedIos;
+    uint64_t skippedUnits;    // Generátor nestíhal – jednotky přeskočené, aby nevznikl nekonečný dluh
+    uint64_t lastReportUs;
+    int64_t lastDropped;
+
+    // Plní jiná vlákna (raw handler, potvrzení)
+    atomic_uint_fast64_t onWire;
+    atomic_uint latency[LATENCY_BUCKETS];
+};
+
+static int
+latencyBucket(uint32_t us)
+{
+    if (us < LATENCY_LINEAR)
+        return (int) us;
+
+    int exponent = 31 - __builtin_clz(us);
+    return LATENCY_LINEAR + (exponent - 6) * LATENCY_SUB_BUCKETS + (int) ((us >> (exponent - 5)) & 31);
+}
+
+// Dolní mez intervalu histogramu v us
+static uint32_t
+bucketValue(int bucket)
+{
+    if (bucket < LATENCY_LINEAR)
+        return (uint32_t) bucket;
+
+    int exponent = (bucket - LATENCY_LINEAR) / LATENCY_SUB_BUCKETS + 6;
+    int sub = (bucket - LATENCY_LINEAR) % LATENCY_SUB_BUCKETS;
+    return (uint32_t) (LATENCY_SUB_BUCKETS + sub) << (exponent - 5);
+}
+
+static bool
+addTemplate(LoadGenerator self, AsduTemplate tmpl, int *capacity)
+{
+    if (self->numTemplates == *capacity) {
+        int newCapacity = *capacity ? *capacity * 2 : 64;
+        AsduTemplate *templates = (AsduTemplate *) GLOBAL_REALLOC(self->templates, newCapacity * sizeof(AsduTemplate));
+        if (templates == NULL)
+            return false;
+        self->templates = templates;
+        int *ios = (int *) GLOBAL_REALLOC(self->templateIos, newCapacity * sizeof(int));
+        if (ios == NULL)
+            return false;
+        self->templateIos = ios;
+        *capacity = newCapacity;
+    }
+
+    self->templates[self->numTemplates] = tmpl;
+    self->templateIos[self->numTemplates] = 0;
+    self->numTemplates++;
+    return true;
+}
+
+LoadGenerator
+LoadGenerator_create(CS101_AppLayerParameters alParams, PointTable points, int oa, int ca, int rate, bool ratePerIo,
+                     int iosPerAsdu, LoadEnqueueFunction enqueue, void *target)
+{
+    const int32_t *order = PointTable_getOrder(points);
+
+    if (order == NULL || rate <= 0)
+        return NULL;
+
+    LoadGenerator self = (LoadGenerator) GLOBAL_CALLOC(1, sizeof(struct sLoadGenerator));
+
+    if (self == NULL)
+        return NULL;
+
+    self->rate = (uint64_t) rate;
+    self->ratePerIo = ratePerIo;
+    self->enqueue = enqueue;
+    self->target = target;
+    self->lastDropped = -1;
+
+    // Body seřazené podle typu a IOA naplní šablony (stejně jako periodické zprávy)
+    int capacity = 0;
+    AsduTemplate current = NULL;
+    int currentType = -1;
+
+    for (int k = 0; k < points->count; k++) {
+        int p = order[k];
+        int type = points->type[p];
+
+        if (!AsduTemplate_isTypeSupported(type))
+            continue;
+
+        bool full = (current != NULL) && (iosPerAsdu > 0) && (self->templateIos[self->numTemplates - 1] >= iosPerAsdu);
+
+        if (current == NULL || type != currentType || full || !AsduTemplate_addPoint(current, points->ioa[p], points->value[p])) {
+            current = AsduTemplate_create(alParams, type, CS101_COT_SPONTANEOUS, oa, ca);
+
+            if (current == NULL || !addTemplate(self, current, &capacity)) {
+                AsduTemplate_destroy(current);
+                LoadGenerator_destroy(self);
+                return NULL;
+            }
+
+            AsduTemplate_addPoint(current, points->ioa[p], points->value[p]);
+            currentType = type;
+        }
+
+        self->templateIos[self->numTemplates - 1]++;
+    }
+
+    if (self->numTemplates == 0) {
+        LoadGenerator_destroy(self);
+        return NULL;
+    }
+
+    self->startUs = TimerWheel_monotonicUs();
+    self->lastReportUs = self->startUs;
+
+    return self;
+}
+
+void
+LoadGenerator_destroy(LoadGenerator self)
+{
+    if (self == NULL)
+        return;
+
+    for (int i = 0; i < self->numTemplates; i++)
+        AsduTemplate_destroy(self->templates[i]);
+
+    GLOBAL_FREEMEM(self->templates);
+    GLOBAL_FREEMEM(self->templateIos);
+    GLOBAL_FREEMEM(self);
+}
+
+void
+LoadGenerator_run(LoadGenerator self)
+{
+    uint64_t nowUs = TimerWheel_monotonicUs();
+    uint64_t due = self->rate * (nowUs - self->startUs) / 1000000ULL;
+
+    if (due <= self->sentUnits)
+        return;
+
+    // Open-loop: dluh se dožene, ale nejvýš o 1 s – zbytek se počítá jako přeskočený
+    if (due - self->sentUnits > self->rate) {
+        self->skippedUnits += due - self->sentUnits - self->rate;
+        self->sentUnits = due - self->rate;
+    }
+
+    TemplateTime now;
+    TemplateTime_set(&now, Hal_getTimeInMs());
+
+    while (self->sentUnits < due) {
+        int t = self->nextTemplate;
+        AsduTemplate tmpl = self->templates[t];
+
+        AsduTemplate_applyTime(tmpl, &now);
+        self->enqueue(self->target, AsduTemplate_getASDU(tmpl));
+
+        self->enqueuedAsdus++;
+        self->enqueuedIos += (uint64_t) self->templateIos[t];
+        self->sentUnits += self->ratePerIo ? (uint64_t) self->templateIos[t] : 1;
+
+        self->nextTemplate = (t + 1 == self->numTemplates) ? 0 : t + 1;
+    }
+}
+
+void
+LoadGenerator_onWire(LoadGenerator self)
+{
+    atomic_fetch_add_explicit(&self->onWire, 1, memory_order_relaxed);
+}
+
+void
+LoadGenerator_onAck(LoadGenerator self, uint32_t latencyUs)
+{
+    atomic_fetch_add_explicit(&self->latency[latencyBucket(latencyUs)], 1, memory_order_relaxed);
+}
+
+void
+LoadGenerator_report(LoadGenerator self, const char *label, int64_t dropped)
+{
+    uint64_t nowUs = TimerWheel_monotonicUs();
+    double seconds = (double) (nowUs - self->lastReportUs) / 1e6;
+
+    if (seconds <= 0)
+        return;
+
+    // Histogram za interval se při čtení nuluje
+    static uint32_t counts[LATENCY_BUCKETS];
+    uint64_t samples = 0;
+
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+        counts[b] = atomic_exchange_explicit(&self->latency[b], 0, memory_order_relaxed);
+        samples += counts[b];
+    }
+
+    uint64_t onWire = atomic_exchange_explicit(&self->onWire, 0, memory_order_relaxed);
+
+    printf("%s LOAD %.2f s: zařazeno %.0f ASDU/s (%.0f IO/s, cíl %llu %s/s) | na lince %.0f ASDU/s",
+           label, seconds, self->enqueuedAsdus / seconds, self->enqueuedIos / seconds,
+           (unsigned long long) self->rate, self->ratePerIo ? "IO" : "ASDU", onWire / seconds);
+
+    if (dropped >= 0) {
+        int64_t droppedNow = (self->lastDropped >= 0) ? dropped - self->lastDropped : dropped;
+        printf(" | zahozeno %lld (celkem %lld)", (long long) droppedNow, (long long) dropped);
+        self->lastDropped = dropped;
+    }
+
+    if (self->skippedUnits > 0)
+        printf(" | generátor nestíhá, přeskočeno %llu", (unsigned long long) self->skippedUnits);
+
+    if (samples > 0) {
+        static const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+        static const char *names[] = {"p50", "p90", "p99", "p99.9"};
+        uint64_t cumulative = 0;
+        int q = 0;
+        int maxBucket = 0;
+
+        printf(" | latence");
+
+        for (int b = 0; b < LATENCY_BUCKETS; b++) {
+            if (counts[b] == 0)
+                continue;
+
+            cumulative += counts[b];
+            maxBucket = b;
+
+            while (q < 4 && cumulative >= (uint64_t) (quantiles[q] * samples + 0.5)) {
+                printf(" %s %u us", names[q], bucketValue(b));
+                q++;
+            }
+        }
+
+        printf(" max %u us (n=%llu)", bucketValue(maxBucket), (unsigned long long) samples);
+    }
+
+    printf("\n");
+
+    self->enqueuedAsdus = 0;
+    self->enqueuedIos = 0;
+    self->skippedUnits = 0;
+    self->lastReportUs = nowUs;
+}
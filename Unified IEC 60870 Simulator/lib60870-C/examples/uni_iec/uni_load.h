@@ -0,0 +1,46 @@
+// =======================
+// ZÁTĚŽOVÝ REŽIM (open-loop generátor s řízenou rychlostí)
+// =======================
+//
+// Generátor posílá ASDU z bodů konfigurace rychlostí danou v ASDU/s nebo IO/s.
+// Tempo se počítá od startu podle monotónních hodin (open-loop): kolik jednotek
+// mělo k danému času odejít, tolik se jich zařadí – pomalá fronta ani pomalý
+// master rychlost nezpomalí, jen se projeví na zahozených ASDU a latenci.
+// Každý interval se vypíše dosažená rychlost zařazování, rychlost na lince,
+// zahozené ASDU a percentily latence zařazení → potvrzení (S/I rámec od mastera).
+
+#ifndef UNI_LOAD_H_
+#define UNI_LOAD_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "iec60870_common.h"
+#include "uni_points.h"
+
+typedef struct sLoadGenerator* LoadGenerator;
+
+// Zařazení ASDU do odesílací fronty (104 nebo 101 slave)
+typedef void (*LoadEnqueueFunction)(void *target, CS101_ASDU asdu);
+
+// Vytvoří generátor nad body tabulky (body se předkódují do šablon po iosPerAsdu IO, 0 = co se vejde).
+// ratePerIo = rychlost je v IO/s (jinak v ASDU/s). Vrací NULL, pokud nejde poslat žádný bod.
+LoadGenerator LoadGenerator_create(CS101_AppLayerParameters alParams, PointTable points, int oa, int ca,
+                                   int rate, bool ratePerIo, int iosPerAsdu,
+                                   LoadEnqueueFunction enqueue, void *target);
+
+void LoadGenerator_destroy(LoadGenerator self);
+
+// Zařadí všechna ASDU, která už podle rozvrhu měla odejít (volat často, např. každou 1 ms)
+void LoadGenerator_run(LoadGenerator self);
+
+// Rámec s ASDU odešel na linku (volá se z raw message handleru, i z jiného vlákna)
+void LoadGenerator_onWire(LoadGenerator self);
+
+// Master potvrdil zařazené ASDU (volá se z vlákna spojení)
+void LoadGenerator_onAck(LoadGenerator self, uint32_t latencyUs);
+
+// Vypíše statistiku za interval od posledního výpisu; dropped = celkem zahozených ASDU (-1 = neznámé)
+void LoadGenerator_report(LoadGenerator self, const char *label, int64_t dropped);
+
+#endif /* UNI_LOAD_H_ */
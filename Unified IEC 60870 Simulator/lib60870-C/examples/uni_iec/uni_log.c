@@ -0,0 +1,652 @@
+// =======================
+// ASYNCHRONNÍ LOGOVÁNÍ – implementace
+// =======================
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "uni_log.h"
+#include "uni_binlog.h"
+#include "hal_thread.h"
+#include "hal_time.h"
+#include "lib_memory.h"
+
+#define LOG_RING_SIZE 65536          // Počet záznamů v bufferu (mocnina dvou)
+#define LOG_RING_MASK (LOG_RING_SIZE - 1)
+#define LOG_WRITE_BUFFER (256 * 1024)  // Velikost výstupního bufferu jednoho souboru
+#define LOG_FLUSH_INTERVAL_MS 200    // Nejdelší doba, po kterou data čekají v bufferu
+#define LOG_KEEP_FILES 5             // Počet starých souborů při rotaci (.1 … .5)
+#define LOG_TEXT_SIZE 48
+
+typedef enum {
+    REC_START,
+    REC_CONREQ,
+    REC_CONOPEN,
+    REC_CONCLOSED,
+    REC_CONACT,
+    REC_CONDEACT,
+    REC_CONEST,
+    REC_STARTDT,
+    REC_STOPDT,
+    REC_RXREQUEST,
+    REC_TXREQUEST,
+    REC_TX,
+    REC_RX,
+    REC_TXWOT,
+    REC_RXWOT,
+    REC_TXWT,
+    REC_RXWT,
+    REC_TXWT24,
+    REC_RXWT24
+} RecordKind;
+
+typedef struct {
+    uint64_t timeMs;             // Čas vzniku záznamu (ms od epochy)
+    uint8_t kind;                // RecordKind
+    uint8_t timestamp[7];        // Zakódovaná CP56Time2a / CP24Time2a
+    int32_t a, b, c, d;          // Parametry podle druhu záznamu (u hodnot c/d = typ/CA hlavičky)
+    float value;
+    char text[LOG_TEXT_SIZE];    // Role / IP adresa
+} LogRecord;
+
+// Slot Vyukovovy fronty – seq říká, zda je slot volný pro producenta nebo plný pro konzumenta
+typedef struct {
+    atomic_size_t seq;
+    LogRecord record;
+} LogSlot;
+
+// Výstupní soubor s vlastním bufferem a údaji pro rotaci
+typedef struct {
+    char path[256];
+    int fd;
+    uint64_t size;               // Velikost souboru včetně nezapsaných dat
+    uint64_t openedMs;
+    char *buffer;
+    int used;
+    bool binary;                 // Datový log v binárním formátu (uni_binlog.h)
+    BinLogWriter bin;
+} LogFile;
+
+enum { FILE_DATA = 0, FILE_SERVICE = 1 };
+
+static LogSlot *ring = NULL;
+static atomic_size_t enqueuePos;
+static size_t dequeuePos;
+static atomic_uint_fast64_t dropped;
+static atomic_bool writerRunning;
+
+static Thread writerThread = NULL;
+static LogFile files[2];
+static uint64_t maxSize = 0;
+static uint64_t rotatePeriod = 0;
+
+// Cache prefixu "YYYY-MM-DD HH:MM:SS " – localtime se volá jen při změně sekundy
+static time_t prefixSecond = (time_t) -1;
+static char prefix[32];
+static int prefixLength = 0;
+
+// Typ a CA z poslední hlavičky LogTX/LogRX daného vlákna – hodnoty je převezmou do záznamu
+static _Thread_local int currentType[2];
+static _Thread_local int currentCa[2];
+
+static void
+updatePrefix(uint64_t timeMs)
+{
+    time_t t = (time_t) (timeMs / 1000);
+
+    if (t == prefixSecond)
+        return;
+
+    struct tm tm;
+    localtime_r(&t, &tm);
+    prefixLength = snprintf(prefix, sizeof(prefix), "%d-%02d-%02d %02d:%02d:%02d ",
+                            tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec);
+    prefixSecond = t;
+}
+
+// =======================
+// PRODUCENTI
+// =======================
+
+// Zarezervuje slot, vrací NULL (a započítá zahození) pokud je buffer plný nebo logger neběží
+static LogSlot *
+beginRecord(void)
+{
+    if ((ring == NULL) || !atomic_load_explicit(&writerRunning, memory_order_relaxed)) {
+        atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    size_t pos = atomic_load_explicit(&enqueuePos, memory_order_relaxed);
+
+    for (;;) {
+        LogSlot *slot = &ring[pos & LOG_RING_MASK];
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&enqueuePos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+                return slot;
+        } else if (diff < 0) {
+            atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+            return NULL;
+        } else {
+            pos = atomic_load_explicit(&enqueuePos, memory_order_relaxed);
+        }
+    }
+}
+
+static void
+commitRecord(LogSlot *slot)
+{
+    size_t pos = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+}
+
+static void
+pushRecord(RecordKind kind, int a, int b, int c, int d, float value, const uint8_t *timestamp, int timestampSize,
+           const char *text)
+{
+    LogSlot *slot = beginRecord();
+
+    if (slot == NULL)
+        return;
+
+    LogRecord *rec = &slot->record;
+    rec->timeMs = Hal_getTimeInMs();
+    rec->kind = (uint8_t) kind;
+    rec->a = a;
+    rec->b = b;
+    rec->c = c;
+    rec->d = d;
+    rec->value = value;
+
+    if (timestamp)
+        memcpy(rec->timestamp, timestamp, timestampSize);
+
+    if (text) {
+        strncpy(rec->text, text, LOG_TEXT_SIZE - 1);
+        rec->text[LOG_TEXT_SIZE - 1] = 0;
+    }
+
+    commitRecord(slot);
+}
+
+// Zaloguje spuštění instance (Client/Server)
+void LogSTART(const char *role) { pushRecord(REC_START, 0, 0, 0, 0, 0, NULL, 0, role); }
+
+// Log přijetí požadavku na spojení (server i klient)
+void LogCONREQ(const char *ipAddress) { pushRecord(REC_CONREQ, 0, 0, 0, 0, 0, NULL, 0, ipAddress); }
+
+// Stav spojení
+void LogCONOPEN(void) { pushRecord(REC_CONOPEN, 0, 0, 0, 0, 0, NULL, 0, NULL); }
+void LogCONCLOSED(void) { pushRecord(REC_CONCLOSED, 0, 0, 0, 0, 0, NULL, 0, NULL); }
+void LogCONACT(void) { pushRecord(REC_CONACT, 0, 0, 0, 0, 0, NULL, 0, NULL); }
+void LogCONDEACT(void) { pushRecord(REC_CONDEACT, 0, 0, 0, 0, 0, NULL, 0, NULL); }
+void LogCONEST(void) { pushRecord(REC_CONEST, 0, 0, 0, 0, 0, NULL, 0, NULL); }
+void LogCONSTARTTD(void) { pushRecord(REC_STARTDT, 0, 0, 0, 0, 0, NULL, 0, NULL); }
+void LogCONSTOPTD(void) { pushRecord(REC_STOPDT, 0, 0, 0, 0, 0, NULL, 0, NULL); }
+
+// Interrogation (QOI) přijatý serverem / poslaný klientem
+void LogRXrequest(int qoi) { pushRecord(REC_RXREQUEST, qoi, 0, 0, 0, 0, NULL, 0, NULL); }
+void LogTXrequest(int qoi) { pushRecord(REC_TXREQUEST, qoi, 0, 0, 0, 0, NULL, 0, NULL); }
+
+// Hlavička odeslané/přijaté zprávy
+void LogTX(int type, int elements, int oa, int ca) {
+    currentType[BINLOG_DIR_TX] = type;
+    currentCa[BINLOG_DIR_TX] = ca;
+    pushRecord(REC_TX, type, elements, oa, ca, 0, NULL, 0, NULL);
+}
+void LogRX(int type, int elements, int oa, int ca) {
+    currentType[BINLOG_DIR_RX] = type;
+    currentCa[BINLOG_DIR_RX] = ca;
+    pushRecord(REC_RX, type, elements, oa, ca, 0, NULL, 0, NULL);
+}
+
+// Hodnota bez časové známky
+void LogTXwoT(int ioa, float value) {
+    pushRecord(REC_TXWOT, ioa, 0, currentType[BINLOG_DIR_TX], currentCa[BINLOG_DIR_TX], value, NULL, 0, NULL);
+}
+void LogRXwoT(int ioa, float value) {
+    pushRecord(REC_RXWOT, ioa, 0, currentType[BINLOG_DIR_RX], currentCa[BINLOG_DIR_RX], value, NULL, 0, NULL);
+}
+
+// Hodnota s časovou známkou (CP56Time2a / CP24Time2a)
+void LogTXwT(int ioa, float value, CP56Time2a timestamp) {
+    pushRecord(REC_TXWT, ioa, 0, currentType[BINLOG_DIR_TX], currentCa[BINLOG_DIR_TX], value,
+               timestamp->encodedValue, sizeof(struct sCP56Time2a), NULL);
+}
+void LogRXwT(int ioa, float value, CP56Time2a timestamp) {
+    pushRecord(REC_RXWT, ioa, 0, currentType[BINLOG_DIR_RX], currentCa[BINLOG_DIR_RX], value,
+               timestamp->encodedValue, sizeof(struct sCP56Time2a), NULL);
+}
+void LogTXwT24(int ioa, float value, CP24Time2a timestamp) {
+    pushRecord(REC_TXWT24, ioa, 0, currentType[BINLOG_DIR_TX], currentCa[BINLOG_DIR_TX], value,
+               timestamp->encodedValue, sizeof(struct sCP24Time2a), NULL);
+}
+void LogRXwT24(int ioa, float value, CP24Time2a timestamp) {
+    pushRecord(REC_RXWT24, ioa, 0, currentType[BINLOG_DIR_RX], currentCa[BINLOG_DIR_RX], value,
+               timestamp->encodedValue, sizeof(struct sCP24Time2a), NULL);
+}
+
+// =======================
+// ZAPISOVACÍ VLÁKNO
+// =======================
+
+static bool
+openLogFile(LogFile *file, uint64_t nowMs)
+{
+    if (file->binary) {
+        file->bin = BinLogWriter_open(file->path);
+        file->size = file->bin ? BinLogWriter_getSize(file->bin) : 0;
+        file->openedMs = nowMs;
+        return file->bin != NULL;
+    }
+
+    file->fd = open(file->path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+
+    if (file->fd < 0) {
+        fprintf(stderr, "Nelze otevřít log %s\n", file->path);
+        return false;
+    }
+
+    file->size = (uint64_t) lseek(file->fd, 0, SEEK_END);
+    file->openedMs = nowMs;
+    return true;
+}
+
+static void
+flushLogFile(LogFile *file)
+{
+    if (file->bin)
+        BinLogWriter_flush(file->bin);
+
+    int offset = 0;
+
+    while ((file->fd >= 0) && (offset < file->used)) {
+        ssize_t written = write(file->fd, file->buffer + offset, file->used - offset);
+        if (written <= 0)
+            break;
+        offset += (int) written;
+    }
+
+    file->used = 0;
+}
+
+// Přejmenuje path+suffix -> path.1+suffix -> path.2+suffix …
+static void
+shiftFiles(const char *path, const char *suffix)
+{
+    char from[300], to[300];
+
+    for (int i = LOG_KEEP_FILES - 1; i >= 1; i--) {
+        snprintf(from, sizeof(from), "%s.%d%s", path, i, suffix);
+        snprintf(to, sizeof(to), "%s.%d%s", path, i + 1, suffix);
+        rename(from, to);
+    }
+
+    snprintf(from, sizeof(from), "%s%s", path, suffix);
+    snprintf(to, sizeof(to), "%s.1%s", path, suffix);
+    rename(from, to);
+}
+
+// Zavře soubor, posune starší verze (.1, .2 …) a otevře nový soubor
+static void
+rotateLogFile(LogFile *file, uint64_t nowMs)
+{
+    flushLogFile(file);
+
+    if (file->fd >= 0)
+        close(file->fd);
+    file->fd = -1;
+
+    if (file->bin) {
+        BinLogWriter_close(file->bin);
+        file->bin = NULL;
+        shiftFiles(file->path, ".idx");
+    }
+
+    shiftFiles(file->path, "");
+
+    openLogFile(file, nowMs);
+}
+
+static bool
+needsRotation(LogFile *file, uint64_t nowMs)
+{
+    if ((maxSize > 0) && (file->size >= maxSize))
+        return true;
+
+    if ((rotatePeriod > 0) && (file->size > 0) && (nowMs - file->openedMs >= rotatePeriod))
+        return true;
+
+    return false;
+}
+
+// Přidá řádek do bufferu souboru (text bez prefixu, prefix doplní sám)
+static void
+appendLine(LogFile *file, uint64_t timeMs, const char *line, int length)
+{
+    if (file->fd < 0)
+        return;
+
+    if (file->used + prefixLength + length > LOG_WRITE_BUFFER)
+        flushLogFile(file);
+
+    if (needsRotation(file, timeMs))
+        rotateLogFile(file, timeMs);
+
+    updatePrefix(timeMs);
+
+    memcpy(file->buffer + file->used, prefix, prefixLength);
+    memcpy(file->buffer + file->used + prefixLength, line, length);
+    file->used += prefixLength + length;
+    file->size += prefixLength + length;
+}
+
+// Zapíše hodnotu do binárního datového logu
+static void
+appendBinary(LogFile *file, const LogRecord *rec)
+{
+    BinLogRecord record;
+    memset(&record, 0, sizeof(record));
+
+    record.timeMs = rec->timeMs;
+    record.ioa = (uint32_t) rec->a;
+    record.value = rec->value;
+    record.type = (uint8_t) rec->c;
+    record.ca = (uint16_t) rec->d;
+
+    switch (rec->kind) {
+        case REC_RXWOT:
+        case REC_RXWT:
+        case REC_RXWT24:
+            record.direction = BINLOG_DIR_RX;
+            break;
+        default:
+            record.direction = BINLOG_DIR_TX;
+            break;
+    }
+
+    if ((rec->kind == REC_TXWT) || (rec->kind == REC_RXWT)) {
+        record.hasTimestamp = 56;
+        memcpy(record.timestamp, rec->timestamp, 7);
+    } else if ((rec->kind == REC_TXWT24) || (rec->kind == REC_RXWT24)) {
+        record.hasTimestamp = 24;
+        memcpy(record.timestamp, rec->timestamp, 3);
+    }
+
+    if (needsRotation(file, rec->timeMs))
+        rotateLogFile(file, rec->timeMs);
+
+    if (file->bin == NULL)
+        return;
+
+    BinLogWriter_append(file->bin, &record);
+    file->size += sizeof(BinLogRecord);
+}
+
+// Naformátuje záznam stejně jako dřívější synchronní Log* funkce
+static void
+formatRecord(const LogRecord *rec)
+{
+    if (files[FILE_DATA].binary && (rec->kind >= REC_TX)) {
+        // Binární log ukládá jen hodnoty, typ a CA z hlavičky jsou v každém záznamu
+        if ((rec->kind != REC_TX) && (rec->kind != REC_RX))
+            appendBinary(&files[FILE_DATA], rec);
+        return;
+    }
+
+    char line[256];
+    int length = 0;
+    int target = FILE_DATA;
+
+    switch (rec->kind) {
+        case REC_START:
+            target = FILE_SERVICE;
+            length = snprintf(line, sizeof(line), "%s started \n", rec->text);
+            break;
+        case REC_CONREQ:
+            target = FILE_SERVICE;
+            length = snprintf(line, sizeof(line), "New connection request from %s\n", rec->text);
+            break;
+        case REC_CONOPEN:
+            target = FILE_SERVICE;
+            length = snprintf(line, sizeof(line), "Connection opened\n");
+            break;
+        case REC_CONCLOSED:
+            target = FILE_SERVICE;
+            length = snprintf(line, sizeof(line), "Connection closed\n");
+            break;
+        case REC_CONACT:
+            target = FILE_SERVICE;
+            length = snprintf(line, sizeof(line), "Connection activated\n");
+            break;
+        case REC_CONDEACT:
+            target = FILE_SERVICE;
+            length = snprintf(line, sizeof(line), "Connection deactivated\n");
+            break;
+        case REC_CONEST:
+            target = FILE_SERVICE;
+            length = snprintf(line, sizeof(line), "Connection established\n");
+            break;
+        case REC_STARTDT:
+            target = FILE_SERVICE;
+            length = snprintf(line, sizeof(line), "Received STARTDT_CON\n");
+            break;
+        case REC_STOPDT:
+            target = FILE_SERVICE;
+            length = snprintf(line, sizeof(line), "Received STOPDT_CON\n");
+            break;
+        case REC_RXREQUEST:
+            target = FILE_SERVICE;
+            length = snprintf(line, sizeof(line), "Received interrogation for group (%i).\n", rec->a);
+            break;
+        case REC_TXREQUEST:
+            target = FILE_SERVICE;
+            length = snprintf(line, sizeof(line), "Transceived interrogation for group (%i).\n", rec->a);
+            break;
+        case REC_TX:
+        case REC_RX:
+            length = snprintf(line, sizeof(line), "oa: %i ca: %i type:(%i) elements: %i\n",
+                              rec->c, rec->d, rec->a, rec->b);
+            break;
+        case REC_TXWOT:
+        case REC_RXWOT:
+            length = snprintf(line, sizeof(line), "IOA: %i value: %f\n", rec->a, rec->value);
+            break;
+        case REC_TXWT:
+        case REC_RXWT: {
+            struct sCP56Time2a ts;
+            memcpy(ts.encodedValue, rec->timestamp, sizeof(ts.encodedValue));
+            length = snprintf(line, sizeof(line),
+                              "IOA: %i value: %f with timestamp: %04i-%02i-%02i %02i:%02i:%02i \n",
+                              rec->a, rec->value,
+                              CP56Time2a_getYear(&ts) + 2000, CP56Time2a_getMonth(&ts), CP56Time2a_getDayOfMonth(&ts),
+                              CP56Time2a_getHour(&ts), CP56Time2a_getMinute(&ts), CP56Time2a_getSecond(&ts));
+            break;
+        }
+        case REC_TXWT24:
+        case REC_RXWT24: {
+            struct sCP24Time2a ts;
+            memcpy(ts.encodedValue, rec->timestamp, sizeof(ts.encodedValue));
+            length = snprintf(line, sizeof(line), "IOA: %i value: %f with timestamp: %02i:%02i:%03i \n",
+                              rec->a, rec->value,
+                              CP24Time2a_getMinute(&ts), CP24Time2a_getSecond(&ts), CP24Time2a_getMillisecond(&ts));
+            break;
+        }
+        default:
+            return;
+    }
+
+    if (length >= (int) sizeof(line))
+        length = sizeof(line) - 1;
+
+    appendLine(&files[target], rec->timeMs, line, length);
+}
+
+// Vybere hotové záznamy z bufferu, vrací jejich počet
+static int
+drainRing(void)
+{
+    int count = 0;
+
+    // Po dávce se vrátí, aby se stihl flush i při trvalém přísunu záznamů
+    while (count < LOG_RING_SIZE / 4) {
+        LogSlot *slot = &ring[dequeuePos & LOG_RING_MASK];
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+
+        if (seq != dequeuePos + 1)
+            break;
+
+        formatRecord(&slot->record);
+
+        atomic_store_explicit(&slot->seq, dequeuePos + LOG_RING_SIZE, memory_order_release);
+        dequeuePos++;
+        count++;
+    }
+
+    return count;
+}
+
+// Zapíše do servisního logu počet nově zahozených záznamů
+static void
+reportDropped(uint64_t *reported, uint64_t nowMs)
+{
+    uint64_t total = atomic_load_explicit(&dropped, memory_order_relaxed);
+
+    if (total == *reported)
+        return;
+
+    char line[128];
+    int length = snprintf(line, sizeof(line), "Log buffer overflow: %llu records dropped (total %llu)\n",
+                          (unsigned long long) (total - *reported), (unsigned long long) total);
+    appendLine(&files[FILE_SERVICE], nowMs, line, length);
+    *reported = total;
+}
+
+static void *
+writerThreadFunction(void *parameter)
+{
+    (void) parameter;
+
+    uint64_t lastFlush = Hal_getTimeInMs();
+    uint64_t reported = 0;
+
+    for (;;) {
+        bool stopping = !atomic_load_explicit(&writerRunning, memory_order_acquire);
+
+        int count = drainRing();
+
+        // Při ukončení se buffer vybere celý, ne jen jedna dávka
+        if (stopping) {
+            while (drainRing() > 0) {
+            }
+        }
+
+        uint64_t now = Hal_getTimeInMs();
+
+        if (now - lastFlush >= LOG_FLUSH_INTERVAL_MS || stopping) {
+            reportDropped(&reported, now);
+            flushLogFile(&files[FILE_DATA]);
+            flushLogFile(&files[FILE_SERVICE]);
+            lastFlush = now;
+        }
+
+        if (stopping)
+            break;
+
+        if (count == 0)
+            Thread_sleep(5);
+    }
+
+    return NULL;
+}
+
+bool
+Logger_start(const char *dataPath, const char *servicePath, bool binaryData, uint64_t maxFileSize,
+             uint64_t rotatePeriodMs)
+{
+    if (writerThread != NULL)
+        return true;
+
+    ring = (LogSlot *) GLOBAL_MALLOC(sizeof(LogSlot) * LOG_RING_SIZE);
+
+    if (ring == NULL)
+        return false;
+
+    for (size_t i = 0; i < LOG_RING_SIZE; i++)
+        atomic_init(&ring[i].seq, i);
+
+    atomic_init(&enqueuePos, 0);
+    dequeuePos = 0;
+    atomic_init(&dropped, 0);
+
+    maxSize = maxFileSize;
+    rotatePeriod = rotatePeriodMs;
+
+    uint64_t now = Hal_getTimeInMs();
+    const char *paths[2] = {dataPath, servicePath};
+
+    for (int i = 0; i < 2; i++) {
+        memset(&files[i], 0, sizeof(LogFile));
+        strncpy(files[i].path, paths[i], sizeof(files[i].path) - 1);
+        files[i].buffer = (char *) GLOBAL_MALLOC(LOG_WRITE_BUFFER);
+        files[i].fd = -1;
+        files[i].binary = (i == FILE_DATA) && binaryData;
+        if (files[i].buffer)
+            openLogFile(&files[i], now);
+    }
+
+    atomic_store(&writerRunning, true);
+
+    writerThread = Thread_create(writerThreadFunction, NULL, false);
+
+    if (writerThread == NULL) {
+        atomic_store(&writerRunning, false);
+        Logger_stop();
+        return false;
+    }
+
+    Thread_start(writerThread);
+    return true;
+}
+
+void
+Logger_stop(void)
+{
+    if (ring == NULL)
+        return;
+
+    atomic_store_explicit(&writerRunning, false, memory_order_release);
+
+    if (writerThread) {
+        Thread_destroy(writerThread);
+        writerThread = NULL;
+    }
+
+    for (int i = 0; i < 2; i++) {
+        if (files[i].fd >= 0)
+            close(files[i].fd);
+        files[i].fd = -1;
+        BinLogWriter_close(files[i].bin);
+        files[i].bin = NULL;
+        GLOBAL_FREEMEM(files[i].buffer);
+        files[i].buffer = NULL;
+    }
+
+    GLOBAL_FREEMEM(ring);
+    ring = NULL;
+}
+
+uint64_t
+Logger_getDropped(void)
+{
+    return atomic_load_explicit(&dropped, memory_order_relaxed);
+}
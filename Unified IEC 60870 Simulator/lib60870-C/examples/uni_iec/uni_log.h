@@ -0,0 +1,55 @@
+// =======================
+// ASYNCHRONNÍ LOGOVÁNÍ (DATALOG / SERVICELOG)
+// =======================
+//
+// Funkce Log* jen zapíšou binární záznam do lock-free kruhového bufferu
+// (více producentů, jeden konzument). Formátování, zápis do souboru a rotaci
+// dělá samostatné vlákno – protokolové callbacky tak neblokuje fopen/fclose.
+// Když je buffer plný, záznam se zahodí a zvýší se čítač zahozených záznamů.
+// Implementace stojí na C11 atomics, _Thread_local a POSIX open/write/lseek,
+// proto se uni_iec sestavuje jen na POSIX (na WIN32 ho CMake přeskočí).
+
+#ifndef UNI_LOG_H_
+#define UNI_LOG_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "iec60870_common.h"
+
+// Spustí zapisovací vlákno. binaryData = datový log v binárním formátu s indexem (uni_binlog.h),
+// maxFileSize = max. velikost souboru v bajtech před rotací (0 = bez limitu),
+// rotatePeriodMs = max. stáří souboru (0 = bez limitu).
+bool Logger_start(const char *dataPath, const char *servicePath, bool binaryData, uint64_t maxFileSize,
+                  uint64_t rotatePeriodMs);
+
+// Zapíše zbývající záznamy, zavře soubory a ukončí vlákno
+void Logger_stop(void);
+
+// Počet záznamů zahozených kvůli plnému bufferu
+uint64_t Logger_getDropped(void);
+
+// Servisní logy
+void LogSTART(const char *role);
+void LogCONREQ(const char *ipAddress);
+void LogCONOPEN(void);
+void LogCONCLOSED(void);
+void LogCONACT(void);
+void LogCONDEACT(void);
+void LogCONEST(void);
+void LogCONSTARTTD(void);
+void LogCONSTOPTD(void);
+void LogRXrequest(int qoi);
+void LogTXrequest(int qoi);
+
+// Datové logy
+void LogTX(int type, int elements, int oa, int ca);
+void LogRX(int type, int elements, int oa, int ca);
+void LogTXwoT(int ioa, float value);
+void LogRXwoT(int ioa, float value);
+void LogTXwT(int ioa, float value, CP56Time2a timestamp);
+void LogTXwT24(int ioa, float value, CP24Time2a timestamp);
+void LogRXwT(int ioa, float value, CP56Time2a timestamp);
+void LogRXwT24(int ioa, float value, CP24Time2a timestamp);
+
+#endif /* UNI_LOG_H_ */
@@ -0,0 +1,27 @@
+// =======================
+// MATEMATICKÉ POMŮCKY BEZ LIBM – implementace
+// =======================
+
+#include <stdint.h>
+#include <string.h>
+
+#include "uni_math.h"
+
+double
+UniMath_naturalLog(double x)
+{
+    uint64_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+
+    int exponent = (int) ((bits >> 52) & 0x7ff) - 1023;
+    bits = (bits & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL;
+
+    double m;
+    memcpy(&m, &bits, sizeof(m));
+
+    double s = (m - 1.0) / (m + 1.0);
+    double s2 = s * s;
+    double series = s * (2.0 + s2 * (2.0 / 3 + s2 * (2.0 / 5 + s2 * (2.0 / 7 + s2 * (2.0 / 9 + s2 * (2.0 / 11))))));
+
+    return exponent * 0.69314718055994530942 + series;
+}
@@ -0,0 +1,14 @@
+// =======================
+// MATEMATICKÉ POMŮCKY BEZ LIBM
+// =======================
+//
+// Příklad se linkuje bez libm (LDLIBS v make/target_system.mk ji nemají),
+// funkce potřebné pro náhodná rozdělení jsou proto tady.
+
+#ifndef UNI_MATH_H_
+#define UNI_MATH_H_
+
+// ln(x) pro x > 0: x = m * 2^e, ln(m) = 2 atanh((m-1)/(m+1)) řadou (chyba < 1e-7)
+double UniMath_naturalLog(double x);
+
+#endif /* UNI_MATH_H_ */
@@ -0,0 +1,235 @@
+// =======================
+// PERIODICKÉ ZPRÁVY – implementace
+// =======================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "uni_periodic.h"
+#include "uni_template.h"
+#include "hal_time.h"
+#include "lib_memory.h"
+
+struct sPeriodicSet;
+
+// Skupina periodických zpráv se stejnou periodou a vlastním časovačem
+typedef struct {
+    struct sPeriodicSet *set;
+    uint32_t periodMs;        // 0 = globální PERIOD
+    int firstTemplate;        // Šablony skupiny [firstTemplate, endTemplate)
+    int endTemplate;
+    Timer timer;
+} PeriodGroup;
+
+// Šablona i obsahuje body PointTable_getOrder(points)[templateStart[i] ...]
+struct sPeriodicSet {
+    PointTable points;
+
+    AsduTemplate *templates;
+    int *templateStart;
+    int numTemplates;
+
+    PeriodGroup groups[PERIODIC_MAX_GROUPS];
+    int numGroups;
+
+    TimerWheel wheel;
+    PeriodicSendFunction send;
+    void *parameter;
+};
+
+// Index skupiny s danou periodou (založí novou), -1 pokud je skupin moc
+static int
+getGroup(PeriodicSet self, uint32_t periodMs)
+{
+    for (int g = 0; g < self->numGroups; g++) {
+        if (self->groups[g].periodMs == periodMs)
+            return g;
+    }
+
+    if (self->numGroups == PERIODIC_MAX_GROUPS)
+        return -1;
+
+    PeriodGroup *group = &self->groups[self->numGroups];
+    memset(group, 0, sizeof(PeriodGroup));
+    group->set = self;
+    group->periodMs = periodMs;
+
+    return self->numGroups++;
+}
+
+PeriodicSet
+PeriodicSet_create(CS101_AppLayerParameters alParams, PointTable points, int oa, int ca)
+{
+    PeriodicSet self = (PeriodicSet) GLOBAL_CALLOC(1, sizeof(struct sPeriodicSet));
+
+    if (self == NULL)
+        return NULL;
+
+    self->points = points;
+
+    const int32_t *order = PointTable_getOrder(points);
+
+    if (order == NULL || points->count == 0)
+        return self;
+
+    // Horní odhad počtu šablon – každý bod ve vlastní šabloně
+    self->templates = (AsduTemplate *) GLOBAL_CALLOC((size_t) points->count, sizeof(AsduTemplate));
+    self->templateStart = (int *) GLOBAL_CALLOC((size_t) points->count, sizeof(int));
+
+    if (self->templates == NULL || self->templateStart == NULL) {
+        fprintf(stderr, "Nedostatek paměti pro šablony periodických zpráv\n");
+        PeriodicSet_destroy(self);
+        return NULL;
+    }
+
+    // Skupiny podle periody (0 = globální PERIOD)
+    for (int i = 0; i < points->count; i++) {
+        if (getGroup(self, points->periodMs[i]) < 0) {
+            fprintf(stderr, "Příliš mnoho různých period (max %d), bod IOA %d použije globální PERIOD\n",
+                    PERIODIC_MAX_GROUPS, points->ioa[i]);
+            PointTable_setPeriod(points, i, 0);
+            getGroup(self, 0);
+        }
+    }
+
+    for (int g = 0; g < self->numGroups; g++) {
+        PeriodGroup *group = &self->groups[g];
+        group->firstTemplate = self->numTemplates;
+
+        AsduTemplate current = NULL;
+        int currentType = -1;
+
+        for (int k = 0; k < points->count; k++) {
+            int p = order[k];
+
+            if (points->periodMs[p] != group->periodMs)
+                continue;
+
+            int type = points->type[p];
+
+            if (!AsduTemplate_isTypeSupported(type)) {
+                if (type != currentType)
+                    fprintf(stderr, "Typ %d nelze poslat periodicky, zprávy přeskočeny\n", type);
+                currentType = type;
+                current = NULL;
+                continue;
+            }
+
+            if (current == NULL || type != currentType ||
+                !AsduTemplate_addPoint(current, points->ioa[p], points->value[p])) {
+                current = AsduTemplate_create(alParams, type, CS101_COT_PERIODIC, oa, ca);
+
+                if (current == NULL) {
+                    fprintf(stderr, "Nepodařilo se vytvořit šablonu pro typ %d\n", type);
+                    continue;
+                }
+
+                AsduTemplate_addPoint(current, points->ioa[p], points->value[p]);
+                self->templates[self->numTemplates] = current;
+                self->templateStart[self->numTemplates] = k;
+                self->numTemplates++;
+                currentType = type;
+            }
+        }
+
+        group->endTemplate = self->numTemplates;
+    }
+
+    return self;
+}
+
+void
+PeriodicSet_destroy(PeriodicSet self)
+{
+    if (self == NULL)
+        return;
+
+    PeriodicSet_stop(self);
+
+    for (int i = 0; i < self->numTemplates; i++)
+        AsduTemplate_destroy(self->templates[i]);
+
+    GLOBAL_FREEMEM(self->templates);
+    GLOBAL_FREEMEM(self->templateStart);
+    GLOBAL_FREEMEM(self);
+}
+
+// Přepíše hodnoty a časové značky v šablonách skupiny a předá ASDU odesílací funkci
+static void
+onGroupTimer(void *parameter, uint64_t now)
+{
+    (void) now;
+
+    PeriodGroup *group = (PeriodGroup *) parameter;
+    PeriodicSet self = group->set;
+    PointTable points = self->points;
+
+    TemplateTime time;
+    uint64_t nowMs = Hal_getTimeInMs();
+    TemplateTime_set(&time, nowMs);
+
+    const int32_t *order = PointTable_getOrder(points);
+
+    if (order == NULL)
+        return;
+
+    for (int i = group->firstTemplate; i < group->endTemplate; i++) {
+        AsduTemplate tmpl = self->templates[i];
+        int n = AsduTemplate_getNumberOfPoints(tmpl);
+        int k = self->templateStart[i];
+
+        // Šablona obsahuje n bodů skupiny počínaje pozicí k v order (ostatní periody přeskočíme)
+        for (int j = 0; j < n; k++) {
+            int p = order[k];
+
+            if (points->periodMs[p] != group->periodMs)
+                continue;
+
+            AsduTemplate_setValue(tmpl, j, points->value[p]);
+            points->lastSent[p] = nowMs;
+            j++;
+        }
+
+        AsduTemplate_applyTime(tmpl, &time);
+
+        self->send(self->parameter, group->periodMs, i - group->firstTemplate, AsduTemplate_getASDU(tmpl));
+    }
+}
+
+void
+PeriodicSet_start(PeriodicSet self, TimerWheel wheel, int defaultPeriodMs, uint32_t phaseMs,
+                  PeriodicSendFunction send, void *parameter)
+{
+    self->wheel = wheel;
+    self->send = send;
+    self->parameter = parameter;
+
+    for (int g = 0; g < self->numGroups; g++) {
+        PeriodGroup *group = &self->groups[g];
+        uint32_t period = group->periodMs ? group->periodMs : (uint32_t) defaultPeriodMs;
+
+        group->timer = TimerWheel_addTimer(wheel, onGroupTimer, group);
+        TimerWheel_start(wheel, group->timer, period + phaseMs % period, period);
+    }
+}
+
+void
+PeriodicSet_stop(PeriodicSet self)
+{
+    if (self->wheel == NULL)
+        return;
+
+    for (int g = 0; g < self->numGroups; g++) {
+        TimerWheel_removeTimer(self->wheel, self->groups[g].timer);
+        self->groups[g].timer = NULL;
+    }
+
+    self->wheel = NULL;
+}
+
+int
+PeriodicSet_getNumberOfTemplates(PeriodicSet self)
+{
+    return self->numTemplates;
+}
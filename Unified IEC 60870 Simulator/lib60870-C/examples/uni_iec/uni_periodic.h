@@ -0,0 +1,43 @@
+// =======================
+// PERIODICKÉ ZPRÁVY PŘES PŘEDKÓDOVANÉ ŠABLONY
+// =======================
+//
+// Tabulka bodů se jednou "zkompiluje" do šablon ASDU (viz uni_template.h).
+// Body se rozdělí do skupin podle periody (0 = globální PERIOD) a v rámci
+// skupiny se body stejného typu plní do jedné šablony, dokud se vejdou do
+// ASDU. Každá skupina má vlastní časovač; v každém ticku se v šablonách jen
+// přepíšou hodnoty a časové značky a ASDU se předají odesílací funkci.
+// Sada patří jedné stanici (OA, CA, tabulka bodů) – nic nesdílí s jinými.
+
+#ifndef UNI_PERIODIC_H_
+#define UNI_PERIODIC_H_
+
+#include <stdint.h>
+
+#include "iec60870_common.h"
+#include "uni_points.h"
+#include "uni_timer.h"
+
+#define PERIODIC_MAX_GROUPS 64
+
+typedef struct sPeriodicSet* PeriodicSet;
+
+// Odeslání jednoho ASDU skupiny s periodou periodMs (0 = globální); index = pořadí ASDU v ticku skupiny
+typedef void (*PeriodicSendFunction)(void *parameter, uint32_t periodMs, int index, CS101_ASDU asdu);
+
+// Zkompiluje body tabulky do šablon. Body s příliš mnoha různými periodami dostanou globální PERIOD.
+PeriodicSet PeriodicSet_create(CS101_AppLayerParameters alParams, PointTable points, int oa, int ca);
+
+// Zruší i časovače, pokud sada běží
+void PeriodicSet_destroy(PeriodicSet self);
+
+// Založí časovače skupin (první tick za periodu + phaseMs, aby se stanice se stejnou periodou rozprostřely)
+void PeriodicSet_start(PeriodicSet self, TimerWheel wheel, int defaultPeriodMs, uint32_t phaseMs,
+                       PeriodicSendFunction send, void *parameter);
+
+// Zruší časovače skupin (šablony zůstanou)
+void PeriodicSet_stop(PeriodicSet self);
+
+int PeriodicSet_getNumberOfTemplates(PeriodicSet self);
+
+#endif /* UNI_PERIODIC_H_ */
@@ -0,0 +1,460 @@
+// =======================
+// PŘEHRÁVÁNÍ ČASOVÝCH ŘAD HODNOT ZE SOUBORU – implementace
+// =======================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "uni_playback.h"
+#include "lib_memory.h"
+
+#define PLAYBACK_WINDOW (8u * 1024 * 1024)   // Okno předem načítané před kurzorem a držené za ním
+#define PLAYBACK_MAX_PER_ADVANCE 100000      // Max. záznamů v jednom volání (omezuje držení zámku bodů)
+#define PLAYBACK_LINE_MAX 128                // Delší řádek CSV je vadný
+
+struct sValuePlayback {
+    const uint8_t *data;
+    size_t size;
+    size_t pageSize;
+    bool binary;
+
+    size_t cursor;            // Pozice dalšího záznamu
+    size_t end;               // Konec záznamů (binárně podle počtu v hlavičce)
+    size_t recordSize;        // Binárně: délka záznamu z hlavičky
+    size_t advisedUntil;      // Konec okna s MADV_WILLNEED
+    size_t releasedUntil;     // Začátek dosud neuvolněné části (MADV_DONTNEED)
+
+    // Přečtený záznam, na který ještě nedošlo
+    bool hasPending;
+    uint64_t pendingTs;
+    uint32_t pendingIoa;
+    float pendingValue;
+    uint8_t pendingQuality;
+
+    bool finished;
+    uint64_t firstTs;
+    uint64_t startMs;
+    float speed;
+
+    // Vyhledávání IOA (otevřené adresování, -1 = prázdné místo)
+    int32_t *hashIoa;
+    int32_t *hashPoint;
+    uint32_t hashMask;
+
+    int count;                // Počet bodů tabulky, pro kterou jsou pole sestavená
+    int32_t *order;           // Pořadí bodů podle (typ, IOA)
+    int32_t *rank;            // Index bodu -> pozice v order
+    uint32_t *mark;           // Bod už je mezi změnami aktuálního volání
+    uint32_t generation;
+    int32_t *changes;         // Výsledek posledního ValuePlayback_advance
+
+    uint64_t records;
+    uint64_t unknown;
+    uint64_t invalid;
+};
+
+static bool
+isBinaryPath(const char *path)
+{
+    size_t length = strlen(path);
+    return length > 4 && strcmp(path + length - 4, ".bin") == 0;
+}
+
+static uint32_t
+hashOf(uint32_t ioa, uint32_t mask)
+{
+    return (ioa * 2654435761u) & mask;
+}
+
+static void
+freePointArrays(ValuePlayback self)
+{
+    GLOBAL_FREEMEM(self->hashIoa);
+    GLOBAL_FREEMEM(self->hashPoint);
+    GLOBAL_FREEMEM(self->order);
+    GLOBAL_FREEMEM(self->rank);
+    GLOBAL_FREEMEM(self->mark);
+    GLOBAL_FREEMEM(self->changes);
+    self->hashIoa = self->hashPoint = self->order = self->rank = self->changes = NULL;
+    self->mark = NULL;
+    self->count = -1;
+}
+
+bool
+ValuePlayback_setPoints(ValuePlayback self, PointTable points)
+{
+    freePointArrays(self);
+
+    const int32_t *order = PointTable_getOrder(points);
+
+    if (order == NULL && points->count > 0)
+        return false;
+
+    int count = points->count;
+    size_t slots = (size_t) (count > 0 ? count : 1);
+    uint32_t hashSize = 16;
+
+    while (hashSize < 2 * (uint32_t) count)
+        hashSize <<= 1;
+
+    self->hashIoa = (int32_t *) GLOBAL_MALLOC(hashSize * sizeof(int32_t));
+    self->hashPoint = (int32_t *) GLOBAL_MALLOC(hashSize * sizeof(int32_t));
+    self->order = (int32_t *) GLOBAL_CALLOC(slots, sizeof(int32_t));
+    self->rank = (int32_t *) GLOBAL_CALLOC(slots, sizeof(int32_t));
+    self->mark = (uint32_t *) GLOBAL_CALLOC(slots, sizeof(uint32_t));
+    self->changes = (int32_t *) GLOBAL_CALLOC(slots, sizeof(int32_t));
+
+    if (self->hashIoa == NULL || self->hashPoint == NULL || self->order == NULL || self->rank == NULL ||
+        self->mark == NULL || self->changes == NULL) {
+        freePointArrays(self);
+        return false;
+    }
+
+    memset(self->hashPoint, 0xff, hashSize * sizeof(int32_t));
+    self->hashMask = hashSize - 1;
+    self->generation = 0;
+
+    // Body jdou podle (typ, IOA), takže pro IOA s více typy zůstane první typ
+    for (int k = 0; k < count; k++) {
+        int p = order[k];
+        uint32_t h = hashOf((uint32_t) points->ioa[p], self->hashMask);
+
+        self->order[k] = p;
+        self->rank[p] = k;
+
+        while (self->hashPoint[h] >= 0 && self->hashIoa[h] != points->ioa[p])
+            h = (h + 1) & self->hashMask;
+
+        if (self->hashPoint[h] < 0) {
+            self->hashIoa[h] = points->ioa[p];
+            self->hashPoint[h] = p;
+        }
+    }
+
+    self->count = count;
+    return true;
+}
+
+static int
+findPoint(ValuePlayback self, uint32_t ioa)
+{
+    uint32_t h = hashOf(ioa, self->hashMask);
+
+    while (self->hashPoint[h] >= 0) {
+        if ((uint32_t) self->hashIoa[h] == ioa)
+            return self->hashPoint[h];
+        h = (h + 1) & self->hashMask;
+    }
+
+    return -1;
+}
+
+static bool
+openBinary(ValuePlayback self)
+{
+    PlaybackHeader header;
+
+    if (self->size < sizeof(header))
+        return false;
+
+    memcpy(&header, self->data, sizeof(header));
+
+    if (memcmp(header.magic, PLAYBACK_MAGIC, sizeof(header.magic)) != 0 || header.version != PLAYBACK_VERSION ||
+        header.recordSize < sizeof(PlaybackRecord))
+        return false;
+
+    uint64_t available = (self->size - sizeof(header)) / header.recordSize;
+    uint64_t count = (header.count > 0 && header.count < available) ? header.count : available;
+
+    self->recordSize = header.recordSize;
+    self->cursor = sizeof(header);
+    self->end = sizeof(header) + (size_t) (count * header.recordSize);
+    return true;
+}
+
+ValuePlayback
+ValuePlayback_open(const char *path, PointTable points)
+{
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) {
+        perror("Failed to open playback file");
+        return NULL;
+    }
+
+    struct stat info;
+
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        fprintf(stderr, "Playback file %s is empty\n", path);
+        close(fd);
+        return NULL;
+    }
+
+    void *data = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        perror("Failed to map playback file");
+        return NULL;
+    }
+
+    ValuePlayback self = (ValuePlayback) GLOBAL_CALLOC(1, sizeof(struct sValuePlayback));
+
+    if (self == NULL) {
+        munmap(data, (size_t) info.st_size);
+        return NULL;
+    }
+
+    self->data = (const uint8_t *) data;
+    self->size = (size_t) info.st_size;
+    self->pageSize = (size_t) sysconf(_SC_PAGESIZE);
+    self->binary = isBinaryPath(path);
+    self->count = -1;
+    self->end = self->size;
+
+    if (self->binary && !openBinary(self)) {
+        fprintf(stderr, "Playback file %s has no valid " PLAYBACK_MAGIC " header\n", path);
+        ValuePlayback_close(self);
+        return NULL;
+    }
+
+    if (!ValuePlayback_setPoints(self, points)) {
+        ValuePlayback_close(self);
+        return NULL;
+    }
+
+    madvise(data, self->size, MADV_SEQUENTIAL);
+
+    return self;
+}
+
+void
+ValuePlayback_close(ValuePlayback self)
+{
+    if (self == NULL)
+        return;
+
+    munmap((void *) self->data, self->size);
+    freePointArrays(self);
+    GLOBAL_FREEMEM(self);
+}
+
+// Jeden řádek CSV: TIMESTAMP_MS;IOA;VALUE[;QUALITY]
+static bool
+parseLine(ValuePlayback self, const char *line)
+{
+    char *end;
+    uint64_t ts = strtoull(line, &end, 10);
+
+    if (*end != ';' && *end != ',')
+        return false;
+
+    const char *next = end + 1;
+    unsigned long ioa = strtoul(next, &end, 10);
+
+    if (end == next || (*end != ';' && *end != ','))
+        return false;
+
+    next = end + 1;
+    float value = strtof(next, &end);
+
+    if (end == next)
+        return false;
+
+    unsigned long quality = 0;
+
+    if (*end == ';' || *end == ',') {
+        next = end + 1;
+        quality = strtoul(next, &end, 0);
+
+        if (end == next || quality > 0xff)
+            return false;
+    }
+
+    while (*end == ' ' || *end == '\t' || *end == '\r')
+        end++;
+
+    if (*end != '\0')
+        return false;
+
+    self->pendingTs = ts;
+    self->pendingIoa = (uint32_t) ioa;
+    self->pendingValue = value;
+    self->pendingQuality = (uint8_t) quality;
+    return true;
+}
+
+// Přečte další záznam od kurzoru do pending; false = konec souboru
+static bool
+readRecord(ValuePlayback self)
+{
+    if (self->binary) {
+        if (self->cursor + self->recordSize > self->end)
+            return false;
+
+        PlaybackRecord record;
+        memcpy(&record, self->data + self->cursor, sizeof(record));
+        self->cursor += self->recordSize;
+
+        self->pendingTs = record.timestampMs;
+        self->pendingIoa = record.ioa;
+        self->pendingValue = record.value;
+        self->pendingQuality = record.quality;
+        self->hasPending = true;
+        return true;
+    }
+
+    while (self->cursor < self->end) {
+        const char *start = (const char *) self->data + self->cursor;
+        size_t remaining = self->end - self->cursor;
+        const char *eol = (const char *) memchr(start, '\n', remaining);
+        size_t length = eol ? (size_t) (eol - start) : remaining;
+
+        self->cursor += eol ? length + 1 : length;
+
+        // Hlavička, komentáře a prázdné řádky
+        if (length == 0 || start[0] < '0' || start[0] > '9')
+            continue;
+
+        // Namapovaný soubor nekončí nulou – řádek se zkopíruje pro strto*
+        char line[PLAYBACK_LINE_MAX];
+
+        if (length >= sizeof(line)) {
+            self->invalid++;
+            continue;
+        }
+
+        memcpy(line, start, length);
+        line[length] = '\0';
+
+        if (!parseLine(self, line)) {
+            self->invalid++;
+            continue;
+        }
+
+        self->hasPending = true;
+        return true;
+    }
+
+    return false;
+}
+
+// Načítá okno před kurzorem a uvolní přečtenou část (kromě jednoho okna za kurzorem)
+static void
+adviseWindow(ValuePlayback self)
+{
+    if (self->cursor + PLAYBACK_WINDOW / 2 > self->advisedUntil && self->advisedUntil < self->size) {
+        size_t start = self->cursor & ~(self->pageSize - 1);
+        size_t length = self->size - start < PLAYBACK_WINDOW ? self->size - start : PLAYBACK_WINDOW;
+
+        madvise((void *) (self->data + start), length, MADV_WILLNEED);
+        self->advisedUntil = start + length;
+    }
+
+    if (self->cursor > self->releasedUntil + 2 * PLAYBACK_WINDOW) {
+        size_t until = (self->cursor - PLAYBACK_WINDOW) & ~(self->pageSize - 1);
+
+        madvise((void *) (self->data + self->releasedUntil), until - self->releasedUntil, MADV_DONTNEED);
+        self->releasedUntil = until;
+    }
+}
+
+void
+ValuePlayback_start(ValuePlayback self, uint64_t nowMs, float speed)
+{
+    self->startMs = nowMs;
+    self->speed = speed;
+    self->finished = !readRecord(self);
+    self->firstTs = self->pendingTs;
+    adviseWindow(self);
+}
+
+static int
+compareInt(const void *a, const void *b)
+{
+    int32_t x = *(const int32_t *) a;
+    int32_t y = *(const int32_t *) b;
+    return (x > y) - (x < y);
+}
+
+int
+ValuePlayback_advance(ValuePlayback self, PointTable points, uint64_t nowMs, const int32_t **changes)
+{
+    int numChanges = 0;
+
+    *changes = self->changes;
+
+    if (self->finished || self->count != points->count)
+        return 0;
+
+    if (++self->generation == 0) {
+        memset(self->mark, 0, (size_t) self->count * sizeof(uint32_t));
+        self->generation = 1;
+    }
+
+    uint64_t elapsed = nowMs > self->startMs ? nowMs - self->startMs : 0;
+    uint64_t due = self->firstTs + (uint64_t) ((double) elapsed * self->speed);
+
+    for (int n = 0; n < PLAYBACK_MAX_PER_ADVANCE; n++) {
+        if (!self->hasPending && !readRecord(self)) {
+            self->finished = true;
+            break;
+        }
+
+        // Starší záznam za novějším (nesetříděný soubor) projde hned
+        if (self->speed > 0 && self->pendingTs > due)
+            break;
+
+        self->hasPending = false;
+        self->records++;
+
+        int p = findPoint(self, self->pendingIoa);
+
+        if (p < 0) {
+            self->unknown++;
+            continue;
+        }
+
+        if (self->pendingValue == points->value[p] && self->pendingQuality == points->quality[p])
+            continue;
+
+        PointTable_setValues(points, p, self->pendingValue, self->pendingValue);
+        points->quality[p] = self->pendingQuality;
+
+        if (self->mark[p] != self->generation) {
+            self->mark[p] = self->generation;
+            self->changes[numChanges++] = self->rank[p];
+        }
+    }
+
+    // Pozice v pořadí (typ, IOA) se seřadí a převedou zpět na indexy bodů
+    qsort(self->changes, (size_t) numChanges, sizeof(int32_t), compareInt);
+
+    for (int c = 0; c < numChanges; c++)
+        self->changes[c] = self->order[self->changes[c]];
+
+    adviseWindow(self);
+
+    return numChanges;
+}
+
+bool
+ValuePlayback_isFinished(ValuePlayback self)
+{
+    return self->finished;
+}
+
+void
+ValuePlayback_getProgress(ValuePlayback self, uint64_t *records, uint64_t *unknown, uint64_t *invalid,
+                          double *percent)
+{
+    *records = self->records;
+    *unknown = self->unknown;
+    *invalid = self->invalid;
+    *percent = self->end > 0 ? 100.0 * (double) self->cursor / (double) self->end : 100.0;
+}
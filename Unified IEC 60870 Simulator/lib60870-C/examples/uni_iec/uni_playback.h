@@ -0,0 +1,69 @@
+// =======================
+// PŘEHRÁVÁNÍ ČASOVÝCH ŘAD HODNOT ZE SOUBORU (PLAYBACK)
+// =======================
+//
+// Záznam hodnot z provozu (časová značka, IOA, hodnota, kvalita) se namapuje
+// do paměti a přehrává do tabulky bodů v pořadí časových značek, volitelně
+// zrychleně. Soubor se nikdy nenačítá celý: parser jde po záznamech od
+// kurzoru, jádro dostává radu MADV_SEQUENTIAL, okno před kurzorem se
+// předem načítá (MADV_WILLNEED) a přečtená část se uvolňuje (MADV_DONTNEED),
+// takže i vícegigabajtový záznam zabere v paměti jen pár oken.
+//
+// CSV: řádky "TIMESTAMP_MS;IOA;VALUE[;QUALITY]" (oddělovač ; nebo ,), řádky,
+// které nezačínají číslicí (hlavička, komentáře), se přeskočí. Binární
+// varianta (přípona .bin) má hlavičku PlaybackHeader a záznamy PlaybackRecord.
+// Záznamy musí být seřazené podle času; starší záznam za novějším se použije
+// hned. IOA se hledá mezi body tabulky (při více typech se stejným IOA platí
+// první podle typu), neznámá IOA se jen započítají.
+
+#ifndef UNI_PLAYBACK_H_
+#define UNI_PLAYBACK_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "uni_points.h"
+
+#define PLAYBACK_MAGIC "UNIVALUE"
+#define PLAYBACK_VERSION 1
+
+// Hlavička binárního záznamu
+typedef struct {
+    char magic[8];            // PLAYBACK_MAGIC
+    uint32_t version;
+    uint32_t recordSize;      // sizeof(PlaybackRecord), novější verze mohou záznam prodloužit
+    uint64_t count;           // Počet záznamů (0 = podle velikosti souboru)
+} PlaybackHeader;
+
+typedef struct {
+    uint64_t timestampMs;     // Čas v ms (libovolný počátek, např. Unix epoch)
+    uint32_t ioa;
+    float value;
+    uint8_t quality;          // QDS
+    uint8_t reserved[7];
+} PlaybackRecord;
+
+typedef struct sValuePlayback* ValuePlayback;
+
+// Namapuje soubor a připraví vyhledávání IOA v tabulce. NULL = chyba.
+ValuePlayback ValuePlayback_open(const char *path, PointTable points);
+
+void ValuePlayback_close(ValuePlayback self);
+
+// Začne přehrávat: první záznam odpovídá času nowMs, speed = zrychlení (0 = co nejrychleji)
+void ValuePlayback_start(ValuePlayback self, uint64_t nowMs, float speed);
+
+// Tabulka bodů byla vyměněna (hot reload) – znovu sestaví vyhledávání IOA
+bool ValuePlayback_setPoints(ValuePlayback self, PointTable points);
+
+// Zapíše do tabulky všechny záznamy, jejichž čas už nastal. Vrací počet změněných bodů, jejich
+// indexy (každý jednou, seřazené podle typu a IOA) jsou v *changes do dalšího volání.
+int ValuePlayback_advance(ValuePlayback self, PointTable points, uint64_t nowMs, const int32_t **changes);
+
+bool ValuePlayback_isFinished(ValuePlayback self);
+
+// Souhrn: přehrané záznamy, záznamy s neznámým IOA, vadné řádky, pozice v souboru v procentech
+void ValuePlayback_getProgress(ValuePlayback self, uint64_t *records, uint64_t *unknown, uint64_t *invalid,
+                               double *percent);
+
+#endif /* UNI_PLAYBACK_H_ */
@@ -0,0 +1,551 @@
+// =======================
+// TABULKA DATOVÝCH BODŮ – implementace
+// =======================
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "uni_points.h"
+#include "iec60870_common.h"
+#include "lib_memory.h"
+
+#define HASH_EMPTY -1
+
+static uint32_t
+hashKey(int type, int ioa)
+{
+    uint32_t key = ((uint32_t) type << 24) | ((uint32_t) ioa & 0xffffff);
+    // Fibonacciho hash – rozprostře souvislé IOA po celé tabulce
+    return key * 2654435761u;
+}
+
+// Realokuje pole na novou kapacitu, nově přidané prvky vynuluje
+static bool
+growArray(void **array, int elementSize, int oldCapacity, int newCapacity)
+{
+    void *newArray = GLOBAL_REALLOC(*array, (size_t) newCapacity * elementSize);
+
+    if (newArray == NULL)
+        return false;
+
+    memset((uint8_t *) newArray + (size_t) oldCapacity * elementSize, 0,
+           (size_t) (newCapacity - oldCapacity) * elementSize);
+
+    *array = newArray;
+    return true;
+}
+
+bool
+PointTable_reserve(PointTable self, int capacity)
+{
+    if (capacity <= self->capacity)
+        return true;
+
+    int oldCapacity = self->capacity;
+
+    if (!growArray((void **) &self->ioa, sizeof(int32_t), oldCapacity, capacity) ||
+        !growArray((void **) &self->type, sizeof(uint8_t), oldCapacity, capacity) ||
+        !growArray((void **) &self->value, sizeof(float), oldCapacity, capacity) ||
+        !growArray((void **) &self->valueA, sizeof(float), oldCapacity, capacity) ||
+        !growArray((void **) &self->valueB, sizeof(float), oldCapacity, capacity) ||
+        !growArray((void **) &self->toggleState, sizeof(uint8_t), oldCapacity, capacity) ||
+        !growArray((void **) &self->quality, sizeof(uint8_t), oldCapacity, capacity) ||
+        !growArray((void **) &self->flags, sizeof(uint8_t), oldCapacity, capacity) ||
+        !growArray((void **) &self->lastSent, sizeof(uint64_t), oldCapacity, capacity) ||
+        !growArray((void **) &self->periodMs, sizeof(uint32_t), oldCapacity, capacity) ||
+        !growArray((void **) &self->deadband, sizeof(float), oldCapacity, capacity) ||
+        !growArray((void **) &self->groups, sizeof(uint16_t), oldCapacity, capacity))
+        return false;
+
+    self->capacity = capacity;
+    return true;
+}
+
+PointTable
+PointTable_create(int initialCapacity)
+{
+    PointTable self = (PointTable) GLOBAL_CALLOC(1, sizeof(struct sPointTable));
+
+    if (self == NULL)
+        return NULL;
+
+    if (initialCapacity < 16)
+        initialCapacity = 16;
+
+    if (!PointTable_reserve(self, initialCapacity)) {
+        PointTable_destroy(self);
+        return NULL;
+    }
+
+    return self;
+}
+
+void
+PointTable_destroy(PointTable self)
+{
+    if (self == NULL)
+        return;
+
+    GLOBAL_FREEMEM(self->ioa);
+    GLOBAL_FREEMEM(self->type);
+    GLOBAL_FREEMEM(self->value);
+    GLOBAL_FREEMEM(self->valueA);
+    GLOBAL_FREEMEM(self->valueB);
+    GLOBAL_FREEMEM(self->toggleState);
+    GLOBAL_FREEMEM(self->quality);
+    GLOBAL_FREEMEM(self->flags);
+    GLOBAL_FREEMEM(self->lastSent);
+    GLOBAL_FREEMEM(self->periodMs);
+    GLOBAL_FREEMEM(self->deadband);
+    GLOBAL_FREEMEM(self->groups);
+    GLOBAL_FREEMEM(self->generators);
+    GLOBAL_FREEMEM(self->commands);
+    GLOBAL_FREEMEM(self->hashIndex);
+    GLOBAL_FREEMEM(self->order);
+    GLOBAL_FREEMEM(self);
+}
+
+PointTable
+PointTable_clone(PointTable self)
+{
+    PointTable clone = PointTable_create(self->count);
+
+    if (clone == NULL)
+        return NULL;
+
+    size_t count = (size_t) self->count;
+
+    memcpy(clone->ioa, self->ioa, count * sizeof(int32_t));
+    memcpy(clone->type, self->type, count * sizeof(uint8_t));
+    memcpy(clone->value, self->value, count * sizeof(float));
+    memcpy(clone->valueA, self->valueA, count * sizeof(float));
+    memcpy(clone->valueB, self->valueB, count * sizeof(float));
+    memcpy(clone->toggleState, self->toggleState, count * sizeof(uint8_t));
+    memcpy(clone->quality, self->quality, count * sizeof(uint8_t));
+    memcpy(clone->flags, self->flags, count * sizeof(uint8_t));
+    memcpy(clone->lastSent, self->lastSent, count * sizeof(uint64_t));
+    memcpy(clone->periodMs, self->periodMs, count * sizeof(uint32_t));
+    memcpy(clone->deadband, self->deadband, count * sizeof(float));
+    memcpy(clone->groups, self->groups, count * sizeof(uint16_t));
+    clone->count = self->count;
+
+    if (self->generatorCount > 0) {
+        clone->generators = (PointGenerator *) GLOBAL_MALLOC((size_t) self->generatorCount * sizeof(PointGenerator));
+        if (clone->generators == NULL) {
+            PointTable_destroy(clone);
+            return NULL;
+        }
+        memcpy(clone->generators, self->generators, (size_t) self->generatorCount * sizeof(PointGenerator));
+        clone->generatorCount = clone->generatorCapacity = self->generatorCount;
+    }
+
+    if (self->commandCount > 0) {
+        clone->commands = (PointCommand *) GLOBAL_MALLOC((size_t) self->commandCount * sizeof(PointCommand));
+        if (clone->commands == NULL) {
+            PointTable_destroy(clone);
+            return NULL;
+        }
+        memcpy(clone->commands, self->commands, (size_t) self->commandCount * sizeof(PointCommand));
+        clone->commandCount = clone->commandCapacity = self->commandCount;
+    }
+
+    return clone;
+}
+
+void
+PointTable_clear(PointTable self)
+{
+    self->count = 0;
+    self->generatorCount = 0;
+    self->commandCount = 0;
+    self->hashValid = false;
+    self->orderValid = false;
+}
+
+int
+PointTable_add(PointTable self, int type, int ioa, float valueA, float valueB, uint8_t flags)
+{
+    if (self->count >= POINT_TABLE_MAX_POINTS)
+        return -1;
+
+    if (self->count == self->capacity) {
+        if (!PointTable_reserve(self, self->capacity * 2))
+            return -1;
+    }
+
+    int index = self->count++;
+
+    self->ioa[index] = ioa;
+    self->type[index] = (uint8_t) type;
+    self->value[index] = valueA;
+    self->valueA[index] = valueA;
+    self->valueB[index] = valueB;
+    self->toggleState[index] = 0;
+    self->quality[index] = IEC60870_QUALITY_GOOD;
+    self->flags[index] = flags;
+    self->lastSent[index] = 0;
+    self->periodMs[index] = 0;
+    self->deadband[index] = 0;
+    self->groups[index] = 0;
+
+    self->hashValid = false;
+    self->orderValid = false;
+
+    return index;
+}
+
+void
+PointTable_setPeriod(PointTable self, int index, uint32_t periodMs)
+{
+    if ((index >= 0) && (index < self->count))
+        self->periodMs[index] = periodMs;
+}
+
+void
+PointTable_setDeadband(PointTable self, int index, float deadband, bool percent)
+{
+    if ((index < 0) || (index >= self->count))
+        return;
+
+    self->deadband[index] = deadband;
+    self->flags[index] |= POINT_FLAG_DEADBAND;
+
+    if (percent)
+        self->flags[index] |= POINT_FLAG_DEADBAND_PERCENT;
+    else
+        self->flags[index] &= ~POINT_FLAG_DEADBAND_PERCENT;
+}
+
+void
+PointTable_setGroups(PointTable self, int index, uint16_t groups)
+{
+    if ((index >= 0) && (index < self->count))
+        self->groups[index] = groups;
+}
+
+bool
+PointTable_setGenerator(PointTable self, int index, const PointGenerator *generator)
+{
+    if ((index < 0) || (index >= self->count))
+        return false;
+
+    int last = self->generatorCount - 1;
+
+    if ((last >= 0) && (self->generators[last].point > index))
+        return false;
+
+    if ((last < 0) || (self->generators[last].point != index)) {
+        if (self->generatorCount == self->generatorCapacity) {
+            int capacity = self->generatorCapacity ? self->generatorCapacity * 2 : 16;
+            PointGenerator *generators =
+                (PointGenerator *) GLOBAL_REALLOC(self->generators, (size_t) capacity * sizeof(PointGenerator));
+            if (generators == NULL)
+                return false;
+            self->generators = generators;
+            self->generatorCapacity = capacity;
+        }
+        last = self->generatorCount++;
+    }
+
+    self->generators[last] = *generator;
+    self->generators[last].point = index;
+    self->flags[index] |= POINT_FLAG_GENERATED;
+    return true;
+}
+
+const PointGenerator *
+PointTable_getGenerator(PointTable self, int index)
+{
+    if ((index < 0) || (index >= self->count) || ((self->flags[index] & POINT_FLAG_GENERATED) == 0))
+        return NULL;
+
+    // Předpisy jsou seřazené podle indexu bodu
+    int low = 0;
+    int high = self->generatorCount - 1;
+
+    while (low <= high) {
+        int middle = (low + high) / 2;
+        int point = self->generators[middle].point;
+
+        if (point == index)
+            return &self->generators[middle];
+
+        if (point < index)
+            low = middle + 1;
+        else
+            high = middle - 1;
+    }
+
+    return NULL;
+}
+
+bool
+PointTable_setCommand(PointTable self, int index, const PointCommand *command)
+{
+    if ((index < 0) || (index >= self->count))
+        return false;
+
+    int last = self->commandCount - 1;
+
+    if ((last >= 0) && (self->commands[last].point > index))
+        return false;
+
+    if ((last < 0) || (self->commands[last].point != index)) {
+        if (self->commandCount == self->commandCapacity) {
+            int capacity = self->commandCapacity ? self->commandCapacity * 2 : 16;
+            PointCommand *commands =
+                (PointCommand *) GLOBAL_REALLOC(self->commands, (size_t) capacity * sizeof(PointCommand));
+            if (commands == NULL)
+                return false;
+            self->commands = commands;
+            self->commandCapacity = capacity;
+        }
+        last = self->commandCount++;
+    }
+
+    self->commands[last] = *command;
+    self->commands[last].point = index;
+    self->flags[index] |= POINT_FLAG_COMMAND;
+    return true;
+}
+
+const PointCommand *
+PointTable_getCommand(PointTable self, int index)
+{
+    if ((index < 0) || (index >= self->count) || ((self->flags[index] & POINT_FLAG_COMMAND) == 0))
+        return NULL;
+
+    // Vazby jsou seřazené podle indexu bodu
+    int low = 0;
+    int high = self->commandCount - 1;
+
+    while (low <= high) {
+        int middle = (low + high) / 2;
+        int point = self->commands[middle].point;
+
+        if (point == index)
+            return &self->commands[middle];
+
+        if (point < index)
+            low = middle + 1;
+        else
+            high = middle - 1;
+    }
+
+    return NULL;
+}
+
+// Stejná vazba na command (bez ohledu na index bodu)
+static bool
+sameCommand(const PointCommand *a, const PointCommand *b)
+{
+    if ((a == NULL) || (b == NULL))
+        return a == b;
+
+    return (a->ioa == b->ioa) && (a->selectBeforeOperate == b->selectBeforeOperate) &&
+           (a->hasDelay == b->hasDelay) && (a->delay.kind == b->delay.kind) &&
+           (memcmp(a->delay.param, b->delay.param, sizeof(a->delay.param)) == 0);
+}
+
+// Stejný generátor (bez ohledu na index bodu)
+static bool
+sameGenerator(const PointGenerator *a, const PointGenerator *b)
+{
+    if ((a == NULL) || (b == NULL))
+        return a == b;
+
+    return (a->kind == b->kind) && (a->stepCount == b->stepCount) &&
+           (memcmp(a->param, b->param, sizeof(a->param)) == 0) &&
+           (memcmp(a->stepValue, b->stepValue, sizeof(a->stepValue)) == 0) &&
+           (memcmp(a->stepMs, b->stepMs, sizeof(a->stepMs)) == 0);
+}
+
+void
+PointTable_setValues(PointTable self, int index, float valueA, float valueB)
+{
+    if ((index < 0) || (index >= self->count))
+        return;
+
+    self->value[index] = valueA;
+    self->valueA[index] = valueA;
+    self->valueB[index] = valueB;
+}
+
+static bool
+buildHashIndex(PointTable self)
+{
+    // Velikost = mocnina dvou, max. 50% zaplnění
+    int size = 64;
+    while (size < self->count * 2)
+        size *= 2;
+
+    if (size != self->hashSize) {
+        int32_t *newIndex = (int32_t *) GLOBAL_MALLOC((size_t) size * sizeof(int32_t));
+        if (newIndex == NULL)
+            return false;
+        GLOBAL_FREEMEM(self->hashIndex);
+        self->hashIndex = newIndex;
+        self->hashSize = size;
+    }
+
+    memset(self->hashIndex, 0xff, (size_t) size * sizeof(int32_t));
+
+    uint32_t mask = (uint32_t) size - 1;
+
+    for (int i = 0; i < self->count; i++) {
+        uint32_t slot = hashKey(self->type[i], self->ioa[i]) & mask;
+
+        while (self->hashIndex[slot] != HASH_EMPTY) {
+            int other = self->hashIndex[slot];
+            // Duplicitní bod – v indexu zůstává první výskyt
+            if ((self->type[other] == self->type[i]) && (self->ioa[other] == self->ioa[i]))
+                break;
+            slot = (slot + 1) & mask;
+        }
+
+        if (self->hashIndex[slot] == HASH_EMPTY)
+            self->hashIndex[slot] = i;
+    }
+
+    self->hashValid = true;
+    return true;
+}
+
+int
+PointTable_find(PointTable self, int type, int ioa)
+{
+    if (!self->hashValid && !buildHashIndex(self))
+        return -1;
+
+    uint32_t mask = (uint32_t) self->hashSize - 1;
+    uint32_t slot = hashKey(type, ioa) & mask;
+
+    while (self->hashIndex[slot] != HASH_EMPTY) {
+        int index = self->hashIndex[slot];
+        if ((self->type[index] == (uint8_t) type) && (self->ioa[index] == ioa))
+            return index;
+        slot = (slot + 1) & mask;
+    }
+
+    return -1;
+}
+
+static int
+compareKeys(const void *a, const void *b)
+{
+    uint64_t keyA = *(const uint64_t *) a;
+    uint64_t keyB = *(const uint64_t *) b;
+    return (keyA > keyB) - (keyA < keyB);
+}
+
+const int32_t *
+PointTable_getOrder(PointTable self)
+{
+    if (self->orderValid)
+        return self->order;
+
+    int32_t *order = (int32_t *) GLOBAL_REALLOC(self->order, (size_t) (self->count + 1) * sizeof(int32_t));
+    uint64_t *keys = (uint64_t *) GLOBAL_MALLOC((size_t) (self->count + 1) * sizeof(uint64_t));
+
+    if ((order == NULL) || (keys == NULL)) {
+        GLOBAL_FREEMEM(keys);
+        if (order != NULL)
+            self->order = order;
+        return NULL;
+    }
+
+    self->order = order;
+
+    // Klíč = type | ioa | index -> po seřazení stačí vzít spodních 24 bitů
+    for (int i = 0; i < self->count; i++)
+        keys[i] = ((uint64_t) self->type[i] << 48) | ((uint64_t) (self->ioa[i] & 0xffffff) << 24) | (uint64_t) i;
+
+    qsort(keys, self->count, sizeof(uint64_t), compareKeys);
+
+    for (int i = 0; i < self->count; i++)
+        order[i] = (int32_t) (keys[i] & 0xffffff);
+
+    GLOBAL_FREEMEM(keys);
+
+    self->orderValid = true;
+    return self->order;
+}
+
+void
+PointTable_copyToggleStates(PointTable self, PointTable other)
+{
+    for (int i = 0; i < self->count; i++) {
+        if ((self->flags[i] & POINT_FLAG_TOGGLE) == 0)
+            continue;
+
+        int index = PointTable_find(other, self->type[i], self->ioa[i]);
+
+        if ((index >= 0) && (other->flags[index] & POINT_FLAG_TOGGLE))
+            self->toggleState[i] = other->toggleState[index];
+    }
+}
+
+static inline uint64_t
+sortKey(PointTable self, int index)
+{
+    return ((uint64_t) self->type[index] << 24) | (uint64_t) (self->ioa[index] & 0xffffff);
+}
+
+PointDiff
+PointTable_diff(PointTable self, PointTable other, PointDiffHandler handler, void *parameter)
+{
+    PointDiff diff;
+    memset(&diff, 0, sizeof(diff));
+
+    const int32_t *oldOrder = PointTable_getOrder(self);
+    const int32_t *newOrder = PointTable_getOrder(other);
+
+    if ((oldOrder == NULL) || (newOrder == NULL))
+        return diff;
+
+    int i = 0;
+    int j = 0;
+
+    // Obě tabulky jsou seřazené podle (type, ioa) – stačí jeden průchod jako při slévání
+    while ((i < self->count) || (j < other->count)) {
+        int oldIndex = (i < self->count) ? oldOrder[i] : -1;
+        int newIndex = (j < other->count) ? newOrder[j] : -1;
+
+        if ((newIndex < 0) || ((oldIndex >= 0) && (sortKey(self, oldIndex) < sortKey(other, newIndex)))) {
+            diff.removed++;
+            if (handler)
+                handler(parameter, POINT_DIFF_REMOVED, oldIndex, -1);
+            i++;
+        }
+        else if ((oldIndex < 0) || (sortKey(self, oldIndex) > sortKey(other, newIndex))) {
+            diff.added++;
+            if (handler)
+                handler(parameter, POINT_DIFF_ADDED, -1, newIndex);
+            j++;
+        }
+        else {
+            if ((self->periodMs[oldIndex] != other->periodMs[newIndex]) ||
+                (self->flags[oldIndex] != other->flags[newIndex]) ||
+                (self->deadband[oldIndex] != other->deadband[newIndex]) ||
+                (self->groups[oldIndex] != other->groups[newIndex]) ||
+                !sameGenerator(PointTable_getGenerator(self, oldIndex), PointTable_getGenerator(other, newIndex)) ||
+                !sameCommand(PointTable_getCommand(self, oldIndex), PointTable_getCommand(other, newIndex))) {
+                diff.changedLayout++;
+                if (handler)
+                    handler(parameter, POINT_DIFF_LAYOUT, oldIndex, newIndex);
+            }
+
+            if ((self->valueA[oldIndex] != other->valueA[newIndex]) ||
+                (self->valueB[oldIndex] != other->valueB[newIndex])) {
+                diff.changedValue++;
+                if (handler)
+                    handler(parameter, POINT_DIFF_VALUE, oldIndex, newIndex);
+            }
+
+            i++;
+            j++;
+        }
+    }
+
+    return diff;
+}
@@ -0,0 +1,191 @@
+// =======================
+// TABULKA DATOVÝCH BODŮ (structure of arrays)
+// =======================
+//
+// Každá vlastnost bodu má vlastní pole, takže periodické odesílání, GI
+// i výběr spontánních zpráv procházejí jen pole, která opravdu potřebují,
+// bez kopírování struktur. Tabulka roste podle potřeby (až miliony bodů).
+
+#ifndef UNI_POINTS_H_
+#define UNI_POINTS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Příznaky bodu (pole flags)
+#define POINT_FLAG_PERMANENT 0x01   // Bod z bloku PERM_MESS (jinak TEMP_MESS)
+#define POINT_FLAG_TOGGLE    0x02   // Dual bod – přepíná mezi valueA a valueB
+#define POINT_FLAG_CONSUMED  0x04   // TEMP bod už byl odeslán (klient, viz uni_journal.h)
+#define POINT_FLAG_GENERATED 0x08   // Hodnotu bodu počítá generátor (volba GEN=, viz uni_generator.h)
+#define POINT_FLAG_DEADBAND  0x10   // Bod má vlastní deadband (volba DB=, jinak platí globální DEADBAND)
+#define POINT_FLAG_DEADBAND_PERCENT 0x20  // Deadband bodu je v procentech poslední hlášené hodnoty
+#define POINT_FLAG_COMMAND   0x40   // Stavový bod ovládaný commandem (volby CMD= / DELAY=, viz uni_commands.h)
+
+// Max. počet bodů (index se vejde do 24 bitů klíče pro řazení)
+#define POINT_TABLE_MAX_POINTS 0xffffff
+
+typedef struct sPointTable* PointTable;
+
+// Druh generátoru hodnoty bodu
+typedef enum {
+    POINT_GEN_NONE = 0,
+    POINT_GEN_SINE,        // base + amp * sin(2π t / perioda + fáze)
+    POINT_GEN_RAMP,        // Pila min → max za periodu
+    POINT_GEN_WALK,        // Náhodná procházka s krokem a mezemi
+    POINT_GEN_NOISE,       // base ± amp (rovnoměrný šum)
+    POINT_GEN_STEP         // Rozvrh hodnot s dobami trvání (dokola)
+} PointGeneratorKind;
+
+#define POINT_GEN_MAX_STEPS 8
+
+// Předpis generátoru jednoho bodu (výchozí hodnota = valueA bodu)
+typedef struct {
+    int32_t point;                        // Index bodu
+    uint8_t kind;                         // PointGeneratorKind
+    uint8_t stepCount;
+    float param[3];                       // Význam podle druhu, viz Generator_parse
+    float stepValue[POINT_GEN_MAX_STEPS];
+    uint32_t stepMs[POINT_GEN_MAX_STEPS];
+} PointGenerator;
+
+// Rozdělení doby vykonání commandu (parametry v ms)
+typedef enum {
+    COMMAND_DELAY_FIXED = 0,   // param[0]
+    COMMAND_DELAY_UNIFORM,     // Rovnoměrně mezi param[0] a param[1]
+    COMMAND_DELAY_NORMAL,      // Střed param[0], směrodatná odchylka param[1] (záporné = 0)
+    COMMAND_DELAY_EXP          // Exponenciální se střední hodnotou param[0]
+} CommandDelayKind;
+
+typedef struct {
+    uint8_t kind;                         // CommandDelayKind
+    float param[2];
+} CommandDelay;
+
+// Vazba stavového bodu na command, který ho ovládá
+typedef struct {
+    int32_t point;                        // Index stavového bodu
+    int32_t ioa;                          // IOA commandu (-1 = stejné jako bod)
+    uint8_t selectBeforeOperate;          // Command vyžaduje výběr (SBO)
+    uint8_t hasDelay;                     // Vlastní doba vykonání (jinak globální COMMANDDELAY)
+    CommandDelay delay;
+} PointCommand;
+
+// Pole jsou veřejná kvůli přímé iteraci v horkých smyčkách,
+// měnit je ale smí jen funkce PointTable_*
+struct sPointTable {
+    int count;
+    int capacity;
+
+    int32_t *ioa;
+    uint8_t *type;
+    float *value;          // Hodnota pro 1-hodnotové body
+    float *valueA;         // Dual: první hodnota
+    float *valueB;         // Dual: druhá hodnota
+    uint8_t *toggleState;  // Dual: 0 = posílá se valueA, 1 = valueB
+    uint8_t *quality;      // QDS (IEC60870_QUALITY_*)
+    uint8_t *flags;        // POINT_FLAG_*
+    uint64_t *lastSent;    // Čas posledního odeslání v ms (0 = zatím neodesláno)
+    uint32_t *periodMs;    // Vlastní perioda bodu v ms (0 = globální PERIOD)
+    float *deadband;       // Vlastní deadband bodu (platí jen s POINT_FLAG_DEADBAND)
+    uint16_t *groups;      // Skupiny dotazu (bit g-1 = skupina g, QOI 20+g)
+
+    // Předpisy generátorů seřazené podle indexu bodu (jen body s POINT_FLAG_GENERATED)
+    PointGenerator *generators;
+    int generatorCount;
+    int generatorCapacity;
+
+    // Vazby na commandy seřazené podle indexu bodu (jen body s POINT_FLAG_COMMAND)
+    PointCommand *commands;
+    int commandCount;
+    int commandCapacity;
+
+    // Hash index (type, ioa) -> index bodu, staví se líně při PointTable_find
+    int32_t *hashIndex;
+    int hashSize;
+    bool hashValid;
+
+    // Indexy bodů seřazené podle (type, ioa), staví se líně
+    int32_t *order;
+    bool orderValid;
+};
+
+PointTable PointTable_create(int initialCapacity);
+
+void PointTable_destroy(PointTable self);
+
+// Samostatná kopie tabulky (body, generátory i vazby na commandy), NULL při nedostatku paměti
+PointTable PointTable_clone(PointTable self);
+
+// Odstraní všechny body (paměť zůstává alokovaná)
+void PointTable_clear(PointTable self);
+
+// Předem zvětší kapacitu (např. před hromadným plněním), vrací false při nedostatku paměti
+bool PointTable_reserve(PointTable self, int capacity);
+
+// Přidá bod, vrací jeho index nebo -1 při nedostatku paměti / plné tabulce
+int PointTable_add(PointTable self, int type, int ioa, float valueA, float valueB, uint8_t flags);
+
+// Nastaví bodu vlastní periodu (0 = globální PERIOD)
+void PointTable_setPeriod(PointTable self, int index, uint32_t periodMs);
+
+// Nastaví bodu vlastní deadband (absolutní, nebo v procentech poslední hlášené hodnoty)
+void PointTable_setDeadband(PointTable self, int index, float deadband, bool percent);
+
+// Nastaví skupiny dotazu bodu (bit g-1 = skupina g z 1–16)
+void PointTable_setGroups(PointTable self, int index, uint16_t groups);
+
+// Přiřadí bodu generátor hodnoty (body se přidávají po sobě, takže stačí přidat na konec)
+bool PointTable_setGenerator(PointTable self, int index, const PointGenerator *generator);
+
+// Generátor bodu nebo NULL
+const PointGenerator *PointTable_getGenerator(PointTable self, int index);
+
+// Přiřadí bodu vazbu na command (body se přidávají po sobě, takže stačí přidat na konec)
+bool PointTable_setCommand(PointTable self, int index, const PointCommand *command);
+
+// Vazba bodu na command nebo NULL
+const PointCommand *PointTable_getCommand(PointTable self, int index);
+
+// Najde bod podle typu a IOA, vrací index nebo -1
+int PointTable_find(PointTable self, int type, int ioa);
+
+// Indexy všech bodů seřazené podle typu a IOA (platné do další změny tabulky)
+const int32_t *PointTable_getOrder(PointTable self);
+
+// Hodnota, která se má poslat (u dual bodů podle toggleState)
+static inline float PointTable_getSendValue(PointTable self, int index) {
+    if (self->flags[index] & POINT_FLAG_TOGGLE)
+        return self->toggleState[index] ? self->valueB[index] : self->valueA[index];
+    return self->value[index];
+}
+
+// Převezme toggleState dual bodů se stejným (type, ioa) z jiné tabulky
+void PointTable_copyToggleStates(PointTable self, PointTable other);
+
+// Nastaví hodnoty bodu (u dual bodů zůstává toggleState)
+void PointTable_setValues(PointTable self, int index, float valueA, float valueB);
+
+// Druh rozdílu mezi dvěma tabulkami (viz PointTable_diff)
+typedef enum {
+    POINT_DIFF_ADDED,      // Bod je jen v nové tabulce
+    POINT_DIFF_REMOVED,    // Bod je jen ve staré tabulce
+    POINT_DIFF_VALUE,      // Jiná hodnota (valueA / valueB)
+    POINT_DIFF_LAYOUT      // Jiná perioda, příznaky nebo generátor (mění rozdělení do šablon)
+} PointDiffKind;
+
+// Callback rozdílu, oldIndex / newIndex = -1, pokud bod v dané tabulce není
+typedef void (*PointDiffHandler)(void *parameter, PointDiffKind kind, int oldIndex, int newIndex);
+
+// Souhrn rozdílů
+typedef struct {
+    int added;
+    int removed;
+    int changedValue;
+    int changedLayout;
+} PointDiff;
+
+// Porovná tabulky podle (type, ioa) v pořadí PointTable_getOrder a každý rozdíl předá
+// handleru (může být NULL). Duplicitní body se párují v pořadí výskytu.
+PointDiff PointTable_diff(PointTable self, PointTable other, PointDiffHandler handler, void *parameter);
+
+#endif /* UNI_POINTS_H_ */
@@ -0,0 +1,811 @@
+// =======================
+// SCÉNÁŘ UDÁLOSTÍ PODLE ČASOVÉ OSY – implementace
+// =======================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "uni_scenario.h"
+#include "uni_timer.h"
+#include "lib_memory.h"
+
+#define SCENARIO_CHUNK (64u * 1024)          // Blok souboru čtený najednou
+#define SCENARIO_LINE_MAX 256                // Delší řádek je vadný
+#define SCENARIO_MAX_FIELDS 8
+#define SCENARIO_MAX_PENDING 65536           // Víc akcí na dohled se z dalších řádků nečte
+#define SCENARIO_INITIAL_HEAP 1024
+#define SCENARIO_REFILL_BATCH 4096           // Akcí za dohledem přidaných v jednom volání (rozkládá čtení)
+#define SCENARIO_MAX_PER_ADVANCE 100000      // Max. akcí v jednom volání (omezuje držení zámku bodů)
+#define SCENARIO_MAX_EVENTS 100000           // Max. událostí lavin v jednom volání
+#define SCENARIO_BURST_STEP_MS 10            // Krok laviny – události kroku se zabalí do společných ASDU
+#define SCENARIO_MAX_RANGE 1000000           // Max. počet IOA v rozsahu jedné akce
+
+struct sScenario {
+    FILE *file;
+    char *chunk;              // Blok souboru
+    size_t chunkStart;        // Začátek nepřečtené části bloku
+    size_t chunkLength;
+    bool eof;
+    bool skipping;            // Zahazuje se zbytek řádku delšího než blok
+
+    uint64_t lastAtMs;        // Čas předchozího řádku (pro "+doba")
+    uint64_t sequence;
+
+    // Rozebraná akce, která ještě není na dohled
+    bool hasNext;
+    ScenarioAction next;
+
+    // Akce na dohled: min-halda podle (atMs, sequence)
+    ScenarioAction *heap;
+    int heapCount;
+    int heapCapacity;
+
+    bool started;
+    bool finished;
+    uint64_t startMs;
+    float speed;
+    uint64_t state;           // xorshift64* pro laviny (pevné semínko)
+
+    // Vyhledávání IOA (otevřené adresování, -1 = prázdné místo)
+    int32_t *hashIoa;
+    int32_t *hashPoint;
+    uint32_t hashMask;
+
+    ScenarioTypeFilter filter;
+    int count;                // Počet bodů tabulky, pro kterou jsou pole sestavená
+    int32_t *order;           // Pořadí bodů podle (typ, IOA)
+    int32_t *rank;            // Index bodu -> pozice v order
+    int32_t *candidates;      // Pozice v order bodů, ze kterých losují laviny bez rozsahu
+    int candidateCount;
+    uint32_t *mark;           // Bod už je mezi změnami aktuálního volání
+    uint32_t generation;
+    int32_t *changes;         // Výsledek posledního Scenario_advance
+    int32_t *events;
+
+    uint64_t actions;
+    uint64_t emittedEvents;
+    uint64_t unknown;
+    uint64_t invalid;
+    int maxPending;
+    uint64_t maxLateMs;
+};
+
+static uint32_t
+hashOf(uint32_t ioa, uint32_t mask)
+{
+    return (ioa * 2654435761u) & mask;
+}
+
+static double
+uniform(Scenario self)
+{
+    self->state ^= self->state >> 12;
+    self->state ^= self->state << 25;
+    self->state ^= self->state >> 27;
+    uint64_t x = self->state * 0x2545F4914F6CDD1DULL;
+
+    // [0, 1)
+    return (double) (x >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static void
+freePointArrays(Scenario self)
+{
+    GLOBAL_FREEMEM(self->hashIoa);
+    GLOBAL_FREEMEM(self->hashPoint);
+    GLOBAL_FREEMEM(self->order);
+    GLOBAL_FREEMEM(self->rank);
+    GLOBAL_FREEMEM(self->candidates);
+    GLOBAL_FREEMEM(self->mark);
+    GLOBAL_FREEMEM(self->changes);
+    self->hashIoa = self->hashPoint = self->order = self->rank = self->candidates = self->changes = NULL;
+    self->mark = NULL;
+    self->candidateCount = 0;
+    self->count = -1;
+}
+
+bool
+Scenario_setPoints(Scenario self, PointTable points)
+{
+    freePointArrays(self);
+
+    const int32_t *order = PointTable_getOrder(points);
+
+    if (order == NULL && points->count > 0)
+        return false;
+
+    int count = points->count;
+    size_t slots = (size_t) (count > 0 ? count : 1);
+    uint32_t hashSize = 16;
+
+    while (hashSize < 2 * (uint32_t) count)
+        hashSize <<= 1;
+
+    self->hashIoa = (int32_t *) GLOBAL_MALLOC(hashSize * sizeof(int32_t));
+    self->hashPoint = (int32_t *) GLOBAL_MALLOC(hashSize * sizeof(int32_t));
+    self->order = (int32_t *) GLOBAL_CALLOC(slots, sizeof(int32_t));
+    self->rank = (int32_t *) GLOBAL_CALLOC(slots, sizeof(int32_t));
+    self->candidates = (int32_t *) GLOBAL_CALLOC(slots, sizeof(int32_t));
+    self->mark = (uint32_t *) GLOBAL_CALLOC(slots, sizeof(uint32_t));
+    self->changes = (int32_t *) GLOBAL_CALLOC(slots, sizeof(int32_t));
+
+    if (self->hashIoa == NULL || self->hashPoint == NULL || self->order == NULL || self->rank == NULL ||
+        self->candidates == NULL || self->mark == NULL || self->changes == NULL) {
+        freePointArrays(self);
+        return false;
+    }
+
+    memset(self->hashPoint, 0xff, hashSize * sizeof(int32_t));
+    self->hashMask = hashSize - 1;
+    self->generation = 0;
+
+    // Body jdou podle (typ, IOA), takže pro IOA s více typy zůstane první typ
+    for (int k = 0; k < count; k++) {
+        int p = order[k];
+        uint32_t h = hashOf((uint32_t) points->ioa[p], self->hashMask);
+
+        self->order[k] = p;
+        self->rank[p] = k;
+
+        if (self->filter(points->type[p]))
+            self->candidates[self->candidateCount++] = k;
+
+        while (self->hashPoint[h] >= 0 && self->hashIoa[h] != points->ioa[p])
+            h = (h + 1) & self->hashMask;
+
+        if (self->hashPoint[h] < 0) {
+            self->hashIoa[h] = points->ioa[p];
+            self->hashPoint[h] = p;
+        }
+    }
+
+    self->count = count;
+    return true;
+}
+
+static int
+findPoint(Scenario self, uint32_t ioa)
+{
+    uint32_t h = hashOf(ioa, self->hashMask);
+
+    while (self->hashPoint[h] >= 0) {
+        if ((uint32_t) self->hashIoa[h] == ioa)
+            return self->hashPoint[h];
+        h = (h + 1) & self->hashMask;
+    }
+
+    return -1;
+}
+
+Scenario
+Scenario_open(const char *path, PointTable points, ScenarioTypeFilter filter)
+{
+    FILE *file = fopen(path, "r");
+
+    if (file == NULL) {
+        perror("Failed to open scenario file");
+        return NULL;
+    }
+
+    Scenario self = (Scenario) GLOBAL_CALLOC(1, sizeof(struct sScenario));
+
+    if (self == NULL) {
+        fclose(file);
+        return NULL;
+    }
+
+    self->file = file;
+    self->filter = filter;
+    self->count = -1;
+    self->chunk = (char *) GLOBAL_MALLOC(SCENARIO_CHUNK);
+    self->events = (int32_t *) GLOBAL_MALLOC(SCENARIO_MAX_EVENTS * sizeof(int32_t));
+
+    if (self->chunk == NULL || self->events == NULL || !Scenario_setPoints(self, points)) {
+        Scenario_close(self);
+        return NULL;
+    }
+
+    return self;
+}
+
+void
+Scenario_close(Scenario self)
+{
+    if (self == NULL)
+        return;
+
+    if (self->file)
+        fclose(self->file);
+
+    freePointArrays(self);
+    GLOBAL_FREEMEM(self->chunk);
+    GLOBAL_FREEMEM(self->events);
+    GLOBAL_FREEMEM(self->heap);
+    GLOBAL_FREEMEM(self);
+}
+
+// Další řádek souboru (blok se doplňuje po SCENARIO_CHUNK), false = konec souboru
+static bool
+readLine(Scenario self, char *line, size_t size)
+{
+    for (;;) {
+        char *start = self->chunk + self->chunkStart;
+        size_t available = self->chunkLength - self->chunkStart;
+        char *eol = (char *) memchr(start, '\n', available);
+
+        if (eol != NULL || (self->eof && available > 0)) {
+            size_t length = eol ? (size_t) (eol - start) : available;
+            self->chunkStart += eol ? length + 1 : length;
+
+            if (self->skipping) {
+                self->skipping = false;
+                continue;
+            }
+
+            // Příliš dlouhý řádek se vrátí prázdný jako vadný
+            if (length >= size) {
+                self->invalid++;
+                length = 0;
+            }
+
+            memcpy(line, start, length);
+            line[length] = '\0';
+            return true;
+        }
+
+        if (self->eof)
+            return false;
+
+        // Řádek delší než celý blok – zbytek až po konec řádku se zahodí
+        if (available == SCENARIO_CHUNK) {
+            self->invalid++;
+            self->skipping = true;
+            available = 0;
+        }
+
+        memmove(self->chunk, start, available);
+        self->chunkStart = 0;
+        self->chunkLength = available;
+
+        size_t n = fread(self->chunk + available, 1, SCENARIO_CHUNK - available, self->file);
+
+        if (n == 0)
+            self->eof = true;
+
+        self->chunkLength += n;
+    }
+}
+
+// "ioa" nebo "od-do"
+static bool
+parseRange(const char *text, int32_t *from, int32_t *to)
+{
+    char *end;
+    long first = strtol(text, &end, 10);
+
+    if (end == text || first < 0 || first > 0xffffff)
+        return false;
+
+    long last = first;
+
+    if (*end == '-') {
+        const char *next = end + 1;
+        last = strtol(next, &end, 10);
+
+        if (end == next || last < first || last > 0xffffff)
+            return false;
+    }
+
+    if (*end != '\0' || last - first >= SCENARIO_MAX_RANGE)
+        return false;
+
+    *from = (int32_t) first;
+    *to = (int32_t) last;
+    return true;
+}
+
+static bool
+parseInt(const char *text, int32_t *value)
+{
+    char *end;
+    long number = strtol(text, &end, 10);
+
+    if (end == text || *end != '\0' || number < 0 || number > 100000000)
+        return false;
+
+    *value = (int32_t) number;
+    return true;
+}
+
+// Jeden řádek "ČAS;AKCE[;parametry]" (bez komentářů a prázdných řádků)
+static bool
+parseLine(Scenario self, char *line, ScenarioAction *action)
+{
+    char *fields[SCENARIO_MAX_FIELDS];
+    char *field = line;
+    int count = 0;
+
+    for (; field != NULL && count < SCENARIO_MAX_FIELDS; count++) {
+        char *separator = strchr(field, ';');
+
+        if (separator)
+            *separator = '\0';
+
+        // Mezery kolem hodnot
+        while (*field == ' ' || *field == '\t')
+            field++;
+
+        size_t length = strlen(field);
+        while (length > 0 && (field[length - 1] == ' ' || field[length - 1] == '\t'))
+            field[--length] = '\0';
+
+        fields[count] = field;
+        field = separator ? separator + 1 : NULL;
+    }
+
+    if (count < 2 || field != NULL)
+        return false;
+
+    bool relative = fields[0][0] == '+';
+    int64_t time = TimerWheel_parseDuration(relative ? fields[0] + 1 : fields[0]);
+
+    if (time < 0)
+        return false;
+
+    memset(action, 0, sizeof(ScenarioAction));
+    action->atMs = relative ? self->lastAtMs + (uint64_t) time : (uint64_t) time;
+    action->ioaFrom = action->ioaTo = -1;
+    action->startMs = UINT64_MAX;
+
+    const char *name = fields[1];
+    int args = count - 2;
+    char **arg = fields + 2;
+
+    if (strcmp(name, "SET") == 0) {
+        if (args < 2 || args > 3 || !parseRange(arg[0], &action->ioaFrom, &action->ioaTo))
+            return false;
+
+        char *end;
+        action->value = strtof(arg[1], &end);
+
+        if (end == arg[1] || *end != '\0')
+            return false;
+
+        if (args == 3) {
+            unsigned long quality = strtoul(arg[2], &end, 0);
+
+            if (end == arg[2] || *end != '\0' || quality > 0xff)
+                return false;
+
+            action->hasQuality = true;
+            action->quality = (uint8_t) quality;
+        }
+
+        action->kind = SCENARIO_SET;
+    }
+    else if (strcmp(name, "BURST") == 0) {
+        if (args < 2 || args > 3 || !parseInt(arg[0], &action->count) || action->count == 0)
+            return false;
+
+        int64_t duration = TimerWheel_parseDuration(arg[1]);
+
+        if (duration < 0 || duration > UINT32_MAX)
+            return false;
+
+        action->durationMs = (uint32_t) duration;
+
+        if (args == 3 && !parseRange(arg[2], &action->ioaFrom, &action->ioaTo))
+            return false;
+
+        action->kind = SCENARIO_BURST;
+    }
+    else if (strcmp(name, "DROP") == 0) {
+        if (args > 1)
+            return false;
+
+        if (args == 1) {
+            int64_t duration = TimerWheel_parseDuration(arg[0]);
+
+            if (duration < 0 || duration > UINT32_MAX)
+                return false;
+
+            action->durationMs = (uint32_t) duration;
+        }
+
+        action->kind = SCENARIO_DROP;
+    }
+    else if (strcmp(name, "RESTORE") == 0) {
+        if (args != 0)
+            return false;
+
+        action->kind = SCENARIO_RESTORE;
+    }
+    else if (strcmp(name, "RATE") == 0) {
+        // Jako EVENTS: rychlost, nebo rychlost;rychlost laviny;délka laviny;doba klidu
+        if ((args != 1 && args != 4) || !parseInt(arg[0], &action->rate))
+            return false;
+
+        if (args == 4) {
+            int64_t burstMs = TimerWheel_parseDuration(arg[2]);
+            int64_t quietMs = TimerWheel_parseDuration(arg[3]);
+
+            if (!parseInt(arg[1], &action->burstRate) || burstMs <= 0 || quietMs <= 0 || burstMs > INT32_MAX ||
+                quietMs > INT32_MAX)
+                return false;
+
+            action->burstMs = (int32_t) burstMs;
+            action->quietMs = (int32_t) quietMs;
+        }
+
+        action->kind = SCENARIO_RATE;
+    }
+    else if (strcmp(name, "GI") == 0) {
+        int32_t coi = 0;
+
+        if (args > 1 || (args == 1 && (!parseInt(arg[0], &coi) || coi > 127)))
+            return false;
+
+        action->coi = (uint8_t) coi;
+        action->kind = SCENARIO_GI;
+    }
+    else {
+        return false;
+    }
+
+    self->lastAtMs = action->atMs;
+    action->sequence = self->sequence++;
+    return true;
+}
+
+// Další platná akce ze souboru, false = konec souboru
+static bool
+readAction(Scenario self, ScenarioAction *action)
+{
+    char line[SCENARIO_LINE_MAX];
+
+    while (readLine(self, line, sizeof(line))) {
+        char *start = line;
+
+        while (*start == ' ' || *start == '\t')
+            start++;
+
+        size_t length = strlen(start);
+        while (length > 0 && (start[length - 1] == '\r' || start[length - 1] == ' '))
+            start[--length] = '\0';
+
+        if (length == 0 || start[0] == '#')
+            continue;
+
+        if (parseLine(self, start, action))
+            return true;
+
+        self->invalid++;
+    }
+
+    return false;
+}
+
+static bool
+actionBefore(const ScenarioAction *a, const ScenarioAction *b)
+{
+    return a->atMs < b->atMs || (a->atMs == b->atMs && a->sequence < b->sequence);
+}
+
+static bool
+heapPush(Scenario self, const ScenarioAction *action)
+{
+    if (self->heapCount == self->heapCapacity) {
+        int capacity = self->heapCapacity ? self->heapCapacity * 2 : SCENARIO_INITIAL_HEAP;
+        ScenarioAction *heap = (ScenarioAction *) GLOBAL_REALLOC(self->heap,
+                                                                 (size_t) capacity * sizeof(ScenarioAction));
+
+        if (heap == NULL)
+            return false;
+
+        self->heap = heap;
+        self->heapCapacity = capacity;
+    }
+
+    int i = self->heapCount++;
+
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!actionBefore(action, &self->heap[parent]))
+            break;
+        self->heap[i] = self->heap[parent];
+        i = parent;
+    }
+
+    self->heap[i] = *action;
+
+    if (self->heapCount > self->maxPending)
+        self->maxPending = self->heapCount;
+
+    return true;
+}
+
+static void
+heapPop(Scenario self, ScenarioAction *action)
+{
+    *action = self->heap[0];
+
+    ScenarioAction *last = &self->heap[--self->heapCount];
+    int i = 0;
+
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= self->heapCount)
+            break;
+        if (child + 1 < self->heapCount && actionBefore(&self->heap[child + 1], &self->heap[child]))
+            child++;
+        if (!actionBefore(&self->heap[child], last))
+            break;
+        self->heap[i] = self->heap[child];
+        i = child;
+    }
+
+    if (self->heapCount > 0)
+        self->heap[i] = *last;
+}
+
+// Rozebere soubor: splatné akce vždy, akce do horizontu (čas scénáře) po dávkách, aby čtení
+// velkého dohledu nezdrželo splatné akce; nejvýš SCENARIO_MAX_PENDING akcí na dohled
+static void
+refill(Scenario self, uint64_t dueMs, uint64_t horizonMs)
+{
+    for (int n = 0; self->heapCount < SCENARIO_MAX_PENDING; n++) {
+        if (!self->hasNext) {
+            if (!readAction(self, &self->next))
+                break;
+            self->hasNext = true;
+        }
+
+        if (self->next.atMs > horizonMs || (self->next.atMs > dueMs && n >= SCENARIO_REFILL_BATCH))
+            break;
+
+        if (!heapPush(self, &self->next))
+            break;
+
+        self->hasNext = false;
+    }
+}
+
+void
+Scenario_start(Scenario self, uint64_t nowMs, float speed)
+{
+    self->startMs = nowMs;
+    self->speed = speed > 0 ? speed : 1;
+    self->started = true;
+    self->state = 0x9E3779B97F4A7C15ULL;
+    refill(self, 0, SCENARIO_LOOKAHEAD_MS);
+    self->finished = self->heapCount == 0 && !self->hasNext;
+}
+
+// Čas scénáře odpovídající nowMs
+static uint64_t
+scenarioTime(Scenario self, uint64_t nowMs)
+{
+    uint64_t elapsed = nowMs > self->startMs ? nowMs - self->startMs : 0;
+    return (uint64_t) ((double) elapsed * self->speed);
+}
+
+// nowMs odpovídající času scénáře (zaokrouhleno nahoru, aby akce nepřišla o ms dřív)
+static uint64_t
+wallTime(Scenario self, uint64_t atMs)
+{
+    double elapsed = (double) atMs / self->speed;
+    uint64_t whole = (uint64_t) elapsed;
+    return self->startMs + whole + ((double) whole < elapsed ? 1 : 0);
+}
+
+static void
+applySet(Scenario self, PointTable points, const ScenarioAction *action, int *numChanges)
+{
+    for (int32_t ioa = action->ioaFrom; ioa <= action->ioaTo; ioa++) {
+        int p = findPoint(self, (uint32_t) ioa);
+
+        if (p < 0) {
+            self->unknown++;
+            continue;
+        }
+
+        uint8_t quality = action->hasQuality ? action->quality : points->quality[p];
+
+        if (action->value == points->value[p] && quality == points->quality[p])
+            continue;
+
+        PointTable_setValues(points, p, action->value, action->value);
+        points->quality[p] = quality;
+
+        if (self->mark[p] != self->generation) {
+            self->mark[p] = self->generation;
+            self->changes[(*numChanges)++] = self->rank[p];
+        }
+    }
+}
+
+// Události laviny do času due; nedokončená lavina se vrátí do haldy
+static void
+runBurst(Scenario self, ScenarioAction *action, uint64_t due, int *numEvents)
+{
+    if (action->startMs == UINT64_MAX)
+        action->startMs = due;
+
+    uint64_t elapsed = due - action->startMs;
+    int64_t target = action->count;
+
+    if (action->durationMs > 0 && elapsed < action->durationMs)
+        target = (int64_t) ((double) action->count * (double) elapsed / action->durationMs);
+
+    int n = (int) (target - action->emitted);
+
+    if (n > SCENARIO_MAX_EVENTS - *numEvents)
+        n = SCENARIO_MAX_EVENTS - *numEvents;
+
+    int first = *numEvents;
+
+    // Bez rozsahu a bez kandidátů lavina jen uplyne
+    for (int i = 0; i < n && (action->ioaFrom >= 0 || self->candidateCount > 0); i++) {
+        if (action->ioaFrom < 0) {
+            self->events[(*numEvents)++] = self->candidates[(int) (uniform(self) * self->candidateCount)];
+        }
+        else {
+            int32_t ioa = action->ioaFrom + (int32_t) (uniform(self) * (action->ioaTo - action->ioaFrom + 1));
+            int p = findPoint(self, (uint32_t) ioa);
+
+            if (p < 0)
+                self->unknown++;
+            else
+                self->events[(*numEvents)++] = self->rank[p];
+        }
+    }
+
+    if (n > 0)
+        action->emitted += n;
+    self->emittedEvents += (uint64_t) (*numEvents - first);
+
+    if (action->emitted < action->count) {
+        // Zbytek kroku přes kapacitu ihned, jinak další krok
+        action->atMs = action->emitted < target ? due : due + SCENARIO_BURST_STEP_MS;
+        heapPush(self, action);
+    }
+}
+
+static int
+compareInt(const void *a, const void *b)
+{
+    int32_t x = *(const int32_t *) a;
+    int32_t y = *(const int32_t *) b;
+    return (x > y) - (x < y);
+}
+
+bool
+Scenario_advance(Scenario self, PointTable points, uint64_t nowMs, ScenarioHandler handler, void *parameter,
+                 ScenarioStep *step)
+{
+    int numChanges = 0;
+    int numEvents = 0;
+    bool more = false;
+
+    step->changes = self->changes;
+    step->changeCount = 0;
+    step->events = self->events;
+    step->eventCount = 0;
+
+    if (!self->started || self->finished || self->count != points->count)
+        return false;
+
+    if (++self->generation == 0) {
+        memset(self->mark, 0, (size_t) self->count * sizeof(uint32_t));
+        self->generation = 1;
+    }
+
+    uint64_t due = scenarioTime(self, nowMs);
+    refill(self, due, due + SCENARIO_LOOKAHEAD_MS);
+
+    for (int n = 0; self->heapCount > 0 && self->heap[0].atMs <= due; n++) {
+        const ScenarioAction *top = &self->heap[0];
+        bool control = top->kind != SCENARIO_SET && top->kind != SCENARIO_BURST;
+
+        // Akce pro handler až po odeslání dřívějších změn, lavina jen s volnou kapacitou
+        if (n == SCENARIO_MAX_PER_ADVANCE || (control && (numChanges > 0 || numEvents > 0)) ||
+            (top->kind == SCENARIO_BURST && numEvents == SCENARIO_MAX_EVENTS)) {
+            more = true;
+            break;
+        }
+
+        ScenarioAction action;
+        heapPop(self, &action);
+
+        // Zpoždění proti plánu se měří u akcí ze souboru (ne u dalších kroků laviny)
+        if (action.startMs == UINT64_MAX) {
+            uint64_t plannedMs = wallTime(self, action.atMs);
+            if (nowMs > plannedMs && nowMs - plannedMs > self->maxLateMs)
+                self->maxLateMs = nowMs - plannedMs;
+            self->actions++;
+        }
+
+        switch (action.kind) {
+            case SCENARIO_SET:
+                applySet(self, points, &action, &numChanges);
+                break;
+            case SCENARIO_BURST:
+                runBurst(self, &action, due, &numEvents);
+                break;
+            case SCENARIO_DROP:
+                handler(parameter, &action);
+                if (action.durationMs > 0) {
+                    // Naplánované obnovení
+                    action.kind = SCENARIO_RESTORE;
+                    action.atMs += action.durationMs;
+                    action.sequence = self->sequence++;
+                    action.startMs = 0;
+                    heapPush(self, &action);
+                }
+                break;
+            default:
+                handler(parameter, &action);
+                break;
+        }
+    }
+
+    // Pozice v pořadí (typ, IOA) se seřadí a převedou zpět na indexy bodů
+    qsort(self->changes, (size_t) numChanges, sizeof(int32_t), compareInt);
+    qsort(self->events, (size_t) numEvents, sizeof(int32_t), compareInt);
+
+    for (int c = 0; c < numChanges; c++)
+        self->changes[c] = self->order[self->changes[c]];
+
+    for (int e = 0; e < numEvents; e++)
+        self->events[e] = self->order[self->events[e]];
+
+    step->changeCount = numChanges;
+    step->eventCount = numEvents;
+
+    self->finished = self->heapCount == 0 && !self->hasNext && self->eof && self->chunkStart == self->chunkLength;
+
+    return more;
+}
+
+uint64_t
+Scenario_getNextMs(Scenario self)
+{
+    if (self->finished)
+        return UINT64_MAX;
+
+    if (!self->started)
+        return 0;
+
+    uint64_t nextAt = UINT64_MAX;
+
+    if (self->heapCount > 0)
+        nextAt = self->heap[0].atMs;
+
+    if (self->hasNext && self->next.atMs < nextAt)
+        nextAt = self->next.atMs;
+
+    // Dohled se vyčerpal limitem SCENARIO_MAX_PENDING – zkusit znovu hned
+    if (nextAt == UINT64_MAX)
+        return self->startMs;
+
+    return wallTime(self, nextAt);
+}
+
+bool
+Scenario_isFinished(Scenario self)
+{
+    return self->finished;
+}
+
+void
+Scenario_getProgress(Scenario self, uint64_t *actions, uint64_t *events, uint64_t *unknown, uint64_t *invalid,
+                     int *maxPending, uint64_t *maxLateMs)
+{
+    *actions = self->actions;
+    *events = self->emittedEvents;
+    *unknown = self->unknown;
+    *invalid = self->invalid;
+    *maxPending = self->maxPending;
+    *maxLateMs = self->maxLateMs;
+}
@@ -0,0 +1,111 @@
+// =======================
+// SCÉNÁŘ UDÁLOSTÍ PODLE ČASOVÉ OSY (SCENARIO)
+// =======================
+//
+// Soubor scénáře je časově seřazený seznam akcí – změny hodnot bodů, laviny
+// událostí, výpadek a obnovení spojení, změna rychlosti událostí a vyvolání
+// generálního dotazu. Opakovatelně tak popíše např. vypnutí rozvodny (stovky
+// vypínačů naráz, lavina ochran) nebo obnovu po blackoutu (všechna spojení
+// spadnou a vrátí se, master pak dotazuje celou stanici).
+//
+// Soubor se čte po blocích a rozebírá jen na dohled: akce do SCENARIO_LOOKAHEAD_MS
+// před aktuálním časem čekají v jedné haldě podle (čas, pořadí v souboru),
+// zbytek zůstává nepřečtený. Hlavní smyčka volá Scenario_advance přesně v čase
+// další akce (Scenario_getNextMs), takže i miliony akcí běží s přesností na ms
+// bez časovače na akci. Lavina a výpadek s dobou se do haldy vrací samy
+// (další krok laviny, naplánované obnovení).
+//
+// Řádek: ČAS;AKCE[;parametry], ČAS jako "1.5", "250ms" (od začátku scénáře)
+// nebo "+100ms" (od předchozího řádku). Prázdné řádky a řádky s # se přeskočí.
+//   SET;ioa[-ioa];hodnota[;kvalita]  nastaví bod(y) a pošle změny spontánně
+//   BURST;počet;doba[;ioa-ioa]       lavina: počet událostí rovnoměrně za dobu
+//                                    (náhodné body typu 30/31/34/35/36 nebo z rozsahu IOA)
+//   DROP[;doba]                      zavře všechna spojení a nepřijímá nová (do RESTORE / po době)
+//   RESTORE                          znovu přijímá spojení
+//   RATE;rychlost[;lavina;délka;klid]  změní EVENTS (událostí/s, 0 = zastaví)
+//   GI[;coi]                         konec inicializace (M_EI_NA_1), master pak pošle GI
+// IOA s více typy bodů se nastaví u prvního podle typu (jako PLAYBACK). Laviny
+// losují s pevným semínkem, takže se scénář opakuje stejně.
+
+#ifndef UNI_SCENARIO_H_
+#define UNI_SCENARIO_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "uni_points.h"
+
+#define SCENARIO_LOOKAHEAD_MS 1000   // Jak daleko dopředu (čas scénáře) se soubor rozebírá
+
+typedef enum {
+    SCENARIO_SET,
+    SCENARIO_BURST,
+    SCENARIO_DROP,
+    SCENARIO_RESTORE,
+    SCENARIO_RATE,
+    SCENARIO_GI
+} ScenarioActionKind;
+
+typedef struct {
+    uint64_t atMs;            // Čas scénáře (od začátku)
+    uint64_t sequence;        // Pořadí v souboru (stejný čas = pořadí řádků)
+    uint8_t kind;             // ScenarioActionKind
+    uint8_t hasQuality;
+    uint8_t quality;          // SET: QDS
+    uint8_t coi;              // GI: příčina inicializace
+    int32_t ioaFrom;          // SET, BURST: rozsah IOA (BURST bez rozsahu = -1)
+    int32_t ioaTo;
+    float value;              // SET
+    uint32_t durationMs;      // BURST: délka laviny, DROP: doba výpadku (0 = do RESTORE)
+    int32_t count;            // BURST: počet událostí
+    int32_t emitted;          // BURST: už vyslané události
+    uint64_t startMs;         // BURST: čas prvního kroku
+    int32_t rate;             // RATE: parametry EVENTS
+    int32_t burstRate;
+    int32_t burstMs;
+    int32_t quietMs;
+} ScenarioAction;
+
+// Výsledek jednoho volání Scenario_advance (platí do dalšího volání)
+typedef struct {
+    const int32_t *changes;   // Body změněné akcemi SET (každý jednou, seřazené podle typu a IOA)
+    int changeCount;
+    const int32_t *events;    // Body vylosované lavinami (seřazené, mohou se opakovat)
+    int eventCount;
+} ScenarioStep;
+
+// Akce, které nemění body (DROP, RESTORE, RATE, GI) – volá se v pořadí scénáře
+typedef void (*ScenarioHandler)(void *parameter, const ScenarioAction *action);
+
+// Vrací true pro typy bodů, ze kterých losují laviny bez rozsahu IOA
+typedef bool (*ScenarioTypeFilter)(int type);
+
+typedef struct sScenario* Scenario;
+
+// Otevře soubor (nic nečte) a připraví vyhledávání IOA v tabulce. NULL = chyba.
+Scenario Scenario_open(const char *path, PointTable points, ScenarioTypeFilter filter);
+
+void Scenario_close(Scenario self);
+
+// Začne scénář v čase nowMs, speed = zrychlení (1 = reálný čas)
+void Scenario_start(Scenario self, uint64_t nowMs, float speed);
+
+// Tabulka bodů byla vyměněna (hot reload) – znovu sestaví vyhledávání IOA a kandidáty lavin
+bool Scenario_setPoints(Scenario self, PointTable points);
+
+// Provede akce, jejichž čas už nastal. Před akcí pro handler se zastaví, pokud už jsou změny
+// k odeslání (pořadí zůstane zachované). Vrací true, pokud zbývají další splatné akce.
+bool Scenario_advance(Scenario self, PointTable points, uint64_t nowMs, ScenarioHandler handler, void *parameter,
+                      ScenarioStep *step);
+
+// Čas (nowMs) další akce, UINT64_MAX = scénář skončil
+uint64_t Scenario_getNextMs(Scenario self);
+
+bool Scenario_isFinished(Scenario self);
+
+// Souhrn: provedené akce, vyslané události lavin, neznámá IOA, vadné řádky, nejvíc akcí v haldě
+// a největší zpoždění akce proti plánu (ms)
+void Scenario_getProgress(Scenario self, uint64_t *actions, uint64_t *events, uint64_t *unknown, uint64_t *invalid,
+                          int *maxPending, uint64_t *maxLateMs);
+
+#endif /* UNI_SCENARIO_H_ */
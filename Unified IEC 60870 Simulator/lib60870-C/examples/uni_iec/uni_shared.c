@@ -0,0 +1,223 @@
+// =======================
+// SDÍLENÉ BODY PRO EXTERNÍ ZDROJ HODNOT – implementace
+// =======================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "uni_shared.h"
+#include "lib_memory.h"
+
+#define SHARED_ALIGN 64
+#define SHARED_READ_RETRIES 64    // Bod, který zdroj právě zapisuje, se zkusí přečíst znovu
+
+struct sSharedPoints {
+    SharedPointsHeader *header;
+    size_t size;
+    int count;
+
+    _Atomic uint32_t *seq;
+    _Atomic uint32_t *value;
+    _Atomic uint64_t *changed;
+    int numWords;
+
+    int32_t *slotToPoint;     // Pozice v oblasti -> index bodu v tabulce
+    int32_t *changes;         // Výsledek posledního SharedPoints_scan
+    uint64_t updates;
+};
+
+static uint64_t
+alignUp(uint64_t offset)
+{
+    return (offset + SHARED_ALIGN - 1) & ~(uint64_t) (SHARED_ALIGN - 1);
+}
+
+SharedPoints
+SharedPoints_create(const char *path, PointTable points)
+{
+    const int32_t *order = PointTable_getOrder(points);
+
+    if (order == NULL && points->count > 0)
+        return NULL;
+
+    int count = points->count;
+    int numWords = (count + 63) / 64;
+
+    SharedPointsHeader layout;
+    memset(&layout, 0, sizeof(layout));
+    layout.version = SHARED_POINTS_VERSION;
+    layout.count = (uint32_t) count;
+    layout.typeOffset = alignUp(sizeof(SharedPointsHeader));
+    layout.ioaOffset = alignUp(layout.typeOffset + (uint64_t) count * sizeof(uint8_t));
+    layout.valueOffset = alignUp(layout.ioaOffset + (uint64_t) count * sizeof(int32_t));
+    layout.seqOffset = alignUp(layout.valueOffset + (uint64_t) count * sizeof(uint32_t));
+    layout.changedOffset = alignUp(layout.seqOffset + (uint64_t) count * sizeof(uint32_t));
+    layout.size = alignUp(layout.changedOffset + (uint64_t) numWords * sizeof(uint64_t));
+
+    // Nový soubor místo zkrácení starého – zdroj se starým mapováním nedostane SIGBUS
+    unlink(path);
+    int fd = open(path, O_RDWR | O_CREAT | O_EXCL, 0666);
+
+    if (fd < 0) {
+        perror("Failed to create shared points file");
+        return NULL;
+    }
+
+    if (ftruncate(fd, (off_t) layout.size) != 0) {
+        perror("Failed to size shared points file");
+        close(fd);
+        return NULL;
+    }
+
+    void *data = mmap(NULL, (size_t) layout.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        perror("Failed to map shared points file");
+        return NULL;
+    }
+
+    SharedPoints self = (SharedPoints) GLOBAL_CALLOC(1, sizeof(struct sSharedPoints));
+
+    if (self == NULL) {
+        munmap(data, (size_t) layout.size);
+        return NULL;
+    }
+
+    self->header = (SharedPointsHeader *) data;
+    self->size = (size_t) layout.size;
+    self->count = count;
+    self->numWords = numWords;
+    self->slotToPoint = (int32_t *) GLOBAL_CALLOC((size_t) (count > 0 ? count : 1), sizeof(int32_t));
+    self->changes = (int32_t *) GLOBAL_CALLOC((size_t) (count > 0 ? count : 1), sizeof(int32_t));
+
+    if (self->slotToPoint == NULL || self->changes == NULL) {
+        SharedPoints_destroy(self);
+        return NULL;
+    }
+
+    char *base = (char *) data;
+    uint8_t *types = (uint8_t *) (base + layout.typeOffset);
+    int32_t *ioas = (int32_t *) (base + layout.ioaOffset);
+    self->value = (_Atomic uint32_t *) (base + layout.valueOffset);
+    self->seq = (_Atomic uint32_t *) (base + layout.seqOffset);
+    self->changed = (_Atomic uint64_t *) (base + layout.changedOffset);
+
+    // Soubor je po ftruncate vynulovaný: čítače i bitmapa začínají na 0
+    for (int k = 0; k < count; k++) {
+        int p = order[k];
+        uint32_t word;
+
+        memcpy(&word, &points->value[p], sizeof(word));
+        types[k] = points->type[p];
+        ioas[k] = points->ioa[p];
+        atomic_store_explicit(&self->value[k], word, memory_order_relaxed);
+        self->slotToPoint[k] = p;
+    }
+
+    memcpy(self->header, &layout, sizeof(layout));
+    atomic_store_explicit((_Atomic uint32_t *) &self->header->magic, SHARED_POINTS_MAGIC, memory_order_release);
+
+    return self;
+}
+
+void
+SharedPoints_destroy(SharedPoints self)
+{
+    if (self == NULL)
+        return;
+
+    atomic_store_explicit((_Atomic uint32_t *) &self->header->magic, 0, memory_order_release);
+    munmap(self->header, self->size);
+
+    GLOBAL_FREEMEM(self->slotToPoint);
+    GLOBAL_FREEMEM(self->changes);
+    GLOBAL_FREEMEM(self);
+}
+
+// Konzistentní hodnota z pozice slot: čítač sudý a stejný před čtením i po něm
+static bool
+readSlot(SharedPoints self, int slot, float *value)
+{
+    for (int attempt = 0; attempt < SHARED_READ_RETRIES; attempt++) {
+        uint32_t before = atomic_load_explicit(&self->seq[slot], memory_order_acquire);
+
+        if (before & 1)
+            continue;
+
+        uint32_t word = atomic_load_explicit(&self->value[slot], memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+
+        if (atomic_load_explicit(&self->seq[slot], memory_order_relaxed) == before) {
+            memcpy(value, &word, sizeof(word));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int
+SharedPoints_scan(SharedPoints self, PointTable points, const int32_t **changes)
+{
+    int numChanges = 0;
+
+    *changes = self->changes;
+
+    if (points->count != self->count)
+        return 0;
+
+    for (int w = 0; w < self->numWords; w++) {
+        // Většina slov je nulová – výměna (zápis do sdílené cache line) jen u slov se změnou
+        if (atomic_load_explicit(&self->changed[w], memory_order_relaxed) == 0)
+            continue;
+
+        uint64_t bits = atomic_exchange_explicit(&self->changed[w], 0, memory_order_acquire);
+        uint64_t retry = 0;
+
+        while (bits) {
+            int bit = __builtin_ctzll(bits);
+            int slot = w * 64 + bit;
+            bits &= bits - 1;
+
+            float value;
+
+            if (!readSlot(self, slot, &value)) {
+                retry |= (uint64_t) 1 << bit;
+                continue;
+            }
+
+            self->updates++;
+
+            int p = self->slotToPoint[slot];
+
+            if (value != points->value[p]) {
+                PointTable_setValues(points, p, value, value);
+                self->changes[numChanges++] = p;
+            }
+        }
+
+        // Body uprostřed zápisu zůstanou označené do dalšího ticku
+        if (retry)
+            atomic_fetch_or_explicit(&self->changed[w], retry, memory_order_relaxed);
+    }
+
+    return numChanges;
+}
+
+int
+SharedPoints_getCount(SharedPoints self)
+{
+    return self->count;
+}
+
+uint64_t
+SharedPoints_getUpdates(SharedPoints self)
+{
+    return self->updates;
+}
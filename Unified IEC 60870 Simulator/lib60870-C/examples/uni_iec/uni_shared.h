@@ -0,0 +1,110 @@
+// =======================
+// SDÍLENÉ BODY PRO EXTERNÍ ZDROJ HODNOT (SHAREDPOINTS)
+// =======================
+//
+// Server vystaví tabulku bodů jako soubor namapovaný do paměti (např. v
+// /dev/shm), do kterého zapisuje jiný proces – třeba model sítě. Oblast má
+// hlavičku a pole po sloupcích (SoA) seřazená podle (typ, IOA): typ, IOA,
+// hodnota, sekvenční čítač (seqlock) a bitmapa změn po 64 bodech. Zápis
+// hodnoty ani převzetí změny nepotřebuje žádné systémové volání ani zámek:
+// zdroj zapíše hodnotu mezi dvě zvýšení čítače a nastaví bit v bitmapě,
+// simulátor v každém ticku projde bitmapu, vymění nenulová slova za nulu a
+// konzistentní hodnoty (sudý a nezměněný čítač) přepíše do tabulky bodů.
+// Každý bod smí zapisovat jen jedno vlákno zdroje.
+//
+// Zdroj v C definuje UNI_SHARED_FEEDER_ONLY (stačí mu tento hlavičkový soubor),
+// soubor si otevře, namapuje (MAP_SHARED), zkontroluje magic a verzi a zapisuje
+// přes SharedPoints_write. Po ukončení simulátoru je magic 0 a při novém startu
+// vznikne nový soubor – zdroj se musí namapovat znovu.
+
+#ifndef UNI_SHARED_H_
+#define UNI_SHARED_H_
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define SHARED_POINTS_MAGIC 0x504e4955u   // "UINP"
+#define SHARED_POINTS_VERSION 1
+
+// Hlavička na začátku oblasti, offsety jsou od jejího začátku a zarovnané na 64 B
+typedef struct {
+    uint32_t magic;           // SHARED_POINTS_MAGIC (zapisuje se poslední), 0 = simulátor skončil
+    uint32_t version;
+    uint32_t count;           // Počet bodů
+    uint32_t reserved;
+    uint64_t size;            // Velikost celé oblasti v bajtech
+    uint64_t typeOffset;      // uint8_t type[count]
+    uint64_t ioaOffset;       // int32_t ioa[count]
+    uint64_t valueOffset;     // float value[count] (zapisuje se jako 32bitové slovo)
+    uint64_t seqOffset;       // uint32_t seq[count], liché = zápis probíhá
+    uint64_t changedOffset;   // uint64_t changed[(count + 63) / 64], bit = bod se změnil
+} SharedPointsHeader;
+
+// Zápis hodnoty bodu na pozici index (pro externí zdroj)
+static inline void
+SharedPoints_write(SharedPointsHeader *header, int index, float value)
+{
+    char *base = (char *) header;
+    _Atomic uint32_t *seq = (_Atomic uint32_t *) (base + header->seqOffset) + index;
+    _Atomic uint32_t *bits = (_Atomic uint32_t *) (base + header->valueOffset) + index;
+    _Atomic uint64_t *changed = (_Atomic uint64_t *) (base + header->changedOffset) + (index >> 6);
+
+    uint32_t word;
+    memcpy(&word, &value, sizeof(word));
+
+    uint32_t s = atomic_load_explicit(seq, memory_order_relaxed);
+    atomic_store_explicit(seq, s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(bits, word, memory_order_relaxed);
+    atomic_store_explicit(seq, s + 2, memory_order_release);
+    atomic_fetch_or_explicit(changed, (uint64_t) 1 << (index & 63), memory_order_release);
+}
+
+// Pozice bodu (type, ioa) v oblasti, -1 = není (pole jsou seřazená, hledá se půlením)
+static inline int
+SharedPoints_find(const SharedPointsHeader *header, int type, int ioa)
+{
+    const char *base = (const char *) header;
+    const uint8_t *types = (const uint8_t *) (base + header->typeOffset);
+    const int32_t *ioas = (const int32_t *) (base + header->ioaOffset);
+    int low = 0;
+    int high = (int) header->count;
+
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+
+        if (types[mid] < type || (types[mid] == type && ioas[mid] < ioa))
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return (low < (int) header->count && types[low] == type && ioas[low] == ioa) ? low : -1;
+}
+
+#ifndef UNI_SHARED_FEEDER_ONLY
+
+#include "uni_points.h"
+
+typedef struct sSharedPoints* SharedPoints;
+
+// Založí soubor path (starý se smaže) s body tabulky a jejich aktuálními hodnotami. NULL = chyba.
+SharedPoints SharedPoints_create(const char *path, PointTable points);
+
+// Nastaví magic na 0 a odmapuje oblast (soubor zůstane)
+void SharedPoints_destroy(SharedPoints self);
+
+// Převezme změněné hodnoty do tabulky (jen hodnoty, které se opravdu liší). Vrací počet změněných
+// bodů, jejich indexy v tabulce (seřazené podle typu a IOA) jsou v *changes do dalšího volání.
+int SharedPoints_scan(SharedPoints self, PointTable points, const int32_t **changes);
+
+int SharedPoints_getCount(SharedPoints self);
+
+// Počet převzatých hodnot od vytvoření (více zápisů bodu mezi dvěma převzetími = jedna hodnota)
+uint64_t SharedPoints_getUpdates(SharedPoints self);
+
+#endif /* UNI_SHARED_FEEDER_ONLY */
+
+#endif /* UNI_SHARED_H_ */
@@ -0,0 +1,426 @@
+// =======================
+// STAVOVÁ TABULKA BODŮ KLIENTA – implementace
+// =======================
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "uni_state.h"
+#include "hal_thread.h"
+#include "hal_time.h"
+#include "lib_memory.h"
+
+#define STATE_PAGE_BITS 12
+#define STATE_PAGE_SIZE (1 << STATE_PAGE_BITS)             // IOA na stránku
+#define STATE_MAX_IOA (1 << 24)                            // IOA má nejvýš 3 bajty
+#define STATE_PAGES (STATE_MAX_IOA / STATE_PAGE_SIZE)
+
+#define STATE_MAGIC "UNISTATE"
+#define STATE_VERSION 1
+
+// Jeden bod (type 0 = IOA zatím nepřišlo)
+typedef struct {
+    double value;
+    uint64_t timestampMs;     // Časová značka ze zprávy (0 = zpráva bez času)
+    uint64_t updatedMs;       // Čas příjmu
+    uint8_t type;
+    uint8_t quality;          // QDS / SIQ / DIQ bity kvality, u BCR příznaky CY/CA/IV
+    uint16_t reserved;
+    uint32_t updates;         // Počet přijatých hodnot
+} StateEntry;
+
+// Záznam binárního exportu (little endian, 32 bajtů)
+typedef struct {
+    uint32_t ioa;
+    uint8_t type;
+    uint8_t quality;
+    uint16_t reserved;
+    double value;
+    uint64_t timestampMs;
+    uint64_t updatedMs;
+} StateRecord;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t count;
+} StateHeader;
+
+// Způsob kódování hodnoty prvku
+typedef enum {
+    ELEMENT_NONE,
+    ELEMENT_SIQ,              // 1 bajt: hodnota bit 0, kvalita horní 4 bity
+    ELEMENT_DIQ,              // 1 bajt: hodnota bity 0–1
+    ELEMENT_VTI,              // VTI + QDS
+    ELEMENT_BSI,              // 4 bajty + QDS
+    ELEMENT_NVA,              // 2 bajty normalizované + QDS
+    ELEMENT_NVA_NO_QDS,       // 2 bajty normalizované bez kvality (typ 21)
+    ELEMENT_SVA,              // 2 bajty škálované + QDS
+    ELEMENT_FLOAT,            // 4 bajty IEEE 754 + QDS
+    ELEMENT_BCR               // 4 bajty čítač + příznaky
+} ElementKind;
+
+typedef struct {
+    uint8_t kind;
+    uint8_t size;             // Velikost hodnoty včetně kvality
+    uint8_t timeSize;         // 0, 3 (CP24) nebo 7 (CP56)
+} ElementFormat;
+
+struct sStateTable {
+    int sizeOfIOA;
+    StateEntry *pages[STATE_PAGES];
+    int count;
+    Semaphore lock;
+    StateEntry *exportPage;   // Kopie stránky pro export mimo zámek
+};
+
+static ElementFormat
+formatOf(int type)
+{
+    ElementFormat format = {ELEMENT_NONE, 0, 0};
+
+    switch (type) {
+        case M_SP_NA_1: format.kind = ELEMENT_SIQ; format.size = 1; break;
+        case M_SP_TA_1: format.kind = ELEMENT_SIQ; format.size = 1; format.timeSize = 3; break;
+        case M_DP_NA_1: format.kind = ELEMENT_DIQ; format.size = 1; break;
+        case M_DP_TA_1: format.kind = ELEMENT_DIQ; format.size = 1; format.timeSize = 3; break;
+        case M_ST_NA_1: format.kind = ELEMENT_VTI; format.size = 2; break;
+        case M_ST_TA_1: format.kind = ELEMENT_VTI; format.size = 2; format.timeSize = 3; break;
+        case M_BO_NA_1: format.kind = ELEMENT_BSI; format.size = 5; break;
+        case M_BO_TA_1: format.kind = ELEMENT_BSI; format.size = 5; format.timeSize = 3; break;
+        case M_ME_NA_1: format.kind = ELEMENT_NVA; format.size = 3; break;
+        case M_ME_TA_1: format.kind = ELEMENT_NVA; format.size = 3; format.timeSize = 3; break;
+        case M_ME_NB_1: format.kind = ELEMENT_SVA; format.size = 3; break;
+        case M_ME_TB_1: format.kind = ELEMENT_SVA; format.size = 3; format.timeSize = 3; break;
+        case M_ME_NC_1: format.kind = ELEMENT_FLOAT; format.size = 5; break;
+        case M_ME_TC_1: format.kind = ELEMENT_FLOAT; format.size = 5; format.timeSize = 3; break;
+        case M_IT_NA_1: format.kind = ELEMENT_BCR; format.size = 5; break;
+        case M_IT_TA_1: format.kind = ELEMENT_BCR; format.size = 5; format.timeSize = 3; break;
+        case M_ME_ND_1: format.kind = ELEMENT_NVA_NO_QDS; format.size = 2; break;
+        case M_SP_TB_1: format.kind = ELEMENT_SIQ; format.size = 1; format.timeSize = 7; break;
+        case M_DP_TB_1: format.kind = ELEMENT_DIQ; format.size = 1; format.timeSize = 7; break;
+        case M_ST_TB_1: format.kind = ELEMENT_VTI; format.size = 2; format.timeSize = 7; break;
+        case M_BO_TB_1: format.kind = ELEMENT_BSI; format.size = 5; format.timeSize = 7; break;
+        case M_ME_TD_1: format.kind = ELEMENT_NVA; format.size = 3; format.timeSize = 7; break;
+        case M_ME_TE_1: format.kind = ELEMENT_SVA; format.size = 3; format.timeSize = 7; break;
+        case M_ME_TF_1: format.kind = ELEMENT_FLOAT; format.size = 5; format.timeSize = 7; break;
+        case M_IT_TB_1: format.kind = ELEMENT_BCR; format.size = 5; format.timeSize = 7; break;
+        default: break;
+    }
+
+    return format;
+}
+
+static inline uint32_t
+readUInt32(const uint8_t *p)
+{
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static inline int16_t
+readInt16(const uint8_t *p)
+{
+    return (int16_t) ((uint16_t) p[0] | ((uint16_t) p[1] << 8));
+}
+
+// Hodnota a kvalita prvku
+static inline void
+decodeValue(const uint8_t *p, int kind, double *value, uint8_t *quality)
+{
+    switch (kind) {
+        case ELEMENT_SIQ:
+            *value = p[0] & 0x01;
+            *quality = p[0] & 0xf0;
+            break;
+        case ELEMENT_DIQ:
+            *value = p[0] & 0x03;
+            *quality = p[0] & 0xf0;
+            break;
+        case ELEMENT_VTI:
+            *value = (int8_t) (p[0] << 1) >> 1;    // 7bitová hodnota se znaménkem
+            *quality = p[1];
+            break;
+        case ELEMENT_BSI:
+            *value = readUInt32(p);
+            *quality = p[4];
+            break;
+        case ELEMENT_NVA:
+            *value = readInt16(p) / 32768.0;
+            *quality = p[2];
+            break;
+        case ELEMENT_NVA_NO_QDS:
+            *value = readInt16(p) / 32768.0;
+            *quality = 0;
+            break;
+        case ELEMENT_SVA:
+            *value = readInt16(p);
+            *quality = p[2];
+            break;
+        case ELEMENT_FLOAT: {
+            uint32_t bits = readUInt32(p);
+            float f;
+            memcpy(&f, &bits, sizeof(f));
+            *value = f;
+            *quality = p[4];
+            break;
+        }
+        case ELEMENT_BCR:
+            *value = (int32_t) readUInt32(p);
+            *quality = p[4] & 0xe0;
+            break;
+    }
+}
+
+// CP24 nese jen minuty a ms – hodina se doplní z času příjmu
+static uint64_t
+decodeCP24(const uint8_t *p, uint64_t receivedMs)
+{
+    uint64_t withinHour = ((uint64_t) (p[2] & 0x3f) * 60000) + ((uint64_t) p[0] | ((uint64_t) p[1] << 8));
+    uint64_t timestamp = receivedMs - (receivedMs % 3600000) + withinHour;
+
+    // Značka z konce minulé hodiny
+    if (timestamp > receivedMs + 60000 && timestamp >= 3600000)
+        timestamp -= 3600000;
+
+    return timestamp;
+}
+
+static uint64_t
+decodeCP56(const uint8_t *p)
+{
+    struct sCP56Time2a time;
+    memcpy(time.encodedValue, p, sizeof(time.encodedValue));
+    return CP56Time2a_toMsTimestamp(&time);
+}
+
+static int
+readIOA(const uint8_t *p, int sizeOfIOA)
+{
+    int ioa = p[0];
+
+    if (sizeOfIOA > 1)
+        ioa |= p[1] << 8;
+    if (sizeOfIOA > 2)
+        ioa |= p[2] << 16;
+
+    return ioa;
+}
+
+// Záznam pro IOA, stránka se alokuje při prvním použití (volá se pod zámkem)
+static StateEntry *
+getEntry(StateTable self, int ioa)
+{
+    StateEntry *page = self->pages[ioa >> STATE_PAGE_BITS];
+
+    if (page == NULL) {
+        page = (StateEntry *) GLOBAL_CALLOC(STATE_PAGE_SIZE, sizeof(StateEntry));
+        if (page == NULL)
+            return NULL;
+        self->pages[ioa >> STATE_PAGE_BITS] = page;
+    }
+
+    return &page[ioa & (STATE_PAGE_SIZE - 1)];
+}
+
+StateTable
+StateTable_create(int sizeOfIOA)
+{
+    StateTable self = (StateTable) GLOBAL_CALLOC(1, sizeof(struct sStateTable));
+
+    if (self == NULL)
+        return NULL;
+
+    self->sizeOfIOA = sizeOfIOA;
+    self->lock = Semaphore_create(1);
+    self->exportPage = (StateEntry *) GLOBAL_MALLOC(STATE_PAGE_SIZE * sizeof(StateEntry));
+
+    if (self->exportPage == NULL) {
+        StateTable_destroy(self);
+        return NULL;
+    }
+
+    return self;
+}
+
+void
+StateTable_destroy(StateTable self)
+{
+    if (self == NULL)
+        return;
+
+    for (int i = 0; i < STATE_PAGES; i++)
+        GLOBAL_FREEMEM(self->pages[i]);
+
+    if (self->lock)
+        Semaphore_destroy(self->lock);
+
+    GLOBAL_FREEMEM(self->exportPage);
+    GLOBAL_FREEMEM(self);
+}
+
+int
+StateTable_update(StateTable self, CS101_ASDU asdu)
+{
+    int type = CS101_ASDU_getTypeID(asdu);
+    ElementFormat format = formatOf(type);
+
+    if (format.kind == ELEMENT_NONE)
+        return -1;
+
+    const uint8_t *payload = CS101_ASDU_getPayload(asdu);
+    int payloadSize = CS101_ASDU_getPayloadSize(asdu);
+    int numberOfElements = CS101_ASDU_getNumberOfElements(asdu);
+    bool sequence = CS101_ASDU_isSequence(asdu);
+    int elementSize = format.size + format.timeSize;
+    int stride = sequence ? elementSize : self->sizeOfIOA + elementSize;
+    int offset = sequence ? self->sizeOfIOA : 0;
+
+    // Zkrácené ASDU se zahodí celé
+    if (numberOfElements == 0 || offset + numberOfElements * stride > payloadSize)
+        return 0;
+
+    uint64_t receivedMs = Hal_getTimeInMs();
+    int firstIoa = sequence ? readIOA(payload, self->sizeOfIOA) : 0;
+    int written = 0;
+
+    Semaphore_wait(self->lock);
+
+    for (int i = 0; i < numberOfElements; i++, offset += stride) {
+        const uint8_t *element = payload + offset;
+        int ioa;
+
+        if (sequence) {
+            ioa = firstIoa + i;
+        }
+        else {
+            ioa = readIOA(element, self->sizeOfIOA);
+            element += self->sizeOfIOA;
+        }
+
+        if (ioa >= STATE_MAX_IOA)
+            continue;
+
+        StateEntry *entry = getEntry(self, ioa);
+        if (entry == NULL)
+            break;
+
+        if (entry->type == 0)
+            self->count++;
+
+        decodeValue(element, format.kind, &entry->value, &entry->quality);
+
+        if (format.timeSize == 7)
+            entry->timestampMs = decodeCP56(element + format.size);
+        else if (format.timeSize == 3)
+            entry->timestampMs = decodeCP24(element + format.size, receivedMs);
+        else
+            entry->timestampMs = 0;
+
+        entry->type = (uint8_t) type;
+        entry->updatedMs = receivedMs;
+        entry->updates++;
+        written++;
+    }
+
+    Semaphore_post(self->lock);
+
+    return written;
+}
+
+int
+StateTable_getCount(StateTable self)
+{
+    Semaphore_wait(self->lock);
+    int count = self->count;
+    Semaphore_post(self->lock);
+
+    return count;
+}
+
+static bool
+isBinaryPath(const char *path)
+{
+    size_t length = strlen(path);
+    return length > 4 && strcmp(path + length - 4, ".bin") == 0;
+}
+
+bool
+StateTable_export(StateTable self, const char *path)
+{
+    char tempPath[512];
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", path);
+
+    FILE *file = fopen(tempPath, "wb");
+
+    if (file == NULL)
+        return false;
+
+    bool binary = isBinaryPath(path);
+    bool written = true;
+
+    if (binary) {
+        StateHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, STATE_MAGIC, 8);
+        header.version = STATE_VERSION;
+        header.recordSize = sizeof(StateRecord);
+        header.count = (uint64_t) StateTable_getCount(self);
+        written = fwrite(&header, sizeof(header), 1, file) == 1;
+    }
+    else {
+        written = fputs("IOA;TYPE;VALUE;QUALITY;TIMESTAMP_MS;UPDATED_MS;UPDATES\n", file) >= 0;
+    }
+
+    uint64_t exported = 0;
+
+    for (int p = 0; p < STATE_PAGES && written; p++) {
+        // Ukazatel na stránku se mění jen z NULL na platnou stránku
+        if (self->pages[p] == NULL)
+            continue;
+
+        Semaphore_wait(self->lock);
+        memcpy(self->exportPage, self->pages[p], STATE_PAGE_SIZE * sizeof(StateEntry));
+        Semaphore_post(self->lock);
+
+        for (int i = 0; i < STATE_PAGE_SIZE && written; i++) {
+            StateEntry *entry = &self->exportPage[i];
+
+            if (entry->type == 0)
+                continue;
+
+            uint32_t ioa = (uint32_t) ((p << STATE_PAGE_BITS) | i);
+
+            if (binary) {
+                StateRecord record = {ioa, entry->type, entry->quality, 0, entry->value, entry->timestampMs,
+                                      entry->updatedMs};
+                written = fwrite(&record, sizeof(record), 1, file) == 1;
+            }
+            else {
+                written = fprintf(file, "%u;%u;%.9g;0x%02x;%llu;%llu;%u\n", ioa, entry->type, entry->value,
+                                  entry->quality, (unsigned long long) entry->timestampMs,
+                                  (unsigned long long) entry->updatedMs, entry->updates) > 0;
+            }
+
+            exported++;
+        }
+    }
+
+    // Počet v hlavičce podle skutečně zapsaných záznamů (tabulka mezitím mohla růst)
+    if (binary && written) {
+        written = fseek(file, (long) offsetof(StateHeader, count), SEEK_SET) == 0 &&
+                  fwrite(&exported, sizeof(exported), 1, file) == 1;
+    }
+
+    if (fclose(file) != 0)
+        written = false;
+
+    if (!written || rename(tempPath, path) != 0) {
+        remove(tempPath);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,39 @@
+// =======================
+// STAVOVÁ TABULKA BODŮ KLIENTA (STATETABLE)
+// =======================
+//
+// Přijaté ASDU se dekódují přímo z payloadu (bez CS101_ASDU_getElement, tedy
+// bez alokace na IO) do tabulky indexované IOA: hodnota, kvalita, časová
+// značka ze zprávy a čas příjmu. Tabulka je stránkovaná po 4096 IOA – stránka
+// se alokuje jen při prvním IO z jejího rozsahu, v ustáleném stavu příjem nic
+// nealokuje. Snímek tabulky lze periodicky uložit do CSV nebo binárního souboru.
+//
+// Zápis probíhá ve vlákně spojení, export v hlavní smyčce; tabulku chrání zámek
+// držený po dobu jednoho ASDU, export kopíruje po stránkách.
+
+#ifndef UNI_STATE_H_
+#define UNI_STATE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "iec60870_common.h"
+
+typedef struct sStateTable* StateTable;
+
+// sizeOfIOA = velikost IOA v ASDU (z CS101_AppLayerParameters spojení)
+StateTable StateTable_create(int sizeOfIOA);
+
+void StateTable_destroy(StateTable self);
+
+// Dekóduje monitorovací ASDU (typy 1–16, 21, 30–37) do tabulky.
+// Vrací počet zapsaných IO, -1 = typ se do tabulky neukládá
+int StateTable_update(StateTable self, CS101_ASDU asdu);
+
+// Počet různých IOA v tabulce
+int StateTable_getCount(StateTable self);
+
+// Uloží snímek (přípona .bin = binární záznamy, jinak CSV) přes dočasný soubor a rename
+bool StateTable_export(StateTable self, const char *path);
+
+#endif /* UNI_STATE_H_ */
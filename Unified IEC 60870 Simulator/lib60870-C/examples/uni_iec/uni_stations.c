@@ -0,0 +1,603 @@
+// =======================
+// VÍCE VIRTUÁLNÍCH STANIC SERVERU 104 – implementace
+// =======================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include "uni_stations.h"
+#include "uni_config.h"
+#include "uni_generator.h"
+#include "uni_periodic.h"
+#include "uni_timer.h"
+#include "hal_thread.h"
+#include "hal_time.h"
+#include "lib_memory.h"
+
+#define STATION_IDLE_SLEEP_MS 5       // Worker bez spojení spí nejvýš tak dlouho (zpoždění accept)
+#define STATION_MAX_WORKERS 256
+#define STATION_DEFAULT_TICK_MS 100   // Výchozí GENTICK
+
+struct sStationPool;
+struct sStationListener;
+
+// Kontext jedné stanice – vše, co jinak drží globální proměnné uni_iec.c
+typedef struct {
+    struct sStationPool *pool;
+    struct sStationListener *listener;
+    int number;                   // Od 1
+    int ca;
+
+    // Body a cache GI: generátor je mění na workeru stanice, dotaz čte na workeru serveru
+    // (v režimu CA to bývají různá vlákna)
+    Semaphore lock;
+    PointTable points;
+    GeneratorSet generators;
+    GiCache giCache;
+    PeriodicSet periodic;
+    Timer generatorTimer;
+    uint64_t lastGeneratorMs;
+
+    // Zapisuje jen worker stanice, čte výpis
+    atomic_uint_fast64_t asdus;
+    atomic_uint_fast64_t interrogations;
+    atomic_uint_fast64_t commands;
+} Station;
+
+// Jeden CS104_Slave (port) se stanicemi [first, first + count)
+typedef struct sStationListener {
+    struct sStationPool *pool;
+    CS104_Slave slave;
+    int port;
+    Station *first;
+    int count;
+    int broadcastCa;
+    bool listening;
+} StationListener;
+
+typedef struct {
+    struct sStationPool *pool;
+    int index;
+    Thread thread;
+    TimerWheel wheel;
+    atomic_uint maxLoopUs;        // Nejdelší průchod smyčkou od minulého výpisu
+} StationWorker;
+
+struct sStationPool {
+    StationOptions options;
+    const char *label;
+
+    Station *stations;
+    int numStations;
+
+    StationListener *listeners;
+    int numListeners;
+
+    StationWorker *workers;
+    int numWorkers;
+
+    PointTable defaultPoints;     // Body ze společného souboru, stanice bez vlastního souboru dostanou kopii
+
+    atomic_bool running;
+
+    uint64_t lastReportUs;
+    uint64_t lastAsdus;
+    uint64_t lastInterrogations;
+    uint64_t lastCommands;
+};
+
+// Každý server potřebuje deskriptor pro naslouchání a další pro spojení
+static void
+raiseFileLimit(int needed)
+{
+    struct rlimit limit;
+
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur >= (rlim_t) needed)
+        return;
+
+    limit.rlim_cur = (limit.rlim_max < (rlim_t) needed) ? limit.rlim_max : (rlim_t) needed;
+    setrlimit(RLIMIT_NOFILE, &limit);
+}
+
+// Stanice serveru s daným CA, NULL = neznámé CA
+static Station *
+findStation(StationListener *listener, int ca)
+{
+    int i = ca - listener->first->ca;
+
+    return (i >= 0 && i < listener->count) ? &listener->first[i] : NULL;
+}
+
+// Odmítne ASDU zrcadlením s negativním COT (např. neznámé CA)
+static void
+rejectAsdu(IMasterConnection connection, CS101_ASDU asdu, CS101_CauseOfTransmission cot)
+{
+    CS101_ASDU_setCOT(asdu, cot);
+    CS101_ASDU_setNegative(asdu, true);
+    IMasterConnection_sendASDU(connection, asdu);
+}
+
+static void
+sendPackedAsdu(void *parameter, CS101_ASDU asdu)
+{
+    IMasterConnection_sendASDU((IMasterConnection) parameter, asdu);
+}
+
+// Dotaz stanice/skupiny: odpoví stanice s daným CA, na globální CA všechny stanice serveru
+static bool
+interrogationHandler(void *parameter, IMasterConnection connection, CS101_ASDU asdu, uint8_t qoi)
+{
+    StationListener *listener = (StationListener *) parameter;
+    int ca = CS101_ASDU_getCA(asdu);
+    bool broadcast = (ca == listener->broadcastCa);
+    Station *station = broadcast ? listener->first : findStation(listener, ca);
+
+    if (station == NULL) {
+        rejectAsdu(connection, asdu, CS101_COT_UNKNOWN_CA);
+        return true;
+    }
+
+    if (qoi < IEC60870_QOI_STATION || qoi > IEC60870_QOI_STATION + GI_CACHE_GROUPS) {
+        IMasterConnection_sendACT_CON(connection, asdu, true);
+        return true;
+    }
+
+    Station *end = broadcast ? listener->first + listener->count : station + 1;
+
+    for (; station < end; station++) {
+        CS101_ASDU_setCA(asdu, station->ca);
+        IMasterConnection_sendACT_CON(connection, asdu, false);
+
+        Semaphore_wait(station->lock);
+        int sent = GiCache_send(station->giCache, station->points, qoi - IEC60870_QOI_STATION, sendPackedAsdu,
+                                connection);
+        Semaphore_post(station->lock);
+
+        IMasterConnection_sendACT_TERM(connection, asdu);
+
+        atomic_fetch_add_explicit(&station->interrogations, 1, memory_order_relaxed);
+        if (sent > 0)
+            atomic_fetch_add_explicit(&station->asdus, (uint64_t) sent, memory_order_relaxed);
+    }
+
+    return true;
+}
+
+// Synchronizace času: false = knihovna pošle negativní ACT_CON
+static bool
+clockSyncHandler(void *parameter, IMasterConnection connection, CS101_ASDU asdu, CP56Time2a newTime)
+{
+    (void) connection;
+    (void) newTime;
+
+    StationListener *listener = (StationListener *) parameter;
+    int ca = CS101_ASDU_getCA(asdu);
+
+    return ca == listener->broadcastCa || findStation(listener, ca) != NULL;
+}
+
+// Commandy 45–51 a 58–64 stanice vykoná hned a potvrdí (ACT_CON). Deaktivace proto nemá co
+// zrušit a dostane negativní DEACT_CON (jako u serveru s COMMANDDELAY), jiné COT se odmítnou
+// s COT 45. Ostatní typy odmítne knihovna.
+static bool
+asduHandler(void *parameter, IMasterConnection connection, CS101_ASDU asdu)
+{
+    StationListener *listener = (StationListener *) parameter;
+    int type = CS101_ASDU_getTypeID(asdu);
+
+    if (!((type >= C_SC_NA_1 && type <= C_BO_NA_1) || (type >= C_SC_TA_1 && type <= C_BO_TA_1)))
+        return false;
+
+    Station *station = findStation(listener, CS101_ASDU_getCA(asdu));
+
+    if (station == NULL) {
+        rejectAsdu(connection, asdu, CS101_COT_UNKNOWN_CA);
+        return true;
+    }
+
+    int cot = CS101_ASDU_getCOT(asdu);
+
+    if (cot == CS101_COT_ACTIVATION) {
+        IMasterConnection_sendACT_CON(connection, asdu, false);
+        atomic_fetch_add_explicit(&station->commands, 1, memory_order_relaxed);
+    }
+    else if (cot == CS101_COT_DEACTIVATION) {
+        CS101_ASDU_setCOT(asdu, CS101_COT_DEACTIVATION_CON);
+        CS101_ASDU_setNegative(asdu, true);
+        IMasterConnection_sendASDU(connection, asdu);
+    }
+    else {
+        rejectAsdu(connection, asdu, CS101_COT_UNKNOWN_COT);
+    }
+
+    return true;
+}
+
+static void
+sendPeriodicAsdu(void *parameter, uint32_t periodMs, int index, CS101_ASDU asdu)
+{
+    (void) periodMs;
+    (void) index;
+
+    Station *station = (Station *) parameter;
+
+    for (int m = 0; m < station->pool->options.multiplier; m++)
+        CS104_Slave_enqueueASDU(station->listener->slave, asdu);
+
+    atomic_fetch_add_explicit(&station->asdus, (uint64_t) station->pool->options.multiplier, memory_order_relaxed);
+}
+
+static void
+onGeneratorTimer(void *parameter, uint64_t now)
+{
+    Station *station = (Station *) parameter;
+
+    Semaphore_wait(station->lock);
+    GeneratorSet_update(station->generators, station->points, (uint32_t) (now - station->lastGeneratorMs));
+    GiCache_invalidateGenerated(station->giCache);
+    Semaphore_post(station->lock);
+    station->lastGeneratorMs = now;
+}
+
+static PointTable
+loadPointFile(StationPool self, const char *path, int number)
+{
+    Config ignored;
+    PointTable points = PointTable_create(64);
+
+    if (points == NULL || !ConfigFile_load(path, &ignored, points)) {
+        fprintf(stderr, "%s Stanice %d: body nelze načíst z %s\n", self->label, number, path);
+        PointTable_destroy(points);
+        return NULL;
+    }
+
+    return points;
+}
+
+// Body stanice: vlastní soubor podle vzoru, jinak kopie společného souboru (ten se rozebere jen jednou)
+static bool
+loadStationPoints(StationPool self, Station *station)
+{
+    if (self->options.pointsPattern && self->options.pointsPattern[0]) {
+        char path[256];
+        snprintf(path, sizeof(path), self->options.pointsPattern, station->number);
+
+        if (access(path, R_OK) == 0) {
+            station->points = loadPointFile(self, path, station->number);
+            return station->points != NULL;
+        }
+    }
+
+    if (self->defaultPoints == NULL) {
+        self->defaultPoints = loadPointFile(self, self->options.defaultPoints, station->number);
+
+        if (self->defaultPoints == NULL)
+            return false;
+    }
+
+    station->points = PointTable_clone(self->defaultPoints);
+    return station->points != NULL;
+}
+
+static bool
+createListener(StationPool self, StationListener *listener, int port)
+{
+    listener->pool = self;
+    listener->port = port;
+    listener->slave = CS104_Slave_create(self->options.queueSize, 10);
+
+    if (listener->slave == NULL)
+        return false;
+
+    CS104_Slave_setLocalAddress(listener->slave, self->options.ip);
+    CS104_Slave_setLocalPort(listener->slave, port);
+    CS104_Slave_setServerMode(listener->slave, CS104_MODE_SINGLE_REDUNDANCY_GROUP);
+    CS104_Slave_setInterrogationHandler(listener->slave, interrogationHandler, listener);
+    CS104_Slave_setClockSyncHandler(listener->slave, clockSyncHandler, listener);
+    CS104_Slave_setASDUHandler(listener->slave, asduHandler, listener);
+
+    if (self->options.rawHandler)
+        CS104_Slave_setRawMessageHandler(listener->slave, self->options.rawHandler, NULL);
+
+    listener->broadcastCa = CS104_Slave_getAppLayerParameters(listener->slave)->sizeOfCA == 1 ? 0xff : 0xffff;
+
+    return true;
+}
+
+StationPool
+StationPool_create(const StationOptions *options, const char *label)
+{
+    if (options->count <= 0)
+        return NULL;
+
+    StationPool self = (StationPool) GLOBAL_CALLOC(1, sizeof(struct sStationPool));
+
+    if (self == NULL)
+        return NULL;
+
+    self->options = *options;
+    self->label = label;
+
+    if (self->options.multiplier < 1)
+        self->options.multiplier = 1;
+
+    self->stations = (Station *) GLOBAL_CALLOC((size_t) options->count, sizeof(Station));
+    self->numListeners = options->byCommonAddress ? 1 : options->count;
+    self->listeners = (StationListener *) GLOBAL_CALLOC((size_t) self->numListeners, sizeof(StationListener));
+
+    if (self->stations == NULL || self->listeners == NULL) {
+        StationPool_destroy(self);
+        return NULL;
+    }
+
+    raiseFileLimit(self->numListeners * 2 + 64);
+
+    for (int i = 0; i < self->numListeners; i++) {
+        StationListener *listener = &self->listeners[i];
+
+        if (!createListener(self, listener, options->byCommonAddress ? options->port : options->port + i)) {
+            StationPool_destroy(self);
+            return NULL;
+        }
+
+        listener->first = &self->stations[options->byCommonAddress ? 0 : i];
+        listener->count = options->byCommonAddress ? options->count : 1;
+    }
+
+    for (int i = 0; i < options->count; i++) {
+        Station *station = &self->stations[i];
+        station->pool = self;
+        station->listener = &self->listeners[options->byCommonAddress ? 0 : i];
+        station->number = i + 1;
+        station->ca = options->byCommonAddress ? options->commonAddress + i : options->commonAddress;
+        station->lock = Semaphore_create(1);
+        self->numStations++;
+
+        if (station->lock == NULL || !loadStationPoints(self, station)) {
+            StationPool_destroy(self);
+            return NULL;
+        }
+
+        CS101_AppLayerParameters alParams = CS104_Slave_getAppLayerParameters(station->listener->slave);
+        station->generators = GeneratorSet_create(station->points);
+        station->giCache = GiCache_create(alParams, station->points, options->originatorAddress, station->ca,
+                                          options->createIO);
+        station->periodic = PeriodicSet_create(alParams, station->points, options->originatorAddress, station->ca);
+    }
+
+    PointTable_destroy(self->defaultPoints);
+    self->defaultPoints = NULL;
+
+    return self;
+}
+
+static void *
+workerThread(void *parameter)
+{
+    StationWorker *worker = (StationWorker *) parameter;
+    StationPool self = worker->pool;
+
+    // Ctrl+C obslouží hlavní vlákno
+    sigset_t signals;
+    sigfillset(&signals);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+    while (atomic_load(&self->running)) {
+        uint64_t startUs = TimerWheel_monotonicUs();
+        int openConnections = 0;
+
+        // Servery workeru: index % numWorkers == worker->index (v režimu CA jen worker 0)
+        for (int i = worker->index; i < self->numListeners; i += self->numWorkers) {
+            StationListener *listener = &self->listeners[i];
+
+            if (!listener->listening)
+                continue;
+
+            CS104_Slave_tick(listener->slave);
+            openConnections += CS104_Slave_getOpenConnections(listener->slave);
+        }
+
+        TimerWheel_process(worker->wheel);
+
+        unsigned int loopUs = (unsigned int) (TimerWheel_monotonicUs() - startUs);
+        unsigned int maxUs = atomic_load_explicit(&worker->maxLoopUs, memory_order_relaxed);
+
+        while (loopUs > maxUs &&
+               !atomic_compare_exchange_weak_explicit(&worker->maxLoopUs, &maxUs, loopUs, memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+        }
+
+        // Se spojeními čeká tick na sockety (až 1 ms na server), bez nich jen do dalšího časovače
+        if (openConnections == 0)
+            TimerWheel_sleep(worker->wheel, STATION_IDLE_SLEEP_MS);
+    }
+
+    return NULL;
+}
+
+int
+StationPool_start(StationPool self)
+{
+    int listening = 0;
+
+    for (int i = 0; i < self->numListeners; i++) {
+        StationListener *listener = &self->listeners[i];
+        CS104_Slave_startThreadless(listener->slave);
+        listener->listening = CS104_Slave_isRunning(listener->slave);
+
+        if (listener->listening)
+            listening++;
+        else
+            fprintf(stderr, "%s Port %d nelze otevřít\n", self->label, listener->port);
+    }
+
+    int workers = self->options.workers;
+
+    if (workers <= 0)
+        workers = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    // Workerů může být víc než serverů: v režimu CA (jeden port) obslouží sockety worker 0
+    // a časovače stanic se rozdělí na všechny
+    if (workers > self->numStations)
+        workers = self->numStations;
+    if (workers > STATION_MAX_WORKERS)
+        workers = STATION_MAX_WORKERS;
+    if (workers < 1)
+        workers = 1;
+
+    self->workers = (StationWorker *) GLOBAL_CALLOC((size_t) workers, sizeof(StationWorker));
+
+    if (self->workers == NULL)
+        return 0;
+
+    self->numWorkers = workers;
+
+    for (int w = 0; w < workers; w++) {
+        self->workers[w].pool = self;
+        self->workers[w].index = w;
+        self->workers[w].wheel = TimerWheel_create();
+        atomic_init(&self->workers[w].maxLoopUs, 0);
+    }
+
+    // Časovače stanice i (generátor, periodické zprávy) na kole workeru i % workers – v režimu portů
+    // je to worker jejího serveru; fáze rozprostřené po stanicích
+    int periodMs = self->options.periodMs > 0 ? self->options.periodMs : 20000;
+    int tickMs = self->options.generatorTickMs > 0 ? self->options.generatorTickMs : STATION_DEFAULT_TICK_MS;
+
+    for (int i = 0; i < self->numStations; i++) {
+        Station *station = &self->stations[i];
+        TimerWheel wheel = self->workers[i % workers].wheel;
+        uint32_t phaseMs = (uint32_t) ((uint64_t) periodMs * (uint64_t) i / (uint64_t) self->numStations);
+
+        if (station->periodic)
+            PeriodicSet_start(station->periodic, wheel, periodMs, phaseMs, sendPeriodicAsdu, station);
+
+        if (station->generators) {
+            station->lastGeneratorMs = TimerWheel_now(wheel);
+            station->generatorTimer = TimerWheel_addTimer(wheel, onGeneratorTimer, station);
+            TimerWheel_start(wheel, station->generatorTimer, tickMs, tickMs);
+        }
+    }
+
+    self->lastReportUs = TimerWheel_monotonicUs();
+    atomic_store(&self->running, true);
+
+    for (int w = 0; w < workers; w++) {
+        self->workers[w].thread = Thread_create(workerThread, &self->workers[w], false);
+        Thread_start(self->workers[w].thread);
+    }
+
+    return listening;
+}
+
+void
+StationPool_destroy(StationPool self)
+{
+    if (self == NULL)
+        return;
+
+    atomic_store(&self->running, false);
+
+    for (int w = 0; w < self->numWorkers; w++) {
+        if (self->workers[w].thread)
+            Thread_destroy(self->workers[w].thread);
+    }
+
+    for (int i = 0; i < self->numListeners; i++) {
+        if (self->listeners[i].slave == NULL)
+            continue;
+
+        if (self->listeners[i].listening)
+            CS104_Slave_stopThreadless(self->listeners[i].slave);
+
+        CS104_Slave_destroy(self->listeners[i].slave);
+    }
+
+    // Kola workerů uvolní i časovače stanic
+    for (int i = 0; i < self->numStations; i++) {
+        Station *station = &self->stations[i];
+
+        if (station->periodic)
+            PeriodicSet_stop(station->periodic);
+
+        PeriodicSet_destroy(station->periodic);
+        GiCache_destroy(station->giCache);
+        GeneratorSet_destroy(station->generators);
+        PointTable_destroy(station->points);
+
+        if (station->lock)
+            Semaphore_destroy(station->lock);
+    }
+
+    PointTable_destroy(self->defaultPoints);
+
+    for (int w = 0; w < self->numWorkers; w++)
+        TimerWheel_destroy(self->workers[w].wheel);
+
+    GLOBAL_FREEMEM(self->workers);
+    GLOBAL_FREEMEM(self->listeners);
+    GLOBAL_FREEMEM(self->stations);
+    GLOBAL_FREEMEM(self);
+}
+
+void
+StationPool_report(StationPool self)
+{
+    uint64_t nowUs = TimerWheel_monotonicUs();
+    double seconds = (double) (nowUs - self->lastReportUs) / 1e6;
+
+    if (seconds <= 0)
+        return;
+
+    uint64_t asdus = 0;
+    uint64_t interrogations = 0;
+    uint64_t commands = 0;
+    int connections = 0;
+    int connectedListeners = 0;
+
+    for (int i = 0; i < self->numStations; i++) {
+        Station *station = &self->stations[i];
+        asdus += atomic_load_explicit(&station->asdus, memory_order_relaxed);
+        interrogations += atomic_load_explicit(&station->interrogations, memory_order_relaxed);
+        commands += atomic_load_explicit(&station->commands, memory_order_relaxed);
+    }
+
+    for (int i = 0; i < self->numListeners; i++) {
+        if (!self->listeners[i].listening)
+            continue;
+
+        int open = CS104_Slave_getOpenConnections(self->listeners[i].slave);
+        connections += open;
+        if (open > 0)
+            connectedListeners++;
+    }
+
+    unsigned int maxLoopUs = 0;
+
+    for (int w = 0; w < self->numWorkers; w++) {
+        unsigned int loopUs = atomic_exchange_explicit(&self->workers[w].maxLoopUs, 0, memory_order_relaxed);
+        if (loopUs > maxLoopUs)
+            maxLoopUs = loopUs;
+    }
+
+    printf("%s STANICE %d (%d %s, %d workerů): spojení %d", self->label, self->numStations, self->numListeners,
+           self->numListeners == 1 ? "port" : "portů", self->numWorkers, connections);
+
+    if (self->numListeners > 1)
+        printf(" (porty se spojením %d)", connectedListeners);
+
+    printf(" | TX %.0f ASDU/s | GI %.0f/s | commandy %.0f/s | nejdelší smyčka workeru %.1f ms\n",
+           (asdus - self->lastAsdus) / seconds, (interrogations - self->lastInterrogations) / seconds,
+           (commands - self->lastCommands) / seconds, maxLoopUs / 1000.0);
+    fflush(stdout);
+
+    self->lastReportUs = nowUs;
+    self->lastAsdus = asdus;
+    self->lastInterrogations = interrogations;
+    self->lastCommands = commands;
+}
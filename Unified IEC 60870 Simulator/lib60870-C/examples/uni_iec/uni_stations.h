@@ -0,0 +1,57 @@
+// =======================
+// VÍCE VIRTUÁLNÍCH STANIC SERVERU 104 V JEDNOM PROCESU (STATIONS)
+// =======================
+//
+// Každá stanice má vlastní kontext: tabulku bodů, generátory, šablony
+// periodických zpráv (uni_periodic.h) a cache odpovědí na GI – nic z toho
+// nejsou globální proměnné, takže stanic může být stovky. Stanice se liší
+// portem (PORT+i, stejné CA) nebo CA (jeden port, CA+i). Servery CS104_Slave
+// běží bez vlastních vláken (threadless); pevný počet workerů si po řadě
+// rozdělí servery (sockety) i stanice (jedno TimerWheel s časovači generátorů
+// a periodických zpráv na worker). V režimu CA obsluhuje jediný server worker 0
+// a výpočet stanic se rozloží na všechny workery; body a cache GI stanice
+// proto chrání zámek stanice. Společný soubor bodů se rozebere jednou a stanice
+// bez vlastního souboru dostanou jeho kopii.
+
+#ifndef UNI_STATIONS_H_
+#define UNI_STATIONS_H_
+
+#include <stdbool.h>
+
+#include "iec60870_common.h"
+#include "cs104_slave.h"
+#include "uni_gicache.h"
+
+typedef struct sStationPool* StationPool;
+
+typedef struct {
+    int count;                    // Počet stanic
+    bool byCommonAddress;         // true = jeden port, CA+i; false = port PORT+i, stejné CA
+    const char *ip;
+    int port;                     // Port první stanice
+    int originatorAddress;
+    int commonAddress;            // CA první stanice
+    const char *pointsPattern;    // Soubor bodů stanice s %d = číslo stanice od 1 (NULL = jen defaultPoints)
+    const char *defaultPoints;    // Soubor bodů stanic, které vlastní soubor nemají
+    int workers;                  // Počet vláken (0 = podle počtu CPU)
+    int periodMs;                 // Globální PERIOD
+    int generatorTickMs;
+    int multiplier;
+    int queueSize;                // Fronta ASDU každého serveru
+    GiCreateIOFunction createIO;
+    CS104_SlaveRawMessageHandler rawHandler;   // Může být NULL
+} StationOptions;
+
+// Načte body a připraví stanice i servery (ještě nenaslouchají). NULL = chyba.
+StationPool StationPool_create(const StationOptions *options, const char *label);
+
+// Otevře porty a spustí workery, vrací počet serverů, které naslouchají
+int StationPool_start(StationPool self);
+
+// Zastaví workery a zavře všechna spojení
+void StationPool_destroy(StationPool self);
+
+// Vypíše souhrn stanic a rychlostí od minulého výpisu (volá hlavní vlákno)
+void StationPool_report(StationPool self);
+
+#endif /* UNI_STATIONS_H_ */
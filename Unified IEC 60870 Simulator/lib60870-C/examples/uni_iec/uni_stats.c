@@ -0,0 +1,192 @@
+// =======================
+// STATISTIKA PROVOZU – implementace
+// =======================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "uni_stats.h"
+#include "uni_timer.h"
+#include "iec60870_common.h"
+#include "lib_memory.h"
+
+#define STATS_TYPES 256
+#define STATS_COTS 64
+#define STATS_TOP 3               // Kolik nejčastějších typů a COT se vypíše
+
+// Čítače jednoho směru (plní vlákna protokolu)
+typedef struct {
+    atomic_uint_fast64_t asdus;
+    atomic_uint_fast64_t ios;
+    atomic_uint_fast64_t frames;
+    atomic_uint_fast64_t bytes;
+    atomic_uint_fast64_t sampled;
+    atomic_uint_fast64_t types[STATS_TYPES];
+    atomic_uint_fast64_t cots[STATS_COTS];
+} DirectionCounters;
+
+// Stav při minulém výpisu (jen vlákno výpisu)
+typedef struct {
+    uint64_t asdus;
+    uint64_t ios;
+    uint64_t frames;
+    uint64_t bytes;
+    uint64_t types[STATS_TYPES];
+    uint64_t cots[STATS_COTS];
+} DirectionSnapshot;
+
+struct sTrafficStats {
+    int sampleEvery;
+    DirectionCounters counters[2];
+    DirectionSnapshot last[2];
+    uint64_t lastReportUs;
+    int64_t lastDropped;
+};
+
+TrafficStats
+TrafficStats_create(int sampleEvery)
+{
+    TrafficStats self = (TrafficStats) GLOBAL_CALLOC(1, sizeof(struct sTrafficStats));
+
+    if (self == NULL)
+        return NULL;
+
+    self->sampleEvery = sampleEvery > 0 ? sampleEvery : 0;
+    self->lastReportUs = TimerWheel_monotonicUs();
+    self->lastDropped = -1;
+
+    return self;
+}
+
+void
+TrafficStats_destroy(TrafficStats self)
+{
+    GLOBAL_FREEMEM(self);
+}
+
+bool
+TrafficStats_onAsdu(TrafficStats self, StatsDirection direction, int type, int cot, int numIos)
+{
+    DirectionCounters *counters = &self->counters[direction];
+
+    atomic_fetch_add_explicit(&counters->asdus, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counters->ios, (uint_fast64_t) numIos, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counters->types[type & (STATS_TYPES - 1)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counters->cots[cot & (STATS_COTS - 1)], 1, memory_order_relaxed);
+
+    if (self->sampleEvery == 0)
+        return false;
+
+    return atomic_fetch_add_explicit(&counters->sampled, 1, memory_order_relaxed) % (uint64_t) self->sampleEvery == 0;
+}
+
+void
+TrafficStats_onFrame(TrafficStats self, StatsDirection direction, int bytes)
+{
+    DirectionCounters *counters = &self->counters[direction];
+
+    atomic_fetch_add_explicit(&counters->frames, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counters->bytes, (uint_fast64_t) bytes, memory_order_relaxed);
+}
+
+// Nejčastější položky za interval (last se přepíše na aktuální stav)
+static int
+topEntries(atomic_uint_fast64_t *current, uint64_t *last, int count, int *top, uint64_t *topCounts)
+{
+    int found = 0;
+
+    for (int i = 0; i < count; i++) {
+        uint64_t value = atomic_load_explicit(&current[i], memory_order_relaxed);
+        uint64_t delta = value - last[i];
+        last[i] = value;
+
+        if (delta == 0)
+            continue;
+
+        // Vložení do krátkého seřazeného seznamu
+        int position = found < STATS_TOP ? found : STATS_TOP;
+        while (position > 0 && topCounts[position - 1] < delta)
+            position--;
+
+        if (position >= STATS_TOP)
+            continue;
+
+        int end = found < STATS_TOP ? found : STATS_TOP - 1;
+        for (int j = end; j > position; j--) {
+            top[j] = top[j - 1];
+            topCounts[j] = topCounts[j - 1];
+        }
+
+        top[position] = i;
+        topCounts[position] = delta;
+
+        if (found < STATS_TOP)
+            found++;
+    }
+
+    return found;
+}
+
+static void
+reportDirection(TrafficStats self, StatsDirection direction, const char *name, double seconds)
+{
+    DirectionCounters *counters = &self->counters[direction];
+    DirectionSnapshot *last = &self->last[direction];
+
+    uint64_t asdus = atomic_load_explicit(&counters->asdus, memory_order_relaxed);
+    uint64_t ios = atomic_load_explicit(&counters->ios, memory_order_relaxed);
+    uint64_t frames = atomic_load_explicit(&counters->frames, memory_order_relaxed);
+    uint64_t bytes = atomic_load_explicit(&counters->bytes, memory_order_relaxed);
+
+    printf(" | %s %.0f ASDU/s %.0f IO/s %.0f rámců/s %.1f kB/s", name, (asdus - last->asdus) / seconds,
+           (ios - last->ios) / seconds, (frames - last->frames) / seconds, (bytes - last->bytes) / seconds / 1024.0);
+
+    last->asdus = asdus;
+    last->ios = ios;
+    last->frames = frames;
+    last->bytes = bytes;
+
+    int top[STATS_TOP];
+    uint64_t topCounts[STATS_TOP];
+
+    int numTypes = topEntries(counters->types, last->types, STATS_TYPES, top, topCounts);
+    for (int i = 0; i < numTypes; i++)
+        printf("%s%s %.0f", i == 0 ? " [" : ", ", TypeID_toString((TypeID) top[i]), topCounts[i] / seconds);
+
+    int numCots = topEntries(counters->cots, last->cots, STATS_COTS, top, topCounts);
+    for (int i = 0; i < numCots; i++)
+        printf("%s%d:%.0f", i == 0 ? (numTypes ? "; COT " : " [COT ") : " ", top[i], topCounts[i] / seconds);
+
+    if (numTypes || numCots)
+        printf("]");
+}
+
+void
+TrafficStats_report(TrafficStats self, const char *label, int64_t queueDepth, int64_t dropped)
+{
+    uint64_t nowUs = TimerWheel_monotonicUs();
+    double seconds = (double) (nowUs - self->lastReportUs) / 1e6;
+
+    if (seconds <= 0)
+        return;
+
+    printf("%s STATS %.2f s", label, seconds);
+    reportDirection(self, STATS_TX, "TX", seconds);
+    reportDirection(self, STATS_RX, "RX", seconds);
+
+    if (queueDepth >= 0)
+        printf(" | fronta %lld", (long long) queueDepth);
+
+    if (dropped >= 0) {
+        int64_t droppedNow = (self->lastDropped >= 0) ? dropped - self->lastDropped : dropped;
+        printf(" | zahozeno %lld (celkem %lld)", (long long) droppedNow, (long long) dropped);
+        self->lastDropped = dropped;
+    }
+
+    printf("\n");
+    fflush(stdout);
+
+    self->lastReportUs = nowUs;
+}
@@ -0,0 +1,37 @@
+// =======================
+// STATISTIKA PROVOZU (tichý režim QUIET)
+// =======================
+//
+// Handlery ASDU a surových rámců jen zvýší atomické čítače (po typech, COT,
+// rámce, bajty) a hlavní smyčka jednou za interval vypíše jeden řádek s
+// rychlostmi. Výpis každé IO na stdout pod zátěží brzdí vlákna protokolu –
+// v tichém režimu se celé ASDU vypíše jen vzorkovaně (1 z N).
+
+#ifndef UNI_STATS_H_
+#define UNI_STATS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct sTrafficStats* TrafficStats;
+
+typedef enum {
+    STATS_TX = 0,
+    STATS_RX = 1
+} StatsDirection;
+
+// sampleEvery = vypsat celé každé N-té ASDU (0 = žádné)
+TrafficStats TrafficStats_create(int sampleEvery);
+
+void TrafficStats_destroy(TrafficStats self);
+
+// Započítá ASDU, vrací true, pokud se má vypsat (vzorek). Volá se z libovolného vlákna.
+bool TrafficStats_onAsdu(TrafficStats self, StatsDirection direction, int type, int cot, int numIos);
+
+// Započítá surový rámec (104 APDU nebo 101 rámec linkové vrstvy)
+void TrafficStats_onFrame(TrafficStats self, StatsDirection direction, int bytes);
+
+// Vypíše rychlosti od minulého výpisu; queueDepth/dropped < 0 = neznámé
+void TrafficStats_report(TrafficStats self, const char *label, int64_t queueDepth, int64_t dropped);
+
+#endif /* UNI_STATS_H_ */
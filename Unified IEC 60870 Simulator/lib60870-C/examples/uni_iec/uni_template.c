@@ -0,0 +1,284 @@
+// =======================
+// PŘEDKÓDOVANÉ ŠABLONY ASDU – implementace
+// =======================
+
+#include <string.h>
+#include <time.h>
+
+#include "uni_template.h"
+#include "lib_memory.h"
+
+struct sAsduTemplate {
+    sCS101_StaticASDU asdu;
+    CS101_AppLayerParameters parameters;
+    int typeId;
+    int valueSize;          // Počet bajtů hodnoty včetně kvality (bez IOA)
+    int timeSize;           // 0, 3 (CP24) nebo 7 (CP56)
+    int capacity;           // Max. počet bodů, které se vejdou do ASDU
+    int numberOfPoints;
+    uint8_t* valueOffset;   // Offset hodnoty v payloadu pro každý bod
+    float* lastValue;       // Naposledy zakódovaná hodnota (pro patch jen při změně)
+};
+
+// Velikost hodnoty (vč. kvality) a časové značky pro daný typ
+static bool
+getTypeLayout(int typeId, int* valueSize, int* timeSize)
+{
+    switch (typeId) {
+        case M_SP_NA_1: case M_DP_NA_1:
+            *valueSize = 1; *timeSize = 0; return true;
+        case M_SP_TA_1: case M_DP_TA_1:
+            *valueSize = 1; *timeSize = 3; return true;
+        case M_SP_TB_1: case M_DP_TB_1:
+            *valueSize = 1; *timeSize = 7; return true;
+        case M_ST_NA_1:
+            *valueSize = 2; *timeSize = 0; return true;
+        case M_ST_TA_1:
+            *valueSize = 2; *timeSize = 3; return true;
+        case M_ST_TB_1:
+            *valueSize = 2; *timeSize = 7; return true;
+        case M_ME_NA_1: case M_ME_NB_1:
+            *valueSize = 3; *timeSize = 0; return true;
+        case M_ME_TA_1: case M_ME_TB_1:
+            *valueSize = 3; *timeSize = 3; return true;
+        case M_ME_TD_1: case M_ME_TE_1:
+            *valueSize = 3; *timeSize = 7; return true;
+        case M_BO_NA_1: case M_ME_NC_1: case M_IT_NA_1:
+            *valueSize = 5; *timeSize = 0; return true;
+        case M_BO_TA_1: case M_ME_TC_1: case M_IT_TA_1:
+            *valueSize = 5; *timeSize = 3; return true;
+        case M_BO_TB_1: case M_ME_TF_1: case M_IT_TB_1:
+            *valueSize = 5; *timeSize = 7; return true;
+        default:
+            return false;
+    }
+}
+
+static void
+encodeInt16(uint8_t* buf, int value)
+{
+    if (value > 32767) value = 32767;
+    else if (value < -32768) value = -32768;
+
+    uint16_t v = (uint16_t) (int16_t) value;
+    buf[0] = (uint8_t) (v & 0xff);
+    buf[1] = (uint8_t) (v >> 8);
+}
+
+static void
+encodeUInt32(uint8_t* buf, uint32_t v)
+{
+    buf[0] = (uint8_t) (v & 0xff);
+    buf[1] = (uint8_t) ((v >> 8) & 0xff);
+    buf[2] = (uint8_t) ((v >> 16) & 0xff);
+    buf[3] = (uint8_t) (v >> 24);
+}
+
+// Zakóduje hodnotu stejně jako createIO() + knihovní *_encode (kvalita GOOD)
+static void
+encodeValue(int typeId, uint8_t* buf, float value)
+{
+    switch (typeId) {
+        case M_SP_NA_1: case M_SP_TA_1: case M_SP_TB_1:
+            buf[0] = (value != 0.0f) ? 1 : 0;
+            break;
+        case M_DP_NA_1: case M_DP_TA_1: case M_DP_TB_1:
+            buf[0] = (uint8_t) (((int) value) & 0x03);
+            break;
+        case M_ST_NA_1: case M_ST_TA_1: case M_ST_TB_1:
+            buf[0] = (uint8_t) (((int) value) & 0x7f); // transient = false
+            buf[1] = IEC60870_QUALITY_GOOD;
+            break;
+        case M_BO_NA_1: case M_BO_TA_1: case M_BO_TB_1:
+            encodeUInt32(buf, (uint32_t) ((int) value));
+            buf[4] = IEC60870_QUALITY_GOOD;
+            break;
+        case M_ME_NA_1: case M_ME_TA_1: case M_ME_TD_1:
+        {
+            float nv = value;
+            if (nv > 1.0f) nv = 1.0f;
+            else if (nv < -1.0f) nv = -1.0f;
+            encodeInt16(buf, (int) (nv * 32767.f));
+            buf[2] = IEC60870_QUALITY_GOOD;
+            break;
+        }
+        case M_ME_NB_1: case M_ME_TB_1: case M_ME_TE_1:
+            encodeInt16(buf, (int) value);
+            buf[2] = IEC60870_QUALITY_GOOD;
+            break;
+        case M_ME_NC_1: case M_ME_TC_1: case M_ME_TF_1:
+        {
+            uint32_t raw;
+            memcpy(&raw, &value, 4);
+            encodeUInt32(buf, raw);
+            buf[4] = IEC60870_QUALITY_GOOD;
+            break;
+        }
+        case M_IT_NA_1: case M_IT_TA_1: case M_IT_TB_1:
+            encodeUInt32(buf, (uint32_t) (int32_t) value);
+            buf[4] = 0; // sekvenční číslo, carry, adjusted, invalid
+            break;
+    }
+}
+
+void
+TemplateTime_set(TemplateTime* self, uint64_t msTimestamp)
+{
+    struct sCP56Time2a cp56;
+    CP56Time2a_createFromMsTimestamp(&cp56, msTimestamp);
+    memcpy(self->cp56, cp56.encodedValue, 7);
+
+    struct sCP24Time2a cp24;
+    memset(&cp24, 0, sizeof(cp24));
+
+    time_t timeVal = (time_t) (msTimestamp / 1000);
+    struct tm tmTime;
+    gmtime_r(&timeVal, &tmTime);
+
+    CP24Time2a_setMillisecond(&cp24, (int) (msTimestamp % 1000));
+    CP24Time2a_setSecond(&cp24, tmTime.tm_sec);
+    CP24Time2a_setMinute(&cp24, tmTime.tm_min);
+    memcpy(self->cp24, cp24.encodedValue, 3);
+}
+
+bool
+AsduTemplate_isTypeSupported(int typeId)
+{
+    int valueSize, timeSize;
+    return getTypeLayout(typeId, &valueSize, &timeSize);
+}
+
+int
+AsduTemplate_getTimeSize(int typeId)
+{
+    int valueSize, timeSize;
+
+    if (!getTypeLayout(typeId, &valueSize, &timeSize))
+        return 0;
+
+    return timeSize;
+}
+
+AsduTemplate
+AsduTemplate_create(CS101_AppLayerParameters parameters, int typeId,
+                    CS101_CauseOfTransmission cot, int oa, int ca)
+{
+    int valueSize, timeSize;
+
+    if (!getTypeLayout(typeId, &valueSize, &timeSize))
+        return NULL;
+
+    AsduTemplate self = (AsduTemplate) GLOBAL_CALLOC(1, sizeof(struct sAsduTemplate));
+
+    if (self == NULL)
+        return NULL;
+
+    CS101_ASDU asdu = CS101_ASDU_initializeStatic(&self->asdu, parameters, false, cot, oa, ca, false, false);
+    CS101_ASDU_setTypeID(asdu, (IEC60870_5_TypeID) typeId);
+
+    self->parameters = parameters;
+    self->typeId = typeId;
+    self->valueSize = valueSize;
+    self->timeSize = timeSize;
+
+    int elementSize = parameters->sizeOfIOA + valueSize + timeSize;
+    self->capacity = (parameters->maxSizeOfASDU - self->asdu.asduHeaderLength) / elementSize;
+
+    if (self->capacity > 127)
+        self->capacity = 127;
+
+    self->valueOffset = (uint8_t*) GLOBAL_CALLOC(self->capacity, sizeof(uint8_t));
+    self->lastValue = (float*) GLOBAL_CALLOC(self->capacity, sizeof(float));
+
+    if ((self->valueOffset == NULL) || (self->lastValue == NULL)) {
+        AsduTemplate_destroy(self);
+        return NULL;
+    }
+
+    return self;
+}
+
+void
+AsduTemplate_destroy(AsduTemplate self)
+{
+    if (self == NULL)
+        return;
+
+    GLOBAL_FREEMEM(self->valueOffset);
+    GLOBAL_FREEMEM(self->lastValue);
+    GLOBAL_FREEMEM(self);
+}
+
+bool
+AsduTemplate_addPoint(AsduTemplate self, int ioa, float value)
+{
+    if (self->numberOfPoints >= self->capacity)
+        return false;
+
+    CS101_ASDU asdu = (CS101_ASDU) &self->asdu;
+
+    uint8_t element[3 + 5 + 7];
+    int pos = 0;
+
+    element[pos++] = (uint8_t) (ioa & 0xff);
+
+    if (self->parameters->sizeOfIOA > 1)
+        element[pos++] = (uint8_t) ((ioa >> 8) & 0xff);
+
+    if (self->parameters->sizeOfIOA > 2)
+        element[pos++] = (uint8_t) ((ioa >> 16) & 0xff);
+
+    encodeValue(self->typeId, element + pos, value);
+    memset(element + pos + self->valueSize, 0, self->timeSize);
+
+    int offset = CS101_ASDU_getPayloadSize(asdu) + pos;
+
+    if (!CS101_ASDU_addPayload(asdu, element, pos + self->valueSize + self->timeSize))
+        return false;
+
+    self->valueOffset[self->numberOfPoints] = (uint8_t) offset;
+    self->lastValue[self->numberOfPoints] = value;
+    self->numberOfPoints++;
+
+    CS101_ASDU_setNumberOfElements(asdu, self->numberOfPoints);
+
+    return true;
+}
+
+int
+AsduTemplate_getNumberOfPoints(AsduTemplate self)
+{
+    return self->numberOfPoints;
+}
+
+void
+AsduTemplate_setValue(AsduTemplate self, int index, float value)
+{
+    if ((index < 0) || (index >= self->numberOfPoints))
+        return;
+
+    if (self->lastValue[index] == value)
+        return;
+
+    encodeValue(self->typeId, CS101_ASDU_getPayload((CS101_ASDU) &self->asdu) + self->valueOffset[index], value);
+    self->lastValue[index] = value;
+}
+
+void
+AsduTemplate_applyTime(AsduTemplate self, const TemplateTime* time)
+{
+    if (self->timeSize == 0)
+        return;
+
+    const uint8_t* encodedTime = (self->timeSize == 3) ? time->cp24 : time->cp56;
+    uint8_t* payload = CS101_ASDU_getPayload((CS101_ASDU) &self->asdu);
+
+    for (int i = 0; i < self->numberOfPoints; i++)
+        memcpy(payload + self->valueOffset[i] + self->valueSize, encodedTime, self->timeSize);
+}
+
+CS101_ASDU
+AsduTemplate_getASDU(AsduTemplate self)
+{
+    return (CS101_ASDU) &self->asdu;
+}
@@ -0,0 +1,55 @@
+// =======================
+// PŘEDKÓDOVANÉ ŠABLONY ASDU (periodické zprávy)
+// =======================
+//
+// Šablona drží jednou zakódované ASDU (hlavička + IOA + hodnoty + místo pro
+// časové značky) a pro každý bod si pamatuje offset hodnoty v payloadu.
+// V každé periodě se pouze přepíšou změněné hodnoty a časové značky
+// a ASDU se rovnou zařadí do fronty – bez alokací a bez createIO().
+
+#ifndef UNI_TEMPLATE_H_
+#define UNI_TEMPLATE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "iec60870_common.h"
+
+typedef struct sAsduTemplate* AsduTemplate;
+
+// Předpočítané časové značky pro jeden tick (jeden gmtime pro všechny šablony)
+typedef struct {
+    uint8_t cp24[3];
+    uint8_t cp56[7];
+} TemplateTime;
+
+// Nastaví CP24/CP56 podle ms timestampu
+void TemplateTime_set(TemplateTime* self, uint64_t msTimestamp);
+
+// Vrátí true, pokud umíme typ zakódovat do šablony (1–16, 30–37)
+bool AsduTemplate_isTypeSupported(int typeId);
+
+// Velikost časové značky typu v bajtech: 3 (CP24), 7 (CP56), 0 = typ bez času nebo nepodporovaný
+int AsduTemplate_getTimeSize(int typeId);
+
+// Vytvoří prázdnou šablonu pro daný typ, NULL pro nepodporovaný typ
+AsduTemplate AsduTemplate_create(CS101_AppLayerParameters parameters, int typeId,
+                                 CS101_CauseOfTransmission cot, int oa, int ca);
+
+void AsduTemplate_destroy(AsduTemplate self);
+
+// Přidá bod do šablony, vrací false pokud se už do ASDU nevejde
+bool AsduTemplate_addPoint(AsduTemplate self, int ioa, float value);
+
+int AsduTemplate_getNumberOfPoints(AsduTemplate self);
+
+// Přepíše hodnotu bodu s indexem index (jen pokud se změnila)
+void AsduTemplate_setValue(AsduTemplate self, int index, float value);
+
+// Přepíše časové značky všech bodů (pro typy bez času nic nedělá)
+void AsduTemplate_applyTime(AsduTemplate self, const TemplateTime* time);
+
+// ASDU připravené k zařazení do fronty (patří šabloně, neuvolňovat)
+CS101_ASDU AsduTemplate_getASDU(AsduTemplate self);
+
+#endif /* UNI_TEMPLATE_H_ */
@@ -0,0 +1,422 @@
+// =======================
+// HIERARCHICKÉ ČASOVÉ KOLO – implementace
+// =======================
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "uni_timer.h"
+#include "hal_time.h"
+#include "lib_memory.h"
+
+#define WHEEL_LEVELS 4
+#define WHEEL_BITS 8
+#define WHEEL_SLOTS (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SLOTS - 1)
+#define WHEEL_WORDS (WHEEL_SLOTS / 64)
+
+// Nejvzdálenější termín, který se vejde do nejvyšší úrovně (~49 dní)
+#define WHEEL_MAX_DELTA ((1ULL << (WHEEL_BITS * WHEEL_LEVELS)) - 1)
+
+struct sTimer {
+    struct sTimer *next;
+    struct sTimer *prev;
+    struct sTimer **head;     // Seznam, ve kterém časovač právě je (NULL = neaktivní)
+    int level;                // Úroveň a slot (-1 = seznam právě spouštěných)
+    int slot;
+
+    uint64_t expiry;          // Termín v ms (relativně k origin kola)
+    uint64_t period;          // 0 = jednorázový
+
+    TimerCallback callback;
+    void *parameter;
+
+    struct sTimer *allNext;   // Seznam všech časovačů kola (kvůli destroy)
+};
+
+struct sTimerWheel {
+    uint64_t originMs;        // Monotónní čas vytvoření kola
+    uint64_t current;         // Další tick, který se bude zpracovávat
+
+    Timer slots[WHEEL_LEVELS][WHEEL_SLOTS];
+    uint64_t bitmap[WHEEL_LEVELS][WHEEL_WORDS];  // Neprázdné sloty
+
+    Timer firing;             // Časovače vyjmuté ze slotu, které se právě spouští
+    Timer allTimers;
+};
+
+uint64_t
+TimerWheel_monotonicNs(void)
+{
+    return Hal_getMonotonicTimeInNs();
+}
+
+uint64_t
+TimerWheel_monotonicUs(void)
+{
+    return Hal_getMonotonicTimeInNs() / 1000ULL;
+}
+
+uint64_t
+TimerWheel_monotonicMs(void)
+{
+    return Hal_getMonotonicTimeInNs() / 1000000ULL;
+}
+
+static inline void
+setBit(uint64_t *bitmap, int slot)
+{
+    bitmap[slot >> 6] |= (1ULL << (slot & 63));
+}
+
+static inline void
+clearBit(uint64_t *bitmap, int slot)
+{
+    bitmap[slot >> 6] &= ~(1ULL << (slot & 63));
+}
+
+// První neprázdný slot >= from, -1 pokud žádný
+static int
+findSlot(const uint64_t *bitmap, int from)
+{
+    for (int word = from >> 6; word < WHEEL_WORDS; word++) {
+        uint64_t bits = bitmap[word];
+
+        if (word == (from >> 6))
+            bits &= ~0ULL << (from & 63);
+
+        if (bits)
+            return (word << 6) + __builtin_ctzll(bits);
+    }
+
+    return -1;
+}
+
+static void
+unlinkTimer(TimerWheel self, Timer timer)
+{
+    if (timer->head == NULL)
+        return;
+
+    if (timer->prev)
+        timer->prev->next = timer->next;
+    else
+        *timer->head = timer->next;
+
+    if (timer->next)
+        timer->next->prev = timer->prev;
+
+    if ((timer->level >= 0) && (self->slots[timer->level][timer->slot] == NULL))
+        clearBit(self->bitmap[timer->level], timer->slot);
+
+    timer->head = NULL;
+    timer->next = NULL;
+    timer->prev = NULL;
+}
+
+static void
+pushTimer(Timer *head, Timer timer)
+{
+    timer->prev = NULL;
+    timer->next = *head;
+
+    if (*head)
+        (*head)->prev = timer;
+
+    *head = timer;
+    timer->head = head;
+}
+
+static void
+insertTimer(TimerWheel self, Timer timer)
+{
+    uint64_t expiry = timer->expiry;
+
+    if (expiry < self->current)
+        expiry = self->current;
+
+    if (expiry - self->current > WHEEL_MAX_DELTA)
+        expiry = self->current + WHEEL_MAX_DELTA;
+
+    // Nejnižší úroveň, ve které má termín stejné vyšší bity jako aktuální tick
+    int level = 0;
+
+    while ((level < WHEEL_LEVELS - 1) &&
+           ((expiry >> (WHEEL_BITS * (level + 1))) != (self->current >> (WHEEL_BITS * (level + 1)))))
+        level++;
+
+    int slot = (int) ((expiry >> (WHEEL_BITS * level)) & WHEEL_MASK);
+
+    timer->level = level;
+    timer->slot = slot;
+    pushTimer(&self->slots[level][slot], timer);
+    setBit(self->bitmap[level], slot);
+}
+
+// Přesune časovače ze slotu vyšší úrovně o úroveň (nebo víc) níž
+static void
+cascade(TimerWheel self, int level, int slot)
+{
+    Timer timer = self->slots[level][slot];
+
+    self->slots[level][slot] = NULL;
+    clearBit(self->bitmap[level], slot);
+
+    while (timer) {
+        Timer next = timer->next;
+        timer->head = NULL;
+        insertTimer(self, timer);
+        timer = next;
+    }
+}
+
+static int
+processTick(TimerWheel self)
+{
+    uint64_t tick = self->current;
+
+    // Na hranici úrovně přesuň časovače z vyšších úrovní (od nejvyšší dolů)
+    if ((tick & WHEEL_MASK) == 0) {
+        int top = 0;
+
+        while ((top < WHEEL_LEVELS - 1) && ((tick & ((1ULL << (WHEEL_BITS * (top + 1))) - 1)) == 0))
+            top++;
+
+        for (int level = top; level > 0; level--)
+            cascade(self, level, (int) ((tick >> (WHEEL_BITS * level)) & WHEEL_MASK));
+    }
+
+    int slot = (int) (tick & WHEEL_MASK);
+    int fired = 0;
+
+    if (self->slots[0][slot]) {
+        // Slot vyjmeme celý – callbacky mohou přidávat i rušit časovače
+        self->firing = self->slots[0][slot];
+        self->slots[0][slot] = NULL;
+        clearBit(self->bitmap[0], slot);
+
+        for (Timer timer = self->firing; timer; timer = timer->next) {
+            timer->head = &self->firing;
+            timer->level = -1;
+        }
+
+        self->current = tick + 1;
+
+        while (self->firing) {
+            Timer timer = self->firing;
+            unlinkTimer(self, timer);
+
+            if (timer->period > 0) {
+                // Pevná fáze – přeskočí zmeškané periody, ale neposouvá se
+                timer->expiry += timer->period;
+                if (timer->expiry < self->current)
+                    timer->expiry += ((self->current - timer->expiry + timer->period - 1) / timer->period) * timer->period;
+                insertTimer(self, timer);
+            }
+
+            timer->callback(timer->parameter, tick);
+            fired++;
+        }
+    }
+
+    self->current = tick + 1;
+
+    return fired;
+}
+
+TimerWheel
+TimerWheel_create(void)
+{
+    TimerWheel self = (TimerWheel) GLOBAL_CALLOC(1, sizeof(struct sTimerWheel));
+
+    if (self)
+        self->originMs = TimerWheel_monotonicMs();
+
+    return self;
+}
+
+void
+TimerWheel_destroy(TimerWheel self)
+{
+    if (self == NULL)
+        return;
+
+    Timer timer = self->allTimers;
+
+    while (timer) {
+        Timer next = timer->allNext;
+        GLOBAL_FREEMEM(timer);
+        timer = next;
+    }
+
+    GLOBAL_FREEMEM(self);
+}
+
+uint64_t
+TimerWheel_now(TimerWheel self)
+{
+    return TimerWheel_monotonicMs() - self->originMs;
+}
+
+Timer
+TimerWheel_addTimer(TimerWheel self, TimerCallback callback, void *parameter)
+{
+    Timer timer = (Timer) GLOBAL_CALLOC(1, sizeof(struct sTimer));
+
+    if (timer) {
+        timer->callback = callback;
+        timer->parameter = parameter;
+        timer->allNext = self->allTimers;
+        self->allTimers = timer;
+    }
+
+    return timer;
+}
+
+void
+TimerWheel_removeTimer(TimerWheel self, Timer timer)
+{
+    if (timer == NULL)
+        return;
+
+    unlinkTimer(self, timer);
+
+    Timer *link = &self->allTimers;
+
+    while (*link && (*link != timer))
+        link = &(*link)->allNext;
+
+    if (*link)
+        *link = timer->allNext;
+
+    GLOBAL_FREEMEM(timer);
+}
+
+void
+TimerWheel_start(TimerWheel self, Timer timer, uint64_t delayMs, uint64_t periodMs)
+{
+    unlinkTimer(self, timer);
+
+    uint64_t now = TimerWheel_now(self);
+
+    // Kolo mohlo zaostat za hodinami (dlouhý callback) – počítej od skutečného času
+    timer->expiry = ((now > self->current) ? now : self->current) + delayMs;
+    timer->period = periodMs;
+
+    insertTimer(self, timer);
+}
+
+void
+TimerWheel_stop(TimerWheel self, Timer timer)
+{
+    unlinkTimer(self, timer);
+}
+
+bool
+TimerWheel_isActive(Timer timer)
+{
+    return (timer != NULL) && (timer->head != NULL);
+}
+
+int
+TimerWheel_process(TimerWheel self)
+{
+    uint64_t now = TimerWheel_now(self);
+    int fired = 0;
+
+    while (self->current <= now) {
+        // Prázdný zbytek nejnižší úrovně přeskoč až k další hranici
+        if ((self->current & WHEEL_MASK) != 0 && findSlot(self->bitmap[0], (int) (self->current & WHEEL_MASK)) < 0) {
+            uint64_t boundary = (self->current | WHEEL_MASK) + 1;
+            self->current = (boundary <= now + 1) ? boundary : now + 1;
+            continue;
+        }
+
+        fired += processTick(self);
+    }
+
+    return fired;
+}
+
+int64_t
+TimerWheel_getMsToNext(TimerWheel self)
+{
+    uint64_t now = TimerWheel_now(self);
+    uint64_t deadline = UINT64_MAX;
+
+    for (int level = 0; level < WHEEL_LEVELS; level++) {
+        int shift = WHEEL_BITS * level;
+        int current = (int) ((self->current >> shift) & WHEEL_MASK);
+
+        // Ve vyšších úrovních je aktuální slot kaskádovaný až při zpracování hraničního ticku
+        bool atBoundary = (self->current & ((1ULL << shift) - 1)) == 0;
+        int from = atBoundary ? current : current + 1;
+
+        int slot = (from < WHEEL_SLOTS) ? findSlot(self->bitmap[level], from) : -1;
+
+        if (slot < 0)
+            continue;
+
+        // U vyšších úrovní známe jen začátek slotu – probudíme se tam a proběhne kaskáda
+        uint64_t windowStart = (self->current >> (shift + WHEEL_BITS)) << (shift + WHEEL_BITS);
+        uint64_t slotStart = windowStart + ((uint64_t) slot << shift);
+
+        if (slotStart < self->current)
+            slotStart = self->current;
+
+        if (slotStart < deadline)
+            deadline = slotStart;
+    }
+
+    if (deadline == UINT64_MAX)
+        return -1;
+
+    return (deadline > now) ? (int64_t) (deadline - now) : 0;
+}
+
+void
+TimerWheel_sleep(TimerWheel self, int maxMs)
+{
+    int64_t ms = TimerWheel_getMsToNext(self);
+
+    if ((ms < 0) || (ms > maxMs))
+        ms = maxMs;
+
+    if (ms <= 0)
+        return;
+
+    // Absolutní čas probuzení – nenasčítává se zpoždění jednotlivých spánků; CLOCK_MONOTONIC
+    // jsou na POSIX tytéž hodiny jako Hal_getMonotonicTimeInNs
+    uint64_t wakeMs = self->originMs + TimerWheel_now(self) + (uint64_t) ms;
+
+    struct timespec ts;
+    ts.tv_sec = (time_t) (wakeMs / 1000);
+    ts.tv_nsec = (long) ((wakeMs % 1000) * 1000000L);
+
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+int64_t
+TimerWheel_parseDuration(const char *text)
+{
+    if (text == NULL)
+        return -1;
+
+    char *end;
+    double value = strtod(text, &end);
+
+    if ((end == text) || (value < 0))
+        return -1;
+
+    while (*end == ' ')
+        end++;
+
+    if (strncmp(end, "ms", 2) == 0)
+        return (int64_t) (value + 0.5);
+
+    if ((*end == 's') || (*end == '\0') || (*end == ';') || (*end == '\r') || (*end == '\n'))
+        return (int64_t) (value * 1000.0 + 0.5);
+
+    return -1;
+}
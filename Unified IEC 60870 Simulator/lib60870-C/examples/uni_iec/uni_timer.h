@@ -0,0 +1,62 @@
+// =======================
+// HIERARCHICKÉ ČASOVÉ KOLO (timer wheel) S ROZLIŠENÍM 1 ms
+// =======================
+//
+// Čtyři úrovně po 256 slotech (1 ms, 256 ms, 65,5 s, 4,6 h) nad monotónními
+// hodinami. Přidání i zrušení časovače je O(1), obsluha jednoho ticku také.
+// Hlavní smyčka volá TimerWheel_process() a TimerWheel_sleep(), který spí
+// přesně do nejbližšího termínu (ne po celých sekundách).
+
+#ifndef UNI_TIMER_H_
+#define UNI_TIMER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct sTimerWheel* TimerWheel;
+typedef struct sTimer* Timer;
+
+// Callback časovače, now = monotónní čas v ms (od vytvoření kola)
+typedef void (*TimerCallback)(void *parameter, uint64_t now);
+
+TimerWheel TimerWheel_create(void);
+
+// Uvolní kolo i všechny časovače vytvořené přes TimerWheel_addTimer
+void TimerWheel_destroy(TimerWheel self);
+
+// Aktuální monotónní čas v ms (od vytvoření kola)
+uint64_t TimerWheel_now(TimerWheel self);
+
+// Vytvoří (zatím neaktivní) časovač
+Timer TimerWheel_addTimer(TimerWheel self, TimerCallback callback, void *parameter);
+
+// Zastaví a uvolní časovač
+void TimerWheel_removeTimer(TimerWheel self, Timer timer);
+
+// Spustí časovač za delayMs; periodMs > 0 = periodický s pevnou fází (bez driftu)
+void TimerWheel_start(TimerWheel self, Timer timer, uint64_t delayMs, uint64_t periodMs);
+
+// Zastaví časovač (lze znovu spustit přes TimerWheel_start)
+void TimerWheel_stop(TimerWheel self, Timer timer);
+
+bool TimerWheel_isActive(Timer timer);
+
+// Obslouží všechny časovače, kterým už vypršel termín, vrací počet spuštěných
+int TimerWheel_process(TimerWheel self);
+
+// Počet ms do nejbližšího termínu (0 = ihned), -1 pokud nic neběží
+int64_t TimerWheel_getMsToNext(TimerWheel self);
+
+// Spí do nejbližšího termínu, nejdéle však maxMs (přeruší ho i signál)
+void TimerWheel_sleep(TimerWheel self, int maxMs);
+
+// Monotónní hodiny celého simulátoru (Hal_getMonotonicTimeInNs, nezávislé na změně systémového
+// času); stejný zdroj používá i kolo. Pro měření intervalů, ne pro časové značky.
+uint64_t TimerWheel_monotonicNs(void);
+uint64_t TimerWheel_monotonicUs(void);
+uint64_t TimerWheel_monotonicMs(void);
+
+// Převod textu "20", "0.5", "250ms" na milisekundy (bez jednotky = sekundy), -1 při chybě
+int64_t TimerWheel_parseDuration(const char *text);
+
+#endif /* UNI_TIMER_H_ */
@@ -96,6 +96,19 @@ SerialPort_getBaudRate(SerialPort self);
 PAL_API void
 SerialPort_setTimeout(SerialPort self, int timeout);
 
+/**
+ * \brief Wait until received data is available or the timeout elapses
+ *
+ * Does not consume any data. Allows an application that calls the link layer
+ * from its own loop to sleep on the serial line instead of polling it.
+ *
+ * \param timeoutInMs maximum time to wait in ms (0 = only check)
+ *
+ * \return 1 if data is available, 0 on timeout, -1 in case of an error or an interrupting signal
+ */
+PAL_API int
+SerialPort_waitForData(SerialPort self, int timeoutInMs);
+
 /**
  * \brief Discard all data in the input buffer of the serial interface
  */
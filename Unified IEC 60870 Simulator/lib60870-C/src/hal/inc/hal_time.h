@@ -57,6 +57,18 @@ Hal_getTimeInMs(void);
 PAL_API nsSinceEpoch
 Hal_getTimeInNs(void);
 
+/**
+ * Get a monotonic time in nanoseconds.
+ *
+ * The value has no relation to the calendar time and is only useful for measuring
+ * intervals. Unlike \ref Hal_getTimeInNs it is not affected when the system time is set
+ * or stepped.
+ *
+ * \return a monotonic time with nanosecond resolution.
+ */
+PAL_API uint64_t
+Hal_getMonotonicTimeInNs(void);
+
 /**
 * Set the system time from ns time
 *
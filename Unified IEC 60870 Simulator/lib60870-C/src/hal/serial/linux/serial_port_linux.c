@@ -248,6 +248,26 @@ SerialPort_readByte(SerialPort self)
     }
 }
 
+int
+SerialPort_waitForData(SerialPort self, int timeoutInMs)
+{
+    fd_set set;
+    struct timeval timeout;
+
+    FD_ZERO(&set);
+    FD_SET(self->fd, &set);
+
+    timeout.tv_sec = timeoutInMs / 1000;
+    timeout.tv_usec = (timeoutInMs % 1000) * 1000;
+
+    int ret = select(self->fd + 1, &set, NULL, NULL, &timeout);
+
+    if (ret == -1)
+        return -1;
+
+    return (ret > 0) ? 1 : 0;
+}
+
 int
 SerialPort_write(SerialPort self, uint8_t* buffer, int startPos, int bufSize)
 {
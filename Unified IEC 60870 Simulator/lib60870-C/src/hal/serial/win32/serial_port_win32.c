@@ -245,6 +245,28 @@ SerialPort_readByte(SerialPort self)
 		return (int) buf[0];
 }
 
+int
+SerialPort_waitForData(SerialPort self, int timeoutInMs)
+{
+	uint64_t start = Hal_getTimeInMs();
+
+	while (true) {
+		DWORD errors;
+		COMSTAT status;
+
+		if (ClearCommError(self->comPort, &errors, &status) == false)
+			return -1;
+
+		if (status.cbInQue > 0)
+			return 1;
+
+		if ((Hal_getTimeInMs() - start) >= (uint64_t) timeoutInMs)
+			return 0;
+
+		Sleep(1);
+	}
+}
+
 int
 SerialPort_write(SerialPort self, uint8_t* buffer, int startPos, int bufSize)
 {
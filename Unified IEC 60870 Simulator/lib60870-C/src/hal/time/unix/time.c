@@ -65,3 +65,12 @@ Hal_setTimeInNs(nsSinceEpoch nsTime)
 
 #endif
 
+uint64_t
+Hal_getMonotonicTimeInNs()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t) now.tv_sec * 1000000000ULL) + (uint64_t) now.tv_nsec;
+}
@@ -42,6 +42,21 @@ Hal_getTimeInNs()
    return nsTime;
 }
 
+uint64_t
+Hal_getMonotonicTimeInNs()
+{
+   static LARGE_INTEGER frequency;
+   LARGE_INTEGER counter;
+
+   if (frequency.QuadPart == 0)
+      QueryPerformanceFrequency(&frequency);
+
+   QueryPerformanceCounter(&counter);
+
+   return (uint64_t) (counter.QuadPart / frequency.QuadPart) * 1000000000ULL +
+          (uint64_t) (counter.QuadPart % frequency.QuadPart) * 1000000000ULL / (uint64_t) frequency.QuadPart;
+}
+
 bool
 Hal_setTimeInNs(nsSinceEpoch nsTime)
 {
@@ -0,0 +1,286 @@
+/*
+ *  Copyright 2016-2022 Michael Zillgith
+ *
+ *  This file is part of lib60870-C
+ *
+ *  lib60870-C is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  lib60870-C is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with lib60870-C.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  See COPYING file for the complete license text.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "iec60870_common.h"
+#include "information_objects_internal.h"
+#include "lib60870_internal.h"
+#include "cs101_asdu_internal.h"
+
+#define MAX_ELEMENTS_PER_ASDU 127
+
+typedef struct {
+    CS101_AppLayerParameters parameters;
+    CS101_CauseOfTransmission cot;
+    int oa;
+    int ca;
+    bool isTest;
+    bool isNegative;
+    CS101_ASDUPackHandler handler;
+    void* parameter;
+    int numberOfASDUs;
+
+    sCS101_StaticASDU sequenceASDU;
+
+    /* ASDU collecting the information objects with individual IOAs (SQ=0) */
+    sCS101_StaticASDU singleASDU;
+    int singleCapacity;
+} sASDUPacker;
+
+static void
+emitASDU(sASDUPacker* self, CS101_ASDU asdu)
+{
+    if (self->handler)
+        self->handler(self->parameter, asdu);
+
+    self->numberOfASDUs++;
+}
+
+static void
+flushSingleASDU(sASDUPacker* self)
+{
+    CS101_ASDU asdu = (CS101_ASDU) &(self->singleASDU);
+
+    if (CS101_ASDU_getNumberOfElements(asdu) > 0) {
+        emitASDU(self, asdu);
+        CS101_ASDU_removeAllElements(asdu);
+    }
+}
+
+static bool
+addSingle(sASDUPacker* self, InformationObject io)
+{
+    CS101_ASDU asdu = (CS101_ASDU) &(self->singleASDU);
+
+    if (CS101_ASDU_addInformationObject(asdu, io))
+        return true;
+
+    flushSingleASDU(self);
+
+    return CS101_ASDU_addInformationObject(asdu, io);
+}
+
+static bool
+addSequence(sASDUPacker* self, InformationObject* ios, int count)
+{
+    CS101_ASDU asdu = CS101_ASDU_initializeStatic(&(self->sequenceASDU), self->parameters, true, self->cot,
+            self->oa, self->ca, self->isTest, self->isNegative);
+
+    int i;
+    for (i = 0; i < count; i++) {
+        if (CS101_ASDU_addInformationObject(asdu, ios[i]) == false)
+            return false;
+    }
+
+    emitASDU(self, asdu);
+
+    return true;
+}
+
+/*
+ * Only monitoring types without time tag may be transmitted with SQ=1 (IEC 60870-5-101/104 type definitions).
+ * Time tagged types, commands, parameters and system/file types are always encoded with individual IOAs.
+ */
+static bool
+isSequenceAllowed(TypeID typeId)
+{
+    switch (typeId) {
+    case M_SP_NA_1:
+    case M_DP_NA_1:
+    case M_ST_NA_1:
+    case M_BO_NA_1:
+    case M_ME_NA_1:
+    case M_ME_NB_1:
+    case M_ME_NC_1:
+    case M_IT_NA_1:
+    case M_PS_NA_1:
+    case M_ME_ND_1:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+int
+CS101_ASDU_pack(CS101_AppLayerParameters parameters, CS101_CauseOfTransmission cot, int oa, int ca,
+        bool isTest, bool isNegative, InformationObject* ios, int numberOfIOs,
+        CS101_ASDUPackHandler handler, void* parameter)
+{
+    if ((ios == NULL) || (numberOfIOs < 1))
+        return 0;
+
+    /* all information objects have to be of the same type and sorted by ascending IOA */
+    TypeID typeId = InformationObject_getType(ios[0]);
+
+    int i;
+    for (i = 1; i < numberOfIOs; i++) {
+        if (InformationObject_getType(ios[i]) != typeId)
+            return -1;
+
+        if (InformationObject_getObjectAddress(ios[i]) <= InformationObject_getObjectAddress(ios[i - 1]))
+            return -1;
+    }
+
+    sASDUPacker self;
+
+    self.parameters = parameters;
+    self.cot = cot;
+    self.oa = oa;
+    self.ca = ca;
+    self.isTest = isTest;
+    self.isNegative = isNegative;
+    self.handler = handler;
+    self.parameter = parameter;
+    self.numberOfASDUs = 0;
+
+    CS101_ASDU single = CS101_ASDU_initializeStatic(&(self.singleASDU), parameters, false, cot, oa, ca, isTest, isNegative);
+
+    /* determine the encoded element size by encoding the first information object */
+    if (CS101_ASDU_addInformationObject(single, ios[0]) == false)
+        return -1;
+
+    int elementSize = CS101_ASDU_getPayloadSize(single) - parameters->sizeOfIOA;
+    int spaceForElements = parameters->maxSizeOfASDU - self.singleASDU.asduHeaderLength;
+
+    CS101_ASDU_removeAllElements(single);
+
+    if (elementSize < 1)
+        return -1;
+
+    self.singleCapacity = spaceForElements / (parameters->sizeOfIOA + elementSize);
+
+    if (self.singleCapacity > MAX_ELEMENTS_PER_ASDU)
+        self.singleCapacity = MAX_ELEMENTS_PER_ASDU;
+
+    if (self.singleCapacity < 1)
+        return -1;
+
+    int sequenceCapacity = 0;
+
+    if (isSequenceAllowed(typeId)) {
+        sequenceCapacity = (spaceForElements - parameters->sizeOfIOA) / elementSize;
+
+        if (sequenceCapacity > MAX_ELEMENTS_PER_ASDU)
+            sequenceCapacity = MAX_ELEMENTS_PER_ASDU;
+    }
+
+    /*
+     * Choose which runs of consecutive IOAs are sent as sequences (SQ=1) so that the total number of ASDUs
+     * is minimal. Full sequence ASDUs are always taken (they hold at least as many elements as an SQ=0 ASDU).
+     * For the shorter remainders of the runs only their length matters: turning j remainders into
+     * sequences costs j ASDUs and saves their elements in the SQ=0 ASDUs, so the best choice is always
+     * the j longest remainders. All j are tried using the counts of the remainder lengths.
+     */
+    int remainderCount[MAX_ELEMENTS_PER_ASDU + 1] = { 0 };
+    int singleElements = 0;
+    int start = 0;
+
+    while (start < numberOfIOs) {
+        int end = start + 1;
+
+        while ((end < numberOfIOs) &&
+                (InformationObject_getObjectAddress(ios[end]) == InformationObject_getObjectAddress(ios[end - 1]) + 1))
+            end++;
+
+        int remainder = (sequenceCapacity > 0) ? ((end - start) % sequenceCapacity) : (end - start);
+
+        if ((sequenceCapacity > 0) && (remainder > 1))
+            remainderCount[remainder]++;
+
+        singleElements += remainder;
+        start = end;
+    }
+
+    int bestCost = (singleElements + self.singleCapacity - 1) / self.singleCapacity;
+    int bestLength = sequenceCapacity; /* remainders longer than bestLength become sequences */
+    int bestOfLength = 0;              /* and the first bestOfLength remainders of length bestLength */
+    int sequences = 0;
+    int length;
+
+    for (length = sequenceCapacity - 1; length > 1; length--) {
+        int k;
+        for (k = 1; k <= remainderCount[length]; k++) {
+            sequences++;
+            singleElements -= length;
+
+            int cost = sequences + (singleElements + self.singleCapacity - 1) / self.singleCapacity;
+
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestLength = length;
+                bestOfLength = k;
+            }
+        }
+    }
+
+    start = 0;
+
+    while (start < numberOfIOs) {
+
+        /* find the end of the run of consecutive IOAs */
+        int end = start + 1;
+
+        while ((end < numberOfIOs) &&
+                (InformationObject_getObjectAddress(ios[end]) == InformationObject_getObjectAddress(ios[end - 1]) + 1))
+            end++;
+
+        int runLength = end - start;
+
+        while ((sequenceCapacity > 0) && (runLength >= sequenceCapacity)) {
+            if (addSequence(&self, ios + start, sequenceCapacity) == false)
+                return -1;
+
+            start += sequenceCapacity;
+            runLength -= sequenceCapacity;
+        }
+
+        bool asSequence = false;
+
+        if ((sequenceCapacity > 0) && (runLength > 1)) {
+            if (runLength > bestLength)
+                asSequence = true;
+            else if ((runLength == bestLength) && (bestOfLength > 0)) {
+                asSequence = true;
+                bestOfLength--;
+            }
+        }
+
+        if (asSequence) {
+            if (addSequence(&self, ios + start, runLength) == false)
+                return -1;
+        }
+        else {
+            for (i = start; i < end; i++) {
+                if (addSingle(&self, ios[i]) == false)
+                    return -1;
+            }
+        }
+
+        start = end;
+    }
+
+    flushSingleASDU(&self);
+
+    return self.numberOfASDUs;
+}
@@ -520,6 +520,12 @@ CS101_Master_setRawMessageHandler(CS101_Master self, IEC60870_RawMessageHandler
     SerialTransceiverFT12_setRawMessageHandler(self->transceiver, handler, parameter);
 }
 
+void
+CS101_Master_setMessageTimeout(CS101_Master self, int timeoutInMs)
+{
+    SerialTransceiverFT12_setMessageTimeout(self->transceiver, timeoutInMs);
+}
+
 void
 CS101_Master_setIdleTimeout(CS101_Master self, int timeoutInMs)
 {
@@ -424,6 +424,12 @@ CS101_Slave_setIdleTimeout(CS101_Slave self, int timeoutInMs)
         LinkLayerBalanced_setIdleTimeout(self->balancedLinkLayer, timeoutInMs);
 }
 
+void
+CS101_Slave_setMessageTimeout(CS101_Slave self, int timeoutInMs)
+{
+    SerialTransceiverFT12_setMessageTimeout(self->transceiver, timeoutInMs);
+}
+
 void
 CS101_Slave_setLinkLayerStateChanged(CS101_Slave self, IEC60870_LinkLayerStateChangedHandler handler, void* parameter)
 {
@@ -105,6 +105,7 @@ struct sMessageQueueEntryInfo {
     uint64_t entryId;
     unsigned int entryState:2;
     unsigned int size:8;
+    uint32_t entryTime; /* monotonic enqueue time in us (wraps, only used for differences) */
 };
 
 struct sMessageQueue {
@@ -116,6 +117,7 @@ struct sMessageQueue {
     uint8_t* lastInBufferEntry; /* entry with highest address in FIFO buffer */
 
     uint64_t entryId; /* ID of next entry; will be increased by one for each new entry */
+    uint64_t droppedEntries; /* number of entries overwritten before they were confirmed */
     uint8_t* buffer;
 
 #if (CONFIG_USE_SEMAPHORES == 1)
@@ -134,6 +136,7 @@ MessageQueue_initialize(MessageQueue self)
     self->lastEntry = NULL;
     self->lastInBufferEntry = NULL;
     self->entryId = 1;
+    self->droppedEntries = 0;
 }
 
 static MessageQueue
@@ -207,6 +210,30 @@ MessageQueue_getEntryCount(MessageQueue self)
     return count;
 }
 
+static uint32_t
+MessageQueue_getTimeInUs(void)
+{
+    return (uint32_t) (Hal_getMonotonicTimeInNs() / 1000);
+}
+
+static uint64_t
+MessageQueue_getDroppedEntries(MessageQueue self)
+{
+    uint64_t count;
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_wait(self->queueLock);
+#endif
+
+    count = self->droppedEntries;
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_post(self->queueLock);
+#endif
+
+    return count;
+}
+
 static int
 MessageQueue_countEntriesUntilEndOfBuffer(MessageQueue self, uint8_t* firstEntry)
 {
@@ -222,6 +249,9 @@ MessageQueue_countEntriesUntilEndOfBuffer(MessageQueue self, uint8_t* firstEntry
 
         count++;
 
+        if (entryInfo.entryState != QUEUE_ENTRY_STATE_NOT_USED_OR_CONFIRMED)
+            self->droppedEntries++;
+
         /* move to next entry */
         if (entryPtr == self->lastInBufferEntry)
             break;
@@ -287,13 +317,17 @@ MessageQueue_enqueueASDU(MessageQueue self, CS101_ASDU asdu)
 
                 self->entryCounter--;
 
+                memcpy(&entryInfo, self->firstEntry, sizeof(struct sMessageQueueEntryInfo));
+
+                if (entryInfo.entryState != QUEUE_ENTRY_STATE_NOT_USED_OR_CONFIRMED)
+                    self->droppedEntries++;
+
                 if (self->firstEntry == self->lastInBufferEntry) {
                     self->firstEntry = self->buffer;
                     self->lastInBufferEntry = nextMsgPtr;
                     break;
                 }
                 else {
-                    memcpy(&entryInfo, self->firstEntry, sizeof(struct sMessageQueueEntryInfo));
                     self->firstEntry = self->firstEntry + sizeof(struct sMessageQueueEntryInfo) + entryInfo.size;
                 }
             }
@@ -315,6 +349,7 @@ MessageQueue_enqueueASDU(MessageQueue self, CS101_ASDU asdu)
     entryInfo.size = asduSize;
     entryInfo.entryId = self->entryId++;
     entryInfo.entryState = QUEUE_ENTRY_STATE_WAITING_FOR_TRANSMISSION;
+    entryInfo.entryTime = MessageQueue_getTimeInUs();
 
     memcpy(nextMsgPtr, &entryInfo, sizeof(struct sMessageQueueEntryInfo));
 
@@ -470,9 +505,15 @@ removeFirstEntry(MessageQueue self)
     self->entryCounter--;
 }
 
-static void
-MessageQueue_markAsduAsConfirmed(MessageQueue self, uint8_t* queueEntry, uint64_t entryId)
+/**
+ * Remove a confirmed ASDU from the queue. Returns true when the entry was found,
+ * latencyUs is then set to the time between enqueueing and confirmation.
+ */
+static bool
+MessageQueue_markAsduAsConfirmed(MessageQueue self, uint8_t* queueEntry, uint64_t entryId, uint32_t* latencyUs)
 {
+    bool confirmed = false;
+
     if (self->entryCounter > 0) {
         /* entryId plausibility check */
         uint64_t entryIdDiff = self->entryId - 1 - entryId;
@@ -487,6 +528,9 @@ MessageQueue_markAsduAsConfirmed(MessageQueue self, uint8_t* queueEntry, uint64_
                 entryInfo.entryState = QUEUE_ENTRY_STATE_NOT_USED_OR_CONFIRMED;
                 memcpy(queueEntry, &entryInfo, sizeof(struct sMessageQueueEntryInfo));
 
+                *latencyUs = MessageQueue_getTimeInUs() - entryInfo.entryTime;
+                confirmed = true;
+
                 if (queueEntry == self->firstEntry) {
                     removeFirstEntry(self);
                 }
@@ -500,6 +544,8 @@ MessageQueue_markAsduAsConfirmed(MessageQueue self, uint8_t* queueEntry, uint64_
             }
         }
     }
+
+    return confirmed;
 }
 
 /***************************************************
@@ -1015,6 +1061,9 @@ struct sCS104_Slave {
     CS104_SlaveRawMessageHandler rawMessageHandler;
     void* rawMessageHandlerParameter;
 
+    CS104_SlaveASDUAckHandler asduAckHandler;
+    void* asduAckHandlerParameter;
+
 #if (CONFIG_CS104_SUPPORT_TLS == 1)
     TLSConfiguration tlsConfig;
 #endif
@@ -1279,6 +1328,7 @@ createSlave(int maxLowPrioQueueSize, int maxHighPrioQueueSize)
         self->connectionRequestHandler = NULL;
         self->connectionEventHandler = NULL;
         self->rawMessageHandler = NULL;
+        self->asduAckHandler = NULL;
         self->maxLowPrioQueueSize = maxLowPrioQueueSize;
         self->maxHighPrioQueueSize = maxHighPrioQueueSize;
 
@@ -1574,6 +1624,13 @@ CS104_Slave_setRawMessageHandler(CS104_Slave self, CS104_SlaveRawMessageHandler
     self->rawMessageHandlerParameter = parameter;
 }
 
+void
+CS104_Slave_setASDUAckHandler(CS104_Slave self, CS104_SlaveASDUAckHandler handler, void* parameter)
+{
+    self->asduAckHandler = handler;
+    self->asduAckHandlerParameter = parameter;
+}
+
 CS104_APCIParameters
 CS104_Slave_getConnectionParameters(CS104_Slave self)
 {
@@ -2170,17 +2227,22 @@ checkSequenceNumber(MasterConnection self, int seqNo)
                 /* remove from server (low-priority) queue if required */
                 if (self->sentASDUs[self->oldestSentASDU].queueEntry != NULL) {
 
+                    uint32_t latencyUs = 0;
+
                     MessageQueue_lock(self->lowPrioQueue);
 
-                    MessageQueue_markAsduAsConfirmed(self->lowPrioQueue,
+                    bool confirmed = MessageQueue_markAsduAsConfirmed(self->lowPrioQueue,
                             self->sentASDUs[self->oldestSentASDU].queueEntry,
-                            self->sentASDUs[self->oldestSentASDU].entryId);
+                            self->sentASDUs[self->oldestSentASDU].entryId, &latencyUs);
 
                     self->sentASDUs[self->oldestSentASDU].queueEntry = NULL;
 
                     self->sentASDUs[self->oldestSentASDU].seqNo = -1;
 
                     MessageQueue_unlock(self->lowPrioQueue);
+
+                    if (confirmed && self->slave->asduAckHandler)
+                        self->slave->asduAckHandler(self->slave->asduAckHandlerParameter, &(self->iMasterConnection), latencyUs);
                 }
 
                 if (oldestAsduSeqNo == seqNo) {
@@ -4008,6 +4070,41 @@ CS104_Slave_getNumberOfQueueEntries(CS104_Slave self, CS104_RedundancyGroup redG
     return 0;
 }
 
+uint64_t
+CS104_Slave_getNumberOfDroppedQueueEntries(CS104_Slave self, CS104_RedundancyGroup redGroup)
+{
+#if (CONFIG_CS104_SUPPORT_SERVER_MODE_SINGLE_REDUNDANCY_GROUP == 1)
+    if (self->serverMode == CS104_MODE_SINGLE_REDUNDANCY_GROUP) {
+        return MessageQueue_getDroppedEntries(self->asduQueue);
+    }
+#endif
+#if (CONFIG_CS104_SUPPORT_SERVER_MODE_MULTIPLE_REDUNDANCY_GROUPS == 1)
+    if (self->serverMode == CS104_MODE_MULTIPLE_REDUNDANCY_GROUPS) {
+
+        if (redGroup) {
+            return MessageQueue_getDroppedEntries(redGroup->asduQueue);
+        }
+
+        DEBUG_PRINT("CS104_SLAVE: redundancy group not found\n");
+    }
+#endif
+#if (CONFIG_CS104_SUPPORT_SERVER_MODE_CONNECTION_IS_REDUNDANCY_GROUP == 1)
+    if (self->serverMode == CS104_MODE_CONNECTION_IS_REDUNDANCY_GROUP) {
+        uint64_t count = 0;
+        int i;
+
+        for (i = 0; i < CONFIG_CS104_MAX_CLIENT_CONNECTIONS; i++) {
+            if (self->masterConnections[i] && self->masterConnections[i]->lowPrioQueue)
+                count += MessageQueue_getDroppedEntries(self->masterConnections[i]->lowPrioQueue);
+        }
+
+        return count;
+    }
+#endif
+
+    return 0;
+}
+
 void
 CS104_Slave_startThreadless(CS104_Slave self)
 {
@@ -67,6 +67,12 @@ SerialTransceiverFT12_setTimeouts(SerialTransceiverFT12 self, int messageTimeout
     self->characterTimeout = characterTimeout;
 }
 
+void
+SerialTransceiverFT12_setMessageTimeout(SerialTransceiverFT12 self, int messageTimeout)
+{
+    self->messageTimeout = messageTimeout;
+}
+
 void
 SerialTransceiverFT12_setRawMessageHandler(SerialTransceiverFT12 self, IEC60870_RawMessageHandler handler, void* parameter)
 {
@@ -82,6 +82,17 @@ CS101_Master
 CS101_Master_createEx(SerialPort serialPort, const LinkLayerParameters llParameters, const CS101_AppLayerParameters alParameters, IEC60870_LinkLayerMode linkLayerMode,
         int queueSize);
 
+/**
+ * \brief Set how long \ref CS101_Master_run waits for the start of a new message
+ *
+ * The default is 10 ms. With 0 the run function never blocks on an idle line,
+ * so the application can wait for data itself (see \ref SerialPort_waitForData).
+ *
+ * \param timeoutInMs the timeout value in milliseconds
+ */
+void
+CS101_Master_setMessageTimeout(CS101_Master self, int timeoutInMs);
+
 /**
  * \brief Receive a new message and run the protocol state machine(s).
  *
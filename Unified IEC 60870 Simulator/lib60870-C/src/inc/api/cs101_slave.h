@@ -201,6 +201,17 @@ CS101_Slave_enqueueUserDataClass2(CS101_Slave self, CS101_ASDU asdu);
 void
 CS101_Slave_flushQueues(CS101_Slave self);
 
+/**
+ * \brief Set how long \ref CS101_Slave_run waits for the start of a new message
+ *
+ * The default is 10 ms. With 0 the run function never blocks on an idle line,
+ * so the application can wait for data itself (see \ref SerialPort_waitForData).
+ *
+ * \param timeoutInMs the timeout value in milliseconds
+ */
+void
+CS101_Slave_setMessageTimeout(CS101_Slave self, int timeoutInMs);
+
 /**
  * \brief Receive a new message and run the link layer state machines
  *
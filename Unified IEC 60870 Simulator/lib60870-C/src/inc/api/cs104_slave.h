@@ -105,6 +105,18 @@ typedef void (*CS104_ConnectionEventHandler) (void* parameter, IMasterConnection
  */
 typedef void (*CS104_SlaveRawMessageHandler) (void* parameter, IMasterConnection connection, uint8_t* msg, int msgSize, bool send);
 
+/**
+ * \brief Callback handler for confirmed ASDUs of the low-priority (event) queue
+ *
+ * Called by the connection thread when the master confirms an ASDU that was added by
+ * \ref CS104_Slave_enqueueASDU. The handler should return quickly.
+ *
+ * \param parameter user provided parameter
+ * \param connection the connection that received the confirmation
+ * \param latencyUs time between enqueueing the ASDU and its confirmation in microseconds
+ */
+typedef void (*CS104_SlaveASDUAckHandler) (void* parameter, IMasterConnection connection, uint32_t latencyUs);
+
 
 /**
  * \brief Create a new instance of a CS104 slave (server)
@@ -233,6 +245,15 @@ CS104_Slave_setClockSyncHandler(CS104_Slave self, CS101_ClockSynchronizationHand
 void
 CS104_Slave_setRawMessageHandler(CS104_Slave self, CS104_SlaveRawMessageHandler handler, void* parameter);
 
+/**
+ * \brief Set the callback that is called when an enqueued ASDU is confirmed by the master
+ *
+ * \param handler user provided callback handler function
+ * \param parameter user provided parameter that is passed to the callback handler
+ */
+void
+CS104_Slave_setASDUAckHandler(CS104_Slave self, CS104_SlaveASDUAckHandler handler, void* parameter);
+
 /**
  * \brief Get the APCI parameters instance. APCI parameters are CS 104 specific parameters.
  */
@@ -317,6 +338,20 @@ CS104_Slave_tick(CS104_Slave self);
 int
 CS104_Slave_getNumberOfQueueEntries(CS104_Slave self, CS104_RedundancyGroup redGroup);
 
+/**
+ * \brief Gets the number of ASDUs that were dropped from the low-priority queue
+ *
+ * An ASDU is dropped when the queue is full and the ASDU is overwritten by a newer one
+ * before it was confirmed by a master. In mode CS104_MODE_CONNECTION_IS_REDUNDANCY_GROUP
+ * the sum over all connections is returned.
+ *
+ * \param redGroup the redundancy group to use or NULL for single redundancy mode
+ *
+ * \return the number of dropped ASDUs
+ */
+uint64_t
+CS104_Slave_getNumberOfDroppedQueueEntries(CS104_Slave self, CS104_RedundancyGroup redGroup);
+
 /**
  * \brief Add an ASDU to the low-priority queue of the slave (use for periodic and spontaneous messages)
  *
@@ -585,6 +585,49 @@ CS101_ASDU_addInformationObject(CS101_ASDU self, InformationObject io);
 void
 CS101_ASDU_removeAllElements(CS101_ASDU self);
 
+/**
+ * \brief Callback handler for ASDUs created by \ref CS101_ASDU_pack
+ *
+ * NOTE: The ASDU is only valid during the callback. It has to be sent (e.g. with \ref CS101_Slave_enqueueUserDataClass1
+ * or \ref IMasterConnection_sendASDU) or copied with \ref CS101_ASDU_clone inside the handler.
+ *
+ * \param parameter user provided parameter
+ * \param asdu the packed ASDU
+ */
+typedef void (*CS101_ASDUPackHandler) (void* parameter, CS101_ASDU asdu);
+
+/**
+ * \brief Pack a batch of information objects of the same type into a minimal number of ASDUs
+ *
+ * The information objects have to be sorted by strictly ascending IOA. Runs of consecutive IOAs
+ * are encoded as sequences (SQ=1) when this reduces the total number of ASDUs, all other information
+ * objects are encoded with individual IOAs (SQ=0). Each ASDU is filled up to the maxSizeOfASDU of the
+ * application layer parameters (and to the maximum of 127 elements).
+ *
+ * Sequences are only used for the monitoring types without time tag (M_SP_NA_1, M_DP_NA_1, M_ST_NA_1,
+ * M_BO_NA_1, M_ME_NA_1, M_ME_NB_1, M_ME_NC_1, M_IT_NA_1, M_PS_NA_1, M_ME_ND_1). The standard defines
+ * all other types (time tagged types, commands, parameters, ...) with SQ=0 only, so they are always
+ * encoded with individual IOAs.
+ *
+ * \param parameters the application layer parameters used to encode the ASDUs
+ * \param cot cause of transmission (COT)
+ * \param oa originator address (OA) to be used
+ * \param ca the common address (CA) of the ASDUs
+ * \param isTest if the test flag will be set or not
+ * \param isNegative if the negative flag will be set or not
+ * \param ios array of information objects to pack
+ * \param numberOfIOs number of information objects in the array
+ * \param handler callback that is called for each packed ASDU
+ * \param parameter user provided parameter that is passed to the handler
+ *
+ * \return the number of created ASDUs, or -1 when the information objects have different types,
+ * are not sorted by ascending IOA, or cannot be encoded
+ */
+int
+CS101_ASDU_pack(CS101_AppLayerParameters parameters, CS101_CauseOfTransmission cot, int oa, int ca,
+        bool isTest, bool isNegative, InformationObject* ios, int numberOfIOs,
+        CS101_ASDUPackHandler handler, void* parameter);
+
 /**
  * \brief Get the elapsed time in ms
  */
@@ -41,6 +41,9 @@ SerialTransceiverFT12_destroy(SerialTransceiverFT12 self);
 void
 SerialTransceiverFT12_setTimeouts(SerialTransceiverFT12 self, int messageTimeout, int characterTimeout);
 
+void
+SerialTransceiverFT12_setMessageTimeout(SerialTransceiverFT12 self, int messageTimeout);
+
 void
 SerialTransceiverFT12_setRawMessageHandler(SerialTransceiverFT12 self, IEC60870_RawMessageHandler handler, void* parameter);
 
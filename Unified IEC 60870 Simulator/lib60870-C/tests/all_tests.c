@@ -860,6 +860,287 @@ test_addMaxNumberOfIOsToASDU(void)
     TEST_ASSERT_EQUAL_INT(124, ioa);
 }
 
+struct sPackResult {
+    int numberOfASDUs;
+    int numberOfSequences;
+    int numberOfElements;
+    int nextIOA;
+    bool ordered;
+};
+
+static void
+test_ASDUPack_handler(void* parameter, CS101_ASDU asdu)
+{
+    struct sPackResult* result = (struct sPackResult*) parameter;
+
+    result->numberOfASDUs++;
+
+    if (CS101_ASDU_isSequence(asdu))
+        result->numberOfSequences++;
+
+    int i;
+    for (i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
+        InformationObject io = CS101_ASDU_getElement(asdu, i);
+
+        TEST_ASSERT_NOT_NULL(io);
+
+        if (InformationObject_getObjectAddress(io) < result->nextIOA)
+            result->ordered = false;
+
+        result->nextIOA = InformationObject_getObjectAddress(io) + 1;
+        result->numberOfElements++;
+
+        InformationObject_destroy(io);
+    }
+}
+
+static int
+test_ASDUPack_runType(CS101_AppLayerParameters alParams, TypeID typeId, int* ioas, int count, struct sPackResult* result)
+{
+    InformationObject* ios = (InformationObject*) calloc(count, sizeof(InformationObject));
+
+    struct sCP56Time2a timestamp;
+    CP56Time2a_createFromMsTimestamp(&timestamp, 1700000000000ULL);
+
+    int i;
+    for (i = 0; i < count; i++) {
+        if (typeId == M_ME_TF_1)
+            ios[i] = (InformationObject) MeasuredValueShortWithCP56Time2a_create(NULL, ioas[i], (float) i,
+                    IEC60870_QUALITY_GOOD, &timestamp);
+        else
+            ios[i] = (InformationObject) MeasuredValueShort_create(NULL, ioas[i], (float) i, IEC60870_QUALITY_GOOD);
+    }
+
+    memset(result, 0, sizeof(struct sPackResult));
+    result->ordered = true;
+
+    int numberOfASDUs = CS101_ASDU_pack(alParams, CS101_COT_INTERROGATED_BY_STATION, 0, 1, false, false,
+            ios, count, test_ASDUPack_handler, result);
+
+    for (i = 0; i < count; i++)
+        InformationObject_destroy(ios[i]);
+
+    free(ios);
+
+    return numberOfASDUs;
+}
+
+static int
+test_ASDUPack_run(CS101_AppLayerParameters alParams, int* ioas, int count, struct sPackResult* result)
+{
+    return test_ASDUPack_runType(alParams, M_ME_NC_1, ioas, count, result);
+}
+
+void
+test_ASDUPackSequence(void)
+{
+    struct sCS101_AppLayerParameters salParameters;
+
+    salParameters.maxSizeOfASDU = 249;
+    salParameters.originatorAddress = 0;
+    salParameters.sizeOfCA = 2;
+    salParameters.sizeOfCOT = 2;
+    salParameters.sizeOfIOA = 3;
+    salParameters.sizeOfTypeId = 1;
+    salParameters.sizeOfVSQ = 1;
+
+    int ioas[1000];
+    struct sPackResult result;
+
+    int i;
+    for (i = 0; i < 1000; i++)
+        ioas[i] = 1000 + i;
+
+    /* (249 - 6 - 3) / 5 = 48 elements per sequence ASDU -> 20 full + 1 with 40 elements */
+    int numberOfASDUs = test_ASDUPack_run(&salParameters, ioas, 1000, &result);
+
+    TEST_ASSERT_EQUAL_INT(21, numberOfASDUs);
+    TEST_ASSERT_EQUAL_INT(21, result.numberOfASDUs);
+    TEST_ASSERT_EQUAL_INT(21, result.numberOfSequences);
+    TEST_ASSERT_EQUAL_INT(1000, result.numberOfElements);
+    TEST_ASSERT_TRUE(result.ordered);
+
+    /* without contiguous IOAs: (249 - 6) / 8 = 30 elements per ASDU */
+    for (i = 0; i < 1000; i++)
+        ioas[i] = 1000 + (i * 2);
+
+    numberOfASDUs = test_ASDUPack_run(&salParameters, ioas, 1000, &result);
+
+    TEST_ASSERT_EQUAL_INT(34, numberOfASDUs);
+    TEST_ASSERT_EQUAL_INT(0, result.numberOfSequences);
+    TEST_ASSERT_EQUAL_INT(1000, result.numberOfElements);
+    TEST_ASSERT_TRUE(result.ordered);
+}
+
+void
+test_ASDUPackMixed(void)
+{
+    struct sCS101_AppLayerParameters salParameters;
+
+    salParameters.maxSizeOfASDU = 249;
+    salParameters.originatorAddress = 0;
+    salParameters.sizeOfCA = 2;
+    salParameters.sizeOfCOT = 2;
+    salParameters.sizeOfIOA = 3;
+    salParameters.sizeOfTypeId = 1;
+    salParameters.sizeOfVSQ = 1;
+
+    int ioas[200];
+    struct sPackResult result;
+
+    int count = 0;
+    int i;
+
+    /* 100 contiguous IOAs followed by 100 pairs of consecutive IOAs with gaps */
+    for (i = 0; i < 100; i++)
+        ioas[count++] = 1 + i;
+
+    for (i = 0; i < 50; i++) {
+        ioas[count++] = 1000 + (i * 10);
+        ioas[count++] = 1000 + (i * 10) + 1;
+    }
+
+    int numberOfASDUs = test_ASDUPack_run(&salParameters, ioas, count, &result);
+
+    /* 2 full sequences + 4 SQ=0 ASDUs for the remaining 4 + 100 elements */
+    TEST_ASSERT_EQUAL_INT(6, numberOfASDUs);
+    TEST_ASSERT_EQUAL_INT(2, result.numberOfSequences);
+    TEST_ASSERT_EQUAL_INT(200, result.numberOfElements);
+
+    /* unsorted and duplicate IOAs are rejected */
+    ioas[0] = 5; ioas[1] = 4;
+    TEST_ASSERT_EQUAL_INT(-1, test_ASDUPack_run(&salParameters, ioas, 2, &result));
+    TEST_ASSERT_EQUAL_INT(0, result.numberOfASDUs);
+
+    ioas[0] = 5; ioas[1] = 5;
+    TEST_ASSERT_EQUAL_INT(-1, test_ASDUPack_run(&salParameters, ioas, 2, &result));
+}
+
+void
+test_ASDUPackStraddle(void)
+{
+    struct sCS101_AppLayerParameters salParameters;
+
+    salParameters.maxSizeOfASDU = 249;
+    salParameters.originatorAddress = 0;
+    salParameters.sizeOfCA = 2;
+    salParameters.sizeOfCOT = 2;
+    salParameters.sizeOfIOA = 3;
+    salParameters.sizeOfTypeId = 1;
+    salParameters.sizeOfVSQ = 1;
+
+    int ioas[100];
+    struct sPackResult result;
+
+    int count = 0;
+    int i, j;
+
+    /* three runs of 16 IOAs: 48 elements fit into 2 SQ=0 ASDUs (30 per ASDU), sequences would need 3 ASDUs */
+    for (j = 0; j < 3; j++) {
+        for (i = 0; i < 16; i++)
+            ioas[count++] = 100 + (j * 100) + i;
+    }
+
+    TEST_ASSERT_EQUAL_INT(2, test_ASDUPack_run(&salParameters, ioas, count, &result));
+    TEST_ASSERT_EQUAL_INT(0, result.numberOfSequences);
+    TEST_ASSERT_EQUAL_INT(48, result.numberOfElements);
+
+    /* 25 single IOAs leave 5 free slots in the open SQ=0 ASDU, the following run of 40 goes into a sequence */
+    count = 0;
+
+    for (i = 0; i < 25; i++)
+        ioas[count++] = 100 + (i * 2);
+
+    for (i = 0; i < 40; i++)
+        ioas[count++] = 1000 + i;
+
+    TEST_ASSERT_EQUAL_INT(2, test_ASDUPack_run(&salParameters, ioas, count, &result));
+    TEST_ASSERT_EQUAL_INT(1, result.numberOfSequences);
+    TEST_ASSERT_EQUAL_INT(65, result.numberOfElements);
+}
+
+void
+test_ASDUPackTimeTagged(void)
+{
+    struct sCS101_AppLayerParameters salParameters;
+
+    salParameters.maxSizeOfASDU = 249;
+    salParameters.originatorAddress = 0;
+    salParameters.sizeOfCA = 2;
+    salParameters.sizeOfCOT = 2;
+    salParameters.sizeOfIOA = 3;
+    salParameters.sizeOfTypeId = 1;
+    salParameters.sizeOfVSQ = 1;
+
+    int ioas[100];
+    struct sPackResult result;
+
+    int i;
+    for (i = 0; i < 100; i++)
+        ioas[i] = 1000 + i;
+
+    /* M_ME_TF_1 is defined with SQ=0 only: (249 - 6) / (3 + 12) = 16 elements per ASDU */
+    TEST_ASSERT_EQUAL_INT(7, test_ASDUPack_runType(&salParameters, M_ME_TF_1, ioas, 100, &result));
+    TEST_ASSERT_EQUAL_INT(0, result.numberOfSequences);
+    TEST_ASSERT_EQUAL_INT(100, result.numberOfElements);
+    TEST_ASSERT_TRUE(result.ordered);
+}
+
+void
+test_ASDUPackSizeOfIOA(void)
+{
+    struct sCS101_AppLayerParameters salParameters;
+
+    salParameters.maxSizeOfASDU = 249;
+    salParameters.originatorAddress = 0;
+    salParameters.sizeOfCA = 1;
+    salParameters.sizeOfCOT = 1;
+    salParameters.sizeOfIOA = 1;
+    salParameters.sizeOfTypeId = 1;
+    salParameters.sizeOfVSQ = 1;
+
+    int ioas[100];
+    struct sPackResult result;
+
+    int i;
+    for (i = 0; i < 100; i++)
+        ioas[i] = 1 + i;
+
+    /* (249 - 4 - 1) / 5 = 48 elements per sequence -> 2 sequences, the last 4 fit into one SQ=0 ASDU */
+    TEST_ASSERT_EQUAL_INT(3, test_ASDUPack_run(&salParameters, ioas, 100, &result));
+    TEST_ASSERT_EQUAL_INT(2, result.numberOfSequences);
+    TEST_ASSERT_EQUAL_INT(100, result.numberOfElements);
+    TEST_ASSERT_TRUE(result.ordered);
+
+    /* (249 - 4) / (1 + 5) = 40 elements per SQ=0 ASDU */
+    for (i = 0; i < 100; i++)
+        ioas[i] = 1 + (i * 2);
+
+    TEST_ASSERT_EQUAL_INT(3, test_ASDUPack_run(&salParameters, ioas, 100, &result));
+    TEST_ASSERT_EQUAL_INT(0, result.numberOfSequences);
+    TEST_ASSERT_EQUAL_INT(100, result.numberOfElements);
+    TEST_ASSERT_EQUAL_INT(200, result.nextIOA);
+    TEST_ASSERT_TRUE(result.ordered);
+
+    salParameters.sizeOfCA = 2;
+    salParameters.sizeOfCOT = 2;
+    salParameters.sizeOfIOA = 2;
+
+    /* (249 - 6) / (2 + 5) = 34 elements per SQ=0 ASDU */
+    TEST_ASSERT_EQUAL_INT(3, test_ASDUPack_run(&salParameters, ioas, 100, &result));
+    TEST_ASSERT_EQUAL_INT(0, result.numberOfSequences);
+    TEST_ASSERT_EQUAL_INT(100, result.numberOfElements);
+    TEST_ASSERT_TRUE(result.ordered);
+
+    /* (249 - 6 - 2) / 5 = 48 elements per sequence */
+    for (i = 0; i < 100; i++)
+        ioas[i] = 60000 + i;
+
+    TEST_ASSERT_EQUAL_INT(3, test_ASDUPack_run(&salParameters, ioas, 100, &result));
+    TEST_ASSERT_EQUAL_INT(2, result.numberOfSequences);
+    TEST_ASSERT_EQUAL_INT(60100, result.nextIOA);
+}
+
 void
 test_SingleEventType(void)
 {
@@ -1140,6 +1421,7 @@ struct sTestMessageQueueEntryInfo {
 	uint64_t entryTimestamp;
 	unsigned int entryState : 2;
 	unsigned int size : 8;
+	uint32_t entryTime;
 };
 
 void
@@ -1598,6 +1880,92 @@ test_CS104SlaveEventQueueOverflow3()
     CS104_Slave_destroy(slave);
 }
 
+struct stest_CS104SlaveEventQueueStatistics {
+    volatile int ackHandlerCalled; /* polled by the test thread */
+    uint32_t maxLatencyUs;
+};
+
+static void
+test_CS104SlaveEventQueueStatistics_ackHandler(void* parameter, IMasterConnection connection, uint32_t latencyUs)
+{
+    struct stest_CS104SlaveEventQueueStatistics* stats = (struct stest_CS104SlaveEventQueueStatistics*) parameter;
+
+    stats->ackHandlerCalled++;
+
+    if (latencyUs > stats->maxLatencyUs)
+        stats->maxLatencyUs = latencyUs;
+}
+
+void
+test_CS104SlaveEventQueueStatistics()
+{
+    CS104_Slave slave = CS104_Slave_create(2, 2);
+
+    CS104_Slave_setServerMode(slave, CS104_MODE_SINGLE_REDUNDANCY_GROUP);
+    CS104_Slave_setLocalPort(slave, 20004);
+
+    struct stest_CS104SlaveEventQueueStatistics stats;
+    stats.ackHandlerCalled = 0;
+    stats.maxLatencyUs = 0;
+
+    CS104_Slave_setASDUAckHandler(slave, test_CS104SlaveEventQueueStatistics_ackHandler, &stats);
+
+    CS104_Slave_start(slave);
+
+    CS101_AppLayerParameters alParams = CS104_Slave_getAppLayerParameters(slave);
+
+    int asduSize = 6 + 3 + 1;
+    int entrySize = sizeof(struct sTestMessageQueueEntryInfo) + asduSize;
+    int msgQueueCapacity = ((sizeof(struct sTestMessageQueueEntryInfo) + 256) * 2) / entrySize;
+
+    /* overflow the queue without a connected master */
+    for (int i = 0; i < 100; i++) {
+        CS101_ASDU newAsdu = CS101_ASDU_create(alParams, false, CS101_COT_SPONTANEOUS, 0, 1, false, false);
+
+        InformationObject io = (InformationObject) SinglePointInformation_create(NULL, 101, true, IEC60870_QUALITY_GOOD);
+
+        CS101_ASDU_addInformationObject(newAsdu, io);
+
+        InformationObject_destroy(io);
+
+        CS104_Slave_enqueueASDU(slave, newAsdu);
+
+        CS101_ASDU_destroy(newAsdu);
+    }
+
+    TEST_ASSERT_EQUAL_INT(msgQueueCapacity, CS104_Slave_getNumberOfQueueEntries(slave, NULL));
+    TEST_ASSERT_EQUAL_UINT64(100 - msgQueueCapacity, CS104_Slave_getNumberOfDroppedQueueEntries(slave, NULL));
+
+    CS104_Connection con = CS104_Connection_create("127.0.0.1", 20004);
+
+    bool result = CS104_Connection_connect(con);
+    TEST_ASSERT_TRUE(result);
+
+    CS104_Connection_sendStartDT(con);
+
+    /* the master confirms after every w (8) received I messages */
+    int expectedAcks = (msgQueueCapacity / 8) * 8;
+
+    uint64_t deadline = Hal_getMonotonicTimeInNs() / 1000000 + 5000;
+
+    while ((stats.ackHandlerCalled < expectedAcks) && (Hal_getMonotonicTimeInNs() / 1000000 < deadline))
+        Thread_sleep(10);
+
+    /* no further confirmations are pending */
+    Thread_sleep(50);
+
+    TEST_ASSERT_EQUAL_INT(expectedAcks, stats.ackHandlerCalled);
+    TEST_ASSERT_TRUE(stats.maxLatencyUs > 0);
+
+    /* confirmed ASDUs are not counted as dropped */
+    TEST_ASSERT_EQUAL_UINT64(100 - msgQueueCapacity, CS104_Slave_getNumberOfDroppedQueueEntries(slave, NULL));
+
+    CS104_Connection_close(con);
+
+    CS104_Connection_destroy(con);
+
+    CS104_Slave_destroy(slave);
+}
 
 void
 test_IpAddressHandling(void)
@@ -6425,6 +6793,11 @@ main(int argc, char** argv)
     RUN_TEST(test_CP56Time2aConversionFunctions);
     RUN_TEST(test_StepPositionInformation);
     RUN_TEST(test_addMaxNumberOfIOsToASDU);
+    RUN_TEST(test_ASDUPackSequence);
+    RUN_TEST(test_ASDUPackMixed);
+    RUN_TEST(test_ASDUPackStraddle);
+    RUN_TEST(test_ASDUPackTimeTagged);
+    RUN_TEST(test_ASDUPackSizeOfIOA);
     RUN_TEST(test_SingleEventType);
 
     RUN_TEST(test_SinglePointInformation);
@@ -6500,6 +6873,7 @@ main(int argc, char** argv)
     RUN_TEST(test_CS104SlaveEventQueueOverflow2);
     RUN_TEST(test_CS104SlaveEventQueueCheckCapacity);
     RUN_TEST(test_CS104SlaveEventQueueOverflow3);
+    RUN_TEST(test_CS104SlaveEventQueueStatistics);
 
     RUN_TEST(test_CS104_Connection_ConnectTimeout);
 